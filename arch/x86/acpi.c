@@ -0,0 +1,318 @@
+#include <llanos/types.h>
+
+#include "acpi.h"
+
+/* MADT entry types */
+#define ACPI_MADT_ENTRY_LAPIC               0
+#define ACPI_MADT_ENTRY_IOAPIC              1
+#define ACPI_MADT_ENTRY_SOURCE_OVERRIDE     2
+#define ACPI_MADT_ENTRY_LAPIC_OVERRIDE      5
+
+/* bytes of the RSDP covered by the revision 0 checksum */
+#define ACPI_RSDP_V1_LENGTH                 20
+
+typedef struct acpi_madt_s acpi_madt_t;
+typedef struct acpi_madt_entry_s acpi_madt_entry_t;
+typedef struct acpi_madt_lapic_s acpi_madt_lapic_t;
+typedef struct acpi_madt_ioapic_s acpi_madt_ioapic_t;
+typedef struct acpi_madt_source_override_s acpi_madt_source_override_t;
+typedef struct acpi_madt_lapic_override_s acpi_madt_lapic_override_t;
+typedef struct acpi_gas_s acpi_gas_t;
+typedef struct acpi_hpet_s acpi_hpet_t;
+
+/**
+ * @brief Multiple APIC Description Table, followed by its entries.
+ *
+ * @member header table header ("APIC").
+ * @member lapic_address physical address of the local APIC registers.
+ * @member flags ACPI_MADT_PCAT_COMPAT.
+ */
+struct acpi_madt_s {
+    acpi_sdt_header_t header;
+    u32 lapic_address;
+    u32 flags;
+} __attribute__((packed));
+
+/**
+ * @brief Header of every MADT entry.
+ *
+ * @member type one of ACPI_MADT_ENTRY_*.
+ * @member length size of the entry including this header.
+ */
+struct acpi_madt_entry_s {
+    u8 type;
+    u8 length;
+} __attribute__((packed));
+
+struct acpi_madt_lapic_s {
+    acpi_madt_entry_t header;
+    u8 processor_id;
+    u8 apic_id;
+    u32 flags;
+} __attribute__((packed));
+
+struct acpi_madt_ioapic_s {
+    acpi_madt_entry_t header;
+    u8 id;
+    u8 reserved;
+    u32 address;
+    u32 gsi_base;
+} __attribute__((packed));
+
+struct acpi_madt_source_override_s {
+    acpi_madt_entry_t header;
+    u8 bus;
+    u8 source;
+    u32 gsi;
+    u16 flags;
+} __attribute__((packed));
+
+struct acpi_madt_lapic_override_s {
+    acpi_madt_entry_t header;
+    u16 reserved;
+    u64 address;
+} __attribute__((packed));
+
+/**
+ * @brief Generic address structure, locates registers in an address space.
+ *
+ * @member space address space (ACPI_ADDRESS_SPACE_MEMORY for memory mapped registers).
+ * @member bit_width width of the registers in bits.
+ * @member bit_offset offset of the registers in bits.
+ * @member access_size access size (0 undefined, 1 byte up to 4 qword).
+ * @member address address of the registers.
+ */
+struct acpi_gas_s {
+    u8 space;
+    u8 bit_width;
+    u8 bit_offset;
+    u8 access_size;
+    u64 address;
+} __attribute__((packed));
+
+/**
+ * @brief High Precision Event Timer table.
+ *
+ * @member header table header ("HPET").
+ * @member block_id copy of the low dword of the capabilities register.
+ * @member base registers of the HPET.
+ * @member number sequence number of the HPET.
+ * @member min_tick fewest counter ticks of a periodic timer.
+ * @member page_protection page protection and OEM attributes.
+ */
+struct acpi_hpet_s {
+    acpi_sdt_header_t header;
+    u32 block_id;
+    acpi_gas_t base;
+    u8 number;
+    u16 min_tick;
+    u8 page_protection;
+} __attribute__((packed));
+
+/**
+ * @brief Compare the 4 character signature of a table.
+ *
+ * @param header table to check.
+ * @param signature expected signature.
+ * @return true if the signatures are equal.
+ */
+static bool __acpi_signature_equal(const acpi_sdt_header_t* header, const char* signature) {
+    size_t index;
+
+    for (index = 0; index < sizeof(header->signature); index++) {
+        if (header->signature[index] != signature[index]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check the signature and checksum of a candidate RSDP.
+ *
+ * @param rsdp candidate RSDP.
+ * @return true if it is a valid RSDP.
+ */
+static bool __acpi_rsdp_valid(const acpi_rsdp_t* rsdp) {
+    static const char signature[] = "RSD PTR ";
+    size_t index;
+
+    for (index = 0; index < sizeof(rsdp->signature); index++) {
+        if (rsdp->signature[index] != signature[index]) {
+            return false;
+        }
+    }
+
+    if (acpi_checksum(rsdp, ACPI_RSDP_V1_LENGTH) != 0) {
+        return false;
+    }
+    return rsdp->revision < 2 || acpi_checksum(rsdp, rsdp->length) == 0;
+}
+
+u8 acpi_checksum(const void* data, size_t length) {
+    const u8* bytes = (const u8*)data;
+    u8 sum = 0;
+    size_t index;
+
+    for (index = 0; index < length; index++) {
+        sum += bytes[index];
+    }
+    return sum;
+}
+
+const acpi_rsdp_t* acpi_find_rsdp(const u8* start, size_t length) {
+    size_t offset;
+
+    for (offset = 0; offset + ACPI_RSDP_V1_LENGTH <= length; offset += 16) {
+        if (__acpi_rsdp_valid((const acpi_rsdp_t*)&start[offset])) {
+            return (const acpi_rsdp_t*)&start[offset];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Read the segment of the EBDA from the BIOS data area.
+ *
+ * GCC takes a pointer below the first page for a null pointer offset and
+ * warns about the read, so the address goes through an empty asm.
+ *
+ * @return physical address of the EBDA, 0 if the BIOS gave none.
+ */
+static u32 __acpi_ebda_address(void) {
+    const volatile u16* pointer;
+
+    __asm__("" : "=r"(pointer) : "0"((uintptr_t)ACPI_EBDA_SEGMENT_POINTER));
+    return (u32)*pointer << 4;
+}
+
+const acpi_rsdp_t* acpi_find_bios_rsdp(void) {
+    u32 ebda = __acpi_ebda_address();
+    const acpi_rsdp_t* rsdp = NULL;
+
+    if (ebda != 0) {
+        rsdp = acpi_find_rsdp((const u8*)(uintptr_t)ebda, ACPI_EBDA_SEARCH_LENGTH);
+    }
+    if (rsdp == NULL) {
+        rsdp = acpi_find_rsdp((const u8*)(uintptr_t)ACPI_BIOS_AREA_START, ACPI_BIOS_AREA_END - ACPI_BIOS_AREA_START);
+    }
+    return rsdp;
+}
+
+const acpi_sdt_header_t* acpi_find_table(const acpi_rsdp_t* rsdp, const char* signature) {
+    const acpi_sdt_header_t* root;
+    const acpi_sdt_header_t* table;
+    const u8* entries;
+    size_t entry_size;
+    size_t count;
+    size_t index;
+    u64 address;
+
+    /* the XSDT can only be used when it is reachable with 32-bit addresses */
+    if (rsdp->revision >= 2 && rsdp->xsdt_address != 0 && rsdp->xsdt_address < 0x100000000ULL) {
+        root = (const acpi_sdt_header_t*)(uintptr_t)rsdp->xsdt_address;
+        entry_size = sizeof(u64);
+    } else {
+        root = (const acpi_sdt_header_t*)(uintptr_t)rsdp->rsdt_address;
+        entry_size = sizeof(u32);
+    }
+
+    if (acpi_checksum(root, root->length) != 0) {
+        return NULL;
+    }
+
+    entries = (const u8*)root + sizeof(acpi_sdt_header_t);
+    count = (root->length - sizeof(acpi_sdt_header_t)) / entry_size;
+    for (index = 0; index < count; index++) {
+        address = entry_size == sizeof(u64) ? \
+            *(const u64*)&entries[index * entry_size] : \
+            *(const u32*)&entries[index * entry_size];
+        if (address >= 0x100000000ULL) {
+            continue;
+        }
+
+        table = (const acpi_sdt_header_t*)(uintptr_t)address;
+        if (__acpi_signature_equal(table, signature) && acpi_checksum(table, table->length) == 0) {
+            return table;
+        }
+    }
+    return NULL;
+}
+
+bool acpi_parse_madt(const acpi_sdt_header_t* madt, acpi_madt_info_t* info) {
+    const acpi_madt_t* table = (const acpi_madt_t*)madt;
+    const u8* position = (const u8*)madt + sizeof(acpi_madt_t);
+    const u8* end = (const u8*)madt + madt->length;
+    const acpi_madt_entry_t* entry;
+    const acpi_madt_lapic_t* lapic;
+    const acpi_madt_ioapic_t* ioapic;
+    const acpi_madt_source_override_t* source_override;
+    const acpi_madt_lapic_override_t* lapic_override;
+    u32 irq;
+
+    info->lapic_address = table->lapic_address;
+    info->legacy_pics = (table->flags & ACPI_MADT_PCAT_COMPAT) != 0;
+    info->cpu_count = 0;
+    info->ioapic_count = 0;
+    for (irq = 0; irq < ACPI_ISA_IRQ_COUNT; irq++) {
+        info->isa_routes[irq].gsi = irq;
+        info->isa_routes[irq].flags = 0;
+    }
+
+    for (; position + sizeof(acpi_madt_entry_t) <= end; position += entry->length) {
+        entry = (const acpi_madt_entry_t*)position;
+        if (entry->length < sizeof(acpi_madt_entry_t) || position + entry->length > end) {
+            break;
+        }
+
+        switch (entry->type) {
+            case ACPI_MADT_ENTRY_LAPIC:
+                lapic = (const acpi_madt_lapic_t*)entry;
+                if ((lapic->flags & ACPI_MADT_CPU_ENABLED) && info->cpu_count < ACPI_MAX_CPUS) {
+                    info->apic_ids[info->cpu_count++] = lapic->apic_id;
+                }
+                break;
+            case ACPI_MADT_ENTRY_IOAPIC:
+                ioapic = (const acpi_madt_ioapic_t*)entry;
+                if (info->ioapic_count < ACPI_MAX_IOAPICS) {
+                    info->ioapics[info->ioapic_count].id = ioapic->id;
+                    info->ioapics[info->ioapic_count].address = ioapic->address;
+                    info->ioapics[info->ioapic_count].gsi_base = ioapic->gsi_base;
+                    info->ioapic_count++;
+                }
+                break;
+            case ACPI_MADT_ENTRY_SOURCE_OVERRIDE:
+                source_override = (const acpi_madt_source_override_t*)entry;
+                if (source_override->bus == 0 && source_override->source < ACPI_ISA_IRQ_COUNT) {
+                    info->isa_routes[source_override->source].gsi = source_override->gsi;
+                    info->isa_routes[source_override->source].flags = source_override->flags;
+                }
+                break;
+            case ACPI_MADT_ENTRY_LAPIC_OVERRIDE:
+                lapic_override = (const acpi_madt_lapic_override_t*)entry;
+                if (lapic_override->address < 0x100000000ULL) {
+                    info->lapic_address = (u32)lapic_override->address;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return info->cpu_count > 0 && info->ioapic_count > 0;
+}
+
+bool acpi_parse_hpet(const acpi_sdt_header_t* hpet, acpi_hpet_info_t* info) {
+    const acpi_hpet_t* table = (const acpi_hpet_t*)hpet;
+
+    if (hpet->length < sizeof(acpi_hpet_t) || \
+            table->base.space != ACPI_ADDRESS_SPACE_MEMORY || \
+            table->base.address >= 0x100000000ULL) {
+        return false;
+    }
+
+    info->address = (u32)table->base.address;
+    info->number = table->number;
+    info->min_tick = table->min_tick;
+    return true;
+}
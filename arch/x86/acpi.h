@@ -0,0 +1,203 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* CPUs and I/O APICs the MADT is read for, further entries are ignored */
+#define ACPI_MAX_CPUS                   8
+#define ACPI_MAX_IOAPICS                4
+
+/* ISA IRQs that may be redirected by MADT interrupt source overrides */
+#define ACPI_ISA_IRQ_COUNT              16
+
+/* MPS INTI flags of an interrupt source override */
+#define ACPI_MADT_POLARITY_MASK         0x3
+#define ACPI_MADT_POLARITY_ACTIVE_LOW   0x3
+#define ACPI_MADT_TRIGGER_MASK          0xc
+#define ACPI_MADT_TRIGGER_LEVEL         0xc
+
+/* MADT flag telling there are 8259 PICs to disable when the APICs are used */
+#define ACPI_MADT_PCAT_COMPAT           (1 << 0)
+
+/* MADT processor local APIC flag of a CPU that can be used */
+#define ACPI_MADT_CPU_ENABLED           (1 << 0)
+
+/* generic address structure space of memory mapped registers */
+#define ACPI_ADDRESS_SPACE_MEMORY       0
+
+/* where the BIOS keeps the RSDP: the first KiB of the EBDA or the BIOS ROM area */
+#define ACPI_EBDA_SEGMENT_POINTER       0x40e
+#define ACPI_EBDA_SEARCH_LENGTH         1024
+#define ACPI_BIOS_AREA_START            0xe0000
+#define ACPI_BIOS_AREA_END              0x100000
+
+typedef struct acpi_rsdp_s acpi_rsdp_t;
+typedef struct acpi_sdt_header_s acpi_sdt_header_t;
+typedef struct acpi_ioapic_s acpi_ioapic_t;
+typedef struct acpi_isa_route_s acpi_isa_route_t;
+typedef struct acpi_madt_info_s acpi_madt_info_t;
+typedef struct acpi_hpet_info_s acpi_hpet_info_t;
+
+/**
+ * @brief Root System Description Pointer.
+ *
+ * @member signature "RSD PTR ".
+ * @member checksum makes the first 20 bytes sum to 0.
+ * @member oem_id OEM identifier.
+ * @member revision 0 for ACPI 1.0 (only the fields up to rsdt_address exist), 2 for later versions.
+ * @member rsdt_address physical address of the RSDT.
+ * @member length size of the whole structure (revision 2).
+ * @member xsdt_address physical address of the XSDT (revision 2).
+ * @member extended_checksum makes the whole structure sum to 0 (revision 2).
+ * @member reserved reserved.
+ */
+struct acpi_rsdp_s {
+    char signature[8];
+    u8 checksum;
+    char oem_id[6];
+    u8 revision;
+    u32 rsdt_address;
+    u32 length;
+    u64 xsdt_address;
+    u8 extended_checksum;
+    u8 reserved[3];
+} __attribute__((packed));
+
+/**
+ * @brief Header every ACPI system description table starts with.
+ *
+ * @member signature 4 character signature of the table ("APIC" for the MADT).
+ * @member length size of the table including the header.
+ * @member revision revision of the table.
+ * @member checksum makes the whole table sum to 0.
+ * @member oem_id OEM identifier.
+ * @member oem_table_id OEM table identifier.
+ * @member oem_revision OEM revision.
+ * @member creator_id identifier of the tool that created the table.
+ * @member creator_revision revision of that tool.
+ */
+struct acpi_sdt_header_s {
+    char signature[4];
+    u32 length;
+    u8 revision;
+    u8 checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    u32 oem_revision;
+    u32 creator_id;
+    u32 creator_revision;
+} __attribute__((packed));
+
+/**
+ * @brief An I/O APIC listed in the MADT.
+ *
+ * @member id I/O APIC ID.
+ * @member address physical address of its registers.
+ * @member gsi_base global system interrupt of its first pin.
+ */
+struct acpi_ioapic_s {
+    u8 id;
+    u32 address;
+    u32 gsi_base;
+};
+
+/**
+ * @brief Global system interrupt an ISA IRQ is wired to.
+ *
+ * @member gsi global system interrupt of the IRQ.
+ * @member flags polarity and trigger mode (ACPI_MADT_POLARITY_*, ACPI_MADT_TRIGGER_*, 0 for the ISA default).
+ */
+struct acpi_isa_route_s {
+    u32 gsi;
+    u16 flags;
+};
+
+/**
+ * @brief Interrupt controllers described by the MADT.
+ *
+ * @member lapic_address physical address of the local APIC registers.
+ * @member legacy_pics whether there are 8259 PICs that have to be disabled.
+ * @member cpu_count number of usable CPUs.
+ * @member apic_ids local APIC ID of every usable CPU (the boot CPU is not necessarily first).
+ * @member ioapic_count number of I/O APICs.
+ * @member ioapics every I/O APIC.
+ * @member isa_routes global system interrupt of every ISA IRQ (identity unless overridden).
+ */
+struct acpi_madt_info_s {
+    u32 lapic_address;
+    bool legacy_pics;
+    u32 cpu_count;
+    u8 apic_ids[ACPI_MAX_CPUS];
+    u32 ioapic_count;
+    acpi_ioapic_t ioapics[ACPI_MAX_IOAPICS];
+    acpi_isa_route_t isa_routes[ACPI_ISA_IRQ_COUNT];
+};
+
+/**
+ * @brief HPET described by the HPET table.
+ *
+ * @member address physical address of its registers.
+ * @member number sequence number of the HPET.
+ * @member min_tick fewest counter ticks a periodic timer may be set to without losing interrupts.
+ */
+struct acpi_hpet_info_s {
+    u32 address;
+    u8 number;
+    u16 min_tick;
+};
+
+/**
+ * @brief Sum bytes modulo 256.
+ *
+ * @param data bytes to sum.
+ * @param length number of bytes.
+ * @return the sum, 0 for a valid ACPI structure.
+ */
+extern u8 acpi_checksum(const void* data, size_t length);
+
+/**
+ * @brief Search a memory area for a valid RSDP (on 16 byte boundaries).
+ *
+ * @param start start of the area (16 byte aligned).
+ * @param length size of the area in bytes.
+ * @return the RSDP, or NULL if there is none.
+ */
+extern const acpi_rsdp_t* acpi_find_rsdp(const u8* start, size_t length);
+
+/**
+ * @brief Search the BIOS areas for the RSDP.
+ *
+ * Reads physical memory, so call this before paging is enabled or with the
+ * first MiB identity mapped.
+ *
+ * @return the RSDP, or NULL if the machine has no ACPI.
+ */
+extern const acpi_rsdp_t* acpi_find_bios_rsdp(void);
+
+/**
+ * @brief Find a system description table through the RSDT (or XSDT).
+ *
+ * The tables are read through their physical addresses.
+ *
+ * @param rsdp RSDP to start at.
+ * @param signature 4 character signature of the table.
+ * @return the table, or NULL if there is no valid table with that signature.
+ */
+extern const acpi_sdt_header_t* acpi_find_table(const acpi_rsdp_t* rsdp, const char* signature);
+
+/**
+ * @brief Read the interrupt controllers out of a MADT.
+ *
+ * @param madt MADT to read (the "APIC" table).
+ * @param info where to store the interrupt controllers.
+ * @return false if the MADT lists no usable CPU or no I/O APIC.
+ */
+extern bool acpi_parse_madt(const acpi_sdt_header_t* madt, acpi_madt_info_t* info);
+
+/**
+ * @brief Read the HPET out of an HPET table.
+ *
+ * @param hpet HPET table to read (the "HPET" table).
+ * @param info where to store the HPET.
+ * @return false if the table is too short or the registers are not in the first 4 GiB of memory.
+ */
+extern bool acpi_parse_hpet(const acpi_sdt_header_t* hpet, acpi_hpet_info_t* info);
@@ -0,0 +1,135 @@
+#include <llanos/types.h>
+
+#include "apic.h"
+#include "pit8254.h"
+
+/**
+ * @brief Read an indirect I/O APIC register.
+ *
+ * @param ioapic I/O APIC to read.
+ * @param index register index.
+ * @return the register.
+ */
+static u32 __ioapic_read(ioapic_t* ioapic, u8 index) {
+    ioapic->registers[IOAPIC_REGISTER_SELECT / sizeof(u32)] = index;
+    return ioapic->registers[IOAPIC_REGISTER_WINDOW / sizeof(u32)];
+}
+
+/**
+ * @brief Write an indirect I/O APIC register.
+ *
+ * @param ioapic I/O APIC to write.
+ * @param index register index.
+ * @param value value to write.
+ */
+static void __ioapic_write(ioapic_t* ioapic, u8 index, u32 value) {
+    ioapic->registers[IOAPIC_REGISTER_SELECT / sizeof(u32)] = index;
+    ioapic->registers[IOAPIC_REGISTER_WINDOW / sizeof(u32)] = value;
+}
+
+/**
+ * @brief Send an IPI to one CPU and wait until the local APIC took it.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @param apic_id APIC ID of the destination CPU.
+ * @param command low dword of the interrupt command register.
+ * @return false if the IPI stayed pending.
+ */
+static bool __lapic_send_ipi(lapic_t* lapic, u8 apic_id, u32 command) {
+    u32 polls;
+
+    /* writing the low dword sends the IPI */
+    lapic->registers[LAPIC_REGISTER_ICR_HIGH / sizeof(u32)] = (u32)apic_id << LAPIC_ICR_DESTINATION_SHIFT;
+    lapic->registers[LAPIC_REGISTER_ICR_LOW / sizeof(u32)] = command;
+
+    for (polls = 0; polls < LAPIC_ICR_TIMEOUT; polls++) {
+        if ((lapic->registers[LAPIC_REGISTER_ICR_LOW / sizeof(u32)] & LAPIC_ICR_DELIVERY_PENDING) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void lapic_initialize(lapic_t* lapic, u32 address, u8 spurious_vector) {
+    lapic->registers = (volatile u32*)(uintptr_t)address;
+    lapic->registers[LAPIC_REGISTER_TASK_PRIORITY / sizeof(u32)] = 0;
+    lapic->registers[LAPIC_REGISTER_SPURIOUS_VECTOR / sizeof(u32)] = LAPIC_SPURIOUS_VECTOR_ENABLE | spurious_vector;
+}
+
+u8 lapic_get_id(const lapic_t* lapic) {
+    return (u8)(lapic->registers[LAPIC_REGISTER_ID / sizeof(u32)] >> 24);
+}
+
+bool lapic_send_init(lapic_t* lapic, u8 apic_id) {
+    return __lapic_send_ipi(lapic, apic_id, LAPIC_ICR_DELIVERY_INIT | LAPIC_ICR_LEVEL_ASSERT);
+}
+
+bool lapic_send_startup(lapic_t* lapic, u8 apic_id, u8 page) {
+    return __lapic_send_ipi(lapic, apic_id, LAPIC_ICR_DELIVERY_STARTUP | LAPIC_ICR_LEVEL_ASSERT | page);
+}
+
+void lapic_timer_setup(lapic_t* lapic, u8 vector, u32 mode) {
+    lapic->registers[LAPIC_REGISTER_TIMER_INITIAL_COUNT / sizeof(u32)] = 0;
+    lapic->registers[LAPIC_REGISTER_TIMER_DIVIDE / sizeof(u32)] = LAPIC_TIMER_DIVIDE_BY_16;
+    lapic->registers[LAPIC_REGISTER_TIMER / sizeof(u32)] = mode | vector;
+}
+
+u64 lapic_timer_calibrate(lapic_t* lapic) {
+    u32 polls;
+    u32 elapsed;
+
+    lapic_timer_setup(lapic, 0, LAPIC_TIMER_MODE_ONESHOT | LAPIC_TIMER_MASKED);
+    pit8254_start_channel2(LAPIC_TIMER_CALIBRATION_TICKS);
+    lapic_timer_start(lapic, 0xffffffff);
+    for (polls = 0; polls < LAPIC_TIMER_CALIBRATION_TIMEOUT; polls++) {
+        if (pit8254_channel2_done()) {
+            elapsed = 0xffffffff - lapic_timer_get_count(lapic);
+            lapic_timer_start(lapic, 0);
+            return (u64)elapsed * PIT8254_FREQUENCY / LAPIC_TIMER_CALIBRATION_TICKS;
+        }
+    }
+
+    lapic_timer_start(lapic, 0);
+    return 0;
+}
+
+void ioapic_initialize(ioapic_t* ioapic, u32 address, u32 gsi_base) {
+    u32 max_entry;
+    u32 pin;
+
+    ioapic->registers = (volatile u32*)(uintptr_t)address;
+    ioapic->gsi_base = gsi_base;
+
+    /* bits 16-23 of the version register hold the index of the last redirection entry */
+    max_entry = (__ioapic_read(ioapic, IOAPIC_VERSION) >> 16) & 0xff;
+    ioapic->pin_count = max_entry + 1 < IOAPIC_MAX_PINS ? max_entry + 1 : IOAPIC_MAX_PINS;
+
+    /* pins beyond IOAPIC_MAX_PINS are masked as well, they are never routed */
+    for (pin = 0; pin <= max_entry; pin++) {
+        if (pin < ioapic->pin_count) {
+            ioapic->redirection[pin] = IOAPIC_REDIRECTION_MASKED;
+        }
+        __ioapic_write(ioapic, (u8)(IOAPIC_REDIRECTION_TABLE + pin * 2), IOAPIC_REDIRECTION_MASKED);
+    }
+}
+
+void ioapic_route(ioapic_t* ioapic, u8 pin, u8 vector, u32 flags, u8 destination) {
+    ioapic->redirection[pin] = IOAPIC_REDIRECTION_MASKED | flags | vector;
+    /* masked while the destination changes, so no interrupt is delivered half routed */
+    __ioapic_write(ioapic, IOAPIC_REDIRECTION_TABLE + pin * 2, ioapic->redirection[pin]);
+    __ioapic_write(ioapic, IOAPIC_REDIRECTION_TABLE + pin * 2 + 1, (u32)destination << IOAPIC_REDIRECTION_DESTINATION_SHIFT);
+}
+
+void ioapic_set_destination(ioapic_t* ioapic, u8 pin, u8 destination) {
+    __ioapic_write(ioapic, IOAPIC_REDIRECTION_TABLE + pin * 2 + 1, (u32)destination << IOAPIC_REDIRECTION_DESTINATION_SHIFT);
+}
+
+void ioapic_mask(ioapic_t* ioapic, u8 pin) {
+    ioapic->redirection[pin] |= IOAPIC_REDIRECTION_MASKED;
+    __ioapic_write(ioapic, IOAPIC_REDIRECTION_TABLE + pin * 2, ioapic->redirection[pin]);
+}
+
+void ioapic_unmask(ioapic_t* ioapic, u8 pin) {
+    ioapic->redirection[pin] &= ~IOAPIC_REDIRECTION_MASKED;
+    __ioapic_write(ioapic, IOAPIC_REDIRECTION_TABLE + pin * 2, ioapic->redirection[pin]);
+}
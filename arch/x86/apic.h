@@ -0,0 +1,226 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* local APIC register offsets */
+#define LAPIC_REGISTER_ID                   0x020
+#define LAPIC_REGISTER_TASK_PRIORITY        0x080
+#define LAPIC_REGISTER_EOI                  0x0b0
+#define LAPIC_REGISTER_SPURIOUS_VECTOR      0x0f0
+#define LAPIC_REGISTER_ICR_LOW              0x300
+#define LAPIC_REGISTER_ICR_HIGH             0x310
+#define LAPIC_REGISTER_TIMER                0x320
+#define LAPIC_REGISTER_TIMER_INITIAL_COUNT  0x380
+#define LAPIC_REGISTER_TIMER_CURRENT_COUNT  0x390
+#define LAPIC_REGISTER_TIMER_DIVIDE         0x3e0
+
+/* spurious interrupt vector register bit enabling the local APIC */
+#define LAPIC_SPURIOUS_VECTOR_ENABLE        (1 << 8)
+
+/* interrupt command register bits, the destination APIC ID is in the top byte of the high dword */
+#define LAPIC_ICR_DELIVERY_INIT             (5 << 8)
+#define LAPIC_ICR_DELIVERY_STARTUP          (6 << 8)
+#define LAPIC_ICR_DELIVERY_PENDING          (1 << 12)
+#define LAPIC_ICR_LEVEL_ASSERT              (1 << 14)
+#define LAPIC_ICR_DESTINATION_SHIFT         24
+
+/* polls of the delivery status after which an IPI is taken as sent */
+#define LAPIC_ICR_TIMEOUT                   1000000
+
+/* local vector table entry bits of the timer */
+#define LAPIC_TIMER_MASKED                  (1 << 16)
+#define LAPIC_TIMER_MODE_ONESHOT            (0 << 17)
+#define LAPIC_TIMER_MODE_TSC_DEADLINE       (2 << 17)
+
+/* divide configuration dividing the bus clock by 16 for the timer */
+#define LAPIC_TIMER_DIVIDE_BY_16            0x3
+
+/* PIT interval the one-shot timer is calibrated over, and polls of the PIT before giving up */
+#define LAPIC_TIMER_CALIBRATION_TICKS       11932
+#define LAPIC_TIMER_CALIBRATION_TIMEOUT     10000000
+
+/* I/O APIC index and data registers, and the indirect registers behind them */
+#define IOAPIC_REGISTER_SELECT              0x00
+#define IOAPIC_REGISTER_WINDOW              0x10
+#define IOAPIC_VERSION                      0x01
+#define IOAPIC_REDIRECTION_TABLE            0x10
+
+/* pins handled per I/O APIC, further pins are left masked */
+#define IOAPIC_MAX_PINS                     24
+
+/* low dword of a redirection entry (fixed delivery, physical destination) */
+#define IOAPIC_REDIRECTION_VECTOR_MASK      0xff
+#define IOAPIC_REDIRECTION_ACTIVE_LOW       (1 << 13)
+#define IOAPIC_REDIRECTION_LEVEL            (1 << 15)
+#define IOAPIC_REDIRECTION_MASKED           (1 << 16)
+
+/* destination APIC ID in the high dword of a redirection entry */
+#define IOAPIC_REDIRECTION_DESTINATION_SHIFT    24
+
+typedef struct lapic_s lapic_t;
+typedef struct ioapic_s ioapic_t;
+
+/**
+ * @brief The local APIC of the running CPU.
+ *
+ * Every CPU sees its own local APIC at the same address.
+ *
+ * @member registers register page (mapped uncached).
+ */
+struct lapic_s {
+    volatile u32* registers;
+};
+
+/**
+ * @brief An I/O APIC.
+ *
+ * @member registers index and data registers (mapped uncached).
+ * @member gsi_base global system interrupt of pin 0.
+ * @member pin_count number of pins handled (at most IOAPIC_MAX_PINS).
+ * @member redirection copy of the low dword of every redirection entry, so masking a pin
+ *      is a single register write.
+ */
+struct ioapic_s {
+    volatile u32* registers;
+    u32 gsi_base;
+    u8 pin_count;
+    u32 redirection[IOAPIC_MAX_PINS];
+};
+
+/**
+ * @brief Enable the local APIC of the running CPU and accept every interrupt priority.
+ *
+ * @param lapic local APIC to initialize.
+ * @param address address of its registers.
+ * @param spurious_vector vector of the spurious interrupts of the local APIC (they must not be ended).
+ */
+extern void lapic_initialize(lapic_t* lapic, u32 address, u8 spurious_vector);
+
+/**
+ * @brief Get the APIC ID of the running CPU.
+ *
+ * @param lapic local APIC to read.
+ * @return the APIC ID.
+ */
+extern u8 lapic_get_id(const lapic_t* lapic);
+
+/**
+ * @brief Send an INIT IPI, which resets a CPU into the wait-for-SIPI state.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @param apic_id APIC ID of the CPU to reset.
+ * @return false if the local APIC did not accept the IPI.
+ */
+extern bool lapic_send_init(lapic_t* lapic, u8 apic_id);
+
+/**
+ * @brief Send a STARTUP IPI, starting a CPU waiting for it in real mode at page << 12.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @param apic_id APIC ID of the CPU to start.
+ * @param page 4 KiB page below 1 MiB holding the code to start at.
+ * @return false if the local APIC did not accept the IPI.
+ */
+extern bool lapic_send_startup(lapic_t* lapic, u8 apic_id, u8 page);
+
+/**
+ * @brief End the interrupt in service on the running CPU.
+ *
+ * The EOI is broadcast to the I/O APICs, which ends level triggered
+ * interrupts there as well.
+ *
+ * @param lapic local APIC of the running CPU.
+ */
+static inline void lapic_send_eoi(lapic_t* lapic) {
+    lapic->registers[LAPIC_REGISTER_EOI / sizeof(u32)] = 0;
+}
+
+/**
+ * @brief Set up the local APIC timer of the running CPU, disarmed.
+ *
+ * In one-shot mode the timer counts down from the count given to
+ * lapic_timer_start at a 16th of the bus clock. In TSC-deadline mode it
+ * fires when the TSC reaches the value written to CPU_MSR_TSC_DEADLINE.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @param vector vector the timer raises.
+ * @param mode LAPIC_TIMER_MODE_ONESHOT or LAPIC_TIMER_MODE_TSC_DEADLINE, with LAPIC_TIMER_MASKED
+ *      to count without raising the vector.
+ */
+extern void lapic_timer_setup(lapic_t* lapic, u8 vector, u32 mode);
+
+/**
+ * @brief Start the one-shot local APIC timer.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @param count timer cycles until the interrupt (0 disarms the timer).
+ */
+static inline void lapic_timer_start(lapic_t* lapic, u32 count) {
+    lapic->registers[LAPIC_REGISTER_TIMER_INITIAL_COUNT / sizeof(u32)] = count;
+}
+
+/**
+ * @brief Read the count left of the one-shot local APIC timer.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @return the timer cycles left until the interrupt.
+ */
+static inline u32 lapic_timer_get_count(const lapic_t* lapic) {
+    return lapic->registers[LAPIC_REGISTER_TIMER_CURRENT_COUNT / sizeof(u32)];
+}
+
+/**
+ * @brief Measure the one-shot local APIC timer frequency against PIT channel 2.
+ *
+ * Takes about 10 ms and leaves the timer set up masked and disarmed. Run
+ * with interrupts disabled.
+ *
+ * @param lapic local APIC of the running CPU.
+ * @return the timer frequency in Hz, or 0 if the PIT did not answer.
+ */
+extern u64 lapic_timer_calibrate(lapic_t* lapic);
+
+/**
+ * @brief Read the pin count of an I/O APIC and mask every pin.
+ *
+ * @param ioapic I/O APIC to initialize.
+ * @param address address of its registers.
+ * @param gsi_base global system interrupt of pin 0.
+ */
+extern void ioapic_initialize(ioapic_t* ioapic, u32 address, u32 gsi_base);
+
+/**
+ * @brief Route a pin to a vector on one CPU, leaving it masked.
+ *
+ * @param ioapic I/O APIC of the pin.
+ * @param pin pin to route.
+ * @param vector vector raised for the pin.
+ * @param flags IOAPIC_REDIRECTION_ACTIVE_LOW and IOAPIC_REDIRECTION_LEVEL, 0 for active high edge triggering.
+ * @param destination APIC ID of the CPU the interrupt is delivered to.
+ */
+extern void ioapic_route(ioapic_t* ioapic, u8 pin, u8 vector, u32 flags, u8 destination);
+
+/**
+ * @brief Deliver the interrupts of a pin to another CPU.
+ *
+ * @param ioapic I/O APIC of the pin.
+ * @param pin pin to redirect.
+ * @param destination APIC ID of the CPU the interrupt is delivered to.
+ */
+extern void ioapic_set_destination(ioapic_t* ioapic, u8 pin, u8 destination);
+
+/**
+ * @brief Mask a pin.
+ *
+ * @param ioapic I/O APIC of the pin.
+ * @param pin pin to mask.
+ */
+extern void ioapic_mask(ioapic_t* ioapic, u8 pin);
+
+/**
+ * @brief Unmask a pin.
+ *
+ * @param ioapic I/O APIC of the pin.
+ * @param pin pin to unmask.
+ */
+extern void ioapic_unmask(ioapic_t* ioapic, u8 pin);
@@ -1,43 +1,174 @@
 #include <llanos/types.h>
+#include <llanos/architecture.h>
 #include <llanos/util/memory.h>
 #include <llanos/math.h>
+#include <llanos/management/abort.h>
+#include <llanos/management/clockevent.h>
+#include <llanos/llanos.h>
 
 #include "gdt.h"
 #include "interrupt.h"
-#include "pic8259.h"
+#include "irq.h"
+#include "irq-pic.h"
+#include "irq-apic.h"
+#include "acpi.h"
 #include "isrhandler.h"
 #include "paging.h"
 #include "memory.h"
+#include "uart16550.h"
+#include "port.h"
+#include "multiboot.h"
+#include "cpu.h"
+#include "tsc.h"
+#include "apic.h"
+#include "pit8254.h"
+#include "hpet.h"
+#include "switch.h"
+#include "smp.h"
 
-/* PIC start and end addresses [start, end) */
-#define PIC1_START_ADDRESS      32
-#define PIC1_END_ADDRESS        (PIC1_START_ADDRESS + 8)
-#define PIC2_START_ADDRESS      (PIC1_START_ADDRESS + 8)
-#define PIC2_END_ADDRESS        (PIC2_START_ADDRESS + 8)
+/* vector of IRQ 0, the IRQs take the vectors right after the CPU exceptions */
+#define IRQ_BASE_VECTOR         INTERRUPT_EXCEPTION_COUNT
 
-/* command and data ports */
+/* vectors the disabled PICs are parked on, their spurious interrupts land there unhandled */
+#define PIC_PARKED_VECTOR       0xf0
+
+/* vector of the spurious interrupts of the local APIC, left unhandled (they must not be ended) */
+#define APIC_SPURIOUS_VECTOR    0xff
+
+/* vector of the local APIC timer, just below the parked PICs */
+#define APIC_TIMER_VECTOR       0xef
+
+/* furthest TSC deadline armed at once (about a day at 3 GHz), keeps rdtsc + cycles from wrapping */
+#define TSC_DEADLINE_MAX_CYCLES (1ULL << 48)
+
+/* HPET comparator used as the timer, IRQ 0 in legacy replacement mode */
+#define HPET_EVENT_TIMER        HPET_LEGACY_TIMER_IRQ0
+
+/* fewest and most HPET ticks a 32 bit comparator is armed ahead of the counter */
+#define HPET_MIN_CYCLES         128
+#define HPET_MAX_CYCLES         0x7fffffff
+
+/* times a comparator the counter passed is armed further ahead before the nearest one is taken */
+#define HPET_SET_NEXT_RETRIES   8
+
+/* serial console line speed */
+#define SERIAL_CONSOLE_BAUD     115200
+
+/* CRTC index and data ports and the cursor location registers of the VGA text mode */
+#define VGA_CRTC_INDEX_PORT         0x3d4
+#define VGA_CRTC_DATA_PORT          0x3d5
+#define VGA_CRTC_CURSOR_HIGH        0x0e
+#define VGA_CRTC_CURSOR_LOW         0x0f
+
+/* bochs/qemu debug console, every byte written to it goes straight to the host */
+#define DEBUGCON_PORT           0xe9
+
+/* command ports of the master and slave PIC (the data ports follow them) */
 #define PIC1_COMMAND_PORT   0x20
-#define PIC1_DATA_PORT      (PIC1_COMMAND_PORT + 1)
 #define PIC2_COMMAND_PORT   0xa0
-#define PIC2_DATA_PORT      (PIC2_COMMAND_PORT + 1)
+
+/* descriptors of a GDT: null, flat code, flat data and the per-CPU data segment */
+#define GDT_ENTRY_COUNT         4
 
 /*
- * Global Descriptor Table
+ * Global Descriptor Table of every CPU, they differ in the base of the
+ * per-CPU data segment.
  */
-gdt_entry_t __gdt[3];
+gdt_entry_t __gdt[SMP_MAX_CPUS][GDT_ENTRY_COUNT];
 
 /*
  * Interrupt Descriptor Table
  */
-idt_entry_t __idt[256] \
+idt_entry_t __idt[INTERRUPT_VECTOR_COUNT] \
     __attribute__((aligned(4))) \
     __attribute__((section(".interrupt_table")));
 
 /*
- * PIC controllers on the standard x86 system.
+ * Statistics every handled interrupt is recorded in (see architecture_record_interrupts).
+ */
+static irqstat_t* __interrupt_stats;
+
+/*
+ * Softirqs run on interrupt exit (see architecture_run_softirqs).
+ */
+static softirq_t* __softirq;
+
+/*
+ * Threads preempted on interrupt exit (see architecture_preempt_threads).
+ */
+static threads_t* __preempt_threads;
+
+/*
+ * Data of every CPU, and the number of CPUs online (the boot CPU first).
+ */
+static smp_cpu_t __cpus[SMP_MAX_CPUS];
+static u32 __cpu_count = 1;
+
+/*
+ * IRQ lines of the interrupt controller in use, the APICs if the MADT lists
+ * them, the PICs otherwise.
+ */
+static irq_controller_t __irq;
+
+/*
+ * The cascaded 8259 PICs, disabled when the APICs are used.
+ */
+static irq_pic_t __pic;
+
+/*
+ * The local APIC and the I/O APICs, used if __has_apic.
+ */
+static irq_apic_t __apic;
+
+/*
+ * Interrupt controllers read from the ACPI MADT, valid if __has_apic.
+ */
+static acpi_madt_info_t __madt;
+
+/*
+ * Whether the CPU has a local APIC and the MADT lists an I/O APIC.
+ */
+static bool __has_apic;
+
+/*
+ * The HPET, used if __has_hpet.
+ */
+static hpet_t __hpet;
+
+/*
+ * Whether the ACPI tables list a working HPET.
+ */
+static bool __has_hpet;
+
+/*
+ * Serial console on COM1.
+ */
+static uart16550_t __com1;
+
+/*
+ * Whether SSE2 has been enabled.
+ */
+static bool __vector_unit;
+
+/*
+ * TSC frequency in Hz measured at boot (0 if it could not be measured).
+ */
+static u64 __tsc_frequency;
+
+/*
+ * One-shot timer device of the boot CPU (set_next is NULL if there is none)
+ * and the clock event it serves (see architecture_attach_clockevent).
  */
-static pic8259_t __pic1;
-static pic8259_t __pic2;
+static clockevent_device_t __timer;
+static clockevent_t* __clockevent;
+
+/*
+ * Thread whose registers the FPU holds, and the running thread (NULL until
+ * the first thread switch). The FPU state is only switched when the
+ * running thread uses the FPU while another thread owns it.
+ */
+static thread_context_t* __fpu_owner;
+static thread_context_t* __fpu_current;
 
 /*
  * Paging Directory and Paging Tables
@@ -50,23 +181,145 @@ static page_table_entry_t __page_tables[sizeof(__page_directory) / sizeof(page_d
     __attribute__((section(".page_tables")));
 
 
-static void __generic_interrupt_handler(u32 isrnum) {
+/**
+ * @brief Handler of CPU exceptions nothing else claimed.
+ *
+ * Returning would restart the faulting instruction forever, so print where
+ * the exception happened and stop the kernel with the vector as the error
+ * code.
+ *
+ * @param frame registers of the faulting code.
+ * @param context unused.
+ */
+static void __unhandled_exception(interrupt_frame_t* frame, void* context) {
+    console_t* console = get_llanos_console();
+
+    (void)context;
+    console_printf(
+        console,
+        LOG_LEVEL_FATAL,
+        "exception %u error code 0x%08x at %04x:%08x eflags 0x%08x\n",
+        frame->vector,
+        frame->error_code,
+        frame->cs,
+        frame->eip,
+        frame->eflags
+    );
+    console_printf(
+        console,
+        LOG_LEVEL_FATAL,
+        "eax %08x ebx %08x ecx %08x edx %08x esi %08x edi %08x ebp %08x\n",
+        frame->eax,
+        frame->ebx,
+        frame->ecx,
+        frame->edx,
+        frame->esi,
+        frame->edi,
+        frame->ebp
+    );
+    if (frame->vector == INTERRUPT_VECTOR_PAGE_FAULT) {
+        console_printf(console, LOG_LEVEL_FATAL, "page fault address %08x\n", cpu_get_page_fault_address());
+    }
+    abort(frame->vector, console);
+}
+
+/**
+ * @brief Handler of #NM, hands the FPU to the running thread at its first FPU instruction since the switch.
+ *
+ * @param frame unused.
+ * @param context unused.
+ */
+static void __fpu_unavailable(interrupt_frame_t* frame, void* context) {
+    (void)frame;
+    (void)context;
+
+    cpu_clear_task_switched();
+    if (__fpu_current == NULL || __fpu_current == __fpu_owner) {
+        return;
+    }
 
+    cpu_save_fpu(__fpu_owner->fpu_state, __vector_unit);
+    if (__fpu_current->fpu_used) {
+        cpu_restore_fpu(__fpu_current->fpu_state, __vector_unit);
+    } else {
+        cpu_init_fpu(__vector_unit);
+        __fpu_current->fpu_used = true;
+    }
+    __fpu_owner = __fpu_current;
 }
 
 
 /**
- * @brief Initialize Global Descriptor Table.
+ * @brief Accounting hook recording handled interrupts in __interrupt_stats.
  *
- * This function will setup the Global Descriptor Table Register.
+ * Interrupts are recorded on the CPU that took them.
+ *
+ * @param vector vector that was handled.
+ * @param cycles TSC cycles the handler ran for.
  */
-static void initialize_global_descriptor_table(void) {
+static void __account_interrupt(u32 vector, u32 cycles) {
+    irqstat_t* stats = __atomic_load_n(&__interrupt_stats, __ATOMIC_ACQUIRE);
+
+    if (stats != NULL) {
+        irqstat_record(stats, smp_this_cpu(), (u8)vector, cycles);
+    }
+}
+
+
+/**
+ * @brief Interrupt exit hook running the pending softirqs in __softirq, then preempting in __preempt_threads.
+ *
+ * The threads run on the boot CPU only, the other CPUs only run softirqs.
+ */
+static void __interrupt_exit(void) {
+    softirq_t* softirq = __atomic_load_n(&__softirq, __ATOMIC_ACQUIRE);
+    threads_t* threads = __atomic_load_n(&__preempt_threads, __ATOMIC_ACQUIRE);
+    smp_cpu_t* cpu = &__cpus[smp_this_cpu()];
+
+    /* softirqs enable interrupts, the outer exit runs what a nested one raised */
+    if (cpu->in_interrupt_exit) {
+        return;
+    }
+
+    cpu->in_interrupt_exit = true;
+    if (softirq != NULL) {
+        softirq_run(softirq);
+    }
+    cpu->in_interrupt_exit = false;
+
+    /* the thread switched to may be interrupted and preempted in turn before this one returns */
+    if (threads != NULL && cpu->number == 0) {
+        thread_preempt(threads);
+    }
+}
+
+/**
+ * @brief Install __interrupt_exit while there is work for it.
+ */
+static void __update_interrupt_exit(void) {
+    bool work = __atomic_load_n(&__softirq, __ATOMIC_ACQUIRE) != NULL || \
+        __atomic_load_n(&__preempt_threads, __ATOMIC_ACQUIRE) != NULL;
+
+    interrupt_set_exit(work ? __interrupt_exit : NULL);
+}
+
+
+/**
+ * @brief Initialize the Global Descriptor Table of a CPU.
+ *
+ * This function will setup the Global Descriptor Table Register, and point
+ * %fs at the data of the CPU (see smp_this_cpu).
+ *
+ * @param cpu number of the running CPU.
+ */
+static void initialize_global_descriptor_table(u32 cpu) {
+    gdt_entry_t* gdt = __gdt[cpu];
     gdt_register_t gdtr;
 
-    gdt_build_entry(&__gdt[0], 0, 0, 0, 0);
+    gdt_build_entry(&gdt[0], 0, 0, 0, 0);
     /* entry 1 will be used for code */
     gdt_build_entry(
-        &__gdt[1], 
+        &gdt[1], 
         0, 
         0xffffffff, 
         gdt_build_access_byte(GDT_ACCESS_TYPE_CODE_EXECUTE_READ, false, 0), 
@@ -74,46 +327,333 @@ static void initialize_global_descriptor_table(void) {
     );
     /* entry 2 will be used for data */
     gdt_build_entry(
-        &__gdt[2], 
+        &gdt[2], 
         0, 
         0xffffffff, 
         gdt_build_access_byte(GDT_ACCESS_TYPE_DATA_READ_WRITE, false, 0), 
         gdt_build_granularity_byte(GDT_OPERAND_SIZE_32BIT, GDT_GRANULARITY_1KILO)
     );
-    
-    gdt_build_gdtr(&gdtr, __gdt, sizeof(__gdt) / sizeof(gdt_entry_t));
+    /* entry 3 spans the data of the CPU */
+    gdt_build_entry(
+        &gdt[3],
+        (u32)(uintptr_t)&__cpus[cpu],
+        sizeof(smp_cpu_t) - 1,
+        gdt_build_access_byte(GDT_ACCESS_TYPE_DATA_READ_WRITE, false, 0),
+        gdt_build_granularity_byte(GDT_OPERAND_SIZE_32BIT, GDT_GRANULARITY_1BYTE)
+    );
+
+    gdt_build_gdtr(&gdtr, gdt, GDT_ENTRY_COUNT);
     gdt_load_gdtr(&gdtr);
+    smp_load_cpu_segment();
+}
+
+/**
+ * @brief Read the interrupt controllers out of the ACPI MADT.
+ *
+ * The ACPI tables are read through their physical addresses, so this runs
+ * before paging is enabled.
+ *
+ * @return true if the CPU has a local APIC and the MADT lists an I/O APIC.
+ */
+static bool discover_apic(void) {
+    const acpi_rsdp_t* rsdp;
+    const acpi_sdt_header_t* madt;
+
+    if (!cpu_has_apic()) {
+        return false;
+    }
+
+    rsdp = acpi_find_bios_rsdp();
+    if (rsdp == NULL) {
+        return false;
+    }
+
+    madt = acpi_find_table(rsdp, "APIC");
+    return madt != NULL && acpi_parse_madt(madt, &__madt);
 }
 
 /**
- * @brief Initialize the PIC (Programmable Interrupt Controller).
+ * @brief Find the HPET through the ACPI HPET table and start its counter.
+ *
+ * Runs before paging is enabled, like discover_apic.
  *
- * This function will start the initialization process for the PIC8259
- * controller sending all ICW (Initialization Command Words) in the 
- * appropriate order to configure the PIC controller.
+ * @return true if there is a working HPET.
+ */
+static bool discover_hpet(void) {
+    const acpi_rsdp_t* rsdp = acpi_find_bios_rsdp();
+    const acpi_sdt_header_t* table;
+    acpi_hpet_info_t info;
+
+    if (rsdp == NULL) {
+        return false;
+    }
+
+    table = acpi_find_table(rsdp, "HPET");
+    return table != NULL && acpi_parse_hpet(table, &info) && hpet_initialize(&__hpet, info.address);
+}
+
+/**
+ * @brief Check whether a page holds the registers of an APIC or of the HPET.
+ *
+ * @param address page base address.
+ * @return true if the page has to be mapped uncached for a device.
+ */
+static bool is_device_page(u64 address) {
+    u32 index;
+
+    if (__has_hpet && address == ((uintptr_t)__hpet.registers & ~0xfff)) {
+        return true;
+    }
+    if (!__has_apic) {
+        return false;
+    }
+
+    if (address == (__madt.lapic_address & ~0xfff)) {
+        return true;
+    }
+    for (index = 0; index < __madt.ioapic_count; index++) {
+        if (address == (__madt.ioapics[index].address & ~0xfff)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Initialize the interrupt controller.
+ *
+ * The PICs are always remapped, as the BIOS leaves them on the CPU
+ * exception vectors. If the APICs are present, the PICs are parked on
+ * unhandled vectors with every line masked and the I/O APICs take over,
+ * otherwise the PICs serve the IRQs behind the CPU exceptions. Either way
+ * every line is masked, so no IRQ arrives before a driver requests it.
  */
 static void initialize_pic(void) {
-    pic8259_init(&__pic1, PIC1_COMMAND_PORT, PIC1_DATA_PORT);
-    pic8259_init(&__pic2, PIC2_COMMAND_PORT, PIC2_DATA_PORT);
+    if (__has_apic) {
+        irq_pic_initialize(&__pic, PIC1_COMMAND_PORT, PIC2_COMMAND_PORT, PIC_PARKED_VECTOR);
+        irq_pic_disable(&__pic);
 
-    /* setup PIC controllers ICW1 (start initialization) */
-    pic8259_send_icw1(&__pic1, true, false, false, true);
-    pic8259_send_icw1(&__pic2, true, false, false, true);
+        cpu_write_msr(CPU_MSR_APIC_BASE, cpu_read_msr(CPU_MSR_APIC_BASE) | CPU_MSR_APIC_BASE_ENABLE);
+        irq_apic_initialize(&__apic, &__madt, IRQ_BASE_VECTOR, APIC_SPURIOUS_VECTOR);
+        irq_initialize(&__irq, &irq_apic_backend, &__apic, IRQ_BASE_VECTOR, IRQ_MAX_LINES);
+        __cpus[0].apic_id = lapic_get_id(&__apic.lapic);
+        irq_set_cpu_online(&__irq, 0, __cpus[0].apic_id);
+    } else {
+        irq_pic_initialize(&__pic, PIC1_COMMAND_PORT, PIC2_COMMAND_PORT, IRQ_BASE_VECTOR);
+        irq_initialize(&__irq, &irq_pic_backend, &__pic, IRQ_BASE_VECTOR, IRQ_PIC_LINE_COUNT);
+    }
+}
 
-    /* setup PIC controllers ICW2 (starting addresses) */
-    pic8259_send_icw2(&__pic1, PIC1_START_ADDRESS);
-    pic8259_send_icw2(&__pic2, PIC2_START_ADDRESS);
+/**
+ * @brief Arm the local APIC timer in TSC-deadline mode.
+ *
+ * @param context unused.
+ * @param cycles TSC cycles until the interrupt.
+ */
+static void __tsc_deadline_set_next(void* context, u64 cycles) {
+    (void)context;
+    cpu_write_msr(CPU_MSR_TSC_DEADLINE, cpu_read_tsc() + cycles);
+}
 
-    /* 
-     * setup PIC controllers ICW3 (because we are setting up cascased mode) 
-     * there is a PIC alive at IR2, so setup cascading in that way.
-     */
-    pic8259_send_master_icw3(&__pic1, (1 << 2));
-    pic8259_send_slave_icw3(&__pic2, 2);
+/**
+ * @brief Disarm the local APIC timer in TSC-deadline mode.
+ *
+ * @param context unused.
+ */
+static void __tsc_deadline_stop(void* context) {
+    (void)context;
+    cpu_write_msr(CPU_MSR_TSC_DEADLINE, 0);
+}
+
+/**
+ * @brief Arm the one-shot local APIC timer.
+ *
+ * @param context local APIC of the running CPU.
+ * @param cycles timer cycles until the interrupt.
+ */
+static void __lapic_timer_set_next(void* context, u64 cycles) {
+    lapic_timer_start((lapic_t*)context, (u32)cycles);
+}
+
+/**
+ * @brief Disarm the one-shot local APIC timer.
+ *
+ * @param context local APIC of the running CPU.
+ */
+static void __lapic_timer_stop(void* context) {
+    lapic_timer_start((lapic_t*)context, 0);
+}
+
+/**
+ * @brief Arm PIT channel 0.
+ *
+ * @param context unused.
+ * @param cycles PIT ticks until the interrupt.
+ */
+static void __pit_set_next(void* context, u64 cycles) {
+    (void)context;
+    pit8254_start_channel0((u16)cycles);
+}
+
+/**
+ * @brief Disarm PIT channel 0.
+ *
+ * @param context unused.
+ */
+static void __pit_stop(void* context) {
+    (void)context;
+    pit8254_stop_channel0();
+}
+
+/**
+ * @brief Arm the HPET comparator.
+ *
+ * The comparator only matches the counter value it holds, so a comparator
+ * the counter passed while it was written would not fire for a whole
+ * counter wrap: check and arm further ahead until it is in the future.
+ * Interrupts stay off meanwhile, so only a stalled CPU (SMIs, a preempted
+ * virtual CPU) needs a retry. A CPU stalled past every retry arms the
+ * nearest comparator once more and leaves it at that.
+ *
+ * @param context HPET.
+ * @param cycles HPET ticks until the interrupt.
+ */
+static void __hpet_set_next(void* context, u64 cycles) {
+    hpet_t* hpet = (hpet_t*)context;
+    u32 comparator;
+    u32 retry;
+    u32 flags;
+
+    flags = cpu_save_and_disable_interrupts();
+    for (retry = 0; retry < HPET_SET_NEXT_RETRIES; retry++) {
+        comparator = hpet_read_counter(hpet) + (u32)cycles;
+        hpet_timer_start(hpet, HPET_EVENT_TIMER, comparator);
+        if ((s32)(comparator - hpet_read_counter(hpet)) > 0) {
+            cpu_restore_interrupts(flags);
+            return;
+        }
+        cycles = cycles * 2 > HPET_MAX_CYCLES ? HPET_MAX_CYCLES : cycles * 2;
+    }
+
+    hpet_timer_start(hpet, HPET_EVENT_TIMER, hpet_read_counter(hpet) + HPET_MIN_CYCLES);
+    cpu_restore_interrupts(flags);
+}
+
+/**
+ * @brief Disarm the HPET comparator.
+ *
+ * @param context HPET.
+ */
+static void __hpet_stop(void* context) {
+    hpet_timer_stop((hpet_t*)context, HPET_EVENT_TIMER);
+}
+
+/**
+ * @brief Handler of the local APIC timer vector.
+ *
+ * The vector is not an IRQ line, so the interrupt is ended here.
+ *
+ * @param vector unused.
+ * @param context unused.
+ */
+static void __lapic_timer_interrupt(u32 vector, void* context) {
+    clockevent_t* event = __atomic_load_n(&__clockevent, __ATOMIC_ACQUIRE);
+
+    (void)vector;
+    (void)context;
+    lapic_send_eoi(&__apic.lapic);
+    if (event != NULL) {
+        clockevent_interrupt(event);
+    }
+}
+
+/**
+ * @brief Handler of IRQ 0 (PIT channel 0 or the HPET comparator replacing it).
+ *
+ * @param vector unused.
+ * @param context unused.
+ */
+static void __irq0_interrupt(u32 vector, void* context) {
+    clockevent_t* event = __atomic_load_n(&__clockevent, __ATOMIC_ACQUIRE);
+
+    (void)vector;
+    (void)context;
+    if (event != NULL) {
+        clockevent_interrupt(event);
+    }
+}
+
+/**
+ * @brief Handler of the COM1 IRQ line.
+ *
+ * @param vector unused.
+ * @param context uart16550_t of COM1.
+ */
+static void __com1_interrupt(u32 vector, void* context) {
+    (void)vector;
+    uart16550_handle_interrupt((uart16550_t*)context);
+}
+
+/**
+ * @brief Pick the one-shot timer device of the boot CPU and install its interrupt handler.
+ *
+ * The local APIC timer in TSC-deadline mode is preferred, as it counts on
+ * the same TSC as the kernel clock, then an HPET comparator, whose counter
+ * frequency is exact, on IRQ 0 in place of the PIT, then the one-shot local
+ * APIC timer calibrated against the PIT, then PIT channel 0 without APICs.
+ * The device stays disarmed until a clock event programs it.
+ */
+static void initialize_timer(void) {
+    u64 frequency;
+
+    if (__has_apic && __tsc_frequency != 0 && cpu_has_tsc_deadline()) {
+        lapic_timer_setup(&__apic.lapic, APIC_TIMER_VECTOR, LAPIC_TIMER_MODE_TSC_DEADLINE);
+        clockevent_device_initialize(
+            &__timer, "lapic-deadline", __tsc_deadline_set_next, __tsc_deadline_stop, NULL,
+            __tsc_frequency, 1, TSC_DEADLINE_MAX_CYCLES
+        );
+        interrupt_register_handler(APIC_TIMER_VECTOR, __lapic_timer_interrupt, NULL);
+    } else if (__has_hpet && __hpet.legacy_route) {
+        pit8254_stop_channel0();
+        hpet_enable_legacy_route(&__hpet);
+        clockevent_device_initialize(
+            &__timer, "hpet", __hpet_set_next, __hpet_stop, &__hpet,
+            __hpet.frequency, HPET_MIN_CYCLES, HPET_MAX_CYCLES
+        );
+        irq_request(&__irq, PIT8254_CHANNEL0_IRQ, __irq0_interrupt, NULL);
+        /* the clock event belongs to the boot CPU, so IRQ 0 is never balanced away from it */
+        irq_set_affinity(&__irq, PIT8254_CHANNEL0_IRQ, 1u << 0);
+    } else if (__has_apic) {
+        frequency = lapic_timer_calibrate(&__apic.lapic);
+        if (frequency == 0) {
+            return;
+        }
+        lapic_timer_setup(&__apic.lapic, APIC_TIMER_VECTOR, LAPIC_TIMER_MODE_ONESHOT);
+        clockevent_device_initialize(
+            &__timer, "lapic-oneshot", __lapic_timer_set_next, __lapic_timer_stop, &__apic.lapic,
+            frequency, 1, 0xffffffff
+        );
+        interrupt_register_handler(APIC_TIMER_VECTOR, __lapic_timer_interrupt, NULL);
+    } else {
+        pit8254_stop_channel0();
+        clockevent_device_initialize(
+            &__timer, "pit", __pit_set_next, __pit_stop, NULL,
+            PIT8254_FREQUENCY, 1, PIT8254_MAX_COUNT
+        );
+        irq_request(&__irq, PIT8254_CHANNEL0_IRQ, __irq0_interrupt, NULL);
+    }
+}
+
+/**
+ * @brief Load the Interrupt Descriptor Table on the running CPU.
+ *
+ * Every CPU shares the same table.
+ */
+static void load_interrupt_descriptor_table(void) {
+    idt_register_t idtr;
 
-    /* setup PIC controllers ICW4 (because we said we need to) */
-    pic8259_send_icw4(&__pic1, true, PIC8259_BUFFERED_MODE_NONE, true);
-    pic8259_send_icw4(&__pic2, true, PIC8259_BUFFERED_MODE_NONE, true);
+    interrupt_build_idtr(&idtr, __idt, sizeof(__idt) / sizeof(idt_entry_t));
+    interrupt_load_idtr(&idtr);
 }
 
 /**
@@ -123,277 +663,35 @@ static void initialize_pic(void) {
  * clear the interrupt descriptor table.
  */
 static void initialize_interrupt_descriptor_table(void) {
-    idt_register_t idtr;
-    idt_entry_t* entry;
-
     memory_set_value((u8*)__idt, 0, sizeof(__idt));
-    interrupt_build_idtr(&idtr, __idt, sizeof(__idt) / sizeof(idt_entry_t));
-    interrupt_load_idtr(&idtr, __generic_interrupt_handler);
+    load_interrupt_descriptor_table();
 }
 
 /**
- * @brief Initialize low level interrupt functions to point to our generic interrupt function.
+ * @brief Point every vector of the IDT at its entry stub.
  *
- * This function will initialize all interrupts with a function that will
- * call the generic interrupt function.
+ * The stubs dispatch through interrupt_handlers (interrupt_fault_handlers
+ * for CPU exceptions), so vectors without a handler are ignored, except
+ * CPU exceptions which stop the kernel.
  */
 static void initialize_interrupt_functions(void) {
-    interrupt_setup(&__idt[0], __isr_handler_0, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[1], __isr_handler_1, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[2], __isr_handler_2, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[3], __isr_handler_3, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[4], __isr_handler_4, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[5], __isr_handler_5, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[6], __isr_handler_6, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[7], __isr_handler_7, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[8], __isr_handler_8, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[9], __isr_handler_9, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[10], __isr_handler_10, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[11], __isr_handler_11, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[12], __isr_handler_12, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[13], __isr_handler_13, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[14], __isr_handler_14, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[15], __isr_handler_15, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[16], __isr_handler_16, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[17], __isr_handler_17, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[18], __isr_handler_18, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[19], __isr_handler_19, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[20], __isr_handler_20, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[21], __isr_handler_21, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[22], __isr_handler_22, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[23], __isr_handler_23, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[24], __isr_handler_24, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[25], __isr_handler_25, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[26], __isr_handler_26, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[27], __isr_handler_27, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[28], __isr_handler_28, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[29], __isr_handler_29, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[30], __isr_handler_30, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[31], __isr_handler_31, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[32], __isr_handler_32, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[33], __isr_handler_33, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[34], __isr_handler_34, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[35], __isr_handler_35, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[36], __isr_handler_36, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[37], __isr_handler_37, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[38], __isr_handler_38, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[39], __isr_handler_39, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[40], __isr_handler_40, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[41], __isr_handler_41, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[42], __isr_handler_42, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[43], __isr_handler_43, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[44], __isr_handler_44, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[45], __isr_handler_45, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[46], __isr_handler_46, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[47], __isr_handler_47, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[48], __isr_handler_48, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[49], __isr_handler_49, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[50], __isr_handler_50, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[51], __isr_handler_51, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[52], __isr_handler_52, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[53], __isr_handler_53, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[54], __isr_handler_54, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[55], __isr_handler_55, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[56], __isr_handler_56, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[57], __isr_handler_57, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[58], __isr_handler_58, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[59], __isr_handler_59, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[60], __isr_handler_60, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[61], __isr_handler_61, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[62], __isr_handler_62, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[63], __isr_handler_63, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[64], __isr_handler_64, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[65], __isr_handler_65, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[66], __isr_handler_66, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[67], __isr_handler_67, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[68], __isr_handler_68, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[69], __isr_handler_69, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[70], __isr_handler_70, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[71], __isr_handler_71, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[72], __isr_handler_72, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[73], __isr_handler_73, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[74], __isr_handler_74, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[75], __isr_handler_75, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[76], __isr_handler_76, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[77], __isr_handler_77, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[78], __isr_handler_78, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[79], __isr_handler_79, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[80], __isr_handler_80, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[81], __isr_handler_81, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[82], __isr_handler_82, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[83], __isr_handler_83, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[84], __isr_handler_84, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[85], __isr_handler_85, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[86], __isr_handler_86, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[87], __isr_handler_87, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[88], __isr_handler_88, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[89], __isr_handler_89, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[90], __isr_handler_90, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[91], __isr_handler_91, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[92], __isr_handler_92, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[93], __isr_handler_93, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[94], __isr_handler_94, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[95], __isr_handler_95, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[96], __isr_handler_96, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[97], __isr_handler_97, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[98], __isr_handler_98, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[99], __isr_handler_99, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[100], __isr_handler_100, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[101], __isr_handler_101, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[102], __isr_handler_102, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[103], __isr_handler_103, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[104], __isr_handler_104, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[105], __isr_handler_105, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[106], __isr_handler_106, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[107], __isr_handler_107, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[108], __isr_handler_108, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[109], __isr_handler_109, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[110], __isr_handler_110, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[111], __isr_handler_111, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[112], __isr_handler_112, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[113], __isr_handler_113, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[114], __isr_handler_114, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[115], __isr_handler_115, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[116], __isr_handler_116, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[117], __isr_handler_117, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[118], __isr_handler_118, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[119], __isr_handler_119, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[120], __isr_handler_120, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[121], __isr_handler_121, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[122], __isr_handler_122, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[123], __isr_handler_123, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[124], __isr_handler_124, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[125], __isr_handler_125, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[126], __isr_handler_126, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[127], __isr_handler_127, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[128], __isr_handler_128, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[129], __isr_handler_129, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[130], __isr_handler_130, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[131], __isr_handler_131, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[132], __isr_handler_132, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[133], __isr_handler_133, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[134], __isr_handler_134, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[135], __isr_handler_135, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[136], __isr_handler_136, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[137], __isr_handler_137, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[138], __isr_handler_138, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[139], __isr_handler_139, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[140], __isr_handler_140, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[141], __isr_handler_141, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[142], __isr_handler_142, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[143], __isr_handler_143, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[144], __isr_handler_144, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[145], __isr_handler_145, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[146], __isr_handler_146, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[147], __isr_handler_147, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[148], __isr_handler_148, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[149], __isr_handler_149, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[150], __isr_handler_150, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[151], __isr_handler_151, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[152], __isr_handler_152, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[153], __isr_handler_153, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[154], __isr_handler_154, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[155], __isr_handler_155, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[156], __isr_handler_156, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[157], __isr_handler_157, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[158], __isr_handler_158, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[159], __isr_handler_159, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[160], __isr_handler_160, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[161], __isr_handler_161, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[162], __isr_handler_162, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[163], __isr_handler_163, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[164], __isr_handler_164, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[165], __isr_handler_165, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[166], __isr_handler_166, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[167], __isr_handler_167, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[168], __isr_handler_168, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[169], __isr_handler_169, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[170], __isr_handler_170, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[171], __isr_handler_171, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[172], __isr_handler_172, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[173], __isr_handler_173, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[174], __isr_handler_174, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[175], __isr_handler_175, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[176], __isr_handler_176, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[177], __isr_handler_177, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[178], __isr_handler_178, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[179], __isr_handler_179, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[180], __isr_handler_180, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[181], __isr_handler_181, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[182], __isr_handler_182, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[183], __isr_handler_183, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[184], __isr_handler_184, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[185], __isr_handler_185, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[186], __isr_handler_186, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[187], __isr_handler_187, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[188], __isr_handler_188, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[189], __isr_handler_189, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[190], __isr_handler_190, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[191], __isr_handler_191, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[192], __isr_handler_192, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[193], __isr_handler_193, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[194], __isr_handler_194, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[195], __isr_handler_195, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[196], __isr_handler_196, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[197], __isr_handler_197, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[198], __isr_handler_198, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[199], __isr_handler_199, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[200], __isr_handler_200, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[201], __isr_handler_201, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[202], __isr_handler_202, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[203], __isr_handler_203, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[204], __isr_handler_204, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[205], __isr_handler_205, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[206], __isr_handler_206, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[207], __isr_handler_207, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[208], __isr_handler_208, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[209], __isr_handler_209, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[210], __isr_handler_210, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[211], __isr_handler_211, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[212], __isr_handler_212, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[213], __isr_handler_213, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[214], __isr_handler_214, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[215], __isr_handler_215, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[216], __isr_handler_216, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[217], __isr_handler_217, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[218], __isr_handler_218, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[219], __isr_handler_219, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[220], __isr_handler_220, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[221], __isr_handler_221, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[222], __isr_handler_222, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[223], __isr_handler_223, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[224], __isr_handler_224, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[225], __isr_handler_225, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[226], __isr_handler_226, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[227], __isr_handler_227, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[228], __isr_handler_228, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[229], __isr_handler_229, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[230], __isr_handler_230, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[231], __isr_handler_231, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[232], __isr_handler_232, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[233], __isr_handler_233, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[234], __isr_handler_234, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[235], __isr_handler_235, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[236], __isr_handler_236, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[237], __isr_handler_237, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[238], __isr_handler_238, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[239], __isr_handler_239, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[240], __isr_handler_240, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[241], __isr_handler_241, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[242], __isr_handler_242, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[243], __isr_handler_243, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[244], __isr_handler_244, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[245], __isr_handler_245, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[246], __isr_handler_246, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[247], __isr_handler_247, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[248], __isr_handler_248, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[249], __isr_handler_249, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[250], __isr_handler_250, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[251], __isr_handler_251, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[252], __isr_handler_252, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[253], __isr_handler_253, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[254], __isr_handler_254, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
-    interrupt_setup(&__idt[255], __isr_handler_255, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
+    u32 vector;
+
+    for (vector = 0; vector < INTERRUPT_VECTOR_COUNT; vector++) {
+        interrupt_setup(
+            &__idt[vector],
+            __isr_handler_table[vector],
+            SEGMENT_SELECTOR_KERNEL_CODE_32BIT,
+            GATE_TYPE_INTERRUPT_GATE_32BIT,
+            0,
+            true
+        );
+    }
+
+    for (vector = 0; vector < INTERRUPT_EXCEPTION_COUNT; vector++) {
+        interrupt_register_fault_handler((u8)vector, __unhandled_exception, NULL);
+    }
+    interrupt_register_fault_handler(INTERRUPT_VECTOR_DEVICE_NOT_AVAILABLE, __fpu_unavailable, NULL);
 }
 
 
@@ -408,10 +706,22 @@ static void initialize_paging(void) {
     range_t kernel_addresses;
     memory_table_t memory_table;
     range_t memory_range;
+    range_t framebuffer_addresses;
+    framebuffer_info_t framebuffer;
 
     /* get kernel addresses */
     memory_get_kernel_addresses(&kernel_addresses);
 
+    /* the framebuffer is device memory outside the memory table (an empty range if there is none) */
+    range_init(&framebuffer_addresses, 0, 0);
+    if (architecture_get_framebuffer(&framebuffer)) {
+        range_init(
+            &framebuffer_addresses,
+            (u32)framebuffer.address,
+            (u32)framebuffer.address + (s64)framebuffer.pitch * framebuffer.height
+        );
+    }
+
     /* get memory table for use addresses */
     memory_get_table(&memory_table);
 
@@ -465,6 +775,26 @@ static void initialize_paging(void) {
             page_table_set_dirty(&__page_tables[location.table_num][location.page_num], false);
             page_table_set_global(&__page_tables[location.table_num][location.page_num], true);
             page_table_set_physical_page_address(&__page_tables[location.table_num][location.page_num], location.page_base_addr);
+        } else if (in_range(addr, &framebuffer_addresses)) {
+            /* only the CPU writes the framebuffer, so write-through caching keeps scroll reads out of video memory */
+            page_table_set_present(&__page_tables[location.table_num][location.page_num], true);
+            page_table_set_permissions(&__page_tables[location.table_num][location.page_num], PAGING_SUPERVISOR_READ_WRITE);
+            page_table_set_write_type(&__page_tables[location.table_num][location.page_num], PAGING_WRITE_TYPE_WRITE_THROUGH);
+            page_table_enable_caching(&__page_tables[location.table_num][location.page_num], true);
+            page_table_set_accessed(&__page_tables[location.table_num][location.page_num], false);
+            page_table_set_dirty(&__page_tables[location.table_num][location.page_num], false);
+            page_table_set_global(&__page_tables[location.table_num][location.page_num], true);
+            page_table_set_physical_page_address(&__page_tables[location.table_num][location.page_num], location.page_base_addr);
+        } else if (is_device_page(addr)) {
+            /* APIC and HPET registers have side effects on every access, so they are never cached */
+            page_table_set_present(&__page_tables[location.table_num][location.page_num], true);
+            page_table_set_permissions(&__page_tables[location.table_num][location.page_num], PAGING_SUPERVISOR_READ_WRITE);
+            page_table_set_write_type(&__page_tables[location.table_num][location.page_num], PAGING_WRITE_TYPE_WRITE_THROUGH);
+            page_table_enable_caching(&__page_tables[location.table_num][location.page_num], false);
+            page_table_set_accessed(&__page_tables[location.table_num][location.page_num], false);
+            page_table_set_dirty(&__page_tables[location.table_num][location.page_num], false);
+            page_table_set_global(&__page_tables[location.table_num][location.page_num], true);
+            page_table_set_physical_page_address(&__page_tables[location.table_num][location.page_num], location.page_base_addr);
         } else {
             int i;
 
@@ -502,11 +832,264 @@ static void initialize_paging(void) {
     paging_enable();
 }
 
+/**
+ * @brief First C function of an application processor, started by architecture_start_cpus.
+ *
+ * Sets the CPU up like the boot CPU, lets the IRQ lines be delivered to it
+ * and sleeps between interrupts from then on.
+ *
+ * @param cpu number of the CPU.
+ */
+static void __application_processor_main(u32 cpu) {
+    lapic_t lapic;
+
+    __cpus[cpu].number = cpu;
+    initialize_global_descriptor_table(cpu);
+    load_interrupt_descriptor_table();
+    if (__vector_unit) {
+        cpu_enable_sse();
+    }
+
+    cpu_write_msr(CPU_MSR_APIC_BASE, cpu_read_msr(CPU_MSR_APIC_BASE) | CPU_MSR_APIC_BASE_ENABLE);
+    lapic_initialize(&lapic, __madt.lapic_address, APIC_SPURIOUS_VECTOR);
+    __cpus[cpu].apic_id = lapic_get_id(&lapic);
+    irq_set_cpu_online(&__irq, (u8)cpu, __cpus[cpu].apic_id);
+    __atomic_store_n(&__cpus[cpu].online, true, __ATOMIC_RELEASE);
+
+    while (1) {
+        cpu_idle();
+    }
+}
+
+/**
+ * @brief Check whether the multiboot information is in the page the trampoline is copied to.
+ *
+ * @return true if copying the trampoline would overwrite it.
+ */
+static bool is_trampoline_page_used(void) {
+    uintptr_t start = (uintptr_t)multiboot_info;
+    uintptr_t end = start + sizeof(multiboot_info_t);
+
+    return start < SMP_TRAMPOLINE_ADDRESS + 4096 && end > SMP_TRAMPOLINE_ADDRESS;
+}
+
+/**
+ * @brief Switch the serial console to interrupt driven transmission on the COM1 IRQ.
+ *
+ * The console is written on the boot CPU, where the log drains, so the
+ * line is kept on it and the transmit ring never meets the handler of
+ * another CPU.
+ */
+static void initialize_serial(void) {
+    if (!__com1.present) {
+        return;
+    }
+
+    irq_request(&__irq, UART16550_COM1_IRQ, __com1_interrupt, &__com1);
+    irq_set_affinity(&__irq, UART16550_COM1_IRQ, 1u << 0);
+    uart16550_enable_interrupts(&__com1);
+}
+
 void initialize_architecture(void) {
+    /* polled serial output needs nothing else, so bring it up first for early boot messages */
+    uart16550_initialize(&__com1, UART16550_COM1_PORT, SERIAL_CONSOLE_BAUD);
+    if (cpu_has_sse2()) {
+        cpu_enable_sse();
+        __vector_unit = true;
+    }
+    __has_apic = discover_apic();
+    __has_hpet = discover_hpet();
+    __tsc_frequency = tsc_calibrate();
+    if (__tsc_frequency == 0 && __has_hpet) {
+        __tsc_frequency = tsc_calibrate_hpet(&__hpet);
+    }
     initialize_paging();
-    initialize_global_descriptor_table();
+    initialize_global_descriptor_table(0);
     initialize_pic();
-    // todo: fix interrupts
-    // initialize_interrupt_descriptor_table();
-    // initialize_interrupt_functions();
-}
\ No newline at end of file
+    initialize_interrupt_descriptor_table();
+    initialize_interrupt_functions();
+    initialize_timer();
+    initialize_serial();
+}
+
+u32 architecture_start_cpus(void) {
+    smp_parameters_t parameters;
+    u32 index;
+    u32 cpu;
+
+    /* the waits of the startup sequence are timed with the TSC */
+    if (!__has_apic || __tsc_frequency == 0 || __cpu_count > 1 || is_trampoline_page_used()) {
+        return __cpu_count;
+    }
+
+    smp_install_trampoline();
+    for (index = 0; index < __madt.cpu_count && __cpu_count < SMP_MAX_CPUS; index++) {
+        if (__madt.apic_ids[index] == __cpus[0].apic_id) {
+            continue;
+        }
+
+        cpu = __cpu_count;
+        parameters.page_directory = (u32)(uintptr_t)__page_directory;
+        parameters.stack_top = (u32)(uintptr_t)&boot_stacks[(cpu + 1) * SMP_BOOT_STACK_SIZE];
+        parameters.entry = (u32)(uintptr_t)__application_processor_main;
+        parameters.cpu = cpu;
+        if (smp_start_cpu(&__apic.lapic, __madt.apic_ids[index], &parameters, &__cpus[cpu].online, __tsc_frequency)) {
+            __cpu_count++;
+        }
+    }
+
+    return __cpu_count;
+}
+
+u32 architecture_cpu_id(void) {
+    return smp_this_cpu();
+}
+
+void architecture_record_interrupts(irqstat_t* stats) {
+    __atomic_store_n(&__interrupt_stats, stats, __ATOMIC_RELEASE);
+    interrupt_set_account(stats != NULL ? __account_interrupt : NULL);
+}
+
+u32 architecture_balance_irqs(void) {
+    irqstat_t* stats = __atomic_load_n(&__interrupt_stats, __ATOMIC_ACQUIRE);
+    u64 counts[IRQ_MAX_LINES];
+    u8 irq;
+
+    if (stats == NULL) {
+        return 0;
+    }
+
+    for (irq = 0; irq < __irq.line_count; irq++) {
+        counts[irq] = irqstat_get_count(stats, __irq.base + irq);
+    }
+    return irq_balance(&__irq, counts);
+}
+
+u64 architecture_clock_cycles(void) {
+    return cpu_read_tsc();
+}
+
+u64 architecture_clock_frequency(void) {
+    return __tsc_frequency;
+}
+
+bool architecture_clock_invariant(void) {
+    return cpu_has_invariant_tsc();
+}
+
+bool architecture_attach_clockevent(clockevent_t* event) {
+    if (__timer.set_next == NULL || __tsc_frequency == 0) {
+        return false;
+    }
+
+    __atomic_store_n(&__clockevent, event, __ATOMIC_RELEASE);
+    clockevent_set_device(event, &__timer);
+    return true;
+}
+
+void architecture_thread_prepare(thread_context_t* context, void* stack_top, thread_function_t entry, void* argument) {
+    /* entry is called with a 16 byte aligned stack, as gcc expects */
+    u32* stack = (u32*)((uintptr_t)stack_top & ~(uintptr_t)0xf) - 4;
+
+    stack[0] = (u32)(uintptr_t)argument;
+    /* entry never returns */
+    *--stack = 0;
+    *--stack = (u32)(uintptr_t)entry;
+    stack -= SWITCH_SAVED_REGISTERS;
+    memory_set_value((u8*)stack, 0, SWITCH_SAVED_REGISTERS * sizeof(u32));
+    context->stack_pointer = stack;
+}
+
+void architecture_thread_switch(thread_context_t* previous, thread_context_t* next) {
+    if (__fpu_current == NULL) {
+        /* the boot flow used the FPU before there were threads */
+        previous->fpu_used = true;
+        __fpu_owner = previous;
+    }
+
+    __fpu_current = next;
+    if (next == __fpu_owner) {
+        cpu_clear_task_switched();
+    } else {
+        cpu_set_task_switched();
+    }
+    switch_to(&previous->stack_pointer, next->stack_pointer);
+}
+
+void architecture_idle(void) {
+    cpu_idle();
+}
+
+void architecture_enable_interrupts(void) {
+    cpu_enable_interrupts();
+}
+
+void architecture_disable_interrupts(void) {
+    cpu_disable_interrupts();
+}
+
+u32 architecture_save_interrupts(void) {
+    return cpu_save_and_disable_interrupts();
+}
+
+void architecture_restore_interrupts(u32 state) {
+    cpu_restore_interrupts(state);
+}
+
+void architecture_run_softirqs(softirq_t* softirq) {
+    __atomic_store_n(&__softirq, softirq, __ATOMIC_RELEASE);
+    __update_interrupt_exit();
+}
+
+void architecture_preempt_threads(threads_t* threads) {
+    __atomic_store_n(&__preempt_threads, threads, __ATOMIC_RELEASE);
+    __update_interrupt_exit();
+}
+
+void architecture_serial_write(const char* buffer, size_t length) {
+    uart16550_write(&__com1, buffer, length);
+}
+
+void architecture_serial_flush(void) {
+    uart16550_flush(&__com1);
+}
+
+void architecture_debugcon_write(const char* buffer, size_t length) {
+    size_t index;
+
+    for (index = 0; index < length; index++) {
+        port_output_byte(DEBUGCON_PORT, (u8)buffer[index]);
+    }
+}
+
+bool architecture_get_framebuffer(framebuffer_info_t* framebuffer) {
+    if ((multiboot_info->flags & MULTIBOOT_INFO_FRAMEBUFFER_INFO) == 0 || \
+            multiboot_info->framebuffer_type != MULTIBOOT_FRAMEBUFFER_TYPE_RGB || \
+            multiboot_info->framebuffer_address + (u64)multiboot_info->framebuffer_pitch * multiboot_info->framebuffer_height > 0x100000000ULL) {
+        return false;
+    }
+
+    framebuffer->address = (u8*)(u32)multiboot_info->framebuffer_address;
+    framebuffer->pitch = multiboot_info->framebuffer_pitch;
+    framebuffer->width = multiboot_info->framebuffer_width;
+    framebuffer->height = multiboot_info->framebuffer_height;
+    framebuffer->bpp = multiboot_info->framebuffer_bpp;
+    framebuffer->red_position = multiboot_info->framebuffer_red_field_position;
+    framebuffer->red_size = multiboot_info->framebuffer_red_mask_size;
+    framebuffer->green_position = multiboot_info->framebuffer_green_field_position;
+    framebuffer->green_size = multiboot_info->framebuffer_green_mask_size;
+    framebuffer->blue_position = multiboot_info->framebuffer_blue_field_position;
+    framebuffer->blue_size = multiboot_info->framebuffer_blue_mask_size;
+    return true;
+}
+
+bool architecture_has_vector_unit(void) {
+    return __vector_unit;
+}
+
+void architecture_vga_set_cursor(u16 position) {
+    port_output_byte(VGA_CRTC_INDEX_PORT, VGA_CRTC_CURSOR_LOW);
+    port_output_byte(VGA_CRTC_DATA_PORT, (u8)(position & 0xff));
+    port_output_byte(VGA_CRTC_INDEX_PORT, VGA_CRTC_CURSOR_HIGH);
+    port_output_byte(VGA_CRTC_DATA_PORT, (u8)(position >> 8));
+}
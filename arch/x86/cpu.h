@@ -0,0 +1,279 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* interrupt enable flag of EFLAGS */
+#define CPU_EFLAGS_INTERRUPT_ENABLE     (1 << 9)
+
+/* CPUID leaf 1 ECX feature bits */
+#define CPU_CPUID_FEATURE_TSC_DEADLINE  (1 << 24)
+
+/* CPUID leaf 1 EDX feature bits */
+#define CPU_CPUID_FEATURE_APIC          (1 << 9)
+#define CPU_CPUID_FEATURE_FXSR          (1 << 24)
+#define CPU_CPUID_FEATURE_SSE2          (1 << 26)
+
+/* CR0 FPU emulation and monitor coprocessor bits, and the task switched bit trapping FPU use */
+#define CPU_CR0_EMULATION               (1 << 2)
+#define CPU_CR0_MONITOR_COPROCESSOR     (1 << 1)
+#define CPU_CR0_TASK_SWITCHED           (1 << 3)
+
+/* MXCSR at power on: every SSE exception masked, round to nearest */
+#define CPU_MXCSR_DEFAULT               0x1f80
+
+/* CPUID extended leaf telling the highest extended leaf, and the power management leaf */
+#define CPU_CPUID_EXTENDED_MAX          0x80000000
+#define CPU_CPUID_POWER_MANAGEMENT      0x80000007
+
+/* CPUID power management leaf EDX bit of a TSC running at a constant rate in every P-, C- and T-state */
+#define CPU_CPUID_INVARIANT_TSC         (1 << 8)
+
+/* local APIC base MSR and its global enable bit */
+#define CPU_MSR_APIC_BASE               0x1b
+#define CPU_MSR_APIC_BASE_ENABLE        (1 << 11)
+
+/* TSC value the local APIC timer fires at in TSC-deadline mode (0 disarms it) */
+#define CPU_MSR_TSC_DEADLINE            0x6e0
+
+/* CR4 bits telling the CPU the OS saves SSE state and handles SSE exceptions */
+#define CPU_CR4_OSFXSR                  (1 << 9)
+#define CPU_CR4_OSXMMEXCPT              (1 << 10)
+
+/**
+ * @brief Enable interrupts on this CPU (sti).
+ */
+static inline void cpu_enable_interrupts(void) {
+    __asm__ volatile("sti" : : : "memory");
+}
+
+/**
+ * @brief Disable interrupts on this CPU (cli).
+ */
+static inline void cpu_disable_interrupts(void) {
+    __asm__ volatile("cli" : : : "memory");
+}
+
+/**
+ * @brief Enable interrupts on this CPU and sleep until the next interrupt (sti; hlt).
+ *
+ * sti only takes effect after the next instruction, so an interrupt arriving
+ * in between still wakes the hlt.
+ */
+static inline void cpu_idle(void) {
+    __asm__ volatile("sti\n\thlt" : : : "memory");
+}
+
+/**
+ * @brief Disable interrupts on this CPU and return the previous EFLAGS.
+ *
+ * @return EFLAGS before interrupts were disabled (pass to cpu_restore_interrupts).
+ */
+static inline u32 cpu_save_and_disable_interrupts(void) {
+    u32 flags;
+
+    __asm__ volatile("pushf\n\tpop %0\n\tcli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+/**
+ * @brief Re-enable interrupts on this CPU if they were enabled before cpu_save_and_disable_interrupts.
+ *
+ * @param flags value returned by cpu_save_and_disable_interrupts.
+ */
+static inline void cpu_restore_interrupts(u32 flags) {
+    if (flags & CPU_EFLAGS_INTERRUPT_ENABLE) {
+        __asm__ volatile("sti" : : : "memory");
+    }
+}
+
+/**
+ * @brief Get the linear address the last page fault was raised for (CR2).
+ *
+ * @return the faulting address.
+ */
+static inline u32 cpu_get_page_fault_address(void) {
+    u32 address;
+
+    __asm__ volatile("mov %%cr2, %0" : "=r"(address));
+    return address;
+}
+
+/**
+ * @brief Read the time stamp counter.
+ *
+ * @return the TSC.
+ */
+static inline u64 cpu_read_tsc(void) {
+    u32 low;
+    u32 high;
+
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((u64)high << 32) | low;
+}
+
+/**
+ * @brief Check whether the TSC runs at a constant rate whatever the power state of the CPU.
+ *
+ * @return true if the TSC is invariant.
+ */
+static inline bool cpu_has_invariant_tsc(void) {
+    u32 eax = CPU_CPUID_EXTENDED_MAX;
+    u32 ebx;
+    u32 ecx = 0;
+    u32 edx;
+
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    if (eax < CPU_CPUID_POWER_MANAGEMENT) {
+        return false;
+    }
+
+    eax = CPU_CPUID_POWER_MANAGEMENT;
+    ecx = 0;
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (edx & CPU_CPUID_INVARIANT_TSC) != 0;
+}
+
+/**
+ * @brief Read a model specific register.
+ *
+ * @param msr register to read.
+ * @return the register.
+ */
+static inline u64 cpu_read_msr(u32 msr) {
+    u32 low;
+    u32 high;
+
+    __asm__ volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+    return ((u64)high << 32) | low;
+}
+
+/**
+ * @brief Write a model specific register.
+ *
+ * @param msr register to write.
+ * @param value value to write.
+ */
+static inline void cpu_write_msr(u32 msr, u64 value) {
+    __asm__ volatile("wrmsr" : : "c"(msr), "a"((u32)value), "d"((u32)(value >> 32)) : "memory");
+}
+
+/**
+ * @brief Check whether the CPU has a local APIC.
+ *
+ * @return true if the local APIC can be enabled through CPU_MSR_APIC_BASE.
+ */
+static inline bool cpu_has_apic(void) {
+    u32 eax = 1;
+    u32 ebx;
+    u32 ecx = 0;
+    u32 edx;
+
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (edx & CPU_CPUID_FEATURE_APIC) != 0;
+}
+
+/**
+ * @brief Check whether the local APIC timer has a TSC-deadline mode.
+ *
+ * @return true if the timer can be armed through CPU_MSR_TSC_DEADLINE.
+ */
+static inline bool cpu_has_tsc_deadline(void) {
+    u32 eax = 1;
+    u32 ebx;
+    u32 ecx = 0;
+    u32 edx;
+
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (ecx & CPU_CPUID_FEATURE_TSC_DEADLINE) != 0;
+}
+
+/**
+ * @brief Check whether the CPU supports SSE2 (and FXSAVE to preserve its registers).
+ *
+ * @return true if SSE2 can be enabled with cpu_enable_sse.
+ */
+static inline bool cpu_has_sse2(void) {
+    u32 eax = 1;
+    u32 ebx;
+    u32 ecx = 0;
+    u32 edx;
+
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (edx & (CPU_CPUID_FEATURE_SSE2 | CPU_CPUID_FEATURE_FXSR)) == (CPU_CPUID_FEATURE_SSE2 | CPU_CPUID_FEATURE_FXSR);
+}
+
+/**
+ * @brief Make the next FPU or SSE instruction raise #NM (device not available).
+ */
+static inline void cpu_set_task_switched(void) {
+    u32 cr0;
+
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    __asm__ volatile("mov %0, %%cr0" : : "r"(cr0 | CPU_CR0_TASK_SWITCHED));
+}
+
+/**
+ * @brief Let FPU and SSE instructions run again (clts).
+ */
+static inline void cpu_clear_task_switched(void) {
+    __asm__ volatile("clts");
+}
+
+/**
+ * @brief Save the FPU and SSE registers.
+ *
+ * @param area 512 byte area aligned on 16 bytes.
+ * @param sse whether SSE is enabled (fxsave), only the x87 state is saved otherwise (fnsave).
+ */
+static inline void cpu_save_fpu(void* area, bool sse) {
+    if (sse) {
+        __asm__ volatile("fxsave (%0)" : : "r"(area) : "memory");
+    } else {
+        __asm__ volatile("fnsave (%0)" : : "r"(area) : "memory");
+    }
+}
+
+/**
+ * @brief Load the FPU and SSE registers saved by cpu_save_fpu.
+ *
+ * @param area area given to cpu_save_fpu.
+ * @param sse whether SSE is enabled.
+ */
+static inline void cpu_restore_fpu(const void* area, bool sse) {
+    if (sse) {
+        __asm__ volatile("fxrstor (%0)" : : "r"(area) : "memory");
+    } else {
+        __asm__ volatile("frstor (%0)" : : "r"(area) : "memory");
+    }
+}
+
+/**
+ * @brief Reset the FPU and SSE registers to their power on state.
+ *
+ * @param sse whether SSE is enabled.
+ */
+static inline void cpu_init_fpu(bool sse) {
+    u32 mxcsr = CPU_MXCSR_DEFAULT;
+
+    __asm__ volatile("fninit");
+    if (sse) {
+        __asm__ volatile("ldmxcsr %0" : : "m"(mxcsr));
+    }
+}
+
+/**
+ * @brief Allow SSE instructions (they raise #UD until the OS opts in through CR0 and CR4).
+ */
+static inline void cpu_enable_sse(void) {
+    u32 cr0;
+    u32 cr4;
+
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    cr0 &= ~CPU_CR0_EMULATION;
+    cr0 |= CPU_CR0_MONITOR_COPROCESSOR;
+    __asm__ volatile("mov %0, %%cr0" : : "r"(cr0));
+
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= CPU_CR4_OSFXSR | CPU_CR4_OSXMMEXCPT;
+    __asm__ volatile("mov %0, %%cr4" : : "r"(cr4));
+}
@@ -0,0 +1,65 @@
+#include <llanos/types.h>
+
+#include "hpet.h"
+
+/**
+ * @brief Write a register.
+ *
+ * @param hpet HPET to write.
+ * @param offset offset of the register (its low dword for a 64 bit register).
+ * @param value value to write.
+ */
+static void __hpet_write(hpet_t* hpet, u32 offset, u32 value) {
+    hpet->registers[offset / sizeof(u32)] = value;
+}
+
+/**
+ * @brief Read a register.
+ *
+ * @param hpet HPET to read.
+ * @param offset offset of the register (its low dword for a 64 bit register).
+ * @return the register.
+ */
+static u32 __hpet_read(const hpet_t* hpet, u32 offset) {
+    return hpet->registers[offset / sizeof(u32)];
+}
+
+bool hpet_initialize(hpet_t* hpet, u32 address) {
+    u32 capabilities;
+    u32 period;
+    u8 timer;
+
+    hpet->registers = (volatile u32*)(uintptr_t)address;
+    capabilities = __hpet_read(hpet, HPET_REGISTER_CAPABILITIES);
+    period = __hpet_read(hpet, HPET_REGISTER_CAPABILITIES + sizeof(u32));
+    if (period == 0 || period > HPET_MAX_PERIOD_FS) {
+        return false;
+    }
+
+    hpet->frequency = HPET_FS_PER_SECOND / period;
+    hpet->timer_count = (u8)(((capabilities >> HPET_CAPABILITIES_LAST_TIMER_SHIFT) & HPET_CAPABILITIES_LAST_TIMER_MASK) + 1);
+    hpet->legacy_route = (capabilities & HPET_CAPABILITIES_LEGACY_ROUTE) != 0;
+
+    /* the counter can only be written while it is halted */
+    __hpet_write(hpet, HPET_REGISTER_CONFIGURATION, 0);
+    for (timer = 0; timer < hpet->timer_count; timer++) {
+        __hpet_write(hpet, HPET_REGISTER_TIMER_CONFIGURATION(timer), HPET_TIMER_32BIT);
+    }
+    __hpet_write(hpet, HPET_REGISTER_MAIN_COUNTER, 0);
+    __hpet_write(hpet, HPET_REGISTER_MAIN_COUNTER + sizeof(u32), 0);
+    __hpet_write(hpet, HPET_REGISTER_CONFIGURATION, HPET_CONFIGURATION_ENABLE);
+    return true;
+}
+
+void hpet_enable_legacy_route(hpet_t* hpet) {
+    __hpet_write(hpet, HPET_REGISTER_CONFIGURATION, HPET_CONFIGURATION_ENABLE | HPET_CONFIGURATION_LEGACY_ROUTE);
+}
+
+void hpet_timer_start(hpet_t* hpet, u8 timer, u32 comparator) {
+    __hpet_write(hpet, HPET_REGISTER_TIMER_COMPARATOR(timer), comparator);
+    __hpet_write(hpet, HPET_REGISTER_TIMER_CONFIGURATION(timer), HPET_TIMER_32BIT | HPET_TIMER_ENABLE);
+}
+
+void hpet_timer_stop(hpet_t* hpet, u8 timer) {
+    __hpet_write(hpet, HPET_REGISTER_TIMER_CONFIGURATION(timer), HPET_TIMER_32BIT);
+}
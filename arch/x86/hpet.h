@@ -0,0 +1,102 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* register offsets */
+#define HPET_REGISTER_CAPABILITIES          0x000
+#define HPET_REGISTER_CONFIGURATION         0x010
+#define HPET_REGISTER_MAIN_COUNTER          0x0f0
+#define HPET_REGISTER_TIMER_CONFIGURATION(timer)    (0x100 + 0x20 * (timer))
+#define HPET_REGISTER_TIMER_COMPARATOR(timer)       (0x108 + 0x20 * (timer))
+
+/* low dword of the capabilities: number of the last timer and legacy replacement support */
+#define HPET_CAPABILITIES_LAST_TIMER_SHIFT  8
+#define HPET_CAPABILITIES_LAST_TIMER_MASK   0x1f
+#define HPET_CAPABILITIES_LEGACY_ROUTE      (1 << 15)
+
+/* longest counter period allowed by the specification in femtoseconds (10 MHz) */
+#define HPET_MAX_PERIOD_FS                  100000000
+
+/* femtoseconds per second */
+#define HPET_FS_PER_SECOND                  1000000000000000ULL
+
+/* general configuration bits */
+#define HPET_CONFIGURATION_ENABLE           (1 << 0)
+#define HPET_CONFIGURATION_LEGACY_ROUTE     (1 << 1)
+
+/* timer configuration bits (edge triggered and one-shot when left clear) */
+#define HPET_TIMER_LEVEL                    (1 << 1)
+#define HPET_TIMER_ENABLE                   (1 << 2)
+#define HPET_TIMER_PERIODIC                 (1 << 3)
+#define HPET_TIMER_32BIT                    (1 << 8)
+
+/* timers wired to IRQ 0 and IRQ 8 in legacy replacement mode */
+#define HPET_LEGACY_TIMER_IRQ0              0
+#define HPET_LEGACY_TIMER_IRQ8              1
+
+typedef struct hpet_s hpet_t;
+
+/**
+ * @brief A High Precision Event Timer.
+ *
+ * A free running main counter of at least 10 MHz and comparators raising
+ * an interrupt when the counter reaches them. The comparators are used in
+ * 32 bit mode, so the driver works the same with 32 and 64 bit counters.
+ *
+ * @member registers register block (mapped uncached).
+ * @member frequency counter frequency in Hz.
+ * @member timer_count number of comparators.
+ * @member legacy_route whether timers 0 and 1 can replace the PIT and the RTC on IRQ 0 and IRQ 8.
+ */
+struct hpet_s {
+    volatile u32* registers;
+    u64 frequency;
+    u8 timer_count;
+    bool legacy_route;
+};
+
+/**
+ * @brief Reset the counter to 0 and start it, with every comparator disabled.
+ *
+ * @param hpet HPET to initialize.
+ * @param address address of its registers.
+ * @return false if the counter period is not valid (no HPET at that address).
+ */
+extern bool hpet_initialize(hpet_t* hpet, u32 address);
+
+/**
+ * @brief Read the low 32 bits of the main counter.
+ *
+ * Enough to time intervals of up to 2^32 ticks with unsigned subtraction,
+ * and a single register read, which cannot tear.
+ *
+ * @param hpet HPET to read.
+ * @return the low 32 bits of the counter.
+ */
+static inline u32 hpet_read_counter(const hpet_t* hpet) {
+    return hpet->registers[HPET_REGISTER_MAIN_COUNTER / sizeof(u32)];
+}
+
+/**
+ * @brief Wire timer 0 to IRQ 0 and timer 1 to IRQ 8, in place of the PIT and the RTC.
+ *
+ * @param hpet HPET with legacy_route.
+ */
+extern void hpet_enable_legacy_route(hpet_t* hpet);
+
+/**
+ * @brief Arm a comparator for one edge triggered interrupt.
+ *
+ * @param hpet HPET of the timer.
+ * @param timer number of the timer.
+ * @param comparator low 32 bits of the counter value to interrupt at.
+ */
+extern void hpet_timer_start(hpet_t* hpet, u8 timer, u32 comparator);
+
+/**
+ * @brief Disarm a comparator.
+ *
+ * @param hpet HPET of the timer.
+ * @param timer number of the timer.
+ */
+extern void hpet_timer_stop(hpet_t* hpet, u8 timer);
@@ -2,30 +2,19 @@
 
 #include "interrupt.h"
 
-void (*__generic_interrupt_handler)(u32 isrnum);
-
-/**
- * @brief Load IDT register into memory.
- *
- * This is equivalent to the assembly instruction `lidt [idtr]`.
- *
- * @param idtr pointer to interrupt descriptor table register to load.
- */
-extern void __interrupt_load_idtr(idt_register_t* idtr);
+interrupt_handler_entry_t interrupt_handlers[INTERRUPT_VECTOR_COUNT];
+interrupt_fault_handler_entry_t interrupt_fault_handlers[INTERRUPT_EXCEPTION_COUNT];
+interrupt_account_t interrupt_account;
+interrupt_exit_t interrupt_exit;
 
 void interrupt_build_idtr(idt_register_t* idtr, idt_entry_t* idt, size_t count) {
-    idtr->base = (u32)idt;
-    idtr->limit = (count * sizeof(u32)) - 1;
-}
-
-void interrupt_load_idtr(idt_register_t* idtr, void (*interrupt_handler)(u32 isrnum)) {
-    __generic_interrupt_handler = interrupt_handler;
-    __interrupt_load_idtr(idtr);
+    idtr->base = (u32)(uintptr_t)idt;
+    idtr->limit = (count * sizeof(idt_entry_t)) - 1;
 }
 
 void interrupt_setup(idt_entry_t* entry, void (*isr)(void), u8 sel, u8 gate_type, u8 dpl, bool present) {
-    entry->base_low = ((u32)(isr) & 0xffff);
-    entry->base_high = ((u32)(isr) >> 16);
+    entry->base_low = ((u32)(uintptr_t)(isr) & 0xffff);
+    entry->base_high = ((u32)(uintptr_t)(isr) >> 16);
 
     entry->sel = sel;
     entry->always0 = 0;
@@ -34,3 +23,39 @@ void interrupt_setup(idt_entry_t* entry, void (*isr)(void), u8 sel, u8 gate_type
     entry->dpl = dpl;
     entry->present = present ? 1 : 0;
 }
+
+bool interrupt_has_error_code(u32 vector) {
+    return vector < INTERRUPT_EXCEPTION_COUNT && (INTERRUPT_ERROR_CODE_VECTORS & (1u << vector)) != 0;
+}
+
+void interrupt_register_handler(u8 vector, interrupt_handler_t handler, void* context) {
+    interrupt_handler_entry_t* entry = &interrupt_handlers[vector];
+
+    __atomic_store_n(&entry->handler, NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->context, context, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->handler, handler, __ATOMIC_RELEASE);
+}
+
+void interrupt_unregister_handler(u8 vector) {
+    __atomic_store_n(&interrupt_handlers[vector].handler, NULL, __ATOMIC_RELEASE);
+}
+
+void interrupt_register_fault_handler(u8 vector, interrupt_fault_handler_t handler, void* context) {
+    interrupt_fault_handler_entry_t* entry = &interrupt_fault_handlers[vector];
+
+    __atomic_store_n(&entry->handler, NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->context, context, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->handler, handler, __ATOMIC_RELEASE);
+}
+
+void interrupt_unregister_fault_handler(u8 vector) {
+    __atomic_store_n(&interrupt_fault_handlers[vector].handler, NULL, __ATOMIC_RELEASE);
+}
+
+void interrupt_set_account(interrupt_account_t account) {
+    __atomic_store_n(&interrupt_account, account, __ATOMIC_RELEASE);
+}
+
+void interrupt_set_exit(interrupt_exit_t hook) {
+    __atomic_store_n(&interrupt_exit, hook, __ATOMIC_RELEASE);
+}
@@ -17,8 +17,67 @@
 #define SEGMENT_SELECTOR_USER_DATA_32BIT        (0x3b)
 #define SEGMENT_SELECTOR_USER_STACK_32BIT       (0x43)
 
+/* number of interrupt vectors on x86 */
+#define INTERRUPT_VECTOR_COUNT                  256
+
+/* vectors below this one are CPU exceptions */
+#define INTERRUPT_EXCEPTION_COUNT               32
+
+/* exceptions the CPU pushes an error code for (bit n set for vector n) */
+#define INTERRUPT_ERROR_CODE_VECTORS            ( \
+    (1 << 8) | (1 << 10) | (1 << 11) | (1 << 12) | (1 << 13) | \
+    (1 << 14) | (1 << 17) | (1 << 21) | (1 << 29) | (1 << 30))
+
+/* FPU or SSE instruction run while CR0.TS is set */
+#define INTERRUPT_VECTOR_DEVICE_NOT_AVAILABLE   7
+
+/* page fault exception, the faulting address is in CR2 */
+#define INTERRUPT_VECTOR_PAGE_FAULT             14
+
 typedef struct idt_register_s idt_register_t;
 typedef struct idt_entry_s idt_entry_t;
+typedef struct interrupt_handler_entry_s interrupt_handler_entry_t;
+typedef struct interrupt_frame_s interrupt_frame_t;
+typedef struct interrupt_fault_handler_entry_s interrupt_fault_handler_entry_t;
+
+/**
+ * @brief Handler of an interrupt vector.
+ *
+ * Runs with interrupts disabled (the IDT uses interrupt gates).
+ *
+ * @param vector vector that was raised.
+ * @param context context pointer the handler was registered with.
+ */
+typedef void (*interrupt_handler_t)(u32 vector, void* context);
+
+/**
+ * @brief Handler of a CPU exception.
+ *
+ * Runs with interrupts disabled. The frame is restored when the handler
+ * returns, so a handler can resume somewhere else by changing eip, or
+ * return unchanged to retry the faulting instruction (after mapping the
+ * page on a page fault, for example).
+ *
+ * @param frame registers of the interrupted code.
+ * @param context context pointer the handler was registered with.
+ */
+typedef void (*interrupt_fault_handler_t)(interrupt_frame_t* frame, void* context);
+
+/**
+ * @brief Accounting hook run after every handler (see interrupt_set_account).
+ *
+ * @param vector vector that was handled.
+ * @param cycles TSC cycles the handler ran for (wraps for handlers running longer than 2^32 cycles).
+ */
+typedef void (*interrupt_account_t)(u32 vector, u32 cycles);
+
+/**
+ * @brief Hook run on the way out of every interrupt (see interrupt_set_exit).
+ *
+ * Runs with interrupts disabled, it may enable them as long as it disables
+ * them again before returning.
+ */
+typedef void (*interrupt_exit_t)(void);
 
 /**
  * @brief Interrupt Descriptor Table Register
@@ -28,7 +87,7 @@ typedef struct idt_entry_s idt_entry_t;
  *                        |  isr1  |
  * idtr.base (4 bytes) -> |  isr0  |
  *
- * If the IDT has 256 entries, then limit would be (256*4)-1=1023 or 0x3ff.
+ * Every entry is 8 bytes, so if the IDT has 256 entries, then limit would be (256*8)-1=2047 or 0x7ff.
  *
  * @member limit limit represents the upper limit of idt.
  * @member base base address of idt.
@@ -62,6 +121,77 @@ struct idt_entry_s {
     u16 base_high;
 } __attribute__((packed));
 
+/**
+ * @brief Slot of a vector in the handler table.
+ *
+ * The entry stub of a vector reads its slot directly (the layout is relied
+ * on by interrupt.S), so dispatching an interrupt is one indirect call.
+ *
+ * @member handler handler of the vector (NULL if the vector is ignored).
+ * @member context context pointer passed to handler.
+ */
+struct interrupt_handler_entry_s {
+    interrupt_handler_t handler;
+    void* context;
+};
+
+/**
+ * @brief Registers of the code interrupted by a CPU exception.
+ *
+ * Built on the stack by the fault trampoline of interrupt.S (the member
+ * order is relied on there). Exceptions without a CPU error code get a 0.
+ * useresp and ss are not part of the frame, the kernel only runs in ring 0.
+ *
+ * @member gs, fs, es, ds segment registers.
+ * @member edi, esi, ebp, esp, ebx, edx, ecx, eax general purpose registers as saved by pushad
+ *      (esp is the value before pushad and is not restored).
+ * @member vector exception vector.
+ * @member error_code error code pushed by the CPU (0 if the exception has none).
+ * @member eip, cs, eflags return address and flags pushed by the CPU.
+ */
+struct interrupt_frame_s {
+    u32 gs;
+    u32 fs;
+    u32 es;
+    u32 ds;
+    u32 edi;
+    u32 esi;
+    u32 ebp;
+    u32 esp;
+    u32 ebx;
+    u32 edx;
+    u32 ecx;
+    u32 eax;
+    u32 vector;
+    u32 error_code;
+    u32 eip;
+    u32 cs;
+    u32 eflags;
+};
+
+/**
+ * @brief Slot of an exception in the fault handler table.
+ *
+ * @member handler handler of the exception (NULL if the exception is ignored).
+ * @member context context pointer passed to handler.
+ */
+struct interrupt_fault_handler_entry_s {
+    interrupt_fault_handler_t handler;
+    void* context;
+};
+
+/* handler table indexed by vector (exception slots are unused, see interrupt_fault_handlers) */
+extern interrupt_handler_entry_t interrupt_handlers[INTERRUPT_VECTOR_COUNT];
+
+/* fault handler table indexed by exception vector */
+extern interrupt_fault_handler_entry_t interrupt_fault_handlers[INTERRUPT_EXCEPTION_COUNT];
+
+/* accounting hook of the entry trampolines (NULL when interrupts are not accounted) */
+extern interrupt_account_t interrupt_account;
+
+/* exit hook of the interrupt trampoline (NULL when there is nothing to do on interrupt exit) */
+extern interrupt_exit_t interrupt_exit;
+
 
 /**
  * @brief Build an IDTR from a base address and a size.
@@ -74,16 +204,14 @@ extern void interrupt_build_idtr(idt_register_t* idtr, idt_entry_t* idt, size_t
 
 
 /**
- * @brief Load Interrupt Descriptor Table Register and interrupt handler function to handle interrupts.
+ * @brief Load Interrupt Descriptor Table Register.
  *
- * This is equivalent to the assembly instruction `lidt [idtr]` along with the addition of setting
- * the generic interrupt handler in order to process interrupts.
+ * This is equivalent to the assembly instruction `lidt [idtr]`. Interrupts
+ * stay disabled; enable them once the interrupt controllers are set up.
  *
  * @param idtr pointer to interrupt descriptor table register to load.
- * @param interrupt_handler generic interrupt handler function that takes in the ISR number 
- *      and switches to the OS passed interrupt functions.
  */
-extern void interrupt_load_idtr(idt_register_t* idtr, void (*interrupt_handler)(u32 isrnum));
+extern void interrupt_load_idtr(idt_register_t* idtr);
 
 
 /**
@@ -106,3 +234,69 @@ extern void interrupt_store_idtr(idt_register_t* idtr);
  * @param present whether or not kernel segment is available in RAM.
  */
 extern void interrupt_setup(idt_entry_t* entry, void (*isr)(void), u8 sel, u8 gate_type, u8 dpl, bool present);
+
+/**
+ * @brief Check whether the CPU pushes an error code for a vector.
+ *
+ * @param vector vector to check.
+ * @return true for the exceptions in INTERRUPT_ERROR_CODE_VECTORS.
+ */
+extern bool interrupt_has_error_code(u32 vector);
+
+/**
+ * @brief Install the handler of a vector, replacing any previous handler.
+ *
+ * Only used for vectors from INTERRUPT_EXCEPTION_COUNT on, exceptions are
+ * dispatched through interrupt_register_fault_handler. The handler slot is cleared while the context is changed, so an
+ * interrupt arriving in between is ignored rather than handed a mismatched
+ * context.
+ *
+ * @param vector vector to handle.
+ * @param handler handler of the vector.
+ * @param context context pointer passed to handler.
+ */
+extern void interrupt_register_handler(u8 vector, interrupt_handler_t handler, void* context);
+
+/**
+ * @brief Remove the handler of a vector, the vector is ignored from now on.
+ *
+ * @param vector vector to stop handling.
+ */
+extern void interrupt_unregister_handler(u8 vector);
+
+/**
+ * @brief Install the handler of a CPU exception, replacing any previous handler.
+ *
+ * Same ordering as interrupt_register_handler.
+ *
+ * @param vector exception vector (below INTERRUPT_EXCEPTION_COUNT).
+ * @param handler handler of the exception.
+ * @param context context pointer passed to handler.
+ */
+extern void interrupt_register_fault_handler(u8 vector, interrupt_fault_handler_t handler, void* context);
+
+/**
+ * @brief Remove the handler of a CPU exception, the exception is ignored from now on.
+ *
+ * @param vector exception vector to stop handling.
+ */
+extern void interrupt_unregister_fault_handler(u8 vector);
+
+/**
+ * @brief Time every handler with the TSC and report it to an accounting hook.
+ *
+ * Vectors without a handler are not reported. While no hook is set the
+ * trampolines skip reading the TSC altogether.
+ *
+ * @param account hook to run after every handler (NULL to stop accounting).
+ */
+extern void interrupt_set_account(interrupt_account_t account);
+
+/**
+ * @brief Run a hook on the way out of every interrupt (not exceptions), after its handler.
+ *
+ * This is where deferred interrupt work runs.
+ *
+ * @param hook hook to run (NULL to run nothing).
+ */
+extern void interrupt_set_exit(interrupt_exit_t hook);
@@ -0,0 +1,180 @@
+#include <llanos/types.h>
+
+#include "irq-apic.h"
+#include "apic.h"
+#include "acpi.h"
+#include "cpu.h"
+
+/**
+ * @brief Take the register select and window pair of the I/O APICs.
+ *
+ * The pair is not reentrant and every CPU masks and moves lines through it,
+ * so interrupts are disabled and the lock of the APICs is spun on.
+ *
+ * @param apic APICs to lock.
+ * @return interrupt state to pass to __irq_apic_unlock.
+ */
+static u32 __irq_apic_lock(irq_apic_t* apic) {
+    u32 flags = cpu_save_and_disable_interrupts();
+
+    while (__atomic_exchange_n(&apic->lock, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(&apic->lock, __ATOMIC_RELAXED) != 0) {
+            __asm__ volatile("pause");
+        }
+    }
+    return flags;
+}
+
+/**
+ * @brief Release the register select and window pair of the I/O APICs.
+ *
+ * @param apic APICs to unlock.
+ * @param flags interrupt state returned by __irq_apic_lock.
+ */
+static void __irq_apic_unlock(irq_apic_t* apic, u32 flags) {
+    __atomic_store_n(&apic->lock, 0, __ATOMIC_RELEASE);
+    cpu_restore_interrupts(flags);
+}
+
+static void __irq_apic_mask(void* chip, u8 irq) {
+    irq_apic_pin_t* pin = &((irq_apic_t*)chip)->pins[irq];
+    u32 flags;
+
+    if (pin->ioapic == NULL) {
+        return;
+    }
+
+    flags = __irq_apic_lock(chip);
+    ioapic_mask(pin->ioapic, pin->pin);
+    __irq_apic_unlock(chip, flags);
+}
+
+static void __irq_apic_unmask(void* chip, u8 irq) {
+    irq_apic_pin_t* pin = &((irq_apic_t*)chip)->pins[irq];
+    u32 flags;
+
+    if (pin->ioapic == NULL) {
+        return;
+    }
+
+    flags = __irq_apic_lock(chip);
+    ioapic_unmask(pin->ioapic, pin->pin);
+    __irq_apic_unlock(chip, flags);
+}
+
+/**
+ * @brief Accept every interrupt, the local APIC raises its spurious interrupts on their own vector.
+ *
+ * @param chip irq_apic_t the line belongs to.
+ * @param irq line that was raised.
+ * @return true.
+ */
+static bool __irq_apic_acknowledge(void* chip, u8 irq) {
+    (void)chip;
+    (void)irq;
+    return true;
+}
+
+static void __irq_apic_end(void* chip, u8 irq) {
+    (void)irq;
+    lapic_send_eoi(&((irq_apic_t*)chip)->lapic);
+}
+
+static bool __irq_apic_set_destination(void* chip, u8 irq, u8 apic_id) {
+    irq_apic_pin_t* pin = &((irq_apic_t*)chip)->pins[irq];
+    u32 flags;
+
+    if (pin->ioapic == NULL) {
+        return false;
+    }
+
+    flags = __irq_apic_lock(chip);
+    ioapic_set_destination(pin->ioapic, pin->pin, apic_id);
+    __irq_apic_unlock(chip, flags);
+    return true;
+}
+
+const irq_backend_t irq_apic_backend = {
+    .mask = __irq_apic_mask,
+    .unmask = __irq_apic_unmask,
+    .acknowledge = __irq_apic_acknowledge,
+    .end = __irq_apic_end,
+    .set_destination = __irq_apic_set_destination
+};
+
+/**
+ * @brief Get the global system interrupt and the redirection flags of an IRQ line.
+ *
+ * @param madt interrupt controllers read from the MADT.
+ * @param irq line to look up.
+ * @param gsi where to store the global system interrupt of the line.
+ * @param flags where to store the IOAPIC_REDIRECTION_* flags of the line.
+ * @return false if the global system interrupt is taken by an overridden ISA IRQ.
+ */
+static bool __irq_apic_line_gsi(const acpi_madt_info_t* madt, u8 irq, u32* gsi, u32* flags) {
+    u16 polarity;
+    u16 trigger;
+    u8 isa;
+
+    if (irq >= ACPI_ISA_IRQ_COUNT) {
+        *gsi = irq;
+        *flags = IOAPIC_REDIRECTION_ACTIVE_LOW | IOAPIC_REDIRECTION_LEVEL;
+    } else {
+        *gsi = madt->isa_routes[irq].gsi;
+        polarity = madt->isa_routes[irq].flags & ACPI_MADT_POLARITY_MASK;
+        trigger = madt->isa_routes[irq].flags & ACPI_MADT_TRIGGER_MASK;
+        *flags = 0;
+        if (polarity == ACPI_MADT_POLARITY_ACTIVE_LOW) {
+            *flags |= IOAPIC_REDIRECTION_ACTIVE_LOW;
+        }
+        if (trigger == ACPI_MADT_TRIGGER_LEVEL) {
+            *flags |= IOAPIC_REDIRECTION_LEVEL;
+        }
+        if (*gsi != irq) {
+            return true;
+        }
+    }
+
+    /* an ISA IRQ overridden onto this line's interrupt (IRQ 0 on GSI 2 on most machines) owns it */
+    for (isa = 0; isa < ACPI_ISA_IRQ_COUNT; isa++) {
+        if (isa != irq && madt->isa_routes[isa].gsi == *gsi) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void irq_apic_initialize(irq_apic_t* apic, const acpi_madt_info_t* madt, u8 base, u8 spurious_vector) {
+    ioapic_t* ioapic;
+    u32 gsi;
+    u32 flags;
+    u32 index;
+    u8 destination;
+    u8 irq;
+
+    lapic_initialize(&apic->lapic, madt->lapic_address, spurious_vector);
+    destination = lapic_get_id(&apic->lapic);
+
+    apic->lock = 0;
+    apic->ioapic_count = madt->ioapic_count;
+    for (index = 0; index < madt->ioapic_count; index++) {
+        ioapic_initialize(&apic->ioapics[index], madt->ioapics[index].address, madt->ioapics[index].gsi_base);
+    }
+
+    for (irq = 0; irq < IRQ_MAX_LINES; irq++) {
+        apic->pins[irq].ioapic = NULL;
+        if (!__irq_apic_line_gsi(madt, irq, &gsi, &flags)) {
+            continue;
+        }
+
+        for (index = 0; index < apic->ioapic_count; index++) {
+            ioapic = &apic->ioapics[index];
+            if (gsi >= ioapic->gsi_base && gsi < ioapic->gsi_base + ioapic->pin_count) {
+                apic->pins[irq].ioapic = ioapic;
+                apic->pins[irq].pin = (u8)(gsi - ioapic->gsi_base);
+                ioapic_route(ioapic, apic->pins[irq].pin, base + irq, flags, destination);
+                break;
+            }
+        }
+    }
+}
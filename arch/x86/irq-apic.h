@@ -0,0 +1,61 @@
+#pragma once
+
+#include <llanos/types.h>
+
+#include "irq.h"
+#include "apic.h"
+#include "acpi.h"
+
+typedef struct irq_apic_pin_s irq_apic_pin_t;
+typedef struct irq_apic_s irq_apic_t;
+
+/**
+ * @brief I/O APIC pin an IRQ line is wired to.
+ *
+ * @member ioapic I/O APIC of the pin (NULL if the line is not wired to any pin).
+ * @member pin pin of the I/O APIC.
+ */
+struct irq_apic_pin_s {
+    ioapic_t* ioapic;
+    u8 pin;
+};
+
+/**
+ * @brief The local APIC and the I/O APICs described by the MADT.
+ *
+ * IRQ 0-15 are the ISA IRQs, wired to the global system interrupt the MADT
+ * overrides say (active high and edge triggered unless overridden). Lines
+ * 16 and up are the global system interrupts of the same number, active
+ * low and level triggered as PCI interrupts are. Every line is delivered
+ * to the boot CPU until irq_set_affinity or irq_balance moves it, and is
+ * ended with a single write to the local APIC.
+ *
+ * @member lapic local APIC of the boot CPU.
+ * @member ioapic_count number of I/O APICs.
+ * @member ioapics every I/O APIC.
+ * @member pins pin every IRQ line is wired to.
+ * @member lock spinlock of the register select and window pair of the I/O APICs.
+ */
+struct irq_apic_s {
+    lapic_t lapic;
+    u32 ioapic_count;
+    ioapic_t ioapics[ACPI_MAX_IOAPICS];
+    irq_apic_pin_t pins[IRQ_MAX_LINES];
+    u32 lock;
+};
+
+/* irq_controller_t operations of an irq_apic_t */
+extern const irq_backend_t irq_apic_backend;
+
+/**
+ * @brief Enable the local APIC and route the IRQ lines through the I/O APICs, masked.
+ *
+ * Paging has to map the register pages of the local APIC and of every I/O
+ * APIC uncached.
+ *
+ * @param apic APICs to initialize.
+ * @param madt interrupt controllers read from the MADT.
+ * @param base vector of IRQ 0 (IRQ n raises base + n).
+ * @param spurious_vector vector of the spurious interrupts of the local APIC (left unhandled).
+ */
+extern void irq_apic_initialize(irq_apic_t* apic, const acpi_madt_info_t* madt, u8 base, u8 spurious_vector);
@@ -0,0 +1,124 @@
+#include <llanos/types.h>
+
+#include "irq-pic.h"
+#include "pic8259.h"
+#include "cpu.h"
+
+/**
+ * @brief Get the PIC a line belongs to.
+ *
+ * @param pic PIC pair the line belongs to.
+ * @param irq line (0-15).
+ * @return the master PIC for IRQ 0-7, the slave PIC for IRQ 8-15.
+ */
+static inline pic8259_t* __irq_pic(irq_pic_t* pic, u8 irq) {
+    return irq < PIC8259_LINE_COUNT ? &pic->master : &pic->slave;
+}
+
+static void __irq_pic_mask(void* chip, u8 irq) {
+    u32 flags;
+
+    /* the cascade stays unmasked, the slave's own mask controls its lines */
+    if (irq == IRQ_PIC_CASCADE_LINE) {
+        return;
+    }
+
+    /* an interrupt handler changing the mask in between would have its change overwritten */
+    flags = cpu_save_and_disable_interrupts();
+    pic8259_mask(__irq_pic((irq_pic_t*)chip, irq), irq % PIC8259_LINE_COUNT);
+    cpu_restore_interrupts(flags);
+}
+
+static void __irq_pic_unmask(void* chip, u8 irq) {
+    u32 flags;
+
+    if (irq == IRQ_PIC_CASCADE_LINE) {
+        return;
+    }
+
+    flags = cpu_save_and_disable_interrupts();
+    pic8259_unmask(__irq_pic((irq_pic_t*)chip, irq), irq % PIC8259_LINE_COUNT);
+    cpu_restore_interrupts(flags);
+}
+
+/**
+ * @brief Check a line against the in-service register to filter out spurious interrupts.
+ *
+ * A PIC reports an interrupt that went away before it was acknowledged on
+ * its lowest priority line without setting the in-service bit. Such an
+ * interrupt must not be ended on that PIC, but a spurious interrupt of the
+ * slave was still a real one on the cascade line of the master.
+ *
+ * @param chip irq_pic_t the line belongs to.
+ * @param irq line that was raised.
+ * @return false if the interrupt is spurious.
+ */
+static bool __irq_pic_acknowledge(void* chip, u8 irq) {
+    irq_pic_t* pic = (irq_pic_t*)chip;
+
+    if (irq == IRQ_PIC_SPURIOUS_MASTER) {
+        return (pic8259_read_isr(&pic->master) & (1 << (IRQ_PIC_SPURIOUS_MASTER % PIC8259_LINE_COUNT))) != 0;
+    } else if (irq == IRQ_PIC_SPURIOUS_SLAVE) {
+        if (pic8259_read_isr(&pic->slave) & (1 << (IRQ_PIC_SPURIOUS_SLAVE % PIC8259_LINE_COUNT))) {
+            return true;
+        }
+        pic8259_send_specific_eoi(&pic->master, IRQ_PIC_CASCADE_LINE);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief End an interrupt on the PICs that took part in it.
+ *
+ * @param chip irq_pic_t the line belongs to.
+ * @param irq line to end.
+ */
+static void __irq_pic_end(void* chip, u8 irq) {
+    irq_pic_t* pic = (irq_pic_t*)chip;
+
+    if (irq >= PIC8259_LINE_COUNT) {
+        pic8259_send_specific_eoi(&pic->slave, irq - PIC8259_LINE_COUNT);
+        pic8259_send_specific_eoi(&pic->master, IRQ_PIC_CASCADE_LINE);
+    } else {
+        pic8259_send_specific_eoi(&pic->master, irq);
+    }
+}
+
+const irq_backend_t irq_pic_backend = {
+    .mask = __irq_pic_mask,
+    .unmask = __irq_pic_unmask,
+    .acknowledge = __irq_pic_acknowledge,
+    .end = __irq_pic_end,
+    .set_destination = NULL
+};
+
+void irq_pic_initialize(irq_pic_t* pic, u16 master_command_port, u16 slave_command_port, u8 base) {
+    pic8259_init(&pic->master, master_command_port, master_command_port + 1);
+    pic8259_init(&pic->slave, slave_command_port, slave_command_port + 1);
+
+    /* ICW1: edge triggered, cascaded, ICW4 follows */
+    pic8259_send_icw1(&pic->master, true, false, false, true);
+    pic8259_send_icw1(&pic->slave, true, false, false, true);
+
+    /* ICW2: vector of line 0 */
+    pic8259_send_icw2(&pic->master, base);
+    pic8259_send_icw2(&pic->slave, base + PIC8259_LINE_COUNT);
+
+    /* ICW3: the slave is cascaded on the master's IRQ_PIC_CASCADE_LINE */
+    pic8259_send_master_icw3(&pic->master, (1 << IRQ_PIC_CASCADE_LINE));
+    pic8259_send_slave_icw3(&pic->slave, IRQ_PIC_CASCADE_LINE);
+
+    /* ICW4: 8086 mode, interrupts are ended with EOIs (no auto EOI) */
+    pic8259_send_icw4(&pic->master, false, PIC8259_BUFFERED_MODE_NONE, false);
+    pic8259_send_icw4(&pic->slave, false, PIC8259_BUFFERED_MODE_NONE, false);
+
+    /* everything is masked but the cascade, which the slave's own mask controls */
+    pic8259_set_mask(&pic->master, (u8)~(1 << IRQ_PIC_CASCADE_LINE));
+    pic8259_set_mask(&pic->slave, 0xff);
+}
+
+void irq_pic_disable(irq_pic_t* pic) {
+    pic8259_set_mask(&pic->slave, 0xff);
+    pic8259_set_mask(&pic->master, 0xff);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <llanos/types.h>
+
+#include "irq.h"
+#include "pic8259.h"
+
+/* number of IRQ lines of the cascaded PIC pair */
+#define IRQ_PIC_LINE_COUNT          (PIC8259_LINE_COUNT * 2)
+
+/* master PIC line the slave PIC is cascaded on */
+#define IRQ_PIC_CASCADE_LINE        2
+
+/* lowest priority line of each PIC, where the PICs report spurious interrupts */
+#define IRQ_PIC_SPURIOUS_MASTER     7
+#define IRQ_PIC_SPURIOUS_SLAVE      15
+
+typedef struct irq_pic_s irq_pic_t;
+
+/**
+ * @brief The cascaded 8259 PIC pair.
+ *
+ * Interrupts are ended with a specific EOI sent only to the PICs that took
+ * part, and the spurious interrupts the PICs raise on their lowest priority
+ * line are filtered out through the in-service register.
+ *
+ * @member master master PIC (IRQ 0-7).
+ * @member slave slave PIC (IRQ 8-15).
+ */
+struct irq_pic_s {
+    pic8259_t master;
+    pic8259_t slave;
+};
+
+/* irq_controller_t operations of an irq_pic_t */
+extern const irq_backend_t irq_pic_backend;
+
+/**
+ * @brief Remap the PICs to base with every line but the cascade masked.
+ *
+ * @param pic PIC pair to initialize.
+ * @param master_command_port command port of the master PIC (its data port is the next port).
+ * @param slave_command_port command port of the slave PIC (its data port is the next port).
+ * @param base vector of IRQ 0 (a multiple of 8, IRQ 8 raises base + 8).
+ */
+extern void irq_pic_initialize(irq_pic_t* pic, u16 master_command_port, u16 slave_command_port, u8 base);
+
+/**
+ * @brief Mask every line of both PICs, including the cascade, when another controller takes over.
+ *
+ * The PICs can still raise spurious interrupts on their lowest priority
+ * line, so they should have been remapped to vectors nothing handles.
+ *
+ * @param pic PIC pair to disable.
+ */
+extern void irq_pic_disable(irq_pic_t* pic);
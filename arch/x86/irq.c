@@ -0,0 +1,174 @@
+#include <llanos/types.h>
+
+#include "irq.h"
+#include "interrupt.h"
+
+/**
+ * @brief Interrupt handler of every IRQ vector, runs the handler of the line and ends the interrupt.
+ *
+ * @param vector vector that was raised.
+ * @param context irq_controller_t of the line.
+ */
+static void __irq_dispatch(u32 vector, void* context) {
+    irq_controller_t* controller = (irq_controller_t*)context;
+    u8 irq = (u8)(vector - controller->base);
+    irq_line_t* line = &controller->lines[irq];
+
+    if (!controller->backend->acknowledge(controller->chip, irq)) {
+        controller->spurious++;
+        return;
+    }
+
+    if (line->handler != NULL) {
+        line->handler(vector, line->context);
+    }
+    controller->backend->end(controller->chip, irq);
+}
+
+/**
+ * @brief Deliver the interrupts of a line to another CPU.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to move.
+ * @param cpu online CPU to deliver to.
+ * @return false if the backend cannot deliver to that CPU.
+ */
+static bool __irq_move(irq_controller_t* controller, u8 irq, u8 cpu) {
+    if (controller->backend->set_destination == NULL || \
+            !controller->backend->set_destination(controller->chip, irq, controller->apic_ids[cpu])) {
+        return false;
+    }
+    controller->lines[irq].cpu = cpu;
+    return true;
+}
+
+void irq_initialize(irq_controller_t* controller, const irq_backend_t* backend, void* chip, u8 base, u8 line_count) {
+    u8 irq;
+
+    controller->backend = backend;
+    controller->chip = chip;
+    controller->base = base;
+    controller->line_count = line_count;
+    controller->spurious = 0;
+    controller->online = 1 << 0;
+    controller->apic_ids[0] = 0;
+
+    for (irq = 0; irq < line_count; irq++) {
+        backend->mask(chip, irq);
+        controller->lines[irq].handler = NULL;
+        controller->lines[irq].context = NULL;
+        controller->lines[irq].affinity = IRQ_AFFINITY_ALL;
+        controller->lines[irq].cpu = 0;
+        controller->lines[irq].balanced_count = 0;
+        interrupt_register_handler(base + irq, __irq_dispatch, controller);
+    }
+}
+
+void irq_request(irq_controller_t* controller, u8 irq, interrupt_handler_t handler, void* context) {
+    irq_mask(controller, irq);
+    controller->lines[irq].context = context;
+    controller->lines[irq].handler = handler;
+    irq_unmask(controller, irq);
+}
+
+void irq_release(irq_controller_t* controller, u8 irq) {
+    irq_mask(controller, irq);
+    controller->lines[irq].handler = NULL;
+    controller->lines[irq].context = NULL;
+}
+
+void irq_mask(irq_controller_t* controller, u8 irq) {
+    controller->backend->mask(controller->chip, irq);
+}
+
+void irq_unmask(irq_controller_t* controller, u8 irq) {
+    controller->backend->unmask(controller->chip, irq);
+}
+
+void irq_set_cpu_online(irq_controller_t* controller, u8 cpu, u8 apic_id) {
+    controller->apic_ids[cpu] = apic_id;
+    /* CPUs come online while the boot CPU balances, the APIC ID is published with the bit */
+    __atomic_fetch_or(&controller->online, 1u << cpu, __ATOMIC_RELEASE);
+}
+
+bool irq_set_affinity(irq_controller_t* controller, u8 irq, u32 affinity) {
+    irq_line_t* line = &controller->lines[irq];
+    u32 allowed = affinity & __atomic_load_n(&controller->online, __ATOMIC_ACQUIRE);
+    u8 cpu;
+
+    if (allowed == 0) {
+        return false;
+    }
+
+    if ((allowed & (1u << line->cpu)) == 0) {
+        cpu = (u8)__builtin_ctz(allowed);
+        if (!__irq_move(controller, irq, cpu)) {
+            return false;
+        }
+    }
+    line->affinity = affinity;
+    return true;
+}
+
+u32 irq_balance(irq_controller_t* controller, const u64* counts) {
+    u64 loads[IRQ_MAX_LINES];
+    u64 cpu_loads[IRQ_MAX_CPUS];
+    u32 pending = 0;
+    u32 moved = 0;
+    u32 allowed;
+    irq_line_t* line;
+    u8 busiest;
+    u8 target;
+    u8 cpu;
+    u8 irq;
+
+    if (controller->backend->set_destination == NULL) {
+        return 0;
+    }
+
+    for (cpu = 0; cpu < IRQ_MAX_CPUS; cpu++) {
+        cpu_loads[cpu] = 0;
+    }
+
+    for (irq = 0; irq < controller->line_count; irq++) {
+        line = &controller->lines[irq];
+        loads[irq] = counts[irq] - line->balanced_count;
+        line->balanced_count = counts[irq];
+        if (line->handler != NULL && loads[irq] != 0) {
+            pending |= 1u << irq;
+        }
+    }
+
+    /* busiest line first, so the small ones fill in the gaps it leaves */
+    while (pending != 0) {
+        busiest = (u8)__builtin_ctz(pending);
+        for (irq = busiest + 1; irq < controller->line_count; irq++) {
+            if ((pending & (1u << irq)) && loads[irq] > loads[busiest]) {
+                busiest = irq;
+            }
+        }
+        pending &= ~(1u << busiest);
+
+        line = &controller->lines[busiest];
+        allowed = line->affinity & __atomic_load_n(&controller->online, __ATOMIC_ACQUIRE);
+        if (allowed == 0) {
+            continue;
+        }
+
+        target = (allowed & (1u << line->cpu)) ? line->cpu : (u8)__builtin_ctz(allowed);
+        for (cpu = 0; cpu < IRQ_MAX_CPUS; cpu++) {
+            if ((allowed & (1u << cpu)) && cpu_loads[cpu] < cpu_loads[target]) {
+                target = cpu;
+            }
+        }
+        if (target != line->cpu) {
+            if (__irq_move(controller, busiest, target)) {
+                moved++;
+            } else {
+                target = line->cpu;
+            }
+        }
+        cpu_loads[target] += loads[busiest];
+    }
+    return moved;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <llanos/types.h>
+
+#include "interrupt.h"
+
+/* most IRQ lines a controller has (the ISA IRQs and the PCI pins of the first I/O APIC) */
+#define IRQ_MAX_LINES           24
+
+/* most CPUs IRQs are delivered to, CPU n is bit n of an affinity mask */
+#define IRQ_MAX_CPUS            8
+
+/* affinity mask letting a line run on every CPU */
+#define IRQ_AFFINITY_ALL        ((1u << IRQ_MAX_CPUS) - 1)
+
+typedef struct irq_line_s irq_line_t;
+typedef struct irq_backend_s irq_backend_t;
+typedef struct irq_controller_s irq_controller_t;
+
+/**
+ * @brief Handler of one IRQ line.
+ *
+ * @member handler handler of the line (NULL while the line is not requested).
+ * @member context context pointer passed to handler.
+ * @member affinity CPUs the line may be delivered to.
+ * @member cpu CPU the line is delivered to.
+ * @member balanced_count interrupt count of the line at the last irq_balance.
+ */
+struct irq_line_s {
+    interrupt_handler_t handler;
+    void* context;
+    u32 affinity;
+    u8 cpu;
+    u64 balanced_count;
+};
+
+/**
+ * @brief Operations of an interrupt controller.
+ *
+ * The operations get the chip pointer of the controller and a line number.
+ * mask, unmask and set_destination may be called with interrupts enabled and
+ * have to protect the chip registers themselves.
+ *
+ * @member mask hold back the interrupts of a line.
+ * @member unmask deliver the interrupts of a line.
+ * @member acknowledge check a raised line before its handler runs, false for a spurious
+ *      interrupt which is neither handled nor ended.
+ * @member end end the interrupt of a line once its handler returned.
+ * @member set_destination deliver the interrupts of a line to the CPU with the given APIC ID,
+ *      false if it cannot (NULL if the controller only delivers to the boot CPU).
+ */
+struct irq_backend_s {
+    void (*mask)(void* chip, u8 irq);
+    void (*unmask)(void* chip, u8 irq);
+    bool (*acknowledge)(void* chip, u8 irq);
+    void (*end)(void* chip, u8 irq);
+    bool (*set_destination)(void* chip, u8 irq, u8 apic_id);
+};
+
+/**
+ * @brief IRQ lines of an interrupt controller.
+ *
+ * Every line is masked until a handler is requested for it, and every
+ * interrupt is ended by the backend once the handler of its line returned.
+ *
+ * @member backend operations of the controller.
+ * @member chip state of the controller passed to the backend.
+ * @member base vector of IRQ 0 (IRQ n raises vector base + n).
+ * @member line_count number of lines.
+ * @member lines handler of every line.
+ * @member spurious number of spurious interrupts filtered out.
+ * @member online CPUs that take interrupts (CPU 0, the boot CPU, from the start).
+ * @member apic_ids APIC ID of every online CPU.
+ */
+struct irq_controller_s {
+    const irq_backend_t* backend;
+    void* chip;
+    u8 base;
+    u8 line_count;
+    irq_line_t lines[IRQ_MAX_LINES];
+    u32 spurious;
+    u32 online;
+    u8 apic_ids[IRQ_MAX_CPUS];
+};
+
+/**
+ * @brief Mask every line of an initialized chip and take over the vectors of its lines.
+ *
+ * Every line may run on every CPU and is delivered to the boot CPU (CPU 0
+ * with APIC ID 0) until irq_set_cpu_online and irq_balance say otherwise.
+ *
+ * @param controller controller to initialize.
+ * @param backend operations of the chip.
+ * @param chip initialized chip, its lines raise base + n.
+ * @param base vector of IRQ 0.
+ * @param line_count number of lines (at most IRQ_MAX_LINES).
+ */
+extern void irq_initialize(irq_controller_t* controller, const irq_backend_t* backend, void* chip, u8 base, u8 line_count);
+
+/**
+ * @brief Install the handler of an IRQ line and unmask it.
+ *
+ * The handler runs with the interrupt still in service; the line is ended
+ * once it returns.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to handle.
+ * @param handler handler of the line (gets the vector of the line).
+ * @param context context pointer passed to handler.
+ */
+extern void irq_request(irq_controller_t* controller, u8 irq, interrupt_handler_t handler, void* context);
+
+/**
+ * @brief Mask an IRQ line and remove its handler.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to release.
+ */
+extern void irq_release(irq_controller_t* controller, u8 irq);
+
+/**
+ * @brief Mask an IRQ line, its interrupts are held back by the controller until it is unmasked.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to mask.
+ */
+extern void irq_mask(irq_controller_t* controller, u8 irq);
+
+/**
+ * @brief Unmask an IRQ line.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to unmask.
+ */
+extern void irq_unmask(irq_controller_t* controller, u8 irq);
+
+/**
+ * @brief Let a CPU take interrupts.
+ *
+ * @param controller controller to deliver from.
+ * @param cpu CPU number (less than IRQ_MAX_CPUS, 0 is the boot CPU).
+ * @param apic_id APIC ID of the CPU.
+ */
+extern void irq_set_cpu_online(irq_controller_t* controller, u8 cpu, u8 apic_id);
+
+/**
+ * @brief Restrict the CPUs an IRQ line is delivered to.
+ *
+ * The line moves to the first online CPU of the mask if its CPU is not in
+ * it, irq_balance keeps it within the mask afterwards.
+ *
+ * @param controller controller the line belongs to.
+ * @param irq line to restrict.
+ * @param affinity CPUs the line may be delivered to.
+ * @return false if no online CPU is in affinity or the line cannot be moved, the affinity is
+ *      left unchanged then.
+ */
+extern bool irq_set_affinity(irq_controller_t* controller, u8 irq, u32 affinity);
+
+/**
+ * @brief Spread the requested IRQ lines over the online CPUs by their recent interrupt counts.
+ *
+ * The lines that took interrupts since the last call are placed busiest
+ * first, each on the least loaded CPU of its affinity (staying put on a
+ * tie), and only the lines that change CPU are reprogrammed. Idle lines are
+ * left where they are. Meant to be called periodically.
+ *
+ * @param controller controller to balance.
+ * @param counts interrupt count of every line since boot (indexed by line).
+ * @return number of lines moved to another CPU.
+ */
+extern u32 irq_balance(irq_controller_t* controller, const u64* counts);
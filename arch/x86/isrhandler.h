@@ -256,3 +256,6 @@ extern void __isr_handler_252(void);
 extern void __isr_handler_253(void);
 extern void __isr_handler_254(void);
 extern void __isr_handler_255(void);
+
+/* entry stubs of all 256 vectors, indexed by vector */
+extern void (* const __isr_handler_table[256])(void);
@@ -93,7 +93,7 @@
 /* Multiboot framebuffer type as part of multiboot_info_s */
 #define MULTIBOOT_FRAMEBUFFER_TYPE_INDEXED      0
 #define MULTIBOOT_FRAMEBUFFER_TYPE_RGB          1
-#define MULTIBOOT_FRAMEBUFFER_TYPE_EGA_TEXT     23
+#define MULTIBOOT_FRAMEBUFFER_TYPE_EGA_TEXT     2
 
 /* Multiboot memory type as part of multiboot_memory_map_s */
 #define MULTIBOOT_MEMORY_AVAILABLE              1
@@ -2,15 +2,14 @@
 #include <llanos/management/abort.h>
 
 #include "pic8259.h"
-
-extern void __output_byte(u16 port, u8 data);
+#include "port.h"
 
 static void pic8259_send_command(pic8259_t* pic, u8 command) {
-    __output_byte(pic->command_port, command);
+    port_output_byte(pic->command_port, command);
 }
 
 static void pic8259_send_data(pic8259_t* pic, u8 data) {
-    __output_byte(pic->data_port, data);
+    port_output_byte(pic->data_port, data);
 }
 
 static u8 pic8259_get_buffered_mode_byte(pic8259_buffered_mode_t mode) {
@@ -28,17 +27,19 @@ static u8 pic8259_get_buffered_mode_byte(pic8259_buffered_mode_t mode) {
 void pic8259_init(pic8259_t* pic, u16 command_port, u16 data_port) {
     pic->command_port = command_port;
     pic->data_port = data_port;
+    pic->mask = 0;
 }
 
 void pic8259_send_icw1(pic8259_t* pic, bool init, bool level_triggered, bool single, bool ic4) {
-    pic8259_send_data(
+    pic8259_send_command(
         pic, 
         (init ? (1 << 4) : 0) | (level_triggered ? (1 << 3) : 0) | (single ? (1 << 1) : 0) | (ic4 ? (1 << 0) : 0)
     );
 }
 
 void pic8259_send_icw2(pic8259_t* pic, u8 base) {
-    pic8259_send_data(pic, base & 0x7);
+    /* the low 3 bits are the line number, the base is a multiple of 8 */
+    pic8259_send_data(pic, base & 0xf8);
 }
 
 void pic8259_send_slave_icw3(pic8259_t* pic, u8 slave_id) {
@@ -55,3 +56,33 @@ void pic8259_send_icw4(pic8259_t* pic, bool sfnm, pic8259_buffered_mode_t mode,
         (sfnm ? (1 << 4) : 0) | (pic8259_get_buffered_mode_byte(mode) << 2) | (aeoi ? (1 << 1) : 0)  | 1
     );
 }
+
+void pic8259_set_mask(pic8259_t* pic, u8 mask) {
+    pic->mask = mask;
+    pic8259_send_data(pic, mask);
+}
+
+void pic8259_mask(pic8259_t* pic, u8 line) {
+    if ((pic->mask & (1 << line)) == 0) {
+        pic8259_set_mask(pic, pic->mask | (1 << line));
+    }
+}
+
+void pic8259_unmask(pic8259_t* pic, u8 line) {
+    if (pic->mask & (1 << line)) {
+        pic8259_set_mask(pic, pic->mask & ~(1 << line));
+    }
+}
+
+bool pic8259_is_masked(const pic8259_t* pic, u8 line) {
+    return (pic->mask & (1 << line)) != 0;
+}
+
+void pic8259_send_specific_eoi(pic8259_t* pic, u8 line) {
+    pic8259_send_command(pic, PIC8259_OCW2_SPECIFIC_EOI | (line & 0x7));
+}
+
+u8 pic8259_read_isr(pic8259_t* pic) {
+    pic8259_send_command(pic, PIC8259_OCW3_READ_ISR);
+    return port_input_byte(pic->command_port);
+}
@@ -2,12 +2,29 @@
 
 #include <llanos/types.h>
 
+/* number of interrupt lines of one PIC */
+#define PIC8259_LINE_COUNT          8
+
+/* OCW2 command ending the interrupt of the line in its low 3 bits */
+#define PIC8259_OCW2_SPECIFIC_EOI   0x60
+
+/* OCW3 command selecting the in-service register for the next command port read */
+#define PIC8259_OCW3_READ_ISR       0x0b
+
 typedef struct pic8259_s pic8259_t;
 typedef enum pic8259_buffered_mode_e pic8259_buffered_mode_t;
 
+/**
+ * @brief An 8259 programmable interrupt controller.
+ *
+ * @member command_port command port (ICW1, OCW2, OCW3, IRR/ISR reads).
+ * @member data_port data port (ICW2-4, IMR).
+ * @member mask copy of the interrupt mask register, so masking a line never reads the PIC.
+ */
 struct pic8259_s {
     u16 command_port;
     u16 data_port;
+    u8 mask;
 };
 
 enum pic8259_buffered_mode_e {
@@ -19,6 +36,9 @@ enum pic8259_buffered_mode_e {
 /**
  * @brief Initialize a PIC structure with command port and data port.
  *
+ * The cached mask is 0 (as the PIC clears its IMR on initialization) until
+ * pic8259_set_mask is called.
+ *
  * @param pic Pointer to PIC data structure to initialize.
  * @param command_port Command port to initialize the PIC data structure with.
  * @param data_port Data port to initialize the PIC data structure with.
@@ -78,3 +98,52 @@ extern void pic8259_send_master_icw3(pic8259_t* pic, u8 slave_mask);
  *      mode of operation and reduces the length of the ISR.
  */
 extern void pic8259_send_icw4(pic8259_t* pic, bool sfnm, pic8259_buffered_mode_t mode, bool aeoi);
+
+/**
+ * @brief Write the interrupt mask register.
+ *
+ * @param pic PIC to mask lines of.
+ * @param mask bit n set masks line n.
+ */
+extern void pic8259_set_mask(pic8259_t* pic, u8 mask);
+
+/**
+ * @brief Mask one line, the PIC is only written if the line was unmasked.
+ *
+ * @param pic PIC the line belongs to.
+ * @param line line to mask (0-7).
+ */
+extern void pic8259_mask(pic8259_t* pic, u8 line);
+
+/**
+ * @brief Unmask one line, the PIC is only written if the line was masked.
+ *
+ * @param pic PIC the line belongs to.
+ * @param line line to unmask (0-7).
+ */
+extern void pic8259_unmask(pic8259_t* pic, u8 line);
+
+/**
+ * @brief Check whether a line is masked (from the cached mask, without reading the PIC).
+ *
+ * @param pic PIC the line belongs to.
+ * @param line line to check (0-7).
+ * @return true if the line is masked.
+ */
+extern bool pic8259_is_masked(const pic8259_t* pic, u8 line);
+
+/**
+ * @brief End the interrupt of one line (specific EOI).
+ *
+ * @param pic PIC the line belongs to.
+ * @param line line whose in-service bit to clear (0-7).
+ */
+extern void pic8259_send_specific_eoi(pic8259_t* pic, u8 line);
+
+/**
+ * @brief Read the in-service register.
+ *
+ * @param pic PIC to read.
+ * @return bit n is set while line n is being serviced.
+ */
+extern u8 pic8259_read_isr(pic8259_t* pic);
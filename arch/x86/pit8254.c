@@ -0,0 +1,33 @@
+#include <llanos/types.h>
+
+#include "pit8254.h"
+#include "port.h"
+
+void pit8254_start_channel0(u16 count) {
+    port_output_byte(PIT8254_COMMAND_PORT, PIT8254_CHANNEL0_ONESHOT);
+    port_output_byte(PIT8254_CHANNEL0_PORT, (u8)(count & 0xff));
+    port_output_byte(PIT8254_CHANNEL0_PORT, (u8)(count >> 8));
+}
+
+void pit8254_stop_channel0(void) {
+    /* writing the mode stops the count until a new count is loaded */
+    port_output_byte(PIT8254_COMMAND_PORT, PIT8254_CHANNEL0_ONESHOT);
+}
+
+void pit8254_start_channel2(u16 count) {
+    u8 control = port_input_byte(PIT8254_CONTROL_PORT);
+
+    /* hold the gate low while the count is loaded, counting starts when it goes high */
+    control &= ~(PIT8254_CONTROL_GATE2 | PIT8254_CONTROL_SPEAKER);
+    port_output_byte(PIT8254_CONTROL_PORT, control);
+
+    port_output_byte(PIT8254_COMMAND_PORT, PIT8254_CHANNEL2_ONESHOT);
+    port_output_byte(PIT8254_CHANNEL2_PORT, (u8)(count & 0xff));
+    port_output_byte(PIT8254_CHANNEL2_PORT, (u8)(count >> 8));
+
+    port_output_byte(PIT8254_CONTROL_PORT, control | PIT8254_CONTROL_GATE2);
+}
+
+bool pit8254_channel2_done(void) {
+    return (port_input_byte(PIT8254_CONTROL_PORT) & PIT8254_CONTROL_OUT2) != 0;
+}
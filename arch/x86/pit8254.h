@@ -0,0 +1,59 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* input clock of every PIT channel in Hz */
+#define PIT8254_FREQUENCY           1193182
+
+/* IRQ line of channel 0 */
+#define PIT8254_CHANNEL0_IRQ        0
+
+/* largest count of a channel (a count of 0 would mean 65536) */
+#define PIT8254_MAX_COUNT           0xffff
+
+/* data ports of channel 0 and 2 and the mode/command port */
+#define PIT8254_CHANNEL0_PORT       0x40
+#define PIT8254_CHANNEL2_PORT       0x42
+#define PIT8254_COMMAND_PORT        0x43
+
+/* command selecting channel 0, low then high byte access, mode 0 (interrupt on terminal count), binary */
+#define PIT8254_CHANNEL0_ONESHOT    0x30
+
+/* command selecting channel 2, low then high byte access, mode 0 (interrupt on terminal count), binary */
+#define PIT8254_CHANNEL2_ONESHOT    0xb0
+
+/* system control port B bits wired to channel 2: its gate, the speaker and its output */
+#define PIT8254_CONTROL_PORT        0x61
+#define PIT8254_CONTROL_GATE2       (1 << 0)
+#define PIT8254_CONTROL_SPEAKER     (1 << 1)
+#define PIT8254_CONTROL_OUT2        (1 << 5)
+
+/**
+ * @brief Start channel 0 counting down once from count, raising IRQ 0 at the end.
+ *
+ * @param count number of PIT8254_FREQUENCY ticks to count (not 0).
+ */
+extern void pit8254_start_channel0(u16 count);
+
+/**
+ * @brief Stop channel 0 before it reaches its terminal count.
+ */
+extern void pit8254_stop_channel0(void);
+
+/**
+ * @brief Start channel 2 counting down once from count, with the speaker off.
+ *
+ * Channel 2 is the only channel whose output can be read back (through the
+ * system control port) without taking an interrupt, so it can time short
+ * intervals before interrupts are set up.
+ *
+ * @param count number of PIT8254_FREQUENCY ticks to count.
+ */
+extern void pit8254_start_channel2(u16 count);
+
+/**
+ * @brief Check whether channel 2 reached its terminal count.
+ *
+ * @return true once the count started by pit8254_start_channel2 elapsed.
+ */
+extern bool pit8254_channel2_done(void);
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/*
+ * I/O port accessors.
+ *
+ * Every accessor compiles to the single in/out instruction (or one rep
+ * ins/outs for the string variants) at the call site, so drivers that move
+ * data through ports one register at a time (PIO disks, serial lines) do not
+ * pay for a call and a stack frame per transfer.
+ */
+
+/**
+ * @brief Write a byte to an I/O port.
+ *
+ * @param port port to write to.
+ * @param data byte to write.
+ */
+static inline void port_output_byte(u16 port, u8 data) {
+    __asm__ volatile("outb %0, %1" : : "a"(data), "Nd"(port) : "memory");
+}
+
+/**
+ * @brief Write a word to an I/O port.
+ *
+ * @param port port to write to.
+ * @param data word to write.
+ */
+static inline void port_output_word(u16 port, u16 data) {
+    __asm__ volatile("outw %0, %1" : : "a"(data), "Nd"(port) : "memory");
+}
+
+/**
+ * @brief Write a double word to an I/O port.
+ *
+ * @param port port to write to.
+ * @param data double word to write.
+ */
+static inline void port_output_dword(u16 port, u32 data) {
+    __asm__ volatile("outl %0, %1" : : "a"(data), "Nd"(port) : "memory");
+}
+
+/**
+ * @brief Read a byte from an I/O port.
+ *
+ * @param port port to read from.
+ * @return the byte read.
+ */
+static inline u8 port_input_byte(u16 port) {
+    u8 data;
+
+    __asm__ volatile("inb %1, %0" : "=a"(data) : "Nd"(port) : "memory");
+    return data;
+}
+
+/**
+ * @brief Read a word from an I/O port.
+ *
+ * @param port port to read from.
+ * @return the word read.
+ */
+static inline u16 port_input_word(u16 port) {
+    u16 data;
+
+    __asm__ volatile("inw %1, %0" : "=a"(data) : "Nd"(port) : "memory");
+    return data;
+}
+
+/**
+ * @brief Read a double word from an I/O port.
+ *
+ * @param port port to read from.
+ * @return the double word read.
+ */
+static inline u32 port_input_dword(u16 port) {
+    u32 data;
+
+    __asm__ volatile("inl %1, %0" : "=a"(data) : "Nd"(port) : "memory");
+    return data;
+}
+
+/**
+ * @brief Write a buffer of words to an I/O port (rep outsw).
+ *
+ * @param port port to write to.
+ * @param buffer words to write.
+ * @param count number of words in buffer.
+ */
+static inline void port_output_words(u16 port, const u16* buffer, size_t count) {
+    __asm__ volatile("cld; rep outsw" : "+S"(buffer), "+c"(count) : "d"(port) : "memory");
+}
+
+/**
+ * @brief Write a buffer of double words to an I/O port (rep outsl).
+ *
+ * @param port port to write to.
+ * @param buffer double words to write.
+ * @param count number of double words in buffer.
+ */
+static inline void port_output_dwords(u16 port, const u32* buffer, size_t count) {
+    __asm__ volatile("cld; rep outsl" : "+S"(buffer), "+c"(count) : "d"(port) : "memory");
+}
+
+/**
+ * @brief Read words from an I/O port into a buffer (rep insw).
+ *
+ * @param port port to read from.
+ * @param buffer buffer to fill.
+ * @param count number of words to read.
+ */
+static inline void port_input_words(u16 port, u16* buffer, size_t count) {
+    __asm__ volatile("cld; rep insw" : "+D"(buffer), "+c"(count) : "d"(port) : "memory");
+}
+
+/**
+ * @brief Read double words from an I/O port into a buffer (rep insl).
+ *
+ * @param port port to read from.
+ * @param buffer buffer to fill.
+ * @param count number of double words to read.
+ */
+static inline void port_input_dwords(u16 port, u32* buffer, size_t count) {
+    __asm__ volatile("cld; rep insl" : "+D"(buffer), "+c"(count) : "d"(port) : "memory");
+}
@@ -0,0 +1,73 @@
+#include <llanos/types.h>
+#include <llanos/util/memory.h>
+
+#include "smp.h"
+#include "cpu.h"
+
+/**
+ * @brief Spin for a number of microseconds.
+ *
+ * @param microseconds time to wait.
+ * @param tsc_frequency TSC frequency in Hz.
+ */
+static void __smp_delay(u32 microseconds, u64 tsc_frequency) {
+    u64 start = cpu_read_tsc();
+    u64 cycles = tsc_frequency * microseconds / 1000000;
+
+    while (cpu_read_tsc() - start < cycles) {
+        __asm__ volatile("pause");
+    }
+}
+
+/**
+ * @brief Wait until a CPU came online.
+ *
+ * @param online set by the CPU once it started.
+ * @param microseconds longest time to wait.
+ * @param tsc_frequency TSC frequency in Hz.
+ * @return whether the CPU came online.
+ */
+static bool __smp_wait_online(volatile bool* online, u32 microseconds, u64 tsc_frequency) {
+    u64 start = cpu_read_tsc();
+    u64 cycles = tsc_frequency * microseconds / 1000000;
+
+    while (!__atomic_load_n(online, __ATOMIC_ACQUIRE)) {
+        if (cpu_read_tsc() - start >= cycles) {
+            return false;
+        }
+        __asm__ volatile("pause");
+    }
+    return true;
+}
+
+void smp_install_trampoline(void) {
+    memory_copy(
+        (u8*)SMP_TRAMPOLINE_ADDRESS,
+        smp_trampoline_start,
+        (u32)(smp_trampoline_end - smp_trampoline_start)
+    );
+}
+
+bool smp_start_cpu(
+        lapic_t* lapic,
+        u8 apic_id,
+        const smp_parameters_t* parameters,
+        volatile bool* online,
+        u64 tsc_frequency) {
+    u8* copy = (u8*)SMP_TRAMPOLINE_ADDRESS + (smp_trampoline_parameters - smp_trampoline_start);
+
+    memory_copy(copy, (const u8*)parameters, sizeof(*parameters));
+
+    if (!lapic_send_init(lapic, apic_id)) {
+        return false;
+    }
+    __smp_delay(SMP_INIT_DELAY_US, tsc_frequency);
+
+    /* the second SIPI is only for CPUs that missed the first one */
+    lapic_send_startup(lapic, apic_id, SMP_TRAMPOLINE_ADDRESS >> 12);
+    if (__smp_wait_online(online, SMP_STARTUP_DELAY_US, tsc_frequency)) {
+        return true;
+    }
+    lapic_send_startup(lapic, apic_id, SMP_TRAMPOLINE_ADDRESS >> 12);
+    return __smp_wait_online(online, SMP_ONLINE_TIMEOUT_US, tsc_frequency);
+}
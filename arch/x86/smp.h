@@ -0,0 +1,130 @@
+#pragma once
+
+/* CPUs brought up, as many as the MADT is read for and the IRQ lines are spread over */
+#define SMP_MAX_CPUS                    8
+
+/* boot stack of every CPU, in the .bss of boot.S */
+#define SMP_BOOT_STACK_SIZE             16384
+
+/* page below 1 MiB the application processors start in real mode at */
+#define SMP_TRAMPOLINE_ADDRESS          0x8000
+
+/* offsets of the members of smp_parameters_s, for the trampoline */
+#define SMP_PARAMETER_PAGE_DIRECTORY    0
+#define SMP_PARAMETER_STACK_TOP         4
+#define SMP_PARAMETER_ENTRY             8
+#define SMP_PARAMETER_CPU               12
+#define SMP_PARAMETERS_SIZE             16
+
+/* GDT selector of the per-CPU data segment, loaded into %fs */
+#define SMP_CPU_SELECTOR                0x18
+
+/* waits of the INIT-SIPI-SIPI sequence in microseconds, and how long a CPU has to come online */
+#define SMP_INIT_DELAY_US               10000
+#define SMP_STARTUP_DELAY_US            200
+#define SMP_ONLINE_TIMEOUT_US           100000
+
+#ifndef __ASM__
+
+#include <llanos/types.h>
+
+#include "apic.h"
+
+typedef struct smp_parameters_s smp_parameters_t;
+typedef struct smp_cpu_s smp_cpu_t;
+
+/**
+ * @brief First C function of an application processor.
+ *
+ * Runs on the boot stack of the CPU with paging enabled, interrupts
+ * disabled and the flat GDT of the trampoline loaded. Must not return.
+ *
+ * @param cpu CPU number given in smp_parameters_s.
+ */
+typedef void (*smp_entry_t)(u32 cpu);
+
+/**
+ * @brief What the trampoline sets up an application processor with.
+ *
+ * @member page_directory physical address of the page directory to enable paging with.
+ * @member stack_top top of the boot stack of the CPU.
+ * @member entry function the CPU calls.
+ * @member cpu CPU number passed to entry.
+ */
+struct smp_parameters_s {
+    u32 page_directory;
+    u32 stack_top;
+    u32 entry;
+    u32 cpu;
+} __attribute__((packed));
+
+/**
+ * @brief Data of one CPU, the base of its %fs segment.
+ *
+ * @member number CPU number, 0 is the boot CPU (read by smp_this_cpu, keep first).
+ * @member apic_id local APIC ID of the CPU.
+ * @member online whether the CPU finished starting.
+ * @member in_interrupt_exit whether the interrupt exit work runs on the CPU.
+ */
+struct smp_cpu_s {
+    u32 number;
+    u8 apic_id;
+    bool online;
+    bool in_interrupt_exit;
+};
+
+/* real mode code the application processors start in, copied to SMP_TRAMPOLINE_ADDRESS */
+extern const u8 smp_trampoline_start[];
+extern const u8 smp_trampoline_parameters[];
+extern const u8 smp_trampoline_end[];
+
+/* boot stacks of boot.S, SMP_BOOT_STACK_SIZE each, the boot CPU runs on the first */
+extern u8 boot_stacks[];
+
+/**
+ * @brief Load the per-CPU data segment of the running CPU into %fs.
+ */
+static inline void smp_load_cpu_segment(void) {
+    __asm__ volatile("mov %0, %%fs" : : "r"((u16)SMP_CPU_SELECTOR) : "memory");
+}
+
+/**
+ * @brief Get the number of the running CPU.
+ *
+ * @return the number in the smp_cpu_s %fs points at.
+ */
+static inline u32 smp_this_cpu(void) {
+    u32 cpu;
+
+    __asm__ volatile("movl %%fs:0, %0" : "=r"(cpu));
+    return cpu;
+}
+
+/**
+ * @brief Copy the trampoline to SMP_TRAMPOLINE_ADDRESS.
+ *
+ * The page must be mapped and free.
+ */
+extern void smp_install_trampoline(void);
+
+/**
+ * @brief Start an application processor with INIT-SIPI-SIPI and wait for it to come online.
+ *
+ * Only one CPU may be started at a time, as they share the parameters of
+ * the trampoline.
+ *
+ * @param lapic local APIC of the boot CPU.
+ * @param apic_id APIC ID of the CPU to start.
+ * @param parameters what the trampoline sets the CPU up with.
+ * @param online set by the CPU once it started.
+ * @param tsc_frequency TSC frequency in Hz, to time the waits with.
+ * @return false if the CPU did not come online in SMP_ONLINE_TIMEOUT_US.
+ */
+extern bool smp_start_cpu(
+        lapic_t* lapic,
+        u8 apic_id,
+        const smp_parameters_t* parameters,
+        volatile bool* online,
+        u64 tsc_frequency);
+
+#endif
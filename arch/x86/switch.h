@@ -0,0 +1,15 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* registers switch_to pushes on top of the return address (edi, esi, ebx, ebp) */
+#define SWITCH_SAVED_REGISTERS      4
+
+/**
+ * @brief Save the callee-saved registers and the stack pointer, then resume another stack.
+ *
+ * @param previous_stack where to store the stack pointer of the calling thread.
+ * @param next_stack stack pointer stored by the switch_to of the thread to resume (or built by
+ *      the thread setup, with SWITCH_SAVED_REGISTERS words under the address to return to).
+ */
+extern void switch_to(void** previous_stack, void* next_stack);
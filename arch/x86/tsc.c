@@ -0,0 +1,60 @@
+#include <llanos/types.h>
+
+#include "tsc.h"
+#include "pit8254.h"
+#include "cpu.h"
+
+/**
+ * @brief Time one PIT interval of TSC_CALIBRATION_TICKS with the TSC.
+ *
+ * @return the TSC cycles the interval took, or 0 if it did not end.
+ */
+static u64 __tsc_time_interval(void) {
+    u64 start;
+    u32 polls;
+
+    pit8254_start_channel2(TSC_CALIBRATION_TICKS);
+    start = cpu_read_tsc();
+    for (polls = 0; polls < TSC_CALIBRATION_TIMEOUT; polls++) {
+        if (pit8254_channel2_done()) {
+            return cpu_read_tsc() - start;
+        }
+    }
+    return 0;
+}
+
+u64 tsc_calibrate(void) {
+    u64 shortest = 0;
+    u64 cycles;
+    u32 run;
+
+    for (run = 0; run < TSC_CALIBRATION_RUNS; run++) {
+        cycles = __tsc_time_interval();
+        if (cycles == 0) {
+            return 0;
+        }
+        if (shortest == 0 || cycles < shortest) {
+            shortest = cycles;
+        }
+    }
+
+    return shortest * PIT8254_FREQUENCY / TSC_CALIBRATION_TICKS;
+}
+
+u64 tsc_calibrate_hpet(const hpet_t* hpet) {
+    u32 ticks = (u32)(hpet->frequency / TSC_CALIBRATION_HPET_DIVISOR);
+    u32 start = hpet_read_counter(hpet);
+    u64 tsc = cpu_read_tsc();
+    u32 elapsed = 0;
+    u32 polls;
+
+    for (polls = 0; polls < TSC_CALIBRATION_TIMEOUT && elapsed < ticks; polls++) {
+        elapsed = hpet_read_counter(hpet) - start;
+    }
+    tsc = cpu_read_tsc() - tsc;
+    if (elapsed < ticks) {
+        return 0;
+    }
+
+    return tsc * hpet->frequency / elapsed;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <llanos/types.h>
+
+#include "hpet.h"
+
+/* length and number of the PIT intervals the TSC is timed over, the shortest run is kept */
+#define TSC_CALIBRATION_TICKS       11932
+#define TSC_CALIBRATION_RUNS        3
+
+/* polls of the PIT output after which a calibration run is given up (no PIT) */
+#define TSC_CALIBRATION_TIMEOUT     10000000
+
+/* HPET interval the TSC is timed over, a hundredth of a second */
+#define TSC_CALIBRATION_HPET_DIVISOR    100
+
+/**
+ * @brief Measure the TSC frequency against PIT channel 2.
+ *
+ * Takes about 30 ms. Run with interrupts disabled, an interrupt during a run
+ * only makes that run longer and the shortest run is kept.
+ *
+ * @return the TSC frequency in Hz, or 0 if the PIT did not answer.
+ */
+extern u64 tsc_calibrate(void);
+
+/**
+ * @brief Measure the TSC frequency against the main counter of an HPET.
+ *
+ * For machines without a PIT. Takes about 10 ms.
+ *
+ * @param hpet running HPET.
+ * @return the TSC frequency in Hz, or 0 if the counter did not advance.
+ */
+extern u64 tsc_calibrate_hpet(const hpet_t* hpet);
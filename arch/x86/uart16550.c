@@ -0,0 +1,219 @@
+#include <llanos/types.h>
+
+#include "cpu.h"
+#include "port.h"
+#include "uart16550.h"
+
+/* register offsets from the base port */
+#define UART16550_REGISTER_DATA                 0
+#define UART16550_REGISTER_INTERRUPT_ENABLE     1
+#define UART16550_REGISTER_DIVISOR_LOW          0
+#define UART16550_REGISTER_DIVISOR_HIGH         1
+#define UART16550_REGISTER_INTERRUPT_ID         2
+#define UART16550_REGISTER_FIFO_CONTROL         2
+#define UART16550_REGISTER_LINE_CONTROL         3
+#define UART16550_REGISTER_MODEM_CONTROL        4
+#define UART16550_REGISTER_LINE_STATUS          5
+#define UART16550_REGISTER_SCRATCH              7
+
+/* line control: 8 data bits, no parity, 1 stop bit and the divisor latch access bit */
+#define UART16550_LINE_CONTROL_8N1              0x03
+#define UART16550_LINE_CONTROL_DLAB             0x80
+
+/* fifo control: enable, clear both FIFOs, 14 byte receive trigger */
+#define UART16550_FIFO_CONTROL_ENABLE           0xc7
+
+/* modem control: DTR, RTS and OUT2 (OUT2 gates the IRQ line on PCs) */
+#define UART16550_MODEM_CONTROL_READY           0x0b
+
+#define UART16550_INTERRUPT_ENABLE_THR_EMPTY    0x02
+#define UART16550_INTERRUPT_ID_MASK             0x0f
+#define UART16550_INTERRUPT_ID_THR_EMPTY        0x02
+#define UART16550_INTERRUPT_ID_FIFO_MASK        0xc0
+#define UART16550_LINE_STATUS_THR_EMPTY         0x20
+
+#define UART16550_FIFO_SIZE                     16
+
+/**
+ * @brief Check whether the transmit holding register (and FIFO) is empty.
+ *
+ * @param uart uart to check.
+ * @return true if a full FIFO worth of bytes can be written.
+ */
+static inline bool __uart16550_can_transmit(uart16550_t* uart) {
+    return (port_input_byte(uart->port + UART16550_REGISTER_LINE_STATUS) & UART16550_LINE_STATUS_THR_EMPTY) != 0;
+}
+
+/**
+ * @brief Move up to one FIFO worth of queued bytes from the transmit ring into the UART.
+ *
+ * Must be called with interrupts disabled so it does not race the interrupt handler.
+ *
+ * @param uart uart to transmit on.
+ */
+static void __uart16550_transmit_queued(uart16550_t* uart) {
+    u8 count = 0;
+    u8 byte;
+
+    if (!__uart16550_can_transmit(uart)) {
+        return;
+    }
+
+    while (count < uart->fifo_size && ring_pop(&uart->tx_ring, &byte)) {
+        port_output_byte(uart->port + UART16550_REGISTER_DATA, byte);
+        count++;
+    }
+}
+
+/**
+ * @brief Enable or disable the THR empty interrupt.
+ *
+ * @param uart uart to configure.
+ * @param enable whether or not the interrupt is wanted.
+ */
+static void __uart16550_set_tx_interrupt(uart16550_t* uart, bool enable) {
+    uart->tx_active = enable;
+    port_output_byte(
+        uart->port + UART16550_REGISTER_INTERRUPT_ENABLE,
+        enable ? UART16550_INTERRUPT_ENABLE_THR_EMPTY : 0
+    );
+}
+
+/**
+ * @brief Queue a byte on the transmit ring, making room first if the ring is full.
+ *
+ * Must be called with interrupts disabled.
+ *
+ * @param uart uart to queue the byte on.
+ * @param byte byte to queue.
+ */
+static void __uart16550_queue(uart16550_t* uart, u8 byte) {
+    while (!ring_push(&uart->tx_ring, byte)) {
+        /* the interrupt cannot drain the ring while interrupts are off, so poll room into it */
+        __uart16550_transmit_queued(uart);
+    }
+}
+
+/**
+ * @brief Send bytes by polling the line status once per FIFO worth.
+ *
+ * @param uart uart to send on.
+ * @param buffer characters to send.
+ * @param length number of characters in buffer.
+ */
+static void __uart16550_write_polled(uart16550_t* uart, const char* buffer, size_t length) {
+    bool carriage_returned = false;
+    size_t index = 0;
+    u8 burst;
+
+    while (index < length) {
+        while (!__uart16550_can_transmit(uart)) {
+        }
+
+        for (burst = 0; burst < uart->fifo_size && index < length; burst++) {
+            /* a line feed takes two slots (CR LF), possibly split over two bursts */
+            if (buffer[index] == '\n' && !carriage_returned) {
+                port_output_byte(uart->port + UART16550_REGISTER_DATA, '\r');
+                carriage_returned = true;
+            } else {
+                port_output_byte(uart->port + UART16550_REGISTER_DATA, (u8)buffer[index]);
+                carriage_returned = false;
+                index++;
+            }
+        }
+    }
+}
+
+bool uart16550_initialize(uart16550_t* uart, u16 port, u32 baud) {
+    u16 divisor = (u16)(UART16550_BASE_BAUD / baud);
+
+    uart->port = port;
+    uart->fifo_size = 1;
+    uart->interrupt_driven = false;
+    uart->tx_active = false;
+    ring_initialize(&uart->tx_ring, uart->tx_buffer, UART16550_TX_RING_SIZE);
+
+    /* nothing answers at a missing port, so the scratch register will not hold a value */
+    port_output_byte(port + UART16550_REGISTER_SCRATCH, 0x5a);
+    uart->present = port_input_byte(port + UART16550_REGISTER_SCRATCH) == 0x5a;
+    if (!uart->present) {
+        return false;
+    }
+
+    port_output_byte(port + UART16550_REGISTER_INTERRUPT_ENABLE, 0);
+    port_output_byte(port + UART16550_REGISTER_LINE_CONTROL, UART16550_LINE_CONTROL_DLAB);
+    port_output_byte(port + UART16550_REGISTER_DIVISOR_LOW, (u8)(divisor & 0xff));
+    port_output_byte(port + UART16550_REGISTER_DIVISOR_HIGH, (u8)(divisor >> 8));
+    port_output_byte(port + UART16550_REGISTER_LINE_CONTROL, UART16550_LINE_CONTROL_8N1);
+    port_output_byte(port + UART16550_REGISTER_FIFO_CONTROL, UART16550_FIFO_CONTROL_ENABLE);
+    port_output_byte(port + UART16550_REGISTER_MODEM_CONTROL, UART16550_MODEM_CONTROL_READY);
+
+    /* both FIFO bits read back set only on a 16550A (older parts have a broken or no FIFO) */
+    if ((port_input_byte(port + UART16550_REGISTER_INTERRUPT_ID) & UART16550_INTERRUPT_ID_FIFO_MASK) == UART16550_INTERRUPT_ID_FIFO_MASK) {
+        uart->fifo_size = UART16550_FIFO_SIZE;
+    }
+    return true;
+}
+
+void uart16550_enable_interrupts(uart16550_t* uart) {
+    if (uart->present) {
+        uart->interrupt_driven = true;
+    }
+}
+
+void uart16550_write(uart16550_t* uart, const char* buffer, size_t length) {
+    size_t index;
+    u32 flags;
+
+    if (!uart->present) {
+        return;
+    }
+
+    if (!uart->interrupt_driven) {
+        __uart16550_write_polled(uart, buffer, length);
+        return;
+    }
+
+    flags = cpu_save_and_disable_interrupts();
+    for (index = 0; index < length; index++) {
+        if (buffer[index] == '\n') {
+            __uart16550_queue(uart, '\r');
+        }
+        __uart16550_queue(uart, (u8)buffer[index]);
+    }
+
+    /* start the transmitter, the THR empty interrupt keeps it going from here */
+    if (!uart->tx_active && !ring_is_empty(&uart->tx_ring)) {
+        __uart16550_transmit_queued(uart);
+        __uart16550_set_tx_interrupt(uart, true);
+    }
+    cpu_restore_interrupts(flags);
+}
+
+void uart16550_flush(uart16550_t* uart) {
+    u32 flags;
+
+    if (!uart->interrupt_driven) {
+        return;
+    }
+
+    /* the THR empty interrupt that follows finds the ring empty and turns itself off */
+    flags = cpu_save_and_disable_interrupts();
+    while (!ring_is_empty(&uart->tx_ring)) {
+        __uart16550_transmit_queued(uart);
+    }
+    cpu_restore_interrupts(flags);
+}
+
+void uart16550_handle_interrupt(uart16550_t* uart) {
+    u8 interrupt_id = port_input_byte(uart->port + UART16550_REGISTER_INTERRUPT_ID) & UART16550_INTERRUPT_ID_MASK;
+
+    if (interrupt_id != UART16550_INTERRUPT_ID_THR_EMPTY) {
+        return;
+    }
+
+    __uart16550_transmit_queued(uart);
+    if (ring_is_empty(&uart->tx_ring)) {
+        __uart16550_set_tx_interrupt(uart, false);
+    }
+}
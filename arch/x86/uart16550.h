@@ -0,0 +1,92 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/util/ring.h>
+
+/* standard PC serial ports */
+#define UART16550_COM1_PORT         0x3f8
+#define UART16550_COM1_IRQ          4
+
+/* base clock divided by the divisor latch gives the baud rate */
+#define UART16550_BASE_BAUD         115200
+
+/* size of the interrupt driven transmit ring (a power of two) */
+#define UART16550_TX_RING_SIZE      1024
+
+typedef struct uart16550_s uart16550_t;
+
+/**
+ * @brief A 16550 compatible UART.
+ *
+ * @member port base I/O port of the UART.
+ * @member present whether or not a UART answered at port.
+ * @member fifo_size number of bytes the transmit FIFO holds (16, or 1 without a working FIFO).
+ * @member interrupt_driven whether transmission is driven by the THR empty interrupt (true)
+ *      or by polling the line status register (false).
+ * @member tx_active whether or not the THR empty interrupt is enabled with bytes in flight.
+ * @member tx_ring bytes waiting for the transmit FIFO (interrupt driven mode only).
+ * @member tx_buffer storage of tx_ring.
+ */
+struct uart16550_s {
+    u16 port;
+    bool present;
+    u8 fifo_size;
+    bool interrupt_driven;
+    bool tx_active;
+    ring_t tx_ring;
+    u8 tx_buffer[UART16550_TX_RING_SIZE];
+};
+
+/**
+ * @brief Initialize a UART for 8N1 output in polled mode.
+ *
+ * Polled mode needs no interrupts, so it can be used from the first
+ * instructions of the kernel. The FIFOs are enabled and cleared.
+ *
+ * @param uart uart to initialize.
+ * @param port base I/O port of the UART (UART16550_COM1_PORT for COM1).
+ * @param baud baud rate (a divisor of UART16550_BASE_BAUD).
+ * @return false if no UART answered at port (writes are then discarded).
+ */
+extern bool uart16550_initialize(uart16550_t* uart, u16 port, u32 baud);
+
+/**
+ * @brief Switch a UART to interrupt driven transmission.
+ *
+ * Writes then only queue bytes in the transmit ring, and the THR empty
+ * interrupt refills the FIFO 16 bytes at a time. The caller must route the
+ * UART's IRQ to uart16550_handle_interrupt before calling this.
+ *
+ * @param uart uart to switch.
+ */
+extern void uart16550_enable_interrupts(uart16550_t* uart);
+
+/**
+ * @brief Write characters to a UART.
+ *
+ * Line feeds are sent as CR LF. In polled mode this waits for the FIFO to
+ * empty once per 16 bytes instead of once per byte. In interrupt driven mode
+ * it only waits when the transmit ring is full.
+ *
+ * @param uart uart to write to.
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void uart16550_write(uart16550_t* uart, const char* buffer, size_t length);
+
+/**
+ * @brief Send every byte queued on the transmit ring by polling.
+ *
+ * Works with interrupts disabled, so output queued right before a halt
+ * still goes out.
+ *
+ * @param uart uart to flush.
+ */
+extern void uart16550_flush(uart16550_t* uart);
+
+/**
+ * @brief Service an interrupt raised by a UART.
+ *
+ * @param uart uart that raised the interrupt.
+ */
+extern void uart16550_handle_interrupt(uart16550_t* uart);
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/video/framebuffer.h>
+#include <llanos/management/irqstat.h>
+#include <llanos/management/softirq.h>
+#include <llanos/management/clockevent.h>
+#include <llanos/management/thread.h>
+
+/**
+ * @brief Bring up the architecture (paging, descriptor tables, interrupt controllers, early serial).
+ *
+ * Called from the boot code before kmain.
+ */
+extern void initialize_architecture(void);
+
+/**
+ * @brief Write characters to the serial console (COM1).
+ *
+ * Output is discarded when there is no serial port.
+ *
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void architecture_serial_write(const char* buffer, size_t length);
+
+/**
+ * @brief Send the serial console output still queued, even with interrupts disabled.
+ *
+ * Polls until the whole transmit ring is out (about 90 ms for a full ring),
+ * so it is only meant for the abort path.
+ */
+extern void architecture_serial_flush(void);
+
+/**
+ * @brief Write characters to the emulator debug console (port 0xe9).
+ *
+ * Real hardware ignores the port, so this is always safe to call.
+ *
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void architecture_debugcon_write(const char* buffer, size_t length);
+
+/**
+ * @brief Get the linear framebuffer the boot loader set up.
+ *
+ * @param framebuffer filled with the framebuffer description.
+ * @return false if the boot loader left the display in text mode.
+ */
+extern bool architecture_get_framebuffer(framebuffer_info_t* framebuffer);
+
+/**
+ * @brief Check whether 128-bit vector instructions (SSE2 on x86) are enabled.
+ *
+ * @return true if code built for 128-bit vectors may run.
+ */
+extern bool architecture_has_vector_unit(void);
+
+/**
+ * @brief Move the VGA text mode hardware cursor (a vga_cursor_t).
+ *
+ * @param position cell (row * columns + column) to show the cursor at.
+ */
+extern void architecture_vga_set_cursor(u16 position);
+
+/**
+ * @brief Start recording every handled interrupt (count and handler time) in interrupt statistics.
+ *
+ * @param stats statistics to record in (NULL to stop recording).
+ */
+extern void architecture_record_interrupts(irqstat_t* stats);
+
+/**
+ * @brief Read the cycle counter of the calling CPU (the TSC).
+ *
+ * @return the cycle counter.
+ */
+extern u64 architecture_clock_cycles(void);
+
+/**
+ * @brief Get the frequency of the cycle counter, measured at boot.
+ *
+ * @return the frequency in Hz, 0 if it could not be measured.
+ */
+extern u64 architecture_clock_frequency(void);
+
+/**
+ * @brief Check whether the cycle counter runs at a constant rate in every power state.
+ *
+ * @return true if the cycle counter is invariant.
+ */
+extern bool architecture_clock_invariant(void);
+
+/**
+ * @brief Drive a clock event with the one-shot timer of the calling CPU.
+ *
+ * The timer is the local APIC timer in TSC-deadline mode if the CPU has
+ * it, an HPET comparator, the one-shot local APIC timer or the PIT, in
+ * that order. It only interrupts for the expiries the
+ * clock event programs, there is no periodic tick.
+ *
+ * @param event clock event measured on the cycle counter (see architecture_clock_cycles).
+ * @return false if there is no usable timer or the cycle counter frequency is unknown.
+ */
+extern bool architecture_attach_clockevent(clockevent_t* event);
+
+/**
+ * @brief Build the first frame of a thread so switching to it calls entry(argument).
+ *
+ * @param context context of the thread.
+ * @param stack_top end of the stack of the thread.
+ * @param entry first function of the thread, must not return.
+ * @param argument argument passed to entry.
+ */
+extern void architecture_thread_prepare(thread_context_t* context, void* stack_top, thread_function_t entry, void* argument);
+
+/**
+ * @brief Switch from the running thread to another one.
+ *
+ * Only the callee-saved registers and the stack pointer are switched. The
+ * FPU state stays in place until the next thread runs an FPU instruction,
+ * which traps and swaps it then, so threads that never touch the FPU never
+ * pay for it.
+ *
+ * @param previous context to save the running thread in.
+ * @param next context of the thread to resume.
+ */
+extern void architecture_thread_switch(thread_context_t* previous, thread_context_t* next);
+
+/**
+ * @brief Enable interrupts and sleep until the next interrupt on the calling CPU.
+ */
+extern void architecture_idle(void);
+
+/**
+ * @brief Enable interrupts on the calling CPU.
+ */
+extern void architecture_enable_interrupts(void);
+
+/**
+ * @brief Disable interrupts on the calling CPU.
+ */
+extern void architecture_disable_interrupts(void);
+
+/**
+ * @brief Disable interrupts on the calling CPU, remembering whether they were enabled.
+ *
+ * @return state to pass to architecture_restore_interrupts.
+ */
+extern u32 architecture_save_interrupts(void);
+
+/**
+ * @brief Enable interrupts on the calling CPU again if they were enabled before architecture_save_interrupts.
+ *
+ * @param state state returned by architecture_save_interrupts.
+ */
+extern void architecture_restore_interrupts(u32 state);
+
+/**
+ * @brief Run the pending softirqs on the way out of every interrupt.
+ *
+ * @param softirq softirqs to run (NULL to stop running them).
+ */
+extern void architecture_run_softirqs(softirq_t* softirq);
+
+/**
+ * @brief Start the other CPUs the ACPI MADT lists.
+ *
+ * They take the IRQ lines irq balancing gives them and otherwise sleep.
+ * Threads, timers and the clock event stay on the boot CPU.
+ *
+ * @return the number of CPUs online, the boot CPU included.
+ */
+extern u32 architecture_start_cpus(void);
+
+/**
+ * @brief Get the number of the running CPU.
+ *
+ * @return the CPU number, 0 for the boot CPU.
+ */
+extern u32 architecture_cpu_id(void);
+
+/**
+ * @brief Preempt the running thread on the way out of every interrupt, after the softirqs.
+ *
+ * @param threads threads to preempt in (NULL to stop preempting).
+ */
+extern void architecture_preempt_threads(threads_t* threads);
+
+/**
+ * @brief Spread the IRQ lines over the CPUs taking interrupts by their counts in the interrupt statistics.
+ *
+ * Meant to be called periodically. Does nothing unless interrupts are
+ * recorded (see architecture_record_interrupts) and the interrupt
+ * controller can deliver to other CPUs.
+ *
+ * @return number of IRQ lines moved to another CPU.
+ */
+extern u32 architecture_balance_irqs(void);
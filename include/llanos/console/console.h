@@ -0,0 +1,217 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/management/log.h>
+#include <llanos/video/vga.h>
+#include <llanos/video/framebuffer.h>
+#include <stdarg.h>
+
+/* most sinks a single console fans out to */
+#define CONSOLE_MAX_SINKS       8
+
+/* formatted output is gathered into batches of this size before it is handed to the sinks */
+#define CONSOLE_BATCH_SIZE      128
+
+typedef struct console_sink_s console_sink_t;
+typedef struct console_s console_t;
+typedef struct console_capture_s console_capture_t;
+
+/**
+ * @brief Write a batch of characters to a sink.
+ *
+ * @param context context pointer the sink was added with.
+ * @param level level of the output.
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+typedef void (*console_write_t)(void* context, log_level_t level, const char* buffer, size_t length);
+
+/**
+ * @brief Make the output written to a sink visible.
+ *
+ * @param context context pointer the sink was added with.
+ */
+typedef void (*console_flush_t)(void* context);
+
+/**
+ * @brief Lock a console against interrupts (and preemption).
+ *
+ * @return state to pass to the matching unlock.
+ */
+typedef u32 (*console_lock_t)(void);
+
+/**
+ * @brief Unlock a console.
+ *
+ * @param state state returned by the matching lock.
+ */
+typedef void (*console_unlock_t)(u32 state);
+
+/**
+ * @brief An output device of a console.
+ *
+ * @member write writes a batch of characters to the device.
+ * @member flush makes written output visible (NULL if writes are visible immediately).
+ * @member context context pointer passed to write and flush.
+ * @member minimum_level output below this level is not written to the sink.
+ */
+struct console_sink_s {
+    console_write_t write;
+    console_flush_t flush;
+    void* context;
+    log_level_t minimum_level;
+};
+
+/**
+ * @brief A console multiplexing its output to a set of sinks.
+ *
+ * @member sinks sinks of the console.
+ * @member sink_count number of sinks in use.
+ * @member lock held while the sinks are written or flushed (NULL if only used from one context).
+ * @member unlock releases the lock.
+ */
+struct console_s {
+    console_sink_t sinks[CONSOLE_MAX_SINKS];
+    size_t sink_count;
+    console_lock_t lock;
+    console_unlock_t unlock;
+};
+
+/**
+ * @brief A sink that keeps output in memory (for log collection and tests).
+ *
+ * @member buffer buffer the output is stored in.
+ * @member capacity size of buffer.
+ * @member length number of characters stored.
+ * @member dropped number of characters that did not fit.
+ */
+struct console_capture_s {
+    char* buffer;
+    size_t capacity;
+    size_t length;
+    size_t dropped;
+};
+
+/**
+ * @brief Initialize a console without any sinks.
+ *
+ * @param console console to initialize.
+ */
+extern void console_initialize(console_t* console);
+
+/**
+ * @brief Serialize the writes and flushes of a console.
+ *
+ * The sinks keep cursor and buffer state that a write from an interrupt
+ * would corrupt halfway through another write.
+ *
+ * @param console console to lock.
+ * @param lock held while the sinks are written or flushed (NULL to not lock).
+ * @param unlock releases the lock.
+ */
+extern void console_set_lock(console_t* console, console_lock_t lock, console_unlock_t unlock);
+
+/**
+ * @brief Add a sink to a console.
+ *
+ * @param console console to add the sink to.
+ * @param write writes a batch of characters to the device.
+ * @param flush makes written output visible (NULL if not needed).
+ * @param context context pointer passed to write and flush.
+ * @param minimum_level output below this level is not written to the sink.
+ * @return the added sink (to change its level later), or NULL if the console has CONSOLE_MAX_SINKS sinks.
+ */
+extern console_sink_t* console_add_sink(
+        console_t* console,
+        console_write_t write,
+        console_flush_t flush,
+        void* context,
+        log_level_t minimum_level);
+
+/**
+ * @brief Change the level filter of a sink.
+ *
+ * Raising the level of a slow sink (a serial line) keeps it from slowing
+ * down the console without hiding output from the fast sinks.
+ *
+ * @param sink sink to change.
+ * @param minimum_level output below this level is not written to the sink.
+ */
+extern void console_set_sink_level(console_sink_t* sink, log_level_t minimum_level);
+
+/**
+ * @brief Write characters to every sink that accepts the level.
+ *
+ * @param console console to write to.
+ * @param level level of the output.
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void console_write(console_t* console, log_level_t level, const char* buffer, size_t length);
+
+/**
+ * @brief Print a formatted string to every sink that accepts the level.
+ *
+ * The output is gathered into CONSOLE_BATCH_SIZE batches, so sinks see a few
+ * large writes rather than one write per formatted field.
+ *
+ * @param console console to print to.
+ * @param level level of the output.
+ * @param format format specifier for the string (refer to format_stream).
+ * @param ... additional arguments.
+ * @return number of characters printed, or -1 if the format string is invalid.
+ */
+extern s32 console_printf(console_t* console, log_level_t level, const char* format, ...);
+
+/**
+ * @brief Print a formatted string to every sink that accepts the level from an argument list.
+ *
+ * @param console console to print to.
+ * @param level level of the output.
+ * @param format format specifier for the string (refer to format_stream).
+ * @param arguments additional arguments.
+ * @return number of characters printed, or -1 if the format string is invalid.
+ */
+extern s32 console_vprintf(console_t* console, log_level_t level, const char* format, va_list arguments);
+
+/**
+ * @brief Make the output of every sink visible.
+ *
+ * @param console console to flush.
+ */
+extern void console_flush(console_t* console);
+
+/**
+ * @brief Console write function for a vga_t context.
+ *
+ * Errors and worse are printed in red, everything else in light grey.
+ */
+extern void console_vga_write(void* context, log_level_t level, const char* buffer, size_t length);
+
+/**
+ * @brief Console flush function for a vga_t context.
+ */
+extern void console_vga_flush(void* context);
+
+/**
+ * @brief Console write function for a framebuffer_console_t context.
+ *
+ * Errors and worse are printed in red, everything else in light grey.
+ */
+extern void console_framebuffer_write(void* context, log_level_t level, const char* buffer, size_t length);
+
+/**
+ * @brief Initialize an empty in-memory capture.
+ *
+ * @param capture capture to initialize.
+ * @param buffer buffer to store the output in.
+ * @param capacity size of buffer.
+ */
+extern void console_capture_initialize(console_capture_t* capture, char* buffer, size_t capacity);
+
+/**
+ * @brief Console write function for a console_capture_t context.
+ *
+ * Output that does not fit is counted in dropped.
+ */
+extern void console_capture_write(void* context, log_level_t level, const char* buffer, size_t length);
@@ -1,6 +1,18 @@
 #pragma once
 
 #include <llanos/video/vga.h>
+#include <llanos/management/log.h>
+#include <llanos/console/console.h>
+#include <llanos/management/irqstat.h>
+#include <llanos/management/softirq.h>
+#include <llanos/management/clock.h>
+#include <llanos/management/clockevent.h>
+#include <llanos/management/timer.h>
+#include <llanos/management/thread.h>
+
+/* length of a tick of the llanos timers in nanoseconds (about 1 ms), a power of two so time turns into ticks with a shift */
+#define LLANOS_TIMER_TICK_SHIFT     20
+#define LLANOS_TIMER_TICK_NS        (1ULL << LLANOS_TIMER_TICK_SHIFT)
 
 /**
  * @brief Get the current llanos global VGA.
@@ -19,5 +31,166 @@ extern void set_llanos_vga(vga_t* vga);
 
 /**
  * @brief Reset the current llanos global VGA the default configuration.
+ *
+ * The global VGA scrolls through a history of rows in RAM, so call
+ * vga_flush on it to make output visible.
  */
 extern void reset_llanos_vga(void);
+
+/**
+ * @brief Get the llanos kernel log.
+ *
+ * @return the llanos kernel log.
+ */
+extern log_buffer_t* get_llanos_log(void);
+
+/**
+ * @brief Reset the llanos kernel log to an empty log.
+ *
+ * @param clock timestamp source for the records (NULL if there is none yet).
+ * @param cpu CPU number source for the records (NULL if there is none yet).
+ */
+extern void reset_llanos_log(log_clock_t clock, log_cpu_t cpu);
+
+/**
+ * @brief Get the llanos kernel console.
+ *
+ * @return the llanos kernel console.
+ */
+extern console_t* get_llanos_console(void);
+
+/**
+ * @brief Reset the llanos kernel console to a console writing only to the global VGA.
+ *
+ * Further sinks (serial, debug console, ...) are added with console_add_sink.
+ */
+extern void reset_llanos_console(void);
+
+/**
+ * @brief Get the llanos interrupt statistics.
+ *
+ * @return the llanos interrupt statistics.
+ */
+extern irqstat_t* get_llanos_irqstat(void);
+
+/**
+ * @brief Reset the llanos interrupt statistics to 0.
+ */
+extern void reset_llanos_irqstat(void);
+
+/**
+ * @brief Get the llanos softirqs (bottom halves of the interrupt handlers).
+ *
+ * @return the llanos softirqs.
+ */
+extern softirq_t* get_llanos_softirq(void);
+
+/**
+ * @brief Reset the llanos softirqs to no pending work.
+ *
+ * @param cpu CPU number source, every CPU runs its own softirqs (NULL when only CPU 0 runs).
+ * @param enable enables interrupts on the calling CPU.
+ * @param disable disables interrupts on the calling CPU.
+ */
+extern void reset_llanos_softirq(softirq_cpu_source_t cpu, softirq_interrupts_t enable, softirq_interrupts_t disable);
+
+/**
+ * @brief Get the llanos kernel clock.
+ *
+ * @return the llanos kernel clock.
+ */
+extern clock_source_t* get_llanos_clock(void);
+
+/**
+ * @brief Reset the llanos kernel clock to count from now.
+ *
+ * @param read reads the cycle counter.
+ * @param frequency cycle counter frequency in Hz (0 if unknown).
+ * @param invariant whether the cycle counter runs at a constant rate.
+ */
+extern void reset_llanos_clock(clock_read_t read, u64 frequency, bool invariant);
+
+/**
+ * @brief Read the cycle counter of the llanos kernel clock.
+ *
+ * For measuring short intervals, turn them into nanoseconds with
+ * clock_source_cycles_to_ns only when needed.
+ *
+ * @return the cycle counter.
+ */
+extern u64 clock_cycles(void);
+
+/**
+ * @brief Get the time since the llanos kernel clock was reset.
+ *
+ * @return the nanoseconds since reset_llanos_clock.
+ */
+extern u64 clock_monotonic_ns(void);
+
+/**
+ * @brief Get the llanos clock event of the boot CPU.
+ *
+ * @return the llanos clock event.
+ */
+extern clockevent_t* get_llanos_clockevent(void);
+
+/**
+ * @brief Reset the llanos clock event to nothing programmed, measured on the llanos kernel clock.
+ *
+ * The timer device and the handler have to be set again afterwards.
+ */
+extern void reset_llanos_clockevent(void);
+
+/**
+ * @brief Get the current tick of the llanos timers.
+ *
+ * @return the LLANOS_TIMER_TICK_NS ticks since the llanos kernel clock was reset.
+ */
+extern u64 clock_ticks(void);
+
+/**
+ * @brief Get the llanos timers.
+ *
+ * @return the llanos timer wheel, its expiries are in clock_ticks.
+ */
+extern timer_wheel_t* get_llanos_timers(void);
+
+/**
+ * @brief Reset the llanos timers to none and run them from the llanos clock event and softirqs.
+ *
+ * The llanos clock event interrupt raises SOFTIRQ_TIMER, which runs the
+ * expired timers and programs the clock event for the next one. Call after
+ * reset_llanos_softirq and reset_llanos_clockevent.
+ *
+ * @param lock disables interrupts on the calling CPU, returning the state to restore.
+ * @param unlock restores the interrupt state.
+ */
+extern void reset_llanos_timers(timer_lock_t lock, timer_unlock_t unlock);
+
+/**
+ * @brief Get the llanos threads of the boot CPU.
+ *
+ * @return the llanos threads.
+ */
+extern threads_t* get_llanos_threads(void);
+
+/**
+ * @brief Reset the llanos threads to the calling flow as the only, boot thread.
+ *
+ * The time slices are ticked by a llanos timer every LLANOS_TIMER_TICK_NS
+ * while threads wait for the CPU. Call after reset_llanos_timers.
+ *
+ * @param prepare builds the first frame of a thread.
+ * @param switch_to switches threads.
+ * @param lock disables interrupts on the calling CPU, returning the state to restore.
+ * @param unlock restores the interrupt state.
+ * @param enable enables interrupts on the calling CPU.
+ * @param idle waits for an interrupt.
+ */
+extern void reset_llanos_threads(
+        thread_prepare_t prepare,
+        thread_switch_t switch_to,
+        thread_lock_t lock,
+        thread_unlock_t unlock,
+        thread_enable_t enable,
+        thread_idle_t idle);
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <llanos/types.h>
-#include <llanos/video/vga.h>
+#include <llanos/console/console.h>
 
 /**
  * Abort the kernel operations immediately.
  * 
  * @param errorcode causing the abort.
- * @param vga vga device to print the error message on with the errorcode (NULL if not needed).
+ * @param console console to print the error message on with the errorcode (NULL to print nothing).
  */
-extern void abort(u32 errorcode, vga_t* vga);
+extern void abort(u32 errorcode, console_t* console);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* nanoseconds per second */
+#define CLOCK_NS_PER_SECOND     1000000000ULL
+
+typedef struct clock_source_s clock_source_t;
+
+/**
+ * @brief Read a free running cycle counter.
+ *
+ * @return the counter.
+ */
+typedef u64 (*clock_read_t)(void);
+
+/**
+ * @brief A free running cycle counter of known frequency.
+ *
+ * Cycles are turned into nanoseconds with a multiply and a shift,
+ * ns = cycles * mult >> shift, so reading the time never divides.
+ *
+ * @member read reads the counter.
+ * @member frequency counter frequency in Hz (0 if unknown, the time is then always 0).
+ * @member mult nanoseconds per cycle as a fixed point number with shift fraction bits.
+ * @member shift number of fraction bits of mult.
+ * @member start counter value the time is counted from.
+ * @member invariant whether the counter runs at frequency in every power state
+ *      (an invariant TSC), otherwise the time drifts with CPU frequency changes.
+ */
+struct clock_source_s {
+    clock_read_t read;
+    u64 frequency;
+    u32 mult;
+    u32 shift;
+    u64 start;
+    bool invariant;
+};
+
+/**
+ * @brief Compute the most precise multiplier turning units of one rate into units of another.
+ *
+ * @param from rate of the units to convert from (not 0).
+ * @param to rate of the units to convert to (at most 2^32 times from).
+ * @param mult where to store the multiplier (below 2^32).
+ * @param shift where to store the number of fraction bits of the multiplier (at most 32).
+ */
+extern void clock_calculate_conversion(u64 from, u64 to, u32* mult, u32* shift);
+
+/**
+ * @brief Compute the most precise multiplier turning cycles of a frequency into nanoseconds.
+ *
+ * @param frequency counter frequency in Hz (not 0).
+ * @param mult where to store the multiplier (below 2^32).
+ * @param shift where to store the number of fraction bits of the multiplier (at most 32).
+ */
+extern void clock_calculate_scale(u64 frequency, u32* mult, u32* shift);
+
+/**
+ * @brief Scale cycles by a 32-bit fixed point multiplier.
+ *
+ * Split in two 32x32 multiplies, so the 96-bit product is never needed and
+ * no cycle count overflows before the result does.
+ *
+ * @param cycles cycles to scale.
+ * @param mult multiplier.
+ * @param shift number of fraction bits of mult (at most 32).
+ * @return cycles * mult >> shift.
+ */
+static inline u64 clock_scale(u64 cycles, u32 mult, u32 shift) {
+    u64 high = (cycles >> 32) * mult;
+    u64 low = (cycles & 0xffffffff) * mult;
+
+    return (high << (32 - shift)) + (low >> shift);
+}
+
+/**
+ * @brief Initialize a clock source counting from now.
+ *
+ * @param source clock source to initialize.
+ * @param read reads the counter.
+ * @param frequency counter frequency in Hz (0 if it could not be measured).
+ * @param invariant whether the counter runs at a constant rate.
+ */
+extern void clock_source_initialize(clock_source_t* source, clock_read_t read, u64 frequency, bool invariant);
+
+/**
+ * @brief Turn a number of cycles of a clock source into nanoseconds.
+ *
+ * @param source clock source the cycles were counted by.
+ * @param cycles cycles to turn into nanoseconds.
+ * @return the nanoseconds.
+ */
+static inline u64 clock_source_cycles_to_ns(const clock_source_t* source, u64 cycles) {
+    return clock_scale(cycles, source->mult, source->shift);
+}
+
+/**
+ * @brief Read the cycle counter of a clock source.
+ *
+ * @param source clock source to read.
+ * @return the counter.
+ */
+static inline u64 clock_source_cycles(const clock_source_t* source) {
+    return source->read();
+}
+
+/**
+ * @brief Get the nanoseconds since a clock source was initialized.
+ *
+ * @param source clock source to read.
+ * @return the nanoseconds since clock_source_initialize.
+ */
+static inline u64 clock_source_ns(const clock_source_t* source) {
+    return clock_source_cycles_to_ns(source, source->read() - source->start);
+}
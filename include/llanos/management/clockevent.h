@@ -0,0 +1,160 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/management/clock.h>
+
+/* next_event of a clock event with nothing programmed */
+#define CLOCKEVENT_NONE     0xffffffffffffffffULL
+
+typedef struct clockevent_device_s clockevent_device_t;
+typedef struct clockevent_s clockevent_t;
+
+/**
+ * @brief Arm a one-shot timer device.
+ *
+ * @param context context of the device.
+ * @param cycles device cycles until the interrupt (within the limits of the device).
+ */
+typedef void (*clockevent_set_next_t)(void* context, u64 cycles);
+
+/**
+ * @brief Disarm a one-shot timer device.
+ *
+ * @param context context of the device.
+ */
+typedef void (*clockevent_stop_t)(void* context);
+
+/**
+ * @brief Handle an expired clock event.
+ *
+ * Runs in the timer interrupt with nothing programmed, program the next
+ * expiry from here (or nothing, to leave the CPU without timer interrupts).
+ *
+ * @param context context pointer given to clockevent_set_handler.
+ * @param now time of the clock of the clock event in nanoseconds.
+ */
+typedef void (*clockevent_handler_t)(void* context, u64 now);
+
+/**
+ * @brief A one-shot timer device of a CPU (local APIC timer, PIT, ...).
+ *
+ * @member name name of the device.
+ * @member set_next arms the device.
+ * @member stop disarms the device.
+ * @member context context passed to set_next and stop.
+ * @member mult nanoseconds to device cycles multiplier (see clock_scale).
+ * @member shift number of fraction bits of mult.
+ * @member min_cycles fewest cycles the device can be armed for.
+ * @member max_cycles most cycles the device can be armed for, longer waits take several interrupts.
+ */
+struct clockevent_device_s {
+    const char* name;
+    clockevent_set_next_t set_next;
+    clockevent_stop_t stop;
+    void* context;
+    u32 mult;
+    u32 shift;
+    u64 min_cycles;
+    u64 max_cycles;
+};
+
+/**
+ * @brief Tickless timer interrupts of one CPU.
+ *
+ * Only the next expiry is ever programmed, there is no periodic tick: a
+ * CPU with nothing to wait for gets no timer interrupt at all. Expiries
+ * beyond the reach of the device take intermediate interrupts that only
+ * re-arm it. Only used by the CPU it belongs to, with interrupts disabled.
+ *
+ * @member clock clock expiries are measured on.
+ * @member device timer device (NULL until clockevent_set_device).
+ * @member handler handler of expired events (NULL if none).
+ * @member context context pointer passed to handler.
+ * @member next_event time of the programmed expiry (CLOCKEVENT_NONE if none).
+ * @member interrupts number of timer interrupts taken.
+ */
+struct clockevent_s {
+    const clock_source_t* clock;
+    clockevent_device_t* device;
+    clockevent_handler_t handler;
+    void* context;
+    u64 next_event;
+    u32 interrupts;
+};
+
+/**
+ * @brief Initialize a timer device.
+ *
+ * @param device device to initialize.
+ * @param name name of the device.
+ * @param set_next arms the device.
+ * @param stop disarms the device.
+ * @param context context passed to set_next and stop.
+ * @param frequency device cycles per second (not 0).
+ * @param min_cycles fewest cycles the device can be armed for.
+ * @param max_cycles most cycles the device can be armed for.
+ */
+extern void clockevent_device_initialize(
+        clockevent_device_t* device,
+        const char* name,
+        clockevent_set_next_t set_next,
+        clockevent_stop_t stop,
+        void* context,
+        u64 frequency,
+        u64 min_cycles,
+        u64 max_cycles);
+
+/**
+ * @brief Initialize a clock event without a device or a handler.
+ *
+ * @param event clock event to initialize.
+ * @param clock clock expiries are measured on.
+ */
+extern void clockevent_initialize(clockevent_t* event, const clock_source_t* clock);
+
+/**
+ * @brief Switch the timer device of a clock event, disarming the previous one.
+ *
+ * A programmed expiry is moved to the new device.
+ *
+ * @param event clock event.
+ * @param device new timer device.
+ */
+extern void clockevent_set_device(clockevent_t* event, clockevent_device_t* device);
+
+/**
+ * @brief Install the handler of expired events.
+ *
+ * @param event clock event.
+ * @param handler handler of expired events.
+ * @param context context pointer passed to handler.
+ */
+extern void clockevent_set_handler(clockevent_t* event, clockevent_handler_t handler, void* context);
+
+/**
+ * @brief Program the next expiry, replacing the programmed one.
+ *
+ * An expiry in the past fires as soon as the device can.
+ *
+ * @param event clock event.
+ * @param expires time of the expiry on the clock of the clock event in nanoseconds.
+ * @return false if the clock event has no device.
+ */
+extern bool clockevent_program(clockevent_t* event, u64 expires);
+
+/**
+ * @brief Disarm the device, nothing is programmed afterwards.
+ *
+ * @param event clock event.
+ */
+extern void clockevent_stop(clockevent_t* event);
+
+/**
+ * @brief Timer interrupt of the device, called by its interrupt handler.
+ *
+ * Runs the handler once the programmed expiry is reached, re-arms the
+ * device for the rest of the wait otherwise.
+ *
+ * @param event clock event.
+ */
+extern void clockevent_interrupt(clockevent_t* event);
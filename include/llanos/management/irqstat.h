@@ -0,0 +1,84 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/management/log.h>
+#include <llanos/console/console.h>
+
+/* number of interrupt vectors counted */
+#define IRQSTAT_VECTOR_COUNT        256
+
+/* number of CPUs counted separately, higher CPU numbers are counted on the last one */
+#define IRQSTAT_MAX_CPUS            8
+
+/* bucket n of a histogram counts handler times of [2^n, 2^(n+1)) cycles (bucket 0 also counts 0) */
+#define IRQSTAT_HISTOGRAM_BUCKETS   32
+
+typedef struct irqstat_cpu_s irqstat_cpu_t;
+typedef struct irqstat_s irqstat_t;
+
+/**
+ * @brief Interrupt counters of one CPU.
+ *
+ * Only ever written by the CPU they belong to (with interrupts disabled),
+ * so they are updated without atomics.
+ *
+ * @member count number of interrupts of every vector.
+ * @member cycles total handler time of every vector in TSC cycles.
+ */
+struct irqstat_cpu_s {
+    u32 count[IRQSTAT_VECTOR_COUNT];
+    u64 cycles[IRQSTAT_VECTOR_COUNT];
+};
+
+/**
+ * @brief Interrupt statistics of the whole system.
+ *
+ * Counts and handler time are kept per CPU, the handler time histograms
+ * are shared by all CPUs and updated with relaxed atomic increments.
+ *
+ * @member cpus counters of every CPU.
+ * @member histograms log2 histogram of handler time (in TSC cycles) of every vector.
+ */
+struct irqstat_s {
+    irqstat_cpu_t cpus[IRQSTAT_MAX_CPUS];
+    u32 histograms[IRQSTAT_VECTOR_COUNT][IRQSTAT_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * @brief Reset all statistics to 0.
+ *
+ * @param stats statistics to reset.
+ */
+extern void irqstat_initialize(irqstat_t* stats);
+
+/**
+ * @brief Account one interrupt.
+ *
+ * @param stats statistics to update.
+ * @param cpu CPU the interrupt was handled on.
+ * @param vector vector of the interrupt.
+ * @param cycles TSC cycles the handler ran for.
+ */
+extern void irqstat_record(irqstat_t* stats, u32 cpu, u8 vector, u32 cycles);
+
+/**
+ * @brief Get the number of interrupts of a vector summed over all CPUs.
+ *
+ * @param stats statistics to look in.
+ * @param vector vector to count.
+ * @return the number of interrupts of vector.
+ */
+extern u64 irqstat_get_count(const irqstat_t* stats, u8 vector);
+
+/**
+ * @brief Print the statistics of every vector that was raised at least once.
+ *
+ * Every vector gets a line with its total count, average handler time and
+ * per-CPU counts, followed by a line with its non-empty histogram buckets
+ * (as "bucket:count", the bucket being the log2 of the handler cycles).
+ *
+ * @param stats statistics to print.
+ * @param console console to print on.
+ * @param level level to print at.
+ */
+extern void irqstat_dump(const irqstat_t* stats, console_t* console, log_level_t level);
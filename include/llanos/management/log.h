@@ -0,0 +1,178 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <stdarg.h>
+
+/* longest message a single record can hold, longer messages are truncated */
+#define LOG_MESSAGE_MAX_LENGTH  240
+
+typedef enum log_level_e log_level_t;
+typedef struct log_record_s log_record_t;
+typedef struct log_buffer_s log_buffer_t;
+
+/**
+ * @brief Source of record timestamps.
+ *
+ * @return the current time (in whatever unit the source counts in).
+ */
+typedef u64 (*log_clock_t)(void);
+
+/**
+ * @brief Source of the CPU number of a record.
+ *
+ * @return the number of the CPU the caller runs on.
+ */
+typedef u32 (*log_cpu_t)(void);
+
+/**
+ * @brief Consumer of drained records.
+ *
+ * @param context context pointer given to log_drain.
+ * @param record header of the record (timestamp, level, CPU and message length).
+ * @param message message of the record (record->length characters, not NUL terminated).
+ */
+typedef void (*log_drain_t)(void* context, const log_record_t* record, const char* message);
+
+enum log_level_e {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_FATAL
+};
+
+/**
+ * @brief Header of a record in the log ring, followed by its message.
+ *
+ * @member timestamp time the record was reserved at.
+ * @member size bytes of the ring used by the record (header, message and alignment).
+ * @member length number of characters in the message.
+ * @member cpu CPU the record was written on.
+ * @member level log_level_t of the record.
+ * @member state whether the record is still being written, committed or padding.
+ */
+struct log_record_s {
+    u64 timestamp;
+    u16 size;
+    u16 length;
+    u16 cpu;
+    u8 level;
+    u8 state;
+};
+
+/**
+ * @brief A multi-producer, single-consumer ring of log records.
+ *
+ * Producers reserve space by advancing head with a compare and swap, copy
+ * their message in and then commit the record. The consumer walks from
+ * tail to head and stops at the first record that is not committed yet,
+ * so records are never read half written. head and tail count bytes
+ * forever and are only reduced to an offset (masked by capacity - 1)
+ * when the ring is accessed.
+ *
+ * @member storage ring storage (aligned to 8 bytes).
+ * @member capacity size of storage in bytes (a power of two).
+ * @member head position the next record will be reserved at.
+ * @member tail position of the oldest record that has not been drained.
+ * @member dropped number of records dropped because the ring was full.
+ * @member draining whether or not a consumer is currently draining the ring.
+ * @member clock timestamp source (NULL to timestamp records with 0).
+ * @member cpu CPU number source (NULL to mark records with CPU 0).
+ */
+struct log_buffer_s {
+    u8* storage;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+    u32 dropped;
+    u32 draining;
+    log_clock_t clock;
+    log_cpu_t cpu;
+};
+
+/**
+ * @brief Initialize an empty log ring.
+ *
+ * @param log log to initialize.
+ * @param storage storage for the ring (aligned to 8 bytes).
+ * @param capacity size of storage in bytes (a power of two, at least 1 KiB).
+ * @param clock timestamp source (NULL if there is none yet).
+ * @param cpu CPU number source (NULL if there is none yet).
+ */
+extern void log_initialize(log_buffer_t* log, u8* storage, u32 capacity, log_clock_t clock, log_cpu_t cpu);
+
+/**
+ * @brief Reserve a record in the log for a message.
+ *
+ * Safe to call from any context, including interrupt handlers that preempt
+ * another producer. The record must be committed with log_commit once the
+ * message has been written; records after it are not drained until then.
+ *
+ * @param log log to reserve the record in.
+ * @param level level of the record.
+ * @param length number of characters of the message (clamped to LOG_MESSAGE_MAX_LENGTH).
+ * @return where to write the message, or NULL if the log is full (the record is counted as dropped).
+ */
+extern char* log_reserve(log_buffer_t* log, log_level_t level, size_t length);
+
+/**
+ * @brief Commit a reserved record so the consumer can drain it.
+ *
+ * @param log log the record was reserved in.
+ * @param message pointer returned by log_reserve.
+ */
+extern void log_commit(log_buffer_t* log, char* message);
+
+/**
+ * @brief Copy a message into the log as one record.
+ *
+ * @param log log to write the record to.
+ * @param level level of the record.
+ * @param message message to write (not NUL terminated).
+ * @param length number of characters in message (clamped to LOG_MESSAGE_MAX_LENGTH).
+ * @return false if the log was full and the record was dropped.
+ */
+extern bool log_write(log_buffer_t* log, log_level_t level, const char* message, size_t length);
+
+/**
+ * @brief Format a message into the log as one record.
+ *
+ * @param log log to write the record to.
+ * @param level level of the record.
+ * @param format format specifier for the message (refer to format_stream).
+ * @param ... additional arguments.
+ * @return false if the log was full and the record was dropped.
+ */
+extern bool log_printf(log_buffer_t* log, log_level_t level, const char* format, ...);
+
+/**
+ * @brief Format a message into the log as one record from an argument list.
+ *
+ * @param log log to write the record to.
+ * @param level level of the record.
+ * @param format format specifier for the message (refer to format_stream).
+ * @param arguments additional arguments.
+ * @return false if the log was full and the record was dropped.
+ */
+extern bool log_vprintf(log_buffer_t* log, log_level_t level, const char* format, va_list arguments);
+
+/**
+ * @brief Hand every committed record to a consumer and free its space.
+ *
+ * Only one consumer drains at a time; a call made while another drain is in
+ * progress (for example from an interrupt handler) returns 0 immediately.
+ *
+ * @param log log to drain.
+ * @param drain consumer of the records, called in the order the records were reserved.
+ * @param context context pointer passed to drain.
+ * @return number of records drained.
+ */
+extern u32 log_drain(log_buffer_t* log, log_drain_t drain, void* context);
+
+/**
+ * @brief Get the name of a log level.
+ *
+ * @param level level to name.
+ * @return a short lowercase name of the level ("info", "error", ...).
+ */
+extern const char* log_level_name(log_level_t level);
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* number of softirq vectors, a lower vector runs first */
+#define SOFTIRQ_VECTOR_COUNT        32
+
+/* number of CPUs with their own pending softirqs, higher CPU numbers share the last one */
+#define SOFTIRQ_MAX_CPUS            8
+
+/* rounds of newly raised softirqs run by one softirq_run before the rest is left pending */
+#define SOFTIRQ_MAX_RESTARTS        10
+
+/* vector running the scheduled tasklets */
+#define SOFTIRQ_TASKLET             0
+
+/* vector running the expired timers */
+#define SOFTIRQ_TIMER               1
+
+typedef struct softirq_action_entry_s softirq_action_entry_t;
+typedef struct softirq_cpu_s softirq_cpu_t;
+typedef struct softirq_s softirq_t;
+typedef struct tasklet_s tasklet_t;
+
+/**
+ * @brief Deferred work of a softirq vector or a tasklet.
+ *
+ * Runs with interrupts enabled.
+ *
+ * @param context context pointer the work was registered with.
+ */
+typedef void (*softirq_action_t)(void* context);
+
+/**
+ * @brief Source of the CPU number of the caller.
+ *
+ * @return the number of the CPU the caller runs on.
+ */
+typedef u32 (*softirq_cpu_source_t)(void);
+
+/**
+ * @brief Enable or disable interrupts on the calling CPU.
+ */
+typedef void (*softirq_interrupts_t)(void);
+
+/**
+ * @brief Action of a softirq vector.
+ *
+ * @member action action of the vector (NULL if raising the vector does nothing).
+ * @member context context pointer passed to action.
+ */
+struct softirq_action_entry_s {
+    softirq_action_t action;
+    void* context;
+};
+
+/**
+ * @brief Deferred work of one CPU.
+ *
+ * @member pending bit n is set while vector n is raised.
+ * @member running whether softirq_run is running on the CPU (so nested calls return at once).
+ * @member tasklets tasklets scheduled on the CPU, last scheduled first.
+ */
+struct softirq_cpu_s {
+    u32 pending;
+    bool running;
+    tasklet_t* tasklets;
+};
+
+/**
+ * @brief Bottom halves of the interrupt handlers.
+ *
+ * An interrupt handler (the top half) only acknowledges its device and
+ * raises a softirq vector or schedules a tasklet; the rest of the work
+ * runs in softirq_run on the way out of the interrupt, with interrupts
+ * enabled again. Work is raised on the CPU the handler runs on and runs
+ * there too.
+ *
+ * @member actions action of every vector.
+ * @member cpus deferred work of every CPU.
+ * @member cpu CPU number source (NULL when only CPU 0 runs).
+ * @member enable enables interrupts on the calling CPU.
+ * @member disable disables interrupts on the calling CPU.
+ */
+struct softirq_s {
+    softirq_action_entry_t actions[SOFTIRQ_VECTOR_COUNT];
+    softirq_cpu_t cpus[SOFTIRQ_MAX_CPUS];
+    softirq_cpu_source_t cpu;
+    softirq_interrupts_t enable;
+    softirq_interrupts_t disable;
+};
+
+/**
+ * @brief Work that is run once per scheduling, and never on two CPUs at a time.
+ *
+ * @member next next scheduled tasklet of the same CPU.
+ * @member function work of the tasklet.
+ * @member context context pointer passed to function.
+ * @member scheduled whether the tasklet is scheduled and has not started running yet.
+ * @member running whether function is running.
+ */
+struct tasklet_s {
+    tasklet_t* next;
+    softirq_action_t function;
+    void* context;
+    u32 scheduled;
+    u32 running;
+};
+
+/**
+ * @brief Initialize softirqs with no pending work and only the tasklet vector set up.
+ *
+ * @param softirq softirqs to initialize.
+ * @param cpu CPU number source (NULL when only CPU 0 runs).
+ * @param enable enables interrupts on the calling CPU.
+ * @param disable disables interrupts on the calling CPU.
+ */
+extern void softirq_initialize(
+        softirq_t* softirq,
+        softirq_cpu_source_t cpu,
+        softirq_interrupts_t enable,
+        softirq_interrupts_t disable);
+
+/**
+ * @brief Set the action of a softirq vector.
+ *
+ * @param softirq softirqs to register in.
+ * @param vector vector to set (SOFTIRQ_TASKLET is taken).
+ * @param action action of the vector.
+ * @param context context pointer passed to action.
+ */
+extern void softirq_register(softirq_t* softirq, u8 vector, softirq_action_t action, void* context);
+
+/**
+ * @brief Mark a softirq vector pending on the calling CPU.
+ *
+ * Safe to call from any context. Raising a vector that is already pending
+ * runs its action only once.
+ *
+ * @param softirq softirqs to raise in.
+ * @param vector vector to raise.
+ */
+extern void softirq_raise(softirq_t* softirq, u8 vector);
+
+/**
+ * @brief Run the pending softirqs of the calling CPU.
+ *
+ * Called with interrupts disabled (on interrupt exit), returns with
+ * interrupts disabled. Actions run with interrupts enabled. Vectors
+ * raised while the actions run are picked up again, up to
+ * SOFTIRQ_MAX_RESTARTS rounds, after which they stay pending for the next
+ * call. Returns at once when called while softirq_run is already running
+ * on the CPU (from an interrupt taken by an action).
+ *
+ * @param softirq softirqs to run.
+ * @return true if work is still pending.
+ */
+extern bool softirq_run(softirq_t* softirq);
+
+/**
+ * @brief Initialize a tasklet that is not scheduled.
+ *
+ * @param tasklet tasklet to initialize.
+ * @param function work of the tasklet.
+ * @param context context pointer passed to function.
+ */
+extern void tasklet_initialize(tasklet_t* tasklet, softirq_action_t function, void* context);
+
+/**
+ * @brief Schedule a tasklet on the calling CPU.
+ *
+ * Safe to call from any context, including the tasklet itself.
+ *
+ * @param softirq softirqs to run the tasklet from.
+ * @param tasklet tasklet to schedule.
+ * @return false if the tasklet was already scheduled (it still runs only once).
+ */
+extern bool tasklet_schedule(softirq_t* softirq, tasklet_t* tasklet);
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* bytes of FPU and SSE register state saved per thread (an fxsave area) */
+#define THREAD_FPU_STATE_SIZE       512
+
+/* smallest stack thread_create accepts */
+#define THREAD_MIN_STACK_SIZE       1024
+
+/* priorities, 0 is the highest, one bit of threads_s.ready_mask per priority */
+#define THREAD_PRIORITY_LEVELS      32
+#define THREAD_PRIORITY_HIGHEST     0
+#define THREAD_PRIORITY_LOWEST      (THREAD_PRIORITY_LEVELS - 1)
+#define THREAD_PRIORITY_DEFAULT     16
+
+/* calls of thread_tick a thread runs for before threads of its priority get their turn */
+#define THREAD_SLICE_TICKS          10
+
+typedef enum thread_state_e thread_state_t;
+typedef struct thread_context_s thread_context_t;
+typedef struct thread_s thread_t;
+typedef struct threads_s threads_t;
+
+/**
+ * @brief Work of a thread.
+ *
+ * The thread exits when it returns.
+ *
+ * @param argument argument given to thread_create.
+ */
+typedef void (*thread_function_t)(void* argument);
+
+/**
+ * @brief Build the first frame of a thread on its stack.
+ *
+ * Switching to the context afterwards calls entry(argument), which never
+ * returns.
+ *
+ * @param context context of the thread.
+ * @param stack_top end of the stack of the thread.
+ * @param entry first function of the thread.
+ * @param argument argument passed to entry.
+ */
+typedef void (*thread_prepare_t)(thread_context_t* context, void* stack_top, thread_function_t entry, void* argument);
+
+/**
+ * @brief Save the registers of the running thread and resume another thread.
+ *
+ * Returns once a later switch resumes the previous thread.
+ *
+ * @param previous context to save the running thread in.
+ * @param next context of the thread to resume.
+ */
+typedef void (*thread_switch_t)(thread_context_t* previous, thread_context_t* next);
+
+/**
+ * @brief Disable interrupts on the calling CPU.
+ *
+ * @return state to pass to the matching unlock.
+ */
+typedef u32 (*thread_lock_t)(void);
+
+/**
+ * @brief Restore the interrupt state.
+ *
+ * @param state state returned by the matching lock.
+ */
+typedef void (*thread_unlock_t)(u32 state);
+
+/**
+ * @brief Enable interrupts on the calling CPU, a thread starts with them enabled.
+ */
+typedef void (*thread_enable_t)(void);
+
+/**
+ * @brief Wait for an interrupt with interrupts enabled.
+ */
+typedef void (*thread_idle_t)(void);
+
+/**
+ * @brief Start calling thread_tick, as threads became ready while none was.
+ *
+ * Called with the threads locked.
+ *
+ * @param context context given to threads_set_slice.
+ */
+typedef void (*thread_slice_t)(void* context);
+
+/**
+ * @brief Life cycle of a thread.
+ */
+enum thread_state_e {
+    THREAD_READY,
+    THREAD_RUNNING,
+    THREAD_BLOCKED,
+    THREAD_DEAD
+};
+
+/**
+ * @brief Registers of a thread that is not running.
+ *
+ * Only the stack pointer is kept here, the other registers the switch has
+ * to preserve are pushed on the stack of the thread. The FPU state is only
+ * saved when another thread uses the FPU.
+ *
+ * @member fpu_state FPU and SSE registers, saved lazily.
+ * @member stack_pointer stack pointer of the thread while it is switched out.
+ * @member fpu_used whether fpu_state holds registers to restore (a thread starts with a clean FPU).
+ */
+struct thread_context_s {
+    u8 fpu_state[THREAD_FPU_STATE_SIZE] __attribute__((aligned(16)));
+    void* stack_pointer;
+    bool fpu_used;
+};
+
+/**
+ * @brief A kernel thread, running on a stack of its own.
+ *
+ * @member context registers of the thread while it is switched out.
+ * @member next next thread of the run queue, or of the joiners of a thread while blocked.
+ * @member threads threads the thread belongs to.
+ * @member function work of the thread.
+ * @member argument argument passed to function.
+ * @member joiners threads blocked in thread_join until the thread exits.
+ * @member name name of the thread.
+ * @member id number of the thread, the boot thread is 0.
+ * @member priority priority of the thread, THREAD_PRIORITY_HIGHEST runs first.
+ * @member slice_left calls of thread_tick left in the time slice of the thread.
+ * @member state life cycle state.
+ */
+struct thread_s {
+    thread_context_t context;
+    thread_t* next;
+    threads_t* threads;
+    thread_function_t function;
+    void* argument;
+    thread_t* joiners;
+    const char* name;
+    u32 id;
+    u32 priority;
+    u32 slice_left;
+    thread_state_t state;
+};
+
+/**
+ * @brief Kernel threads of a CPU, scheduled by priority.
+ *
+ * The highest priority ready thread runs. Threads of one priority take
+ * turns, first in, first out, each for a time slice. Every priority has a
+ * run queue of its own and a bit in ready_mask, set while the queue is not
+ * empty, so queuing a thread and finding the next one to run take the same
+ * time however many threads there are.
+ *
+ * A thread that must give up the CPU, when its slice ended or a higher
+ * priority thread became ready, is only switched out by thread_preempt,
+ * which the interrupt exit path calls.
+ *
+ * @member current running thread.
+ * @member ready_head first thread of the run queue of each priority.
+ * @member ready_tail last thread of the run queue of each priority.
+ * @member ready_mask bit p set while the run queue of priority p is not empty.
+ * @member prepare builds the first frame of a thread.
+ * @member switch_to switches threads.
+ * @member lock disables interrupts.
+ * @member unlock restores interrupts.
+ * @member enable enables interrupts for a thread that starts.
+ * @member idle waits for an interrupt.
+ * @member slice starts the calls of thread_tick (NULL when they never stop).
+ * @member slice_context context passed to slice.
+ * @member next_id number of the next thread created.
+ * @member need_resched whether thread_preempt has to switch the running thread out.
+ */
+struct threads_s {
+    thread_t* current;
+    thread_t* ready_head[THREAD_PRIORITY_LEVELS];
+    thread_t* ready_tail[THREAD_PRIORITY_LEVELS];
+    u32 ready_mask;
+    thread_prepare_t prepare;
+    thread_switch_t switch_to;
+    thread_lock_t lock;
+    thread_unlock_t unlock;
+    thread_enable_t enable;
+    thread_idle_t idle;
+    thread_slice_t slice;
+    void* slice_context;
+    u32 next_id;
+    bool need_resched;
+};
+
+/**
+ * @brief Initialize the threads of a CPU, with the calling flow as the running boot thread.
+ *
+ * The boot thread keeps the stack it runs on and THREAD_PRIORITY_DEFAULT.
+ * It may yield and join, but must not exit.
+ *
+ * @param threads threads to initialize.
+ * @param boot thread to describe the calling flow with.
+ * @param prepare builds the first frame of a thread.
+ * @param switch_to switches threads.
+ * @param lock disables interrupts.
+ * @param unlock restores interrupts.
+ * @param enable enables interrupts.
+ * @param idle waits for an interrupt (when every thread is blocked).
+ */
+extern void threads_initialize(
+        threads_t* threads,
+        thread_t* boot,
+        thread_prepare_t prepare,
+        thread_switch_t switch_to,
+        thread_lock_t lock,
+        thread_unlock_t unlock,
+        thread_enable_t enable,
+        thread_idle_t idle);
+
+/**
+ * @brief Set the hook starting the calls of thread_tick.
+ *
+ * thread_tick tells when the calls may stop, slice is called once they are
+ * needed again. Without a hook thread_tick has to be called all along.
+ *
+ * @param threads threads to set the hook of.
+ * @param slice hook starting the calls of thread_tick.
+ * @param context context passed to slice.
+ */
+extern void threads_set_slice(threads_t* threads, thread_slice_t slice, void* context);
+
+/**
+ * @brief Create a thread and queue it to run.
+ *
+ * The thread and its stack must stay valid until thread_join returns.
+ *
+ * A thread of a higher priority than the running one runs from the next
+ * thread_preempt on.
+ *
+ * @param threads threads to add to.
+ * @param thread thread to create.
+ * @param name name of the thread.
+ * @param priority priority of the thread, up to THREAD_PRIORITY_LOWEST.
+ * @param stack stack of the thread.
+ * @param stack_size size of the stack in bytes.
+ * @param function work of the thread.
+ * @param argument argument passed to function.
+ * @return false if the stack is smaller than THREAD_MIN_STACK_SIZE or the priority is out of range.
+ */
+extern bool thread_create(
+        threads_t* threads,
+        thread_t* thread,
+        const char* name,
+        u32 priority,
+        void* stack,
+        size_t stack_size,
+        thread_function_t function,
+        void* argument);
+
+/**
+ * @brief Get the running thread.
+ *
+ * @param threads threads of the calling CPU.
+ * @return the running thread.
+ */
+static inline thread_t* thread_current(const threads_t* threads) {
+    return threads->current;
+}
+
+/**
+ * @brief Let the ready threads of the same or a higher priority run first.
+ *
+ * The running thread is queued behind the threads of its priority, lower
+ * priority threads do not run.
+ *
+ * @param threads threads of the calling CPU.
+ */
+extern void thread_yield(threads_t* threads);
+
+/**
+ * @brief Change the priority of a thread that did not exit.
+ *
+ * @param threads threads of the calling CPU.
+ * @param thread thread to change.
+ * @param priority new priority, up to THREAD_PRIORITY_LOWEST.
+ * @return false if the priority is out of range.
+ */
+extern bool thread_set_priority(threads_t* threads, thread_t* thread, u32 priority);
+
+/**
+ * @brief Account a tick of the time slice of the running thread.
+ *
+ * Once the slice ended and a thread of the same priority is ready, the
+ * next thread_preempt switches.
+ *
+ * @param threads threads of the calling CPU.
+ * @return false while no other thread is ready, the calls may stop until the slice hook is called.
+ */
+extern bool thread_tick(threads_t* threads);
+
+/**
+ * @brief Switch the running thread out if it has to give up the CPU.
+ *
+ * Called on the way out of interrupts, with interrupts disabled. A thread
+ * switched out here returns from it when it runs again.
+ *
+ * @param threads threads of the calling CPU.
+ */
+extern void thread_preempt(threads_t* threads);
+
+/**
+ * @brief End the running thread and wake the threads joining it.
+ *
+ * Does not return. The stack of the thread is no longer used once a
+ * joiner runs.
+ *
+ * @param threads threads of the calling CPU.
+ */
+extern void thread_exit(threads_t* threads);
+
+/**
+ * @brief Wait until a thread exited.
+ *
+ * Returns at once if the thread already exited or is the running thread.
+ *
+ * @param threads threads of the calling CPU.
+ * @param thread thread to wait for.
+ */
+extern void thread_join(threads_t* threads, thread_t* thread);
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* every level of the wheel has 1 << TIMER_WHEEL_BITS slots */
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+
+/* number of levels, a slot of a level spans all the slots of the level below */
+#define TIMER_WHEEL_LEVELS      5
+
+/* furthest the wheel reaches in ticks, later timers wait at the far end and are placed again from there */
+#define TIMER_WHEEL_MAX_DELTA   ((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/* next expiry of a wheel without timers */
+#define TIMER_NONE              0xffffffffffffffffULL
+
+typedef struct timer_s timer_t;
+typedef struct timer_wheel_s timer_wheel_t;
+
+/**
+ * @brief Work of an expired timer.
+ *
+ * Runs from timer_wheel_run with the wheel unlocked, so it may add, modify
+ * or cancel timers, itself included.
+ *
+ * @param context context pointer of the timer.
+ */
+typedef void (*timer_function_t)(void* context);
+
+/**
+ * @brief Lock a timer wheel against interrupts (and other CPUs).
+ *
+ * @return state to pass to the matching unlock.
+ */
+typedef u32 (*timer_lock_t)(void);
+
+/**
+ * @brief Unlock a timer wheel.
+ *
+ * @param state state returned by the matching lock.
+ */
+typedef void (*timer_unlock_t)(u32 state);
+
+/**
+ * @brief Arm the timer interrupt for the earliest tick the wheel has work at.
+ *
+ * Called with the wheel locked.
+ *
+ * @param context context pointer given to timer_wheel_initialize.
+ * @param expires tick timer_wheel_run has to be called at (it may already be due).
+ */
+typedef void (*timer_rearm_t)(void* context, u64 expires);
+
+/**
+ * @brief A timer, runs its function once at its expiry unless cancelled.
+ *
+ * @member next next timer of the same slot.
+ * @member previous link pointing at the timer (NULL while the timer is not pending).
+ * @member expires tick the timer expires at.
+ * @member function work of the timer.
+ * @member context context pointer passed to function.
+ */
+struct timer_s {
+    timer_t* next;
+    timer_t** previous;
+    u64 expires;
+    timer_function_t function;
+    void* context;
+};
+
+/**
+ * @brief Hierarchical timing wheel.
+ *
+ * A timer lands in the first level whose span covers its expiry and in the
+ * slot of that level its expiry falls in, so adding and cancelling are a
+ * list push and unlink whatever the number of timers. Level 0 has one slot
+ * per tick; when the wheel enters a slot of a higher level, its timers are
+ * cascaded into the levels below. Most timers are cancelled long before
+ * they would ever be cascaded. Ticks without work are skipped, so a long
+ * idle period costs only the cascades of the slots holding timers.
+ *
+ * @member slots timers of every slot of every level.
+ * @member clock next tick to run.
+ * @member programmed tick the timer interrupt is armed for (TIMER_NONE if none).
+ * @member count number of pending timers.
+ * @member lock locks the wheel (NULL if only used from one context).
+ * @member unlock unlocks the wheel.
+ * @member rearm arms the timer interrupt (NULL if timer_wheel_run is called by other means).
+ * @member context context pointer passed to rearm.
+ */
+struct timer_wheel_s {
+    timer_t* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    u64 clock;
+    u64 programmed;
+    u32 count;
+    timer_lock_t lock;
+    timer_unlock_t unlock;
+    timer_rearm_t rearm;
+    void* context;
+};
+
+/**
+ * @brief Initialize a timer wheel without timers.
+ *
+ * @param wheel wheel to initialize.
+ * @param now current tick.
+ * @param lock locks the wheel (NULL if only used from one context).
+ * @param unlock unlocks the wheel.
+ * @param rearm arms the timer interrupt (NULL if none).
+ * @param context context pointer passed to rearm.
+ */
+extern void timer_wheel_initialize(
+        timer_wheel_t* wheel,
+        u64 now,
+        timer_lock_t lock,
+        timer_unlock_t unlock,
+        timer_rearm_t rearm,
+        void* context);
+
+/**
+ * @brief Initialize a timer that is not pending.
+ *
+ * @param timer timer to initialize.
+ * @param function work of the timer.
+ * @param context context pointer passed to function.
+ */
+extern void timer_initialize(timer_t* timer, timer_function_t function, void* context);
+
+/**
+ * @brief Check whether a timer is waiting to expire.
+ *
+ * @param timer timer to check.
+ * @return true if the timer is pending.
+ */
+static inline bool timer_pending(const timer_t* timer) {
+    return timer->previous != NULL;
+}
+
+/**
+ * @brief Add a timer that is not pending.
+ *
+ * A timer whose expiry already passed expires on the next run.
+ *
+ * @param wheel wheel to add to.
+ * @param timer timer to add.
+ * @param expires tick the timer expires at.
+ * @return false if the timer was already pending (it is left as is).
+ */
+extern bool timer_add(timer_wheel_t* wheel, timer_t* timer, u64 expires);
+
+/**
+ * @brief Cancel a timer.
+ *
+ * Does not wait for the function of the timer if it is running.
+ *
+ * @param wheel wheel the timer was added to.
+ * @param timer timer to cancel.
+ * @return true if the timer was pending.
+ */
+extern bool timer_cancel(timer_wheel_t* wheel, timer_t* timer);
+
+/**
+ * @brief Move the expiry of a timer, adding it if it is not pending.
+ *
+ * @param wheel wheel the timer belongs to.
+ * @param timer timer to move.
+ * @param expires tick the timer expires at.
+ * @return true if the timer was pending.
+ */
+extern bool timer_mod(timer_wheel_t* wheel, timer_t* timer, u64 expires);
+
+/**
+ * @brief Run the timers expired up to a tick, then rearm for the next one.
+ *
+ * Meant to run in a bottom half raised by the timer interrupt. Each timer
+ * function runs with the wheel unlocked.
+ *
+ * @param wheel wheel to run.
+ * @param now current tick.
+ * @return number of timers run.
+ */
+extern u32 timer_wheel_run(timer_wheel_t* wheel, u64 now);
+
+/**
+ * @brief Get the earliest tick the wheel has work at.
+ *
+ * Exact for timers in the next TIMER_WHEEL_SLOTS ticks, for later timers
+ * this is the tick their slot is cascaded at, which comes first.
+ *
+ * @param wheel wheel to look at.
+ * @return the tick to run the wheel at, TIMER_NONE without timers.
+ */
+extern u64 timer_wheel_next_expiry(timer_wheel_t* wheel);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* longest text produced by the conversions below (no NUL terminator is written) */
+#define CONVERT_U32_MAX_DECIMAL_DIGITS  10
+#define CONVERT_U64_MAX_DECIMAL_DIGITS  20
+#define CONVERT_U64_MAX_BINARY_DIGITS   64
+
+/* 17 significant digits are enough to round trip any double */
+#define CONVERT_DOUBLE_MAX_DIGITS       17
+
+/* most significant digits of an exact conversion, enough for any field of format_stream */
+#define CONVERT_DECIMAL_MAX_DIGITS      64
+
+typedef struct convert_decimal_s convert_decimal_t;
+
+/**
+ * @brief Decimal form of a floating point magnitude: d1.d2d3...dn * 10^exponent.
+ *
+ * @member digits significant digits as characters (not NUL terminated).
+ * @member length number of digits (0 when the value is zero).
+ * @member exponent decimal exponent of the first digit (0 when the value is zero).
+ */
+struct convert_decimal_s {
+    char digits[CONVERT_DECIMAL_MAX_DIGITS];
+    u8 length;
+    s32 exponent;
+};
+
+/**
+ * @brief Convert a 32-bit unsigned integer to decimal text.
+ *
+ * Digits are produced two at a time from a digit-pair table, front to back,
+ * so no reversal pass is needed. Only 32-bit divisions by constants are used.
+ *
+ * @param buffer destination of at least CONVERT_U32_MAX_DECIMAL_DIGITS characters.
+ * @param value value to convert.
+ * @return number of characters written.
+ */
+extern size_t convert_u32_to_decimal(char* buffer, u32 value);
+
+/**
+ * @brief Convert a 64-bit unsigned integer to decimal text.
+ *
+ * Values that fit in 32 bits take the convert_u32_to_decimal path. Larger
+ * values are reduced four digits at a time with 32-bit divisions, so no
+ * 64-bit (software) division is ever performed.
+ *
+ * @param buffer destination of at least CONVERT_U64_MAX_DECIMAL_DIGITS characters.
+ * @param value value to convert.
+ * @return number of characters written.
+ */
+extern size_t convert_u64_to_decimal(char* buffer, u64 value);
+
+/**
+ * @brief Convert a 64-bit unsigned integer to text in a power of two base.
+ *
+ * Digits are extracted with shifts and masks only.
+ *
+ * @param buffer destination of at least CONVERT_U64_MAX_BINARY_DIGITS characters.
+ * @param value value to convert.
+ * @param bits_per_digit 1 for binary, 3 for octal, 4 for hex.
+ * @param uppercase use uppercase letters for digits above 9.
+ * @return number of characters written.
+ */
+extern size_t convert_u64_to_power_of_two_base(char* buffer, u64 value, u8 bits_per_digit, bool uppercase);
+
+/**
+ * @brief Convert a double to decimal digits that read back as the same double.
+ *
+ * The digits are found with the Grisu2 algorithm: the value and its rounding
+ * interval are scaled by a cached 64-bit power of ten and the digits are
+ * generated with integer arithmetic, so the work is bounded by the 17 digits
+ * of a double no matter the value (no repeated multiplication by 10.0).
+ * The digits always round trip and are the shortest for almost all values;
+ * without a Grisu3 style fallback about 0.1% of doubles get a digit more
+ * than needed. The sign of the value is ignored.
+ *
+ * @param decimal destination for the digits and exponent.
+ * @param value finite value to convert.
+ */
+extern void convert_double_to_shortest_decimal(convert_decimal_t* decimal, double value);
+
+/**
+ * @brief Convert a double to its exact digits rounded to a number of significant digits.
+ *
+ * The exact binary value is expanded with big integer arithmetic and rounded
+ * once, half to even, so no digit is rounded twice (2.675 is 2.67499...
+ * and keeps its 7 when rounded to 3 digits). The sign of the value is ignored.
+ *
+ * @param decimal destination for the digits and exponent (trailing zeros are dropped).
+ * @param value finite value to convert.
+ * @param digits number of significant digits (clamped to CONVERT_DECIMAL_MAX_DIGITS).
+ */
+extern void convert_double_to_significant_decimal(convert_decimal_t* decimal, double value, s32 digits);
+
+/**
+ * @brief Convert a double to its exact digits rounded to a number of fractional digits.
+ *
+ * Rounds like convert_double_to_significant_decimal, at the digit of
+ * 10^-fraction instead of after a number of significant digits, so values
+ * below half of that digit come out as zero.
+ *
+ * @param decimal destination for the digits and exponent (trailing zeros are dropped).
+ * @param value finite value to convert.
+ * @param fraction number of digits after the decimal point.
+ */
+extern void convert_double_to_fixed_decimal(convert_decimal_t* decimal, double value, s32 fraction);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <stdarg.h>
+
+/**
+ * @brief Destination for formatted output.
+ *
+ * A sink is handed whole spans of formatted output: a run of literal text
+ * from the format string, the padding of a field or a complete converted
+ * field. A sink never receives output one character at a time.
+ *
+ * @param context context pointer given to the formatting function.
+ * @param span pointer to the first character of the span (not NUL terminated).
+ * @param length number of characters in the span.
+ */
+typedef void (*format_sink_t)(void* context, const char* span, size_t length);
+
+/**
+ * @brief Format a string and hand the output to a sink.
+ *
+ * A format specifier follows this prototype: %[flags][width][.precision][length]specifier
+ *      where the specifier character at the end is the most significant component.
+ *
+ *      | specifier     | output                        | example   |
+ *      |---------------|-------------------------------|-----------|
+ *      | d             | signed integer                | -239      |
+ *      | u             | unsigned integer              | 234       |
+ *      | o             | unsigned octal                | 610       |
+ *      | x             | unsigned hex                  | 7aa       |
+ *      | X             | unsigned hex (uppercase)      | 7AA       |
+ *      | b             | unsigned binary               | 1101001   |
+ *      | f             | floating point                | 32.25     |
+ *      | e             | scientific notation           | 2.25e-3   |
+ *      | c             | character                     | a         |
+ *      | s             | string                        | abc       |
+ *      | S             | string with preceeding length | abc       |
+ *      | %             | the percent character         | %         |
+ *
+ *      | flag          | meaning                                               |
+ *      |---------------|-------------------------------------------------------|
+ *      | -             | left justify the field within its width               |
+ *      | 0             | pad numbers with zeros instead of spaces              |
+ *      | +             | always print a sign for signed numbers                |
+ *      | (space)       | print a space in place of a positive sign             |
+ *
+ *      width and precision are either a decimal number or `*` to take the value
+ *      from the argument list (as an int). For integers the precision is the
+ *      minimum number of digits, for strings the maximum number of characters
+ *      and for floating point numbers the number of fractional digits (at most 40).
+ *
+ *      Floating point numbers without a precision are printed with digits that
+ *      read back as the same double (the shortest for almost all values, see
+ *      convert_double_to_shortest_decimal). With a precision the exact
+ *      binary value is rounded once, half to even (%.2f of 2.675 is 2.67, %.0f
+ *      of 0.5 is 0). %f falls back to scientific notation for magnitudes of
+ *      10^19 and above (and below 10^-20 when no precision is given). Infinities
+ *      and NaNs print as inf and nan.
+ *
+ *      | length        | integer argument type         |
+ *      |---------------|-------------------------------|
+ *      | (none)        | int / unsigned int            |
+ *      | hh            | char                          |
+ *      | h             | short                         |
+ *      | l             | long                          |
+ *      | ll            | long long (u64 / s64)         |
+ *      | z             | size_t                        |
+ *
+ * @param sink sink that receives every formatted span in order.
+ * @param context context pointer passed to the sink.
+ * @param format format specifier for the string.
+ * @param arguments additional arguments.
+ * @return number of characters handed to the sink, or -1 if the format
+ *      string contains an invalid specifier (output up to the invalid
+ *      specifier has already been handed to the sink).
+ */
+extern s32 format_stream(format_sink_t sink, void* context, const char* format, va_list arguments);
+
+/**
+ * @brief Format a string into a caller supplied buffer.
+ *
+ * The buffer is always NUL terminated when size is greater than zero. Output that
+ * does not fit is discarded, but still counted in the return value so the caller
+ * can detect truncation.
+ *
+ * @param buffer destination buffer (may be NULL when size is zero).
+ * @param size size of the destination buffer in bytes.
+ * @param format format specifier for the string (refer to format_stream).
+ * @param arguments additional arguments.
+ * @return number of characters the full output needs (excluding the NUL terminator),
+ *      or -1 if the format string is invalid.
+ */
+extern s32 kvsnprintf(char* buffer, size_t size, const char* format, va_list arguments);
+
+/**
+ * @brief Format a string into a caller supplied buffer.
+ *
+ * @param buffer destination buffer (may be NULL when size is zero).
+ * @param size size of the destination buffer in bytes.
+ * @param format format specifier for the string (refer to format_stream).
+ * @param ... additional arguments.
+ * @return number of characters the full output needs (excluding the NUL terminator),
+ *      or -1 if the format string is invalid.
+ */
+extern s32 ksnprintf(char* buffer, size_t size, const char* format, ...);
@@ -9,4 +9,18 @@
  * @param value value to set at each byte of memory.
  * @param length how may bytes to set to the given value.
  */
-extern void memory_set_value(u8* dest, u8 value, u32 length);
\ No newline at end of file
+extern void memory_set_value(u8* dest, u8 value, u32 length);
+
+/**
+ * Copy length bytes of memory from source to destination.
+ *
+ * When both pointers share the same word alignment the copy is performed
+ * a 32-bit word at a time, so a run of characters or VGA cells is moved
+ * with a handful of wide stores instead of one store per byte. The source
+ * and destination must not overlap.
+ *
+ * @param dest destination memory pointer to start copying to.
+ * @param source source memory pointer to start copying from.
+ * @param length how many bytes to copy.
+ */
+extern void memory_copy(u8* dest, const u8* source, u32 length);
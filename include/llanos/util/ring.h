@@ -0,0 +1,81 @@
+#pragma once
+
+#include <llanos/types.h>
+
+typedef struct ring_s ring_t;
+
+/**
+ * @brief A byte ring buffer with one producer and one consumer.
+ *
+ * head and tail count every byte ever pushed and popped and are only
+ * reduced to a position when the buffer is indexed, so head - tail is the
+ * number of queued bytes even after the counters wrap.
+ *
+ * @member buffer storage of the bytes.
+ * @member size number of bytes buffer holds (a power of two).
+ * @member head number of bytes pushed.
+ * @member tail number of bytes popped.
+ */
+struct ring_s {
+    u8* buffer;
+    u32 size;
+    u32 head;
+    u32 tail;
+};
+
+/**
+ * @brief Initialize an empty ring.
+ *
+ * @param ring ring to initialize.
+ * @param buffer storage of the bytes.
+ * @param size number of bytes buffer holds (a power of two).
+ */
+extern void ring_initialize(ring_t* ring, u8* buffer, u32 size);
+
+/**
+ * @brief Get the number of bytes queued on a ring.
+ *
+ * @param ring ring to check.
+ * @return the bytes pushed and not popped yet.
+ */
+static inline u32 ring_count(const ring_t* ring) {
+    return ring->head - ring->tail;
+}
+
+/**
+ * @brief Check whether a ring has no bytes queued.
+ *
+ * @param ring ring to check.
+ * @return true if there is nothing to pop.
+ */
+static inline bool ring_is_empty(const ring_t* ring) {
+    return ring->head == ring->tail;
+}
+
+/**
+ * @brief Check whether a ring has no room left.
+ *
+ * @param ring ring to check.
+ * @return true if a push would fail.
+ */
+static inline bool ring_is_full(const ring_t* ring) {
+    return ring_count(ring) >= ring->size;
+}
+
+/**
+ * @brief Queue a byte on a ring.
+ *
+ * @param ring ring to queue the byte on.
+ * @param byte byte to queue.
+ * @return false if the ring was full and the byte was not queued.
+ */
+extern bool ring_push(ring_t* ring, u8 byte);
+
+/**
+ * @brief Take the oldest byte off a ring.
+ *
+ * @param ring ring to take the byte from.
+ * @param byte where to store the byte.
+ * @return false if the ring was empty.
+ */
+extern bool ring_pop(ring_t* ring, u8* byte);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <llanos/types.h>
+
+/* glyphs are 5 pixels wide and 7 pixels high, one byte per row with the leftmost pixel in bit 4 */
+#define FONT_GLYPH_WIDTH        5
+#define FONT_GLYPH_HEIGHT       7
+
+/* printable ASCII is covered, everything else is drawn as FONT_REPLACEMENT_CHARACTER */
+#define FONT_FIRST_CHARACTER    0x20
+#define FONT_LAST_CHARACTER     0x7e
+#define FONT_REPLACEMENT_CHARACTER '?'
+
+/**
+ * @brief Get the bitmap of a character.
+ *
+ * @param character character to look up.
+ * @return FONT_GLYPH_HEIGHT rows of the glyph of the character.
+ */
+extern const u8* font_get_glyph(char character);
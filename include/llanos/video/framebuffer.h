@@ -0,0 +1,124 @@
+#pragma once
+
+#include <llanos/types.h>
+#include <llanos/video/vga.h>
+
+/* every character is drawn in a cell of 8x16 pixels (128x48 cells at 1024x768) */
+#define FRAMEBUFFER_CELL_WIDTH          8
+#define FRAMEBUFFER_CELL_HEIGHT         16
+
+/* number of rasterised glyphs kept per console (a power of two) */
+#define FRAMEBUFFER_GLYPH_CACHE_SIZE    64
+
+/* only 32 bits per pixel framebuffers are supported */
+#define FRAMEBUFFER_BITS_PER_PIXEL      32
+
+typedef struct framebuffer_info_s framebuffer_info_t;
+typedef struct framebuffer_glyph_s framebuffer_glyph_t;
+typedef struct framebuffer_console_s framebuffer_console_t;
+
+/**
+ * @brief Description of a linear RGB framebuffer (as handed over by the boot loader).
+ *
+ * @member address address of the first pixel.
+ * @member pitch number of bytes from the start of one pixel row to the next.
+ * @member width number of pixels per row.
+ * @member height number of pixel rows.
+ * @member bpp bits per pixel.
+ * @member red_position bit position of the red channel in a pixel.
+ * @member red_size number of bits of the red channel.
+ * @member green_position bit position of the green channel in a pixel.
+ * @member green_size number of bits of the green channel.
+ * @member blue_position bit position of the blue channel in a pixel.
+ * @member blue_size number of bits of the blue channel.
+ */
+struct framebuffer_info_s {
+    u8* address;
+    u32 pitch;
+    u32 width;
+    u32 height;
+    u8 bpp;
+    u8 red_position;
+    u8 red_size;
+    u8 green_position;
+    u8 green_size;
+    u8 blue_position;
+    u8 blue_size;
+};
+
+/**
+ * @brief A glyph rasterised in one foreground and background color.
+ *
+ * @member key character and colors the pixels were rasterised for (0 when the entry is unused).
+ * @member pixels FRAMEBUFFER_CELL_HEIGHT rows of FRAMEBUFFER_CELL_WIDTH pixels.
+ */
+struct framebuffer_glyph_s {
+    u32 key;
+    u32 pixels[FRAMEBUFFER_CELL_HEIGHT * FRAMEBUFFER_CELL_WIDTH];
+};
+
+/**
+ * @brief A text console drawn on a linear framebuffer.
+ *
+ * Characters are drawn by copying whole rows of a pre-rasterised glyph, so
+ * printing never tests individual font bits once a glyph is in the cache.
+ * Scrolling and clearing move entire pixel rows.
+ *
+ * @member address address of the first pixel.
+ * @member pitch number of bytes from the start of one pixel row to the next.
+ * @member width number of pixels per row.
+ * @member height number of pixel rows.
+ * @member columns number of character columns.
+ * @member rows number of character rows.
+ * @member cursor_row row the next character is drawn in.
+ * @member cursor_col column the next character is drawn in.
+ * @member vector whether row copies and fills use 128-bit vector instructions.
+ * @member palette pixel value of every vga_color_t.
+ * @member glyph_cache direct mapped cache of rasterised glyphs.
+ */
+struct framebuffer_console_s {
+    u8* address;
+    u32 pitch;
+    u32 width;
+    u32 height;
+    size_t columns;
+    size_t rows;
+    size_t cursor_row;
+    size_t cursor_col;
+    bool vector;
+    u32 palette[16];
+    framebuffer_glyph_t glyph_cache[FRAMEBUFFER_GLYPH_CACHE_SIZE];
+};
+
+/**
+ * @brief Initialize a framebuffer console and clear the screen.
+ *
+ * @param console console to initialize.
+ * @param info framebuffer to draw on.
+ * @param vector whether 128-bit vector instructions (SSE2 on x86) may be used.
+ * @return false if the framebuffer is not FRAMEBUFFER_BITS_PER_PIXEL or smaller than one cell.
+ */
+extern bool framebuffer_console_initialize(framebuffer_console_t* console, const framebuffer_info_t* info, bool vector);
+
+/**
+ * @brief Clear the screen to black and move the cursor to the top left.
+ *
+ * @param console console to clear.
+ */
+extern void framebuffer_console_clear(framebuffer_console_t* console);
+
+/**
+ * @brief Draw characters at the cursor, scrolling up when the cursor passes the last row.
+ *
+ * @param console console to draw on.
+ * @param color_fg foreground color of the characters.
+ * @param color_bg background color of the characters.
+ * @param buffer characters to draw ('\n' moves to the next row, not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void framebuffer_console_write(
+        framebuffer_console_t* console,
+        vga_color_t color_fg,
+        vga_color_t color_bg,
+        const char* buffer,
+        size_t length);
@@ -1,10 +1,19 @@
 #pragma once
 
 #include <llanos/types.h>
+#include <stdarg.h>
 
 typedef enum vga_color_e vga_color_t;
 typedef struct vga_s vga_t;
 
+/**
+ * @brief Move the hardware cursor of a VGA.
+ *
+ * @param position cell (row * terminal_width + column) to show the cursor at;
+ *      terminal_width * terminal_height moves it off the screen.
+ */
+typedef void (*vga_cursor_t)(u16 position);
+
 enum vga_color_e {
     VGA_COLOR_BLACK = 0,
     VGA_COLOR_BLUE,
@@ -24,12 +33,44 @@ enum vga_color_e {
     VGA_COLOR_WHITE
 };
 
+/**
+ * @brief A VGA text terminal.
+ *
+ * @member buffer_address hardware (or test) buffer the terminal is displayed from.
+ * @member shadow_address cached RAM copy of the terminal that is written to instead
+ *      of buffer_address (NULL to write straight to buffer_address).
+ * @member dirty_row_begin first row of the shadow that differs from the buffer.
+ * @member dirty_row_end one past the last row of the shadow that differs from the
+ *      buffer (the shadow is clean when dirty_row_begin >= dirty_row_end).
+ * @member history_address ring of terminal_width wide rows holding the scrollback
+ *      (NULL when the terminal wraps to the top instead of scrolling).
+ * @member history_rows number of rows in the history ring.
+ * @member history_top ring index of the row shown at the top of the live screen.
+ * @member history_used number of ring rows holding output (at least terminal_height).
+ * @member view_offset number of rows the view is scrolled back from the live screen.
+ * @member cursor_row row the next character is written to.
+ * @member cursor_col column the next character is written to.
+ * @member terminal_width number of columns of the terminal.
+ * @member terminal_height number of rows of the terminal.
+ * @member set_cursor moves the hardware cursor (NULL when there is none).
+ * @member cursor_position position last handed to set_cursor.
+ */
 struct vga_s {
     u16* buffer_address;
+    u16* shadow_address;
+    size_t dirty_row_begin;
+    size_t dirty_row_end;
+    u16* history_address;
+    size_t history_rows;
+    size_t history_top;
+    size_t history_used;
+    size_t view_offset;
     size_t cursor_row;
     size_t cursor_col;
     size_t terminal_width;
     size_t terminal_height;
+    vga_cursor_t set_cursor;
+    u16 cursor_position;
 };
 
 /**
@@ -72,6 +113,72 @@ extern u16* vga_get_default_buffer_address(void);
  */
 extern void vga_initialize(vga_t* vga, u16* buffer_address, size_t width, size_t height);
 
+/**
+ * @brief Write to a shadow buffer in normal RAM instead of the VGA buffer.
+ *
+ * The current contents of the VGA buffer are copied into the shadow once.
+ * From then on writes only touch the shadow and mark their rows as dirty,
+ * and vga_flush copies the dirty rows to the VGA buffer in one bulk copy.
+ * Video memory is uncached, so this turns thousands of scattered 16-bit
+ * stores into a few wide copies.
+ *
+ * @param vga vga to attach the shadow to.
+ * @param shadow_address buffer of terminal_width * terminal_height entries.
+ */
+extern void vga_attach_shadow(vga_t* vga, u16* shadow_address);
+
+/**
+ * @brief Scroll instead of wrapping to the top, keeping a scrollback history.
+ *
+ * The terminal contents move into a ring of rows in normal RAM that takes
+ * the place of the shadow buffer. When output reaches the bottom row the
+ * ring's head moves by one row and only the new row is cleared, so scrolling
+ * never moves the rows themselves. The screen is redrawn from the ring by
+ * vga_flush. Output older than history_rows rows is overwritten.
+ *
+ * @param vga vga to attach the history to.
+ * @param history_address buffer of terminal_width * history_rows entries.
+ * @param history_rows number of rows of history (at least terminal_height).
+ */
+extern void vga_attach_history(vga_t* vga, u16* history_address, size_t history_rows);
+
+/**
+ * @brief Move the view through the scrollback history.
+ *
+ * The view is clamped between the oldest row in the history and the live
+ * screen, and snaps back to the live screen when new output is written.
+ * Only the view offset changes; the screen is redrawn on the next vga_flush.
+ *
+ * @param vga vga with a history attached.
+ * @param rows number of rows to scroll back (negative to scroll towards the live screen).
+ */
+extern void vga_scroll_view(vga_t* vga, s32 rows);
+
+/**
+ * @brief Let the hardware cursor follow the cursor of the terminal.
+ *
+ * Moving the hardware cursor takes several slow port writes, so it is not
+ * moved per character. It is moved once at the end of every vga_write,
+ * vga_put_string and vga_printf, or only by vga_flush when a shadow or
+ * history is attached, and only when its position actually changed.
+ *
+ * @param vga vga to attach the cursor to.
+ * @param set_cursor moves the hardware cursor.
+ */
+extern void vga_attach_hardware_cursor(vga_t* vga, vga_cursor_t set_cursor);
+
+/**
+ * @brief Copy the dirty rows of the shadow buffer (or history) to the VGA buffer.
+ *
+ * Also moves the hardware cursor when one is attached. Copies nothing when
+ * neither a shadow nor a history is attached, or nothing changed since the
+ * last flush. Call it at points where output must become
+ * visible (after a batch of prints, before halting, on a timer tick).
+ *
+ * @param vga vga to flush.
+ */
+extern void vga_flush(vga_t* vga);
+
 /**
  * @brief Put a single colored character into the vga.
  *
@@ -93,34 +200,47 @@ extern void vga_put_character(vga_t* vga, vga_color_t color_fg, vga_color_t colo
 extern void vga_put_string(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* str);
 
 
+/**
+ * @brief Write a span of characters into the vga.
+ *
+ * Every character of the span is stored with the same colors, so
+ * callers that already have their output in a buffer (formatted
+ * output, log records) should prefer this over putting one
+ * character at a time.
+ *
+ * @param vga vga to write the characters in.
+ * @param color_fg color of the characters in the forground.
+ * @param color_bg color of the characters in the background.
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
+ */
+extern void vga_write(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* buffer, size_t length);
+
 /**
  * @brief Print a formatted string to the terminal.
  *
+ * Formatting is done by format_stream (see llanos/util/format.h for the
+ * supported specifiers); every formatted span is written with vga_write.
+ *
  * @param vga vga to print the formatted string to.
  * @param color_fg color of the character in the forground.
  * @param color_bg color of the character in the background.
  * @param format format speicifier for the string.
- *      A format specifier follows this prototype: %[specifier]
- *          where the specifier character at the end is the most signuifican component.
- *
- *      | speicifier    | output                        | example   |
- *      |---------------|-------------------------------|-----------|
- *      | d             | signed integer                | -239      |
- *      | u             | unsigned integer              | 234       |
- *      | o             | unsigned octal                | 610       |
- *      | x             | unsigned hex                  | 7aa       |
- *      | b             | unsigned binary               | 1101001   |
- *      | f             | floating point                | 32.25     |
- *      | e             | scientific notation           | 2.25e-3   |
- *      | c             | character                     | a         |
- *      | s             | string                        | abc       |
- *      | S             | string with preceeding length | abc       |
- *      | %             | the percent character         | %         |
- *
  * @param ... additional arguments.
  */
 extern void vga_printf(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* format, ...);
 
+/**
+ * @brief Print a formatted string to the terminal from an argument list.
+ *
+ * @param vga vga to print the formatted string to.
+ * @param color_fg color of the character in the forground.
+ * @param color_bg color of the character in the background.
+ * @param format format speicifier for the string (refer to vga_printf).
+ * @param arguments additional arguments.
+ */
+extern void vga_vprintf(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* format, va_list arguments);
+
 
 /**
  * @brief Test is first == second.
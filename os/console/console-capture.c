@@ -0,0 +1,25 @@
+#include <llanos/console/console.h>
+#include <llanos/util/memory.h>
+#include <llanos/types.h>
+
+void console_capture_initialize(console_capture_t* capture, char* buffer, size_t capacity) {
+    capture->buffer = buffer;
+    capture->capacity = capacity;
+    capture->length = 0;
+    capture->dropped = 0;
+}
+
+void console_capture_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    console_capture_t* capture = (console_capture_t*)context;
+    size_t available = capture->capacity - capture->length;
+
+    (void)level;
+
+    if (length > available) {
+        capture->dropped += length - available;
+        length = available;
+    }
+
+    memory_copy((u8*)&capture->buffer[capture->length], (const u8*)buffer, (u32)length);
+    capture->length += length;
+}
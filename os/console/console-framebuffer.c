@@ -0,0 +1,13 @@
+#include <llanos/console/console.h>
+#include <llanos/video/framebuffer.h>
+#include <llanos/types.h>
+
+void console_framebuffer_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    framebuffer_console_write(
+        (framebuffer_console_t*)context,
+        level >= LOG_LEVEL_ERROR ? VGA_COLOR_LIGHT_RED : VGA_COLOR_LIGHT_GREY,
+        VGA_COLOR_BLACK,
+        buffer,
+        length
+    );
+}
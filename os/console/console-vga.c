@@ -0,0 +1,17 @@
+#include <llanos/console/console.h>
+#include <llanos/video/vga.h>
+#include <llanos/types.h>
+
+void console_vga_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    vga_write(
+        (vga_t*)context,
+        level >= LOG_LEVEL_ERROR ? VGA_COLOR_LIGHT_RED : VGA_COLOR_LIGHT_GREY,
+        VGA_COLOR_BLACK,
+        buffer,
+        length
+    );
+}
+
+void console_vga_flush(void* context) {
+    vga_flush((vga_t*)context);
+}
@@ -0,0 +1,171 @@
+#include <llanos/console/console.h>
+#include <llanos/util/format.h>
+#include <llanos/util/memory.h>
+#include <llanos/types.h>
+#include <stdarg.h>
+
+typedef struct console_batch_s console_batch_t;
+
+/**
+ * @brief Formatted output gathered before it is handed to the sinks.
+ *
+ * @member console console the batch is written to.
+ * @member level level of the output.
+ * @member length number of characters in buffer.
+ * @member buffer characters that have not been written yet.
+ */
+struct console_batch_s {
+    console_t* console;
+    log_level_t level;
+    size_t length;
+    char buffer[CONSOLE_BATCH_SIZE];
+};
+
+/**
+ * @brief Write the gathered characters of a batch to the console.
+ *
+ * @param batch batch to write out.
+ */
+static void __console_batch_flush(console_batch_t* batch) {
+    if (batch->length != 0) {
+        console_write(batch->console, batch->level, batch->buffer, batch->length);
+        batch->length = 0;
+    }
+}
+
+/**
+ * @brief Format sink gathering spans into a console batch.
+ *
+ * Spans too large for the batch are written straight through.
+ *
+ * @param context console_batch_t to gather into.
+ * @param span formatted characters.
+ * @param length number of characters in span.
+ */
+static void __console_batch_sink(void* context, const char* span, size_t length) {
+    console_batch_t* batch = (console_batch_t*)context;
+
+    if (batch->length + length > CONSOLE_BATCH_SIZE) {
+        __console_batch_flush(batch);
+    }
+
+    if (length >= CONSOLE_BATCH_SIZE) {
+        console_write(batch->console, batch->level, span, length);
+        return;
+    }
+
+    memory_copy((u8*)&batch->buffer[batch->length], (const u8*)span, (u32)length);
+    batch->length += length;
+}
+
+/**
+ * @brief Lock a console.
+ *
+ * @param console console to lock.
+ * @return state to pass to __console_unlock.
+ */
+static u32 __console_lock(console_t* console) {
+    return console->lock != NULL ? console->lock() : 0;
+}
+
+/**
+ * @brief Unlock a console.
+ *
+ * @param console console to unlock.
+ * @param state state returned by __console_lock.
+ */
+static void __console_unlock(console_t* console, u32 state) {
+    if (console->unlock != NULL) {
+        console->unlock(state);
+    }
+}
+
+void console_initialize(console_t* console) {
+    console->sink_count = 0;
+    console->lock = NULL;
+    console->unlock = NULL;
+}
+
+void console_set_lock(console_t* console, console_lock_t lock, console_unlock_t unlock) {
+    console->lock = lock;
+    console->unlock = unlock;
+}
+
+console_sink_t* console_add_sink(
+        console_t* console,
+        console_write_t write,
+        console_flush_t flush,
+        void* context,
+        log_level_t minimum_level) {
+    console_sink_t* sink;
+
+    if (console->sink_count >= CONSOLE_MAX_SINKS) {
+        return NULL;
+    }
+
+    sink = &console->sinks[console->sink_count++];
+    sink->write = write;
+    sink->flush = flush;
+    sink->context = context;
+    sink->minimum_level = minimum_level;
+    return sink;
+}
+
+void console_set_sink_level(console_sink_t* sink, log_level_t minimum_level) {
+    sink->minimum_level = minimum_level;
+}
+
+void console_write(console_t* console, log_level_t level, const char* buffer, size_t length) {
+    size_t index;
+    u32 state;
+
+    if (length == 0) {
+        return;
+    }
+
+    state = __console_lock(console);
+    for (index = 0; index < console->sink_count; index++) {
+        if (level >= console->sinks[index].minimum_level) {
+            console->sinks[index].write(console->sinks[index].context, level, buffer, length);
+        }
+    }
+    __console_unlock(console, state);
+}
+
+s32 console_printf(console_t* console, log_level_t level, const char* format, ...) {
+    va_list arguments;
+    s32 length;
+
+    va_start(arguments, format);
+    length = console_vprintf(console, level, format, arguments);
+    va_end(arguments);
+
+    return length;
+}
+
+s32 console_vprintf(console_t* console, log_level_t level, const char* format, va_list arguments) {
+    console_batch_t batch;
+    s32 length;
+
+    batch.console = console;
+    batch.level = level;
+    batch.length = 0;
+
+    length = format_stream(__console_batch_sink, &batch, format, arguments);
+    __console_batch_flush(&batch);
+
+    return length;
+}
+
+void console_flush(console_t* console) {
+    size_t index;
+    u32 state;
+
+    state = __console_lock(console);
+    for (index = 0; index < console->sink_count; index++) {
+        if (console->sinks[index].flush != NULL) {
+            console->sinks[index].flush(console->sinks[index].context);
+        }
+    }
+    __console_unlock(console, state);
+}
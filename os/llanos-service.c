@@ -1,9 +1,100 @@
 #include <llanos/llanos.h>
 #include <llanos/video/vga.h>
+#include <llanos/management/log.h>
+#include <llanos/console/console.h>
+#include <llanos/management/irqstat.h>
+#include <llanos/management/softirq.h>
+#include <llanos/management/clock.h>
+#include <llanos/management/clockevent.h>
+#include <llanos/management/timer.h>
+#include <llanos/management/thread.h>
 
 
+/* the default terminal is 80 columns wide, keep 200 rows of scrollback */
+#define LLANOS_VGA_COLUMNS          80
+#define LLANOS_VGA_HISTORY_ROWS     200
+
+/* 16 KiB of log records between drains */
+#define LLANOS_LOG_CAPACITY         16384
+
 static vga_t __vga;
+static u16 __vga_history[LLANOS_VGA_COLUMNS * LLANOS_VGA_HISTORY_ROWS];
+
+static log_buffer_t __log;
+static u64 __log_storage[LLANOS_LOG_CAPACITY / sizeof(u64)];
+
+static console_t __console;
+
+static irqstat_t __irqstat;
+
+static softirq_t __softirq;
+
+static clock_source_t __clock;
+
+static clockevent_t __clockevent;
 
+static timer_wheel_t __timers;
+
+static threads_t __threads;
+static thread_t __boot_thread;
+static timer_t __slice_timer;
+
+/**
+ * @brief Arm the llanos clock event for a tick of the llanos timers.
+ *
+ * @param context unused.
+ * @param expires tick to run the timers at.
+ */
+static void __llanos_timers_rearm(void* context, u64 expires) {
+    (void)context;
+    clockevent_program(&__clockevent, expires << LLANOS_TIMER_TICK_SHIFT);
+}
+
+/**
+ * @brief Handler of the llanos clock event, defers the timers to SOFTIRQ_TIMER.
+ *
+ * @param context unused.
+ * @param now unused.
+ */
+static void __llanos_timers_interrupt(void* context, u64 now) {
+    (void)context;
+    (void)now;
+    softirq_raise(&__softirq, SOFTIRQ_TIMER);
+}
+
+/**
+ * @brief Action of SOFTIRQ_TIMER, runs the expired llanos timers.
+ *
+ * @param context unused.
+ */
+static void __llanos_timers_run(void* context) {
+    (void)context;
+    timer_wheel_run(&__timers, clock_ticks());
+}
+
+
+/**
+ * @brief Timer accounting the time slices of the llanos threads every tick, while threads wait for the CPU.
+ *
+ * @param context unused.
+ */
+static void __llanos_threads_tick(void* context) {
+    (void)context;
+    if (thread_tick(&__threads)) {
+        timer_add(&__timers, &__slice_timer, clock_ticks() + 1);
+    }
+}
+
+/**
+ * @brief Slice hook of the llanos threads, starts __llanos_threads_tick.
+ *
+ * @param context unused.
+ */
+static void __llanos_threads_slice(void* context) {
+    (void)context;
+    /* a pending timer is already ticking */
+    timer_add(&__timers, &__slice_timer, clock_ticks() + 1);
+}
 
 void reset_llanos_vga(void) {
     vga_initialize(
@@ -12,6 +103,7 @@ void reset_llanos_vga(void) {
         vga_get_default_terminal_width(),
         vga_get_default_terminal_height()
     );
+    vga_attach_history(&__vga, __vga_history, LLANOS_VGA_HISTORY_ROWS);
 }
 
 vga_t* get_llanos_vga(void) {
@@ -21,3 +113,90 @@ vga_t* get_llanos_vga(void) {
 void set_llanos_vga(vga_t* vga) {
     vga_copy(&__vga, vga);
 }
+
+void reset_llanos_log(log_clock_t clock, log_cpu_t cpu) {
+    log_initialize(&__log, (u8*)__log_storage, LLANOS_LOG_CAPACITY, clock, cpu);
+}
+
+log_buffer_t* get_llanos_log(void) {
+    return &__log;
+}
+
+void reset_llanos_console(void) {
+    console_initialize(&__console);
+    console_add_sink(&__console, console_vga_write, console_vga_flush, &__vga, LOG_LEVEL_DEBUG);
+}
+
+console_t* get_llanos_console(void) {
+    return &__console;
+}
+
+void reset_llanos_irqstat(void) {
+    irqstat_initialize(&__irqstat);
+}
+
+irqstat_t* get_llanos_irqstat(void) {
+    return &__irqstat;
+}
+
+void reset_llanos_softirq(softirq_cpu_source_t cpu, softirq_interrupts_t enable, softirq_interrupts_t disable) {
+    softirq_initialize(&__softirq, cpu, enable, disable);
+}
+
+softirq_t* get_llanos_softirq(void) {
+    return &__softirq;
+}
+
+void reset_llanos_clock(clock_read_t read, u64 frequency, bool invariant) {
+    clock_source_initialize(&__clock, read, frequency, invariant);
+}
+
+clock_source_t* get_llanos_clock(void) {
+    return &__clock;
+}
+
+u64 clock_cycles(void) {
+    return clock_source_cycles(&__clock);
+}
+
+u64 clock_monotonic_ns(void) {
+    return clock_source_ns(&__clock);
+}
+
+void reset_llanos_clockevent(void) {
+    clockevent_initialize(&__clockevent, &__clock);
+}
+
+clockevent_t* get_llanos_clockevent(void) {
+    return &__clockevent;
+}
+
+u64 clock_ticks(void) {
+    return clock_source_ns(&__clock) >> LLANOS_TIMER_TICK_SHIFT;
+}
+
+void reset_llanos_timers(timer_lock_t lock, timer_unlock_t unlock) {
+    timer_wheel_initialize(&__timers, clock_ticks(), lock, unlock, __llanos_timers_rearm, NULL);
+    softirq_register(&__softirq, SOFTIRQ_TIMER, __llanos_timers_run, NULL);
+    clockevent_set_handler(&__clockevent, __llanos_timers_interrupt, NULL);
+}
+
+timer_wheel_t* get_llanos_timers(void) {
+    return &__timers;
+}
+
+void reset_llanos_threads(
+        thread_prepare_t prepare,
+        thread_switch_t switch_to,
+        thread_lock_t lock,
+        thread_unlock_t unlock,
+        thread_enable_t enable,
+        thread_idle_t idle) {
+    timer_initialize(&__slice_timer, __llanos_threads_tick, NULL);
+    threads_initialize(&__threads, &__boot_thread, prepare, switch_to, lock, unlock, enable, idle);
+    threads_set_slice(&__threads, __llanos_threads_slice, NULL);
+}
+
+threads_t* get_llanos_threads(void) {
+    return &__threads;
+}
@@ -2,27 +2,171 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <llanos/management/abort.h>
+#include <llanos/management/log.h>
+#include <llanos/util/format.h>
+#include <llanos/architecture.h>
 #include <llanos/video/vga.h>
+#include <llanos/video/framebuffer.h>
+#include <llanos/console/console.h>
 #include <llanos/llanos.h>
 
 
+/* room for the record prefix on top of the message */
+#define KMAIN_LOG_LINE_LENGTH   (LOG_MESSAGE_MAX_LENGTH + 64)
+
+/* the serial line is slow, keep debug chatter off it */
+#define KMAIN_SERIAL_LEVEL      LOG_LEVEL_INFO
+
+/* early boot output kept in memory for later inspection */
+#define KMAIN_CAPTURE_SIZE      4096
+
+/* ticks between two IRQ balancing rounds */
+#define KMAIN_BALANCE_TICKS     1000
+
+static console_capture_t __kmain_capture;
+static char __kmain_capture_buffer[KMAIN_CAPTURE_SIZE];
+
+static framebuffer_console_t __kmain_framebuffer;
+
+static timer_t __kmain_balance_timer;
+
+/**
+ * @brief Console write function for the serial console.
+ */
+static void __kmain_serial_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    (void)context;
+    (void)level;
+    architecture_serial_write(buffer, length);
+}
+
+/**
+ * @brief Console write function for the emulator debug console.
+ */
+static void __kmain_debugcon_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    (void)context;
+    (void)level;
+    architecture_debugcon_write(buffer, length);
+}
+
+/**
+ * @brief Spread the IRQ lines over the CPUs and come back in KMAIN_BALANCE_TICKS.
+ *
+ * @param context unused.
+ */
+static void __kmain_balance_irqs(void* context) {
+    (void)context;
+    architecture_balance_irqs();
+    timer_add(get_llanos_timers(), &__kmain_balance_timer, clock_ticks() + KMAIN_BALANCE_TICKS);
+}
+
+/**
+ * @brief Print a drained log record on a console.
+ *
+ * @param context console_t to print the record on.
+ * @param record header of the record.
+ * @param message message of the record.
+ */
+static void __kmain_drain_to_console(void* context, const log_record_t* record, const char* message) {
+    char line[KMAIN_LOG_LINE_LENGTH];
+    s32 length = ksnprintf(
+        line,
+        sizeof(line),
+        "[%llu] cpu%u %s: %S\n",
+        record->timestamp,
+        (u32)record->cpu,
+        log_level_name((log_level_t)record->level),
+        (size_t)record->length,
+        message
+    );
+
+    if (length >= (s32)sizeof(line)) {
+        length = (s32)sizeof(line) - 1;
+    }
+
+    console_write((console_t*)context, (log_level_t)record->level, line, (size_t)length);
+}
+
+/**
+ * @brief Print the log records committed so far on the console and flush its sinks.
+ *
+ * Runs in the idle loop of the boot thread and never from an interrupt, as
+ * the framebuffer sink copies with the vector unit, whose registers belong
+ * to the interrupted thread there.
+ */
+static void __kmain_drain_log(void) {
+    log_drain(get_llanos_log(), __kmain_drain_to_console, get_llanos_console());
+    console_flush(get_llanos_console());
+}
+
 int kmain(void) {
-    vga_t vga;
-    int a;
+    framebuffer_info_t framebuffer;
 
     reset_llanos_vga();
+    reset_llanos_clock(architecture_clock_cycles, architecture_clock_frequency(), architecture_clock_invariant());
+    reset_llanos_log(clock_monotonic_ns, architecture_cpu_id);
+    reset_llanos_console();
+    reset_llanos_irqstat();
+    architecture_record_interrupts(get_llanos_irqstat());
+    reset_llanos_softirq(architecture_cpu_id, architecture_enable_interrupts, architecture_disable_interrupts);
+    architecture_run_softirqs(get_llanos_softirq());
+    reset_llanos_clockevent();
+    architecture_attach_clockevent(get_llanos_clockevent());
+    reset_llanos_timers(architecture_save_interrupts, architecture_restore_interrupts);
+    reset_llanos_threads(
+        architecture_thread_prepare,
+        architecture_thread_switch,
+        architecture_save_interrupts,
+        architecture_restore_interrupts,
+        architecture_enable_interrupts,
+        architecture_idle
+    );
+    architecture_preempt_threads(get_llanos_threads());
+    timer_initialize(&__kmain_balance_timer, __kmain_balance_irqs, NULL);
+    timer_add(get_llanos_timers(), &__kmain_balance_timer, clock_ticks() + KMAIN_BALANCE_TICKS);
+    /* every IRQ line stays masked until a driver requests it */
+    architecture_enable_interrupts();
+
+    if (architecture_get_framebuffer(&framebuffer) && \
+            framebuffer_console_initialize(&__kmain_framebuffer, &framebuffer, architecture_has_vector_unit())) {
+        /* the VGA text buffer is not displayed in a graphics mode, draw on the framebuffer instead */
+        console_initialize(get_llanos_console());
+        console_add_sink(get_llanos_console(), console_framebuffer_write, NULL, &__kmain_framebuffer, LOG_LEVEL_DEBUG);
+    } else {
+        vga_attach_hardware_cursor(get_llanos_vga(), architecture_vga_set_cursor);
+    }
+    console_set_lock(get_llanos_console(), architecture_save_interrupts, architecture_restore_interrupts);
+
+    console_capture_initialize(&__kmain_capture, __kmain_capture_buffer, sizeof(__kmain_capture_buffer));
+    console_add_sink(get_llanos_console(), __kmain_serial_write, NULL, NULL, KMAIN_SERIAL_LEVEL);
+    console_add_sink(get_llanos_console(), __kmain_debugcon_write, NULL, NULL, LOG_LEVEL_DEBUG);
+    console_add_sink(get_llanos_console(), console_capture_write, NULL, &__kmain_capture, LOG_LEVEL_DEBUG);
 
-    vga_printf(
-        get_llanos_vga(), 
-        VGA_COLOR_BLACK, 
-        VGA_COLOR_LIGHT_CYAN, 
-        "test %d %s %e", 
-        -123, 
+    log_printf(get_llanos_log(), LOG_LEVEL_INFO, "llanos kernel started");
+    log_printf(
+        get_llanos_log(),
+        LOG_LEVEL_INFO,
+        "clock %llu Hz%s",
+        get_llanos_clock()->frequency,
+        get_llanos_clock()->invariant ? " invariant" : ""
+    );
+    log_printf(get_llanos_log(), LOG_LEVEL_INFO, "%u CPUs online", architecture_start_cpus());
+
+    console_printf(
+        get_llanos_console(),
+        LOG_LEVEL_INFO,
+        "test %d %s %e\n",
+        -123,
         "this is some string",
         9.2343e+18
     );
 
-    while (1);
+    irqstat_dump(get_llanos_irqstat(), get_llanos_console(), LOG_LEVEL_DEBUG);
+
+    /* the CPU sleeps until the next timer or device interrupt, then prints what was logged meanwhile */
+    while (1) {
+        __kmain_drain_log();
+        architecture_idle();
+    }
 
     return 0;
 }
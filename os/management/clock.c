@@ -0,0 +1,40 @@
+#include <llanos/management/clock.h>
+#include <llanos/types.h>
+
+void clock_calculate_conversion(u64 from, u64 to, u32* mult, u32* shift) {
+    u64 scaled = 0;
+    u32 bits;
+
+    /* the most fraction bits that keep the rounded multiplier within 32 bits (to << 32 must not overflow) */
+    for (bits = 32; bits > 0; bits--) {
+        if (to >> (64 - bits) != 0) {
+            continue;
+        }
+        scaled = ((to << bits) + from / 2) / from;
+        if (scaled <= 0xffffffff) {
+            break;
+        }
+    }
+    if (bits == 0) {
+        scaled = (to + from / 2) / from;
+    }
+
+    *mult = (u32)scaled;
+    *shift = bits;
+}
+
+void clock_calculate_scale(u64 frequency, u32* mult, u32* shift) {
+    clock_calculate_conversion(frequency, CLOCK_NS_PER_SECOND, mult, shift);
+}
+
+void clock_source_initialize(clock_source_t* source, clock_read_t read, u64 frequency, bool invariant) {
+    source->read = read;
+    source->frequency = frequency;
+    source->invariant = invariant;
+    source->mult = 0;
+    source->shift = 0;
+    if (frequency != 0) {
+        clock_calculate_scale(frequency, &source->mult, &source->shift);
+    }
+    source->start = read();
+}
@@ -0,0 +1,107 @@
+#include <llanos/management/clockevent.h>
+#include <llanos/management/clock.h>
+#include <llanos/types.h>
+
+/**
+ * @brief Arm the device for an expiry, as close to it as the device reaches.
+ *
+ * @param event clock event with a device.
+ * @param expires time of the expiry in nanoseconds.
+ * @param now current time in nanoseconds.
+ */
+static void __clockevent_arm(clockevent_t* event, u64 expires, u64 now) {
+    clockevent_device_t* device = event->device;
+    u64 cycles = 0;
+
+    /* the conversion rounds down, one more cycle keeps the interrupt from coming early */
+    if (expires > now) {
+        cycles = clock_scale(expires - now, device->mult, device->shift) + 1;
+    }
+
+    if (cycles < device->min_cycles) {
+        cycles = device->min_cycles;
+    } else if (cycles > device->max_cycles) {
+        cycles = device->max_cycles;
+    }
+    device->set_next(device->context, cycles);
+}
+
+void clockevent_device_initialize(
+        clockevent_device_t* device,
+        const char* name,
+        clockevent_set_next_t set_next,
+        clockevent_stop_t stop,
+        void* context,
+        u64 frequency,
+        u64 min_cycles,
+        u64 max_cycles) {
+    device->name = name;
+    device->set_next = set_next;
+    device->stop = stop;
+    device->context = context;
+    device->min_cycles = min_cycles;
+    device->max_cycles = max_cycles;
+    clock_calculate_conversion(CLOCK_NS_PER_SECOND, frequency, &device->mult, &device->shift);
+}
+
+void clockevent_initialize(clockevent_t* event, const clock_source_t* clock) {
+    event->clock = clock;
+    event->device = NULL;
+    event->handler = NULL;
+    event->context = NULL;
+    event->next_event = CLOCKEVENT_NONE;
+    event->interrupts = 0;
+}
+
+void clockevent_set_device(clockevent_t* event, clockevent_device_t* device) {
+    if (event->device != NULL) {
+        event->device->stop(event->device->context);
+    }
+
+    event->device = device;
+    if (event->next_event != CLOCKEVENT_NONE) {
+        __clockevent_arm(event, event->next_event, clock_source_ns(event->clock));
+    }
+}
+
+void clockevent_set_handler(clockevent_t* event, clockevent_handler_t handler, void* context) {
+    event->context = context;
+    event->handler = handler;
+}
+
+bool clockevent_program(clockevent_t* event, u64 expires) {
+    if (event->device == NULL) {
+        return false;
+    }
+
+    event->next_event = expires;
+    __clockevent_arm(event, expires, clock_source_ns(event->clock));
+    return true;
+}
+
+void clockevent_stop(clockevent_t* event) {
+    event->next_event = CLOCKEVENT_NONE;
+    if (event->device != NULL) {
+        event->device->stop(event->device->context);
+    }
+}
+
+void clockevent_interrupt(clockevent_t* event) {
+    u64 now = clock_source_ns(event->clock);
+
+    event->interrupts++;
+    if (event->next_event == CLOCKEVENT_NONE) {
+        return;
+    }
+
+    /* an intermediate interrupt of a wait longer than the device reaches */
+    if (now < event->next_event) {
+        __clockevent_arm(event, event->next_event, now);
+        return;
+    }
+
+    event->next_event = CLOCKEVENT_NONE;
+    if (event->handler != NULL) {
+        event->handler(event->context, now);
+    }
+}
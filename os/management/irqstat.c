@@ -0,0 +1,75 @@
+#include <llanos/management/irqstat.h>
+#include <llanos/management/log.h>
+#include <llanos/console/console.h>
+#include <llanos/util/memory.h>
+#include <llanos/types.h>
+
+/**
+ * @brief Get the histogram bucket of a handler time.
+ *
+ * @param cycles handler time in TSC cycles.
+ * @return floor(log2(cycles)), 0 for 0 cycles.
+ */
+static inline u32 __irqstat_bucket(u32 cycles) {
+    if (cycles == 0) {
+        return 0;
+    }
+    return 31 - (u32)__builtin_clz(cycles);
+}
+
+void irqstat_initialize(irqstat_t* stats) {
+    memory_set_value((u8*)stats, 0, sizeof(irqstat_t));
+}
+
+void irqstat_record(irqstat_t* stats, u32 cpu, u8 vector, u32 cycles) {
+    irqstat_cpu_t* counters = &stats->cpus[cpu < IRQSTAT_MAX_CPUS ? cpu : IRQSTAT_MAX_CPUS - 1];
+
+    counters->count[vector]++;
+    counters->cycles[vector] += cycles;
+    __atomic_fetch_add(&stats->histograms[vector][__irqstat_bucket(cycles)], 1, __ATOMIC_RELAXED);
+}
+
+u64 irqstat_get_count(const irqstat_t* stats, u8 vector) {
+    u64 count = 0;
+    u32 cpu;
+
+    for (cpu = 0; cpu < IRQSTAT_MAX_CPUS; cpu++) {
+        count += stats->cpus[cpu].count[vector];
+    }
+    return count;
+}
+
+void irqstat_dump(const irqstat_t* stats, console_t* console, log_level_t level) {
+    u64 count;
+    u64 cycles;
+    u32 vector;
+    u32 cpu;
+    u32 bucket;
+
+    for (vector = 0; vector < IRQSTAT_VECTOR_COUNT; vector++) {
+        count = irqstat_get_count(stats, (u8)vector);
+        if (count == 0) {
+            continue;
+        }
+
+        cycles = 0;
+        for (cpu = 0; cpu < IRQSTAT_MAX_CPUS; cpu++) {
+            cycles += stats->cpus[cpu].cycles[vector];
+        }
+
+        console_printf(console, level, "vector %3u: %llu interrupts, %llu cycles average, cpus", vector, count, cycles / count);
+        for (cpu = 0; cpu < IRQSTAT_MAX_CPUS; cpu++) {
+            if (stats->cpus[cpu].count[vector] != 0) {
+                console_printf(console, level, " %u:%u", cpu, stats->cpus[cpu].count[vector]);
+            }
+        }
+
+        console_printf(console, level, "\n    log2 cycles");
+        for (bucket = 0; bucket < IRQSTAT_HISTOGRAM_BUCKETS; bucket++) {
+            if (stats->histograms[vector][bucket] != 0) {
+                console_printf(console, level, " %u:%u", bucket, stats->histograms[vector][bucket]);
+            }
+        }
+        console_printf(console, level, "\n");
+    }
+}
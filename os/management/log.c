@@ -0,0 +1,177 @@
+#include <llanos/management/log.h>
+#include <llanos/util/format.h>
+#include <llanos/util/memory.h>
+#include <llanos/types.h>
+#include <stdarg.h>
+
+/* records start on a header boundary so a padding header always fits before the end of the ring */
+#define LOG_RECORD_ALIGNMENT    sizeof(log_record_t)
+
+#define LOG_RECORD_EMPTY        0
+#define LOG_RECORD_COMMITTED    1
+#define LOG_RECORD_PADDING      2
+
+static const char* __log_level_names[] = {
+    "debug",
+    "info",
+    "warning",
+    "error",
+    "fatal"
+};
+
+/**
+ * @brief Get the header of the record at a ring position.
+ *
+ * @param log log to look in.
+ * @param position position in the ring (any multiple of LOG_RECORD_ALIGNMENT).
+ * @return the record header at that position.
+ */
+static inline log_record_t* __log_record_at(log_buffer_t* log, u32 position) {
+    return (log_record_t*)&log->storage[position & (log->capacity - 1)];
+}
+
+void log_initialize(log_buffer_t* log, u8* storage, u32 capacity, log_clock_t clock, log_cpu_t cpu) {
+    log->storage = storage;
+    log->capacity = capacity;
+    log->head = 0;
+    log->tail = 0;
+    log->dropped = 0;
+    log->draining = 0;
+    log->clock = clock;
+    log->cpu = cpu;
+
+    memory_set_value(storage, 0, capacity);
+}
+
+char* log_reserve(log_buffer_t* log, log_level_t level, size_t length) {
+    log_record_t* record;
+    u32 head;
+    u32 tail;
+    u32 offset;
+    u32 size;
+    u32 padding;
+
+    if (length > LOG_MESSAGE_MAX_LENGTH) {
+        length = LOG_MESSAGE_MAX_LENGTH;
+    }
+    size = (u32)((sizeof(log_record_t) + length + LOG_RECORD_ALIGNMENT - 1) & ~(LOG_RECORD_ALIGNMENT - 1));
+
+    head = __atomic_load_n(&log->head, __ATOMIC_RELAXED);
+    do {
+        tail = __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE);
+        offset = head & (log->capacity - 1);
+
+        /* a record never wraps, the end of the ring is skipped with a padding record instead */
+        padding = offset + size > log->capacity ? log->capacity - offset : 0;
+
+        if ((head + padding + size) - tail > log->capacity) {
+            __atomic_fetch_add(&log->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&log->head, &head, head + padding + size, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    if (padding != 0) {
+        record = __log_record_at(log, head);
+        record->size = (u16)padding;
+        record->length = 0;
+        __atomic_store_n(&record->state, LOG_RECORD_PADDING, __ATOMIC_RELEASE);
+        head += padding;
+    }
+
+    record = __log_record_at(log, head);
+    record->timestamp = log->clock != NULL ? log->clock() : 0;
+    record->size = (u16)size;
+    record->length = (u16)length;
+    record->cpu = (u16)(log->cpu != NULL ? log->cpu() : 0);
+    record->level = (u8)level;
+
+    return (char*)(record + 1);
+}
+
+void log_commit(log_buffer_t* log, char* message) {
+    log_record_t* record = (log_record_t*)message - 1;
+
+    (void)log;
+    __atomic_store_n(&record->state, LOG_RECORD_COMMITTED, __ATOMIC_RELEASE);
+}
+
+bool log_write(log_buffer_t* log, log_level_t level, const char* message, size_t length) {
+    char* destination = log_reserve(log, level, length);
+
+    if (destination == NULL) {
+        return false;
+    }
+
+    if (length > LOG_MESSAGE_MAX_LENGTH) {
+        length = LOG_MESSAGE_MAX_LENGTH;
+    }
+    memory_copy((u8*)destination, (const u8*)message, (u32)length);
+    log_commit(log, destination);
+    return true;
+}
+
+bool log_printf(log_buffer_t* log, log_level_t level, const char* format, ...) {
+    va_list arguments;
+    bool written;
+
+    va_start(arguments, format);
+    written = log_vprintf(log, level, format, arguments);
+    va_end(arguments);
+
+    return written;
+}
+
+bool log_vprintf(log_buffer_t* log, log_level_t level, const char* format, va_list arguments) {
+    char message[LOG_MESSAGE_MAX_LENGTH + 1];
+    s32 length = kvsnprintf(message, sizeof(message), format, arguments);
+
+    if (length < 0) {
+        return false;
+    }
+    return log_write(log, level, message, (size_t)length);
+}
+
+u32 log_drain(log_buffer_t* log, log_drain_t drain, void* context) {
+    log_record_t* record;
+    u32 drained = 0;
+    u32 tail;
+    u8 state;
+
+    if (__atomic_exchange_n(&log->draining, 1, __ATOMIC_ACQUIRE) != 0) {
+        return 0;
+    }
+
+    tail = log->tail;
+    while (tail != __atomic_load_n(&log->head, __ATOMIC_ACQUIRE)) {
+        record = __log_record_at(log, tail);
+        state = __atomic_load_n(&record->state, __ATOMIC_ACQUIRE);
+
+        /* a producer is still writing this record, everything after it has to wait */
+        if (state == LOG_RECORD_EMPTY) {
+            break;
+        }
+
+        if (state == LOG_RECORD_COMMITTED) {
+            drain(context, record, (const char*)(record + 1));
+            drained++;
+        }
+
+        /*
+         * clear the whole record, a later record may start anywhere inside it
+         * and must not find a stale state there
+         */
+        tail += record->size;
+        memory_set_value((u8*)record, 0, record->size);
+        __atomic_store_n(&log->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&log->draining, 0, __ATOMIC_RELEASE);
+    return drained;
+}
+
+const char* log_level_name(log_level_t level) {
+    if ((u32)level >= sizeof(__log_level_names) / sizeof(__log_level_names[0])) {
+        return "unknown";
+    }
+    return __log_level_names[level];
+}
@@ -0,0 +1,149 @@
+#include <llanos/management/softirq.h>
+#include <llanos/types.h>
+
+/**
+ * @brief Get the deferred work of the calling CPU.
+ *
+ * @param softirq softirqs to look in.
+ * @return the deferred work of the calling CPU.
+ */
+static softirq_cpu_t* __softirq_this_cpu(softirq_t* softirq) {
+    u32 cpu = softirq->cpu != NULL ? softirq->cpu() : 0;
+
+    return &softirq->cpus[cpu < SOFTIRQ_MAX_CPUS ? cpu : SOFTIRQ_MAX_CPUS - 1];
+}
+
+/**
+ * @brief Push a tasklet on the scheduled tasklets of a CPU and raise the tasklet vector.
+ *
+ * The list is only ever pushed to or taken as a whole, so a compare and swap
+ * of its head is safe against interrupts and other CPUs.
+ *
+ * @param state deferred work of the CPU.
+ * @param tasklet tasklet to push.
+ */
+static void __softirq_push_tasklet(softirq_cpu_t* state, tasklet_t* tasklet) {
+    tasklet_t* head = __atomic_load_n(&state->tasklets, __ATOMIC_RELAXED);
+
+    do {
+        tasklet->next = head;
+    } while (!__atomic_compare_exchange_n(&state->tasklets, &head, tasklet, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    __atomic_fetch_or(&state->pending, 1u << SOFTIRQ_TASKLET, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Action of SOFTIRQ_TASKLET, runs the tasklets scheduled on the calling CPU in scheduling order.
+ *
+ * @param context softirq_t the tasklets were scheduled in.
+ */
+static void __softirq_run_tasklets(void* context) {
+    softirq_cpu_t* state = __softirq_this_cpu((softirq_t*)context);
+    tasklet_t* tasklets = __atomic_exchange_n(&state->tasklets, NULL, __ATOMIC_ACQUIRE);
+    tasklet_t* ordered = NULL;
+    tasklet_t* next;
+
+    /* the list is last scheduled first */
+    while (tasklets != NULL) {
+        next = tasklets->next;
+        tasklets->next = ordered;
+        ordered = tasklets;
+        tasklets = next;
+    }
+
+    for (; ordered != NULL; ordered = next) {
+        next = ordered->next;
+
+        if (__atomic_exchange_n(&ordered->running, 1, __ATOMIC_ACQUIRE)) {
+            /* still running on another CPU, try again in the next round */
+            __softirq_push_tasklet(state, ordered);
+            continue;
+        }
+
+        /* cleared first so the tasklet can schedule itself again */
+        __atomic_store_n(&ordered->scheduled, 0, __ATOMIC_RELEASE);
+        ordered->function(ordered->context);
+        __atomic_store_n(&ordered->running, 0, __ATOMIC_RELEASE);
+    }
+}
+
+void softirq_initialize(
+        softirq_t* softirq,
+        softirq_cpu_source_t cpu,
+        softirq_interrupts_t enable,
+        softirq_interrupts_t disable) {
+    size_t index;
+
+    for (index = 0; index < SOFTIRQ_VECTOR_COUNT; index++) {
+        softirq->actions[index].action = NULL;
+        softirq->actions[index].context = NULL;
+    }
+    for (index = 0; index < SOFTIRQ_MAX_CPUS; index++) {
+        softirq->cpus[index].pending = 0;
+        softirq->cpus[index].running = false;
+        softirq->cpus[index].tasklets = NULL;
+    }
+
+    softirq->cpu = cpu;
+    softirq->enable = enable;
+    softirq->disable = disable;
+
+    softirq_register(softirq, SOFTIRQ_TASKLET, __softirq_run_tasklets, softirq);
+}
+
+void softirq_register(softirq_t* softirq, u8 vector, softirq_action_t action, void* context) {
+    softirq->actions[vector].context = context;
+    softirq->actions[vector].action = action;
+}
+
+void softirq_raise(softirq_t* softirq, u8 vector) {
+    __atomic_fetch_or(&__softirq_this_cpu(softirq)->pending, 1u << vector, __ATOMIC_RELEASE);
+}
+
+bool softirq_run(softirq_t* softirq) {
+    softirq_cpu_t* state = __softirq_this_cpu(softirq);
+    u32 restart;
+    u32 pending;
+    u32 vector;
+
+    if (state->running) {
+        return __atomic_load_n(&state->pending, __ATOMIC_RELAXED) != 0;
+    }
+    state->running = true;
+
+    for (restart = 0; restart < SOFTIRQ_MAX_RESTARTS; restart++) {
+        pending = __atomic_exchange_n(&state->pending, 0, __ATOMIC_ACQUIRE);
+        if (pending == 0) {
+            break;
+        }
+
+        softirq->enable();
+        for (; pending != 0; pending &= pending - 1) {
+            vector = (u32)__builtin_ctz(pending);
+            if (softirq->actions[vector].action != NULL) {
+                softirq->actions[vector].action(softirq->actions[vector].context);
+            }
+        }
+        softirq->disable();
+    }
+
+    state->running = false;
+    return __atomic_load_n(&state->pending, __ATOMIC_RELAXED) != 0;
+}
+
+void tasklet_initialize(tasklet_t* tasklet, softirq_action_t function, void* context) {
+    tasklet->next = NULL;
+    tasklet->function = function;
+    tasklet->context = context;
+    tasklet->scheduled = 0;
+    tasklet->running = 0;
+}
+
+bool tasklet_schedule(softirq_t* softirq, tasklet_t* tasklet) {
+    if (__atomic_exchange_n(&tasklet->scheduled, 1, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    __softirq_push_tasklet(__softirq_this_cpu(softirq), tasklet);
+    return true;
+}
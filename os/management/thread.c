@@ -0,0 +1,322 @@
+#include <llanos/management/thread.h>
+#include <llanos/types.h>
+
+/**
+ * @brief Queue a thread at the end of the run queue of its priority.
+ *
+ * @param threads locked threads.
+ * @param thread thread to queue.
+ */
+static void __thread_enqueue(threads_t* threads, thread_t* thread) {
+    u32 priority = thread->priority;
+    bool idle = threads->ready_mask == 0;
+
+    thread->state = THREAD_READY;
+    thread->next = NULL;
+    if (threads->ready_tail[priority] != NULL) {
+        threads->ready_tail[priority]->next = thread;
+    } else {
+        threads->ready_head[priority] = thread;
+        threads->ready_mask |= 1u << priority;
+    }
+    threads->ready_tail[priority] = thread;
+
+    /* the running thread queues itself only to be switched out at once */
+    if (thread == threads->current) {
+        return;
+    }
+    if (priority < threads->current->priority) {
+        threads->need_resched = true;
+    }
+    if (idle && threads->slice != NULL) {
+        threads->slice(threads->slice_context);
+    }
+}
+
+/**
+ * @brief Take a thread off the run queue of its priority.
+ *
+ * @param threads locked threads.
+ * @param thread ready thread.
+ */
+static void __thread_unqueue(threads_t* threads, thread_t* thread) {
+    u32 priority = thread->priority;
+    thread_t** link = &threads->ready_head[priority];
+    thread_t* previous = NULL;
+
+    while (*link != thread) {
+        previous = *link;
+        link = &previous->next;
+    }
+
+    *link = thread->next;
+    if (threads->ready_tail[priority] == thread) {
+        threads->ready_tail[priority] = previous;
+    }
+    if (threads->ready_head[priority] == NULL) {
+        threads->ready_mask &= ~(1u << priority);
+    }
+    thread->next = NULL;
+}
+
+/**
+ * @brief Take the first thread of the highest priority off the run queues.
+ *
+ * @param threads locked threads.
+ * @return the thread, NULL if no thread is ready.
+ */
+static thread_t* __thread_dequeue(threads_t* threads) {
+    thread_t* thread;
+    u32 priority;
+
+    if (threads->ready_mask == 0) {
+        return NULL;
+    }
+
+    /* a single bsf finds the highest priority with a ready thread */
+    priority = (u32)__builtin_ctz(threads->ready_mask);
+    thread = threads->ready_head[priority];
+    threads->ready_head[priority] = thread->next;
+    if (threads->ready_head[priority] == NULL) {
+        threads->ready_tail[priority] = NULL;
+        threads->ready_mask &= ~(1u << priority);
+    }
+    thread->next = NULL;
+    return thread;
+}
+
+/**
+ * @brief Switch to the next ready thread.
+ *
+ * The running thread must have been queued, blocked or ended already. If
+ * nothing is ready and the running thread cannot go on, wait for an
+ * interrupt to make a thread ready.
+ *
+ * @param threads locked threads.
+ * @param state interrupt state to restore when unlocking.
+ * @return the interrupt state once the running thread is switched back in.
+ */
+static u32 __thread_schedule(threads_t* threads, u32 state) {
+    thread_t* previous = threads->current;
+    thread_t* next;
+
+    while ((next = __thread_dequeue(threads)) == NULL) {
+        if (previous->state == THREAD_RUNNING) {
+            return state;
+        }
+        threads->unlock(state);
+        threads->idle();
+        state = threads->lock();
+    }
+
+    next->state = THREAD_RUNNING;
+    next->slice_left = THREAD_SLICE_TICKS;
+    threads->need_resched = false;
+    if (next == previous) {
+        return state;
+    }
+
+    threads->current = next;
+    threads->switch_to(&previous->context, &next->context);
+    return state;
+}
+
+/**
+ * @brief First function of every created thread.
+ *
+ * Reached from the switch of another thread, with the lock that switch
+ * held, which belongs to the switched out thread. It may be preempted in
+ * an interrupt, so interrupts are enabled rather than restored.
+ *
+ * @param argument the thread.
+ */
+static void __thread_start(void* argument) {
+    thread_t* thread = (thread_t*)argument;
+    threads_t* threads = thread->threads;
+
+    threads->enable();
+    thread->function(thread->argument);
+    thread_exit(threads);
+}
+
+void threads_initialize(
+        threads_t* threads,
+        thread_t* boot,
+        thread_prepare_t prepare,
+        thread_switch_t switch_to,
+        thread_lock_t lock,
+        thread_unlock_t unlock,
+        thread_enable_t enable,
+        thread_idle_t idle) {
+    u32 priority;
+
+    for (priority = 0; priority < THREAD_PRIORITY_LEVELS; priority++) {
+        threads->ready_head[priority] = NULL;
+        threads->ready_tail[priority] = NULL;
+    }
+    threads->ready_mask = 0;
+    threads->prepare = prepare;
+    threads->switch_to = switch_to;
+    threads->lock = lock;
+    threads->unlock = unlock;
+    threads->enable = enable;
+    threads->idle = idle;
+    threads->slice = NULL;
+    threads->slice_context = NULL;
+    threads->next_id = 1;
+    threads->need_resched = false;
+
+    boot->context.stack_pointer = NULL;
+    boot->context.fpu_used = false;
+    boot->next = NULL;
+    boot->threads = threads;
+    boot->function = NULL;
+    boot->argument = NULL;
+    boot->joiners = NULL;
+    boot->name = "boot";
+    boot->id = 0;
+    boot->priority = THREAD_PRIORITY_DEFAULT;
+    boot->slice_left = THREAD_SLICE_TICKS;
+    boot->state = THREAD_RUNNING;
+    threads->current = boot;
+}
+
+void threads_set_slice(threads_t* threads, thread_slice_t slice, void* context) {
+    u32 state = threads->lock();
+
+    threads->slice = slice;
+    threads->slice_context = context;
+    if (slice != NULL && threads->ready_mask != 0) {
+        slice(context);
+    }
+
+    threads->unlock(state);
+}
+
+bool thread_create(
+        threads_t* threads,
+        thread_t* thread,
+        const char* name,
+        u32 priority,
+        void* stack,
+        size_t stack_size,
+        thread_function_t function,
+        void* argument) {
+    u32 state;
+
+    if (stack_size < THREAD_MIN_STACK_SIZE || priority > THREAD_PRIORITY_LOWEST) {
+        return false;
+    }
+
+    thread->context.fpu_used = false;
+    thread->threads = threads;
+    thread->function = function;
+    thread->argument = argument;
+    thread->joiners = NULL;
+    thread->name = name;
+    thread->priority = priority;
+    thread->slice_left = THREAD_SLICE_TICKS;
+    threads->prepare(&thread->context, (u8*)stack + stack_size, __thread_start, thread);
+
+    state = threads->lock();
+    thread->id = threads->next_id++;
+    __thread_enqueue(threads, thread);
+    threads->unlock(state);
+    return true;
+}
+
+void thread_yield(threads_t* threads) {
+    u32 state = threads->lock();
+
+    __thread_enqueue(threads, threads->current);
+    state = __thread_schedule(threads, state);
+    threads->unlock(state);
+}
+
+bool thread_set_priority(threads_t* threads, thread_t* thread, u32 priority) {
+    u32 state;
+    thread_t* current;
+
+    if (priority > THREAD_PRIORITY_LOWEST) {
+        return false;
+    }
+
+    state = threads->lock();
+    current = threads->current;
+    if (thread->state == THREAD_READY) {
+        __thread_unqueue(threads, thread);
+        thread->priority = priority;
+        __thread_enqueue(threads, thread);
+    } else {
+        thread->priority = priority;
+    }
+
+    /* the running thread gives way to the ready threads it now ranks below */
+    if (threads->ready_mask != 0 && (u32)__builtin_ctz(threads->ready_mask) < current->priority) {
+        threads->need_resched = true;
+    }
+
+    threads->unlock(state);
+    return true;
+}
+
+bool thread_tick(threads_t* threads) {
+    u32 state = threads->lock();
+    thread_t* current = threads->current;
+    bool ready;
+
+    if (current->slice_left > 0) {
+        current->slice_left--;
+    }
+    /* a higher priority thread already set need_resched when it was queued */
+    if (current->slice_left == 0 && (threads->ready_mask & (1u << current->priority)) != 0) {
+        threads->need_resched = true;
+    }
+    ready = threads->ready_mask != 0;
+
+    threads->unlock(state);
+    return ready;
+}
+
+void thread_preempt(threads_t* threads) {
+    u32 state = threads->lock();
+
+    /* a thread blocked or idling in __thread_schedule is not preempted */
+    if (threads->need_resched && threads->current->state == THREAD_RUNNING) {
+        __thread_enqueue(threads, threads->current);
+        state = __thread_schedule(threads, state);
+    }
+
+    threads->unlock(state);
+}
+
+void thread_exit(threads_t* threads) {
+    u32 state = threads->lock();
+    thread_t* thread = threads->current;
+    thread_t* joiner;
+
+    thread->state = THREAD_DEAD;
+    while ((joiner = thread->joiners) != NULL) {
+        thread->joiners = joiner->next;
+        __thread_enqueue(threads, joiner);
+    }
+
+    /* never switched back to */
+    state = __thread_schedule(threads, state);
+    threads->unlock(state);
+}
+
+void thread_join(threads_t* threads, thread_t* thread) {
+    u32 state = threads->lock();
+    thread_t* current = threads->current;
+
+    /* only thread_exit makes the joiner ready again */
+    if (thread->state != THREAD_DEAD && thread != current) {
+        current->state = THREAD_BLOCKED;
+        current->next = thread->joiners;
+        thread->joiners = current;
+        state = __thread_schedule(threads, state);
+    }
+
+    threads->unlock(state);
+}
@@ -0,0 +1,328 @@
+#include <llanos/management/timer.h>
+#include <llanos/types.h>
+
+/**
+ * @brief Lock a wheel.
+ *
+ * @param wheel wheel to lock.
+ * @return state to pass to __timer_wheel_unlock.
+ */
+static u32 __timer_wheel_lock(timer_wheel_t* wheel) {
+    return wheel->lock != NULL ? wheel->lock() : 0;
+}
+
+/**
+ * @brief Unlock a wheel.
+ *
+ * @param wheel wheel to unlock.
+ * @param state state returned by __timer_wheel_lock.
+ */
+static void __timer_wheel_unlock(timer_wheel_t* wheel, u32 state) {
+    if (wheel->unlock != NULL) {
+        wheel->unlock(state);
+    }
+}
+
+/**
+ * @brief Push a timer on a list.
+ *
+ * @param head head of the list.
+ * @param timer timer to push.
+ */
+static void __timer_link(timer_t** head, timer_t* timer) {
+    timer->next = *head;
+    if (timer->next != NULL) {
+        timer->next->previous = &timer->next;
+    }
+    timer->previous = head;
+    *head = timer;
+}
+
+/**
+ * @brief Take a timer off its list.
+ *
+ * @param timer pending timer.
+ */
+static void __timer_unlink(timer_t* timer) {
+    *timer->previous = timer->next;
+    if (timer->next != NULL) {
+        timer->next->previous = timer->previous;
+    }
+    timer->next = NULL;
+    timer->previous = NULL;
+}
+
+/**
+ * @brief Get the tick a timer is placed for, its expiry within the reach of the wheel.
+ *
+ * @param wheel wheel of the timer.
+ * @param expires expiry of the timer.
+ * @return the expiry, the next tick if it passed, the far end of the wheel if it is beyond.
+ */
+static u64 __timer_wheel_target(const timer_wheel_t* wheel, u64 expires) {
+    if (expires < wheel->clock) {
+        return wheel->clock;
+    }
+    if (expires - wheel->clock > TIMER_WHEEL_MAX_DELTA) {
+        return wheel->clock + TIMER_WHEEL_MAX_DELTA;
+    }
+    return expires;
+}
+
+/**
+ * @brief Put a timer in the slot of the first level spanning its expiry.
+ *
+ * @param wheel wheel to place in.
+ * @param timer timer that is not on a list.
+ */
+static void __timer_wheel_place(timer_wheel_t* wheel, timer_t* timer) {
+    u64 target = __timer_wheel_target(wheel, timer->expires);
+    u64 delta = target - wheel->clock;
+    u32 level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+        if (delta < (1ULL << ((level + 1) * TIMER_WHEEL_BITS))) {
+            break;
+        }
+    }
+
+    __timer_link(&wheel->slots[level][(target >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK], timer);
+}
+
+/**
+ * @brief Arm the timer interrupt if a tick comes before the one it is armed for.
+ *
+ * @param wheel locked wheel.
+ * @param expires tick the wheel has work at.
+ */
+static void __timer_wheel_rearm(timer_wheel_t* wheel, u64 expires) {
+    if (expires < wheel->programmed) {
+        wheel->programmed = expires;
+        if (wheel->rearm != NULL) {
+            wheel->rearm(wheel->context, expires);
+        }
+    }
+}
+
+/**
+ * @brief Add a timer to a locked wheel.
+ *
+ * @param wheel locked wheel.
+ * @param timer timer that is not pending.
+ * @param expires tick the timer expires at.
+ */
+static void __timer_wheel_add(timer_wheel_t* wheel, timer_t* timer, u64 expires) {
+    timer->expires = expires;
+    __timer_wheel_place(wheel, timer);
+    wheel->count++;
+    __timer_wheel_rearm(wheel, __timer_wheel_target(wheel, expires));
+}
+
+/**
+ * @brief Get the earliest tick a locked wheel has an expiry or a cascade at.
+ *
+ * @param wheel locked wheel.
+ * @return the tick, TIMER_NONE without timers.
+ */
+static u64 __timer_wheel_next_tick(const timer_wheel_t* wheel) {
+    u64 next = TIMER_NONE;
+    u64 tick;
+    u32 level;
+    u32 shift;
+    u32 index;
+    u32 offset;
+
+    if (wheel->count == 0) {
+        return TIMER_NONE;
+    }
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        shift = level * TIMER_WHEEL_BITS;
+        index = (u32)(wheel->clock >> shift) & TIMER_WHEEL_MASK;
+
+        for (offset = 0; offset < TIMER_WHEEL_SLOTS; offset++) {
+            if (wheel->slots[level][(index + offset) & TIMER_WHEEL_MASK] == NULL) {
+                continue;
+            }
+
+            /* a slot of a higher level is cascaded when the clock enters it, the current one a turn later */
+            tick = ((wheel->clock >> shift) + offset) << shift;
+            if (tick < wheel->clock) {
+                tick += (u64)TIMER_WHEEL_SLOTS << shift;
+            }
+            if (tick < next) {
+                next = tick;
+            }
+
+            /* the later slots of the level come after this one, but not after the current one's next turn */
+            if (offset != 0 || tick == wheel->clock) {
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief Cascade the slots of the higher levels the clock enters into the levels below.
+ *
+ * @param wheel locked wheel.
+ */
+static void __timer_wheel_cascade(timer_wheel_t* wheel) {
+    timer_t* timers;
+    timer_t* next;
+    u32 level;
+    u32 shift;
+
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        shift = level * TIMER_WHEEL_BITS;
+
+        /* the clock enters a slot of this level only at the start of a slot of every level below */
+        if ((wheel->clock & ((1ULL << shift) - 1)) != 0) {
+            break;
+        }
+
+        timers = wheel->slots[level][(wheel->clock >> shift) & TIMER_WHEEL_MASK];
+        wheel->slots[level][(wheel->clock >> shift) & TIMER_WHEEL_MASK] = NULL;
+        for (; timers != NULL; timers = next) {
+            next = timers->next;
+            __timer_wheel_place(wheel, timers);
+        }
+    }
+}
+
+void timer_wheel_initialize(
+        timer_wheel_t* wheel,
+        u64 now,
+        timer_lock_t lock,
+        timer_unlock_t unlock,
+        timer_rearm_t rearm,
+        void* context) {
+    u32 level;
+    u32 slot;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NULL;
+        }
+    }
+
+    wheel->clock = now;
+    wheel->programmed = TIMER_NONE;
+    wheel->count = 0;
+    wheel->lock = lock;
+    wheel->unlock = unlock;
+    wheel->rearm = rearm;
+    wheel->context = context;
+}
+
+void timer_initialize(timer_t* timer, timer_function_t function, void* context) {
+    timer->next = NULL;
+    timer->previous = NULL;
+    timer->expires = 0;
+    timer->function = function;
+    timer->context = context;
+}
+
+bool timer_add(timer_wheel_t* wheel, timer_t* timer, u64 expires) {
+    u32 state = __timer_wheel_lock(wheel);
+    bool added = !timer_pending(timer);
+
+    if (added) {
+        __timer_wheel_add(wheel, timer, expires);
+    }
+
+    __timer_wheel_unlock(wheel, state);
+    return added;
+}
+
+bool timer_cancel(timer_wheel_t* wheel, timer_t* timer) {
+    u32 state = __timer_wheel_lock(wheel);
+    bool pending = timer_pending(timer);
+
+    /* the timer interrupt stays armed, an early wakeup finds nothing to run and rearms */
+    if (pending) {
+        __timer_unlink(timer);
+        wheel->count--;
+    }
+
+    __timer_wheel_unlock(wheel, state);
+    return pending;
+}
+
+bool timer_mod(timer_wheel_t* wheel, timer_t* timer, u64 expires) {
+    u32 state = __timer_wheel_lock(wheel);
+    bool pending = timer_pending(timer);
+
+    if (pending) {
+        __timer_unlink(timer);
+        wheel->count--;
+    }
+    __timer_wheel_add(wheel, timer, expires);
+
+    __timer_wheel_unlock(wheel, state);
+    return pending;
+}
+
+u32 timer_wheel_run(timer_wheel_t* wheel, u64 now) {
+    u32 state = __timer_wheel_lock(wheel);
+    timer_t* expired;
+    timer_t* timer;
+    timer_function_t function;
+    void* context;
+    u64 next;
+    u32 count = 0;
+
+    /* the interrupt that got us here is used up */
+    wheel->programmed = TIMER_NONE;
+
+    while (wheel->clock <= now) {
+        next = __timer_wheel_next_tick(wheel);
+        if (next > now) {
+            wheel->clock = now + 1;
+            break;
+        }
+        wheel->clock = next;
+        __timer_wheel_cascade(wheel);
+
+        /*
+         * take the slot off the wheel and step the clock before running it, so
+         * timers a function adds for now land in the next tick instead
+         */
+        expired = NULL;
+        timer = wheel->slots[0][wheel->clock & TIMER_WHEEL_MASK];
+        if (timer != NULL) {
+            wheel->slots[0][wheel->clock & TIMER_WHEEL_MASK] = NULL;
+            timer->previous = &expired;
+            expired = timer;
+        }
+        wheel->clock++;
+
+        while (expired != NULL) {
+            timer = expired;
+            __timer_unlink(timer);
+            wheel->count--;
+            function = timer->function;
+            context = timer->context;
+
+            __timer_wheel_unlock(wheel, state);
+            function(context);
+            count++;
+            state = __timer_wheel_lock(wheel);
+        }
+    }
+
+    __timer_wheel_rearm(wheel, __timer_wheel_next_tick(wheel));
+
+    __timer_wheel_unlock(wheel, state);
+    return count;
+}
+
+u64 timer_wheel_next_expiry(timer_wheel_t* wheel) {
+    u32 state = __timer_wheel_lock(wheel);
+    u64 next = __timer_wheel_next_tick(wheel);
+
+    __timer_wheel_unlock(wheel, state);
+    return next;
+}
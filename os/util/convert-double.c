@@ -0,0 +1,665 @@
+#include <llanos/util/convert.h>
+#include <llanos/util/memory.h>
+#include <llanos/types.h>
+
+#define CONVERT_DOUBLE_FRACTION_BITS    52
+#define CONVERT_DOUBLE_FRACTION_MASK    0x000fffffffffffffULL
+#define CONVERT_DOUBLE_HIDDEN_BIT       0x0010000000000000ULL
+#define CONVERT_DOUBLE_EXPONENT_MASK    0x7ff0000000000000ULL
+#define CONVERT_DOUBLE_EXPONENT_BIAS    (0x3ff + CONVERT_DOUBLE_FRACTION_BITS)
+
+/* the cached powers of ten are 8 decades apart, starting at 10^-348 */
+#define CONVERT_CACHED_POWER_FIRST_DECADE   -348
+#define CONVERT_CACHED_POWER_DECADE_STEP    8
+#define CONVERT_CACHED_POWER_COUNT          87
+
+/* scaled values should land just below the target binary exponent so their integral part fits 32 bits */
+#define CONVERT_TARGET_EXPONENT     -61
+
+/* 2^1074 times 10^324 for the smallest subnormal, with room for the digit steps */
+#define CONVERT_BIGNUM_WORDS        40
+
+/* largest power of ten a 32-bit word multiplies by */
+#define CONVERT_U32_MAX_DECADE      9
+
+typedef struct convert_fp_s convert_fp_t;
+typedef struct convert_cached_power_s convert_cached_power_t;
+typedef struct convert_bignum_s convert_bignum_t;
+
+/**
+ * @brief An unpacked floating point value: fraction * 2^exponent.
+ *
+ * @member fraction 64-bit fraction (not necessarily normalized).
+ * @member exponent binary exponent.
+ */
+struct convert_fp_s {
+    u64 fraction;
+    s32 exponent;
+};
+
+/**
+ * @brief An unsigned big integer for the exact expansion of a double.
+ *
+ * @member words 32-bit words, least significant first.
+ * @member length number of words in use (0 for zero, the top one is not zero).
+ */
+struct convert_bignum_s {
+    u32 words[CONVERT_BIGNUM_WORDS];
+    u32 length;
+};
+
+/**
+ * @brief A normalized 64-bit approximation of a power of ten.
+ *
+ * @member fraction normalized fraction (top bit set) rounded to nearest.
+ * @member exponent binary exponent, 10^decade ~= fraction * 2^exponent.
+ * @member decade decimal exponent of the power of ten.
+ */
+struct convert_cached_power_s {
+    u64 fraction;
+    s16 exponent;
+    s16 decade;
+};
+
+/* generated exactly (rational arithmetic, rounded to nearest) for 10^-348 to 10^340 */
+static const convert_cached_power_t __convert_cached_powers[CONVERT_CACHED_POWER_COUNT] = {
+    {0xfa8fd5a0081c0288ULL, -1220, -348},
+    {0xbaaee17fa23ebf76ULL, -1193, -340},
+    {0x8b16fb203055ac76ULL, -1166, -332},
+    {0xcf42894a5dce35eaULL, -1140, -324},
+    {0x9a6bb0aa55653b2dULL, -1113, -316},
+    {0xe61acf033d1a45dfULL, -1087, -308},
+    {0xab70fe17c79ac6caULL, -1060, -300},
+    {0xff77b1fcbebcdc4fULL, -1034, -292},
+    {0xbe5691ef416bd60cULL, -1007, -284},
+    {0x8dd01fad907ffc3cULL, -980, -276},
+    {0xd3515c2831559a83ULL, -954, -268},
+    {0x9d71ac8fada6c9b5ULL, -927, -260},
+    {0xea9c227723ee8bcbULL, -901, -252},
+    {0xaecc49914078536dULL, -874, -244},
+    {0x823c12795db6ce57ULL, -847, -236},
+    {0xc21094364dfb5637ULL, -821, -228},
+    {0x9096ea6f3848984fULL, -794, -220},
+    {0xd77485cb25823ac7ULL, -768, -212},
+    {0xa086cfcd97bf97f4ULL, -741, -204},
+    {0xef340a98172aace5ULL, -715, -196},
+    {0xb23867fb2a35b28eULL, -688, -188},
+    {0x84c8d4dfd2c63f3bULL, -661, -180},
+    {0xc5dd44271ad3cdbaULL, -635, -172},
+    {0x936b9fcebb25c996ULL, -608, -164},
+    {0xdbac6c247d62a584ULL, -582, -156},
+    {0xa3ab66580d5fdaf6ULL, -555, -148},
+    {0xf3e2f893dec3f126ULL, -529, -140},
+    {0xb5b5ada8aaff80b8ULL, -502, -132},
+    {0x87625f056c7c4a8bULL, -475, -124},
+    {0xc9bcff6034c13053ULL, -449, -116},
+    {0x964e858c91ba2655ULL, -422, -108},
+    {0xdff9772470297ebdULL, -396, -100},
+    {0xa6dfbd9fb8e5b88fULL, -369, -92},
+    {0xf8a95fcf88747d94ULL, -343, -84},
+    {0xb94470938fa89bcfULL, -316, -76},
+    {0x8a08f0f8bf0f156bULL, -289, -68},
+    {0xcdb02555653131b6ULL, -263, -60},
+    {0x993fe2c6d07b7facULL, -236, -52},
+    {0xe45c10c42a2b3b06ULL, -210, -44},
+    {0xaa242499697392d3ULL, -183, -36},
+    {0xfd87b5f28300ca0eULL, -157, -28},
+    {0xbce5086492111aebULL, -130, -20},
+    {0x8cbccc096f5088ccULL, -103, -12},
+    {0xd1b71758e219652cULL, -77, -4},
+    {0x9c40000000000000ULL, -50, 4},
+    {0xe8d4a51000000000ULL, -24, 12},
+    {0xad78ebc5ac620000ULL, 3, 20},
+    {0x813f3978f8940984ULL, 30, 28},
+    {0xc097ce7bc90715b3ULL, 56, 36},
+    {0x8f7e32ce7bea5c70ULL, 83, 44},
+    {0xd5d238a4abe98068ULL, 109, 52},
+    {0x9f4f2726179a2245ULL, 136, 60},
+    {0xed63a231d4c4fb27ULL, 162, 68},
+    {0xb0de65388cc8ada8ULL, 189, 76},
+    {0x83c7088e1aab65dbULL, 216, 84},
+    {0xc45d1df942711d9aULL, 242, 92},
+    {0x924d692ca61be758ULL, 269, 100},
+    {0xda01ee641a708deaULL, 295, 108},
+    {0xa26da3999aef774aULL, 322, 116},
+    {0xf209787bb47d6b85ULL, 348, 124},
+    {0xb454e4a179dd1877ULL, 375, 132},
+    {0x865b86925b9bc5c2ULL, 402, 140},
+    {0xc83553c5c8965d3dULL, 428, 148},
+    {0x952ab45cfa97a0b3ULL, 455, 156},
+    {0xde469fbd99a05fe3ULL, 481, 164},
+    {0xa59bc234db398c25ULL, 508, 172},
+    {0xf6c69a72a3989f5cULL, 534, 180},
+    {0xb7dcbf5354e9beceULL, 561, 188},
+    {0x88fcf317f22241e2ULL, 588, 196},
+    {0xcc20ce9bd35c78a5ULL, 614, 204},
+    {0x98165af37b2153dfULL, 641, 212},
+    {0xe2a0b5dc971f303aULL, 667, 220},
+    {0xa8d9d1535ce3b396ULL, 694, 228},
+    {0xfb9b7cd9a4a7443cULL, 720, 236},
+    {0xbb764c4ca7a44410ULL, 747, 244},
+    {0x8bab8eefb6409c1aULL, 774, 252},
+    {0xd01fef10a657842cULL, 800, 260},
+    {0x9b10a4e5e9913129ULL, 827, 268},
+    {0xe7109bfba19c0c9dULL, 853, 276},
+    {0xac2820d9623bf429ULL, 880, 284},
+    {0x80444b5e7aa7cf85ULL, 907, 292},
+    {0xbf21e44003acdd2dULL, 933, 300},
+    {0x8e679c2f5e44ff8fULL, 960, 308},
+    {0xd433179d9c8cb841ULL, 986, 316},
+    {0x9e19db92b4e31ba9ULL, 1013, 324},
+    {0xeb96bf6ebadf77d9ULL, 1039, 332},
+    {0xaf87023b9bf0ee6bULL, 1066, 340}
+};
+
+static const u32 __convert_u32_powers_of_ten[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static const u64 __convert_u64_powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/**
+ * @brief Multiply two values and keep the rounded upper 64 bits of the product.
+ *
+ * Only 32x32->64 multiplications are used.
+ *
+ * @param left left operand.
+ * @param right right operand.
+ * @return left * right with the exponents added.
+ */
+static convert_fp_t __convert_fp_multiply(convert_fp_t left, convert_fp_t right) {
+    convert_fp_t product;
+    u64 left_high = left.fraction >> 32;
+    u64 left_low = left.fraction & 0xffffffffULL;
+    u64 right_high = right.fraction >> 32;
+    u64 right_low = right.fraction & 0xffffffffULL;
+    u64 high_high = left_high * right_high;
+    u64 low_high = left_low * right_high;
+    u64 high_low = left_high * right_low;
+    u64 low_low = left_low * right_low;
+    u64 middle;
+
+    /* the 1 << 31 rounds the discarded lower half to nearest */
+    middle = (low_low >> 32) + (high_low & 0xffffffffULL) + (low_high & 0xffffffffULL) + (1ULL << 31);
+    product.fraction = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+    product.exponent = left.exponent + right.exponent + 64;
+    return product;
+}
+
+/**
+ * @brief Shift a value left until the top bit of its fraction is set.
+ *
+ * @param value value to normalize (fraction must not be zero).
+ * @return the normalized value.
+ */
+static convert_fp_t __convert_fp_normalize(convert_fp_t value) {
+    s32 shift = __builtin_clzll(value.fraction);
+
+    value.fraction <<= shift;
+    value.exponent -= shift;
+    return value;
+}
+
+/**
+ * @brief Unpack the bits of a finite, positive double.
+ *
+ * @param value value to unpack.
+ * @return the value as fraction * 2^exponent.
+ */
+static convert_fp_t __convert_fp_from_double(double value) {
+    convert_fp_t unpacked;
+    u64 bits;
+    u32 biased_exponent;
+
+    memory_copy((u8*)&bits, (const u8*)&value, sizeof(bits));
+    biased_exponent = (u32)((bits & CONVERT_DOUBLE_EXPONENT_MASK) >> CONVERT_DOUBLE_FRACTION_BITS);
+
+    if (biased_exponent != 0) {
+        unpacked.fraction = (bits & CONVERT_DOUBLE_FRACTION_MASK) + CONVERT_DOUBLE_HIDDEN_BIT;
+        unpacked.exponent = (s32)biased_exponent - CONVERT_DOUBLE_EXPONENT_BIAS;
+    } else {
+        /* subnormal */
+        unpacked.fraction = bits & CONVERT_DOUBLE_FRACTION_MASK;
+        unpacked.exponent = 1 - CONVERT_DOUBLE_EXPONENT_BIAS;
+    }
+    return unpacked;
+}
+
+/**
+ * @brief Compute the boundaries of the rounding interval of a value.
+ *
+ * Any number strictly between the boundaries reads back as the value.
+ * Both boundaries share the exponent of the normalized upper boundary.
+ *
+ * @param value unpacked value.
+ * @param lower destination for the lower boundary.
+ * @param upper destination for the upper (normalized) boundary.
+ */
+static void __convert_fp_boundaries(convert_fp_t value, convert_fp_t* lower, convert_fp_t* upper) {
+    upper->fraction = (value.fraction << 1) + 1;
+    upper->exponent = value.exponent - 1;
+    *upper = __convert_fp_normalize(*upper);
+
+    if (value.fraction == CONVERT_DOUBLE_HIDDEN_BIT) {
+        /* the gap below a power of two is half the gap above it */
+        lower->fraction = (value.fraction << 2) - 1;
+        lower->exponent = value.exponent - 2;
+    } else {
+        lower->fraction = (value.fraction << 1) - 1;
+        lower->exponent = value.exponent - 1;
+    }
+    lower->fraction <<= lower->exponent - upper->exponent;
+    lower->exponent = upper->exponent;
+}
+
+/**
+ * @brief Find the cached power of ten that scales a value into the target exponent range.
+ *
+ * @param exponent binary exponent of the normalized upper boundary.
+ * @return the cached power that brings the scaled exponent into [-60, -32].
+ */
+static const convert_cached_power_t* __convert_cached_power(s32 exponent) {
+    /* ceil((-61 - exponent) * log10(2)) with log10(2) ~= 78913 / 2^18 */
+    s32 offset = ((((CONVERT_TARGET_EXPONENT - exponent) * 78913) + ((1 << 18) - 1)) >> 18) - CONVERT_CACHED_POWER_FIRST_DECADE - 1;
+    s32 index = (offset / CONVERT_CACHED_POWER_DECADE_STEP) + 1;
+
+    return &__convert_cached_powers[index];
+}
+
+/**
+ * @brief Count the decimal digits of a 32-bit value.
+ *
+ * @param value value to count the digits of.
+ * @return number of decimal digits (1 for 0).
+ */
+static u32 __convert_decimal_length(u32 value) {
+    u32 length = 1;
+
+    while (length < 10 && value >= __convert_u32_powers_of_ten[length]) {
+        length++;
+    }
+    return length;
+}
+
+/**
+ * @brief Nudge the last generated digit towards the exact value.
+ *
+ * @param decimal generated digits.
+ * @param distance distance from the upper boundary to the exact value.
+ * @param delta width of the rounding interval.
+ * @param rest distance from the generated digits to the upper boundary.
+ * @param unit value of one unit in the last generated digit.
+ */
+static void __convert_weed(convert_decimal_t* decimal, u64 distance, u64 delta, u64 rest, u64 unit) {
+    while (rest < distance
+            && delta - rest >= unit
+            && (rest + unit < distance || distance - rest > rest + unit - distance)) {
+        decimal->digits[decimal->length - 1]--;
+        rest += unit;
+    }
+}
+
+/**
+ * @brief Generate the shortest digits inside the rounding interval.
+ *
+ * @param decimal destination for the digits (exponent is set to the decimal exponent of the last digit).
+ * @param scaled scaled value.
+ * @param upper scaled upper boundary (shrunk by one unit).
+ * @param delta width of the scaled rounding interval.
+ * @param decade decimal exponent of the scale applied.
+ */
+static void __convert_generate_digits(
+        convert_decimal_t* decimal,
+        convert_fp_t scaled,
+        convert_fp_t upper,
+        u64 delta,
+        s32 decade) {
+    u32 shift = (u32)-upper.exponent;
+    u64 one = 1ULL << shift;
+    u64 distance = upper.fraction - scaled.fraction;
+    u32 integral = (u32)(upper.fraction >> shift);
+    u64 fractional = upper.fraction & (one - 1);
+    s32 kappa = (s32)__convert_decimal_length(integral);
+    u32 digit;
+    u64 rest;
+
+    decimal->length = 0;
+
+    while (kappa > 0) {
+        digit = integral / __convert_u32_powers_of_ten[kappa - 1];
+        integral %= __convert_u32_powers_of_ten[kappa - 1];
+        if (digit != 0 || decimal->length != 0) {
+            decimal->digits[decimal->length++] = (char)('0' + digit);
+        }
+        kappa--;
+
+        rest = ((u64)integral << shift) + fractional;
+        if (rest <= delta) {
+            decimal->exponent = decade + kappa;
+            __convert_weed(decimal, distance, delta, rest, (u64)__convert_u32_powers_of_ten[kappa] << shift);
+            return;
+        }
+    }
+
+    /* at most 17 significant digits are ever needed, so this terminates quickly */
+    while (true) {
+        fractional *= 10;
+        delta *= 10;
+        digit = (u32)(fractional >> shift);
+        if (digit != 0 || decimal->length != 0) {
+            decimal->digits[decimal->length++] = (char)('0' + digit);
+        }
+        fractional &= one - 1;
+        kappa--;
+
+        if (fractional < delta) {
+            decimal->exponent = decade + kappa;
+            __convert_weed(
+                decimal,
+                distance * (-kappa < 20 ? __convert_u64_powers_of_ten[-kappa] : 0),
+                delta,
+                fractional,
+                one
+            );
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Set a big integer to a 64-bit value.
+ *
+ * @param bignum big integer to set.
+ * @param value value to set.
+ */
+static void __convert_bignum_set(convert_bignum_t* bignum, u64 value) {
+    bignum->length = 0;
+    while (value != 0) {
+        bignum->words[bignum->length++] = (u32)value;
+        value >>= 32;
+    }
+}
+
+/**
+ * @brief Multiply a big integer by a 32-bit value.
+ *
+ * @param bignum big integer to multiply in place.
+ * @param factor factor (not 0).
+ */
+static void __convert_bignum_multiply(convert_bignum_t* bignum, u32 factor) {
+    u64 carry = 0;
+    u32 index;
+
+    for (index = 0; index < bignum->length; index++) {
+        carry += (u64)bignum->words[index] * factor;
+        bignum->words[index] = (u32)carry;
+        carry >>= 32;
+    }
+    if (carry != 0) {
+        bignum->words[bignum->length++] = (u32)carry;
+    }
+}
+
+/**
+ * @brief Multiply a big integer by a power of ten.
+ *
+ * @param bignum big integer to multiply in place.
+ * @param decade exponent of the power of ten.
+ */
+static void __convert_bignum_multiply_power_of_ten(convert_bignum_t* bignum, u32 decade) {
+    while (decade > CONVERT_U32_MAX_DECADE) {
+        __convert_bignum_multiply(bignum, __convert_u32_powers_of_ten[CONVERT_U32_MAX_DECADE]);
+        decade -= CONVERT_U32_MAX_DECADE;
+    }
+    __convert_bignum_multiply(bignum, __convert_u32_powers_of_ten[decade]);
+}
+
+/**
+ * @brief Multiply a big integer by a power of two.
+ *
+ * @param bignum big integer to shift in place.
+ * @param bits exponent of the power of two.
+ */
+static void __convert_bignum_shift_left(convert_bignum_t* bignum, u32 bits) {
+    u32 words = bits / 32;
+    u32 index;
+
+    bits %= 32;
+    if (bignum->length == 0) {
+        return;
+    }
+
+    if (bits != 0) {
+        bignum->words[bignum->length] = 0;
+        for (index = bignum->length; index > 0; index--) {
+            bignum->words[index] = (bignum->words[index] << bits) | (bignum->words[index - 1] >> (32 - bits));
+        }
+        bignum->words[0] <<= bits;
+        if (bignum->words[bignum->length] != 0) {
+            bignum->length++;
+        }
+    }
+
+    if (words != 0) {
+        for (index = bignum->length; index > 0; index--) {
+            bignum->words[index - 1 + words] = bignum->words[index - 1];
+        }
+        memory_set_value((u8*)bignum->words, 0, words * sizeof(u32));
+        bignum->length += words;
+    }
+}
+
+/**
+ * @brief Compare two big integers.
+ *
+ * @param left left operand.
+ * @param right right operand.
+ * @return a negative number, 0 or a positive number as left is below, equal to or above right.
+ */
+static s32 __convert_bignum_compare(const convert_bignum_t* left, const convert_bignum_t* right) {
+    u32 index;
+
+    if (left->length != right->length) {
+        return left->length < right->length ? -1 : 1;
+    }
+
+    for (index = left->length; index > 0; index--) {
+        if (left->words[index - 1] != right->words[index - 1]) {
+            return left->words[index - 1] < right->words[index - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Subtract a big integer from another.
+ *
+ * @param left big integer to subtract from in place (not below right).
+ * @param right big integer to subtract.
+ */
+static void __convert_bignum_subtract(convert_bignum_t* left, const convert_bignum_t* right) {
+    u64 borrow = 0;
+    u64 difference;
+    u32 index;
+
+    for (index = 0; index < left->length; index++) {
+        difference = (u64)left->words[index] - (index < right->length ? right->words[index] : 0) - borrow;
+        left->words[index] = (u32)difference;
+        borrow = (difference >> 32) & 1;
+    }
+
+    while (left->length > 0 && left->words[left->length - 1] == 0) {
+        left->length--;
+    }
+}
+
+/**
+ * @brief Expand a double exactly and round it once, half to even.
+ *
+ * The value is kept as numerator / denominator, scaled so the quotient is
+ * the digit at the current position. Every digit is the integral part of
+ * the quotient, found by subtracting the denominator at most 9 times, so
+ * only 32-bit multiplies are needed.
+ *
+ * @param decimal destination for the digits and exponent.
+ * @param value finite value to convert.
+ * @param digits significant digits to keep, or digits after the decimal point if fixed.
+ * @param fixed whether digits counts the digits after the decimal point.
+ */
+static void __convert_double_exact(convert_decimal_t* decimal, double value, s32 digits, bool fixed) {
+    convert_bignum_t numerator;
+    convert_bignum_t denominator;
+    convert_bignum_t half;
+    convert_fp_t unpacked;
+    s32 exponent;
+    s32 count;
+    s32 index;
+    s32 order;
+    bool round_up;
+    u8 digit;
+
+    if (value < 0.0) {
+        value = -value;
+    }
+
+    decimal->length = 0;
+    decimal->exponent = 0;
+    if (value == 0.0) {
+        return;
+    }
+
+    unpacked = __convert_fp_from_double(value);
+    __convert_bignum_set(&numerator, unpacked.fraction);
+    __convert_bignum_set(&denominator, 1);
+    if (unpacked.exponent >= 0) {
+        __convert_bignum_shift_left(&numerator, (u32)unpacked.exponent);
+    } else {
+        __convert_bignum_shift_left(&denominator, (u32)-unpacked.exponent);
+    }
+
+    /* floor(log10(2^msb)) with log10(2) ~= 78913 / 2^18, the loops below fix it up by a decade */
+    exponent = ((unpacked.exponent + 63 - __builtin_clzll(unpacked.fraction)) * 78913) >> 18;
+    if (exponent >= 0) {
+        __convert_bignum_multiply_power_of_ten(&denominator, (u32)exponent);
+    } else {
+        __convert_bignum_multiply_power_of_ten(&numerator, (u32)-exponent);
+    }
+
+    /* bring the quotient into [1, 10), the first digit is then at 10^exponent */
+    while (__convert_bignum_compare(&numerator, &denominator) < 0) {
+        __convert_bignum_multiply(&numerator, 10);
+        exponent--;
+    }
+    half = denominator;
+    __convert_bignum_multiply(&half, 10);
+    while (__convert_bignum_compare(&numerator, &half) >= 0) {
+        denominator = half;
+        __convert_bignum_multiply(&half, 10);
+        exponent++;
+    }
+
+    count = fixed ? exponent + 1 + digits : digits;
+    if (count > CONVERT_DECIMAL_MAX_DIGITS) {
+        count = CONVERT_DECIMAL_MAX_DIGITS;
+    }
+    if (count < 0) {
+        /* everything is below half of the rounding position */
+        return;
+    }
+
+    for (index = 0; index < count; index++) {
+        digit = 0;
+        while (__convert_bignum_compare(&numerator, &denominator) >= 0) {
+            __convert_bignum_subtract(&numerator, &denominator);
+            digit++;
+        }
+        decimal->digits[index] = (char)('0' + digit);
+        __convert_bignum_multiply(&numerator, 10);
+    }
+
+    /* the quotient is now the first dropped digit and what follows it */
+    half = denominator;
+    __convert_bignum_multiply(&half, 5);
+    order = __convert_bignum_compare(&numerator, &half);
+    round_up = order > 0 || (order == 0 && count > 0 && ((decimal->digits[count - 1] - '0') & 1) != 0);
+
+    decimal->exponent = exponent;
+    if (!round_up) {
+        decimal->length = (u8)count;
+    } else {
+        for (index = count - 1; index >= 0 && decimal->digits[index] == '9'; index--) {
+        }
+
+        if (index < 0) {
+            decimal->digits[0] = '1';
+            decimal->length = 1;
+            decimal->exponent++;
+        } else {
+            decimal->digits[index]++;
+            decimal->length = (u8)(index + 1);
+        }
+    }
+
+    while (decimal->length > 0 && decimal->digits[decimal->length - 1] == '0') {
+        decimal->length--;
+    }
+    if (decimal->length == 0) {
+        decimal->exponent = 0;
+    }
+}
+
+void convert_double_to_shortest_decimal(convert_decimal_t* decimal, double value) {
+    const convert_cached_power_t* power;
+    convert_fp_t unpacked;
+    convert_fp_t scale;
+    convert_fp_t scaled;
+    convert_fp_t lower;
+    convert_fp_t upper;
+
+    if (value < 0.0) {
+        value = -value;
+    }
+
+    decimal->length = 0;
+    decimal->exponent = 0;
+    if (value == 0.0) {
+        return;
+    }
+
+    unpacked = __convert_fp_from_double(value);
+    __convert_fp_boundaries(unpacked, &lower, &upper);
+
+    power = __convert_cached_power(upper.exponent);
+    scale.fraction = power->fraction;
+    scale.exponent = power->exponent;
+
+    scaled = __convert_fp_multiply(__convert_fp_normalize(unpacked), scale);
+    upper = __convert_fp_multiply(upper, scale);
+    lower = __convert_fp_multiply(lower, scale);
+
+    /* shrink the interval by one unit to stay inside it despite the rounded multiplication */
+    upper.fraction--;
+    lower.fraction++;
+
+    __convert_generate_digits(decimal, scaled, upper, upper.fraction - lower.fraction, -power->decade);
+
+    /* the exponent of the last digit becomes the exponent of the first digit */
+    while (decimal->length > 1 && decimal->digits[decimal->length - 1] == '0') {
+        decimal->length--;
+        decimal->exponent++;
+    }
+    decimal->exponent += (s32)decimal->length - 1;
+}
+
+void convert_double_to_significant_decimal(convert_decimal_t* decimal, double value, s32 digits) {
+    __convert_double_exact(decimal, value, digits, false);
+}
+
+void convert_double_to_fixed_decimal(convert_decimal_t* decimal, double value, s32 fraction) {
+    __convert_double_exact(decimal, value, fraction, true);
+}
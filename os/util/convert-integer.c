@@ -0,0 +1,175 @@
+#include <llanos/util/convert.h>
+#include <llanos/types.h>
+#include <llanos/limits.h>
+
+/* the largest group of digits that can be peeled off a u64 using 32-bit divisions only */
+#define CONVERT_CHUNK_DIVISOR   10000
+#define CONVERT_CHUNK_DIGITS    4
+
+/* a u64 has at most 20 digits, so at most 3 chunks are needed to fit the rest in 32 bits */
+#define CONVERT_MAX_CHUNKS      3
+
+static const char __convert_digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static const char __convert_lowercase_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+static const char __convert_uppercase_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/**
+ * @brief Count the decimal digits of a 32-bit value.
+ *
+ * @param value value to count the digits of.
+ * @return number of decimal digits (1 for 0).
+ */
+static size_t __convert_u32_decimal_length(u32 value) {
+    if (value < 10) {
+        return 1;
+    } else if (value < 100) {
+        return 2;
+    } else if (value < 1000) {
+        return 3;
+    } else if (value < 10000) {
+        return 4;
+    } else if (value < 100000) {
+        return 5;
+    } else if (value < 1000000) {
+        return 6;
+    } else if (value < 10000000) {
+        return 7;
+    } else if (value < 100000000) {
+        return 8;
+    } else if (value < 1000000000) {
+        return 9;
+    } else {
+        return 10;
+    }
+}
+
+/**
+ * @brief Write a value below 100 as exactly two digits.
+ *
+ * @param buffer destination of two characters.
+ * @param value value in [0, 100).
+ */
+static inline void __convert_write_pair(char* buffer, u32 value) {
+    buffer[0] = __convert_digit_pairs[value * 2];
+    buffer[1] = __convert_digit_pairs[(value * 2) + 1];
+}
+
+/**
+ * @brief Divide a u64 in place by CONVERT_CHUNK_DIVISOR using 32-bit divisions.
+ *
+ * The value is treated as four 16-bit limbs and divided schoolbook style.
+ * Because the divisor is below 2^14, every partial dividend fits in 32 bits.
+ *
+ * @param value value to divide (replaced by the quotient).
+ * @return remainder of the division.
+ */
+static u32 __convert_divide_by_chunk(u64* value) {
+    u32 high = (u32)(*value >> 32);
+    u32 low = (u32)*value;
+    u32 partial;
+    u32 quotient_high;
+    u32 quotient_low;
+
+    partial = high >> 16;
+    quotient_high = (partial / CONVERT_CHUNK_DIVISOR) << 16;
+    partial = ((partial % CONVERT_CHUNK_DIVISOR) << 16) | (high & 0xffff);
+    quotient_high |= partial / CONVERT_CHUNK_DIVISOR;
+    partial = ((partial % CONVERT_CHUNK_DIVISOR) << 16) | (low >> 16);
+    quotient_low = (partial / CONVERT_CHUNK_DIVISOR) << 16;
+    partial = ((partial % CONVERT_CHUNK_DIVISOR) << 16) | (low & 0xffff);
+    quotient_low |= partial / CONVERT_CHUNK_DIVISOR;
+
+    *value = ((u64)quotient_high << 32) | quotient_low;
+    return partial % CONVERT_CHUNK_DIVISOR;
+}
+
+size_t convert_u32_to_decimal(char* buffer, u32 value) {
+    size_t length = __convert_u32_decimal_length(value);
+    char* digit = buffer + length;
+
+    while (value >= 100) {
+        digit -= 2;
+        __convert_write_pair(digit, value % 100);
+        value /= 100;
+    }
+
+    if (value >= 10) {
+        __convert_write_pair(digit - 2, value);
+    } else {
+        digit[-1] = (char)('0' + value);
+    }
+    return length;
+}
+
+size_t convert_u64_to_decimal(char* buffer, u64 value) {
+    u32 chunks[CONVERT_MAX_CHUNKS];
+    size_t count = 0;
+    size_t length;
+
+    if (value <= U32MAX) {
+        return convert_u32_to_decimal(buffer, (u32)value);
+    }
+
+    while (value > U32MAX) {
+        chunks[count++] = __convert_divide_by_chunk(&value);
+    }
+
+    length = convert_u32_to_decimal(buffer, (u32)value);
+    while (count > 0) {
+        count--;
+        __convert_write_pair(&buffer[length], chunks[count] / 100);
+        __convert_write_pair(&buffer[length + 2], chunks[count] % 100);
+        length += CONVERT_CHUNK_DIGITS;
+    }
+    return length;
+}
+
+size_t convert_u64_to_power_of_two_base(char* buffer, u64 value, u8 bits_per_digit, bool uppercase) {
+    const char* digits = uppercase ? __convert_uppercase_digits : __convert_lowercase_digits;
+    u32 mask = ((u32)1 << bits_per_digit) - 1;
+    u32 high = (u32)(value >> 32);
+    u32 low = (u32)value;
+    u32 bits;
+    size_t length;
+    size_t index;
+
+    if (high != 0) {
+        bits = 64 - (u32)__builtin_clz(high);
+    } else if (low != 0) {
+        bits = 32 - (u32)__builtin_clz(low);
+    } else {
+        bits = 1;
+    }
+    length = (bits + bits_per_digit - 1) / bits_per_digit;
+
+    if (high == 0) {
+        /* the common case never touches the upper word */
+        for (index = length; index > 0; index--) {
+            buffer[index - 1] = digits[low & mask];
+            low >>= bits_per_digit;
+        }
+    } else {
+        for (index = length; index > 0; index--) {
+            buffer[index - 1] = digits[(u32)value & mask];
+            value >>= bits_per_digit;
+        }
+    }
+    return length;
+}
@@ -0,0 +1,737 @@
+#include <llanos/util/format.h>
+#include <llanos/util/string.h>
+#include <llanos/util/memory.h>
+#include <llanos/util/convert.h>
+#include <llanos/types.h>
+#include <llanos/limits.h>
+#include <stdarg.h>
+
+/* 64 binary digits is the longest integer body that can be produced */
+#define FORMAT_INTEGER_BUFFER_SIZE  64
+#define FORMAT_FLOAT_BUFFER_SIZE    64
+#define FORMAT_PADDING_CHUNK_SIZE   16
+
+/* precision is clamped so every floating point field fits FORMAT_FLOAT_BUFFER_SIZE */
+#define FORMAT_FLOAT_MAX_PRECISION  40
+
+/* %f switches to scientific notation outside of [10^-20, 10^19) */
+#define FORMAT_FIXED_MAX_EXPONENT   19
+#define FORMAT_FIXED_MIN_EXPONENT   -20
+
+#define FORMAT_DOUBLE_MAX           1.7976931348623157e308
+
+typedef enum format_length_e format_length_t;
+typedef struct format_specification_s format_specification_t;
+typedef struct format_output_s format_output_t;
+typedef struct format_buffer_s format_buffer_t;
+
+enum format_length_e {
+    FORMAT_LENGTH_DEFAULT = 0,
+    FORMAT_LENGTH_CHAR,
+    FORMAT_LENGTH_SHORT,
+    FORMAT_LENGTH_LONG,
+    FORMAT_LENGTH_LONG_LONG,
+    FORMAT_LENGTH_SIZE
+};
+
+/**
+ * @brief A parsed format specifier.
+ *
+ * @member left_justify pad on the right instead of the left.
+ * @member zero_pad pad with zeros (between the sign and the digits) instead of spaces.
+ * @member force_sign always emit a sign for signed conversions.
+ * @member space_sign emit a space in place of a positive sign.
+ * @member width minimum number of characters of the field.
+ * @member precision precision of the field (-1 when not given).
+ * @member length size of the integer argument.
+ * @member specifier conversion character.
+ */
+struct format_specification_s {
+    bool left_justify;
+    bool zero_pad;
+    bool force_sign;
+    bool space_sign;
+    s32 width;
+    s32 precision;
+    format_length_t length;
+    char specifier;
+};
+
+struct format_output_s {
+    format_sink_t sink;
+    void* context;
+    s32 count;
+};
+
+struct format_buffer_s {
+    char* buffer;
+    size_t size;
+    size_t position;
+};
+
+static const char __format_spaces[FORMAT_PADDING_CHUNK_SIZE] = {
+    ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '
+};
+
+static const char __format_zeros[FORMAT_PADDING_CHUNK_SIZE] = {
+    '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0'
+};
+
+/**
+ * @brief Hand a span of output to the sink.
+ *
+ * @param output output to emit the span on.
+ * @param span first character of the span.
+ * @param length number of characters in the span (nothing is emitted when 0).
+ */
+static void __format_emit(format_output_t* output, const char* span, size_t length) {
+    if (length > 0) {
+        output->sink(output->context, span, length);
+        output->count += (s32)length;
+    }
+}
+
+/**
+ * @brief Emit length characters of padding in chunks.
+ *
+ * @param output output to emit the padding on.
+ * @param padding chunk of FORMAT_PADDING_CHUNK_SIZE padding characters.
+ * @param length number of padding characters to emit.
+ */
+static void __format_emit_padding(format_output_t* output, const char* padding, size_t length) {
+    while (length > FORMAT_PADDING_CHUNK_SIZE) {
+        __format_emit(output, padding, FORMAT_PADDING_CHUNK_SIZE);
+        length -= FORMAT_PADDING_CHUNK_SIZE;
+    }
+    __format_emit(output, padding, length);
+}
+
+/**
+ * @brief Emit a field with its width padding applied.
+ *
+ * The field is laid out as [padding][prefix][zero padding][leading zeros][body][padding].
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field (width and justification).
+ * @param prefix sign or other prefix of the field.
+ * @param prefix_length number of characters in prefix.
+ * @param leading_zeros number of zeros between the prefix and the body.
+ * @param body body of the field.
+ * @param body_length number of characters in body.
+ */
+static void __format_emit_field(
+        format_output_t* output,
+        format_specification_t* specification,
+        const char* prefix,
+        size_t prefix_length,
+        size_t leading_zeros,
+        const char* body,
+        size_t body_length) {
+    size_t field_length = prefix_length + leading_zeros + body_length;
+    size_t padding = 0;
+
+    if (specification->width > 0 && (size_t)specification->width > field_length) {
+        padding = (size_t)specification->width - field_length;
+    }
+
+    if (!specification->left_justify && !specification->zero_pad) {
+        __format_emit_padding(output, __format_spaces, padding);
+    }
+
+    __format_emit(output, prefix, prefix_length);
+
+    if (!specification->left_justify && specification->zero_pad) {
+        __format_emit_padding(output, __format_zeros, padding);
+    }
+
+    __format_emit_padding(output, __format_zeros, leading_zeros);
+    __format_emit(output, body, body_length);
+
+    if (specification->left_justify) {
+        __format_emit_padding(output, __format_spaces, padding);
+    }
+}
+
+/**
+ * @brief Pick the sign character of a number.
+ *
+ * @param specification specifier for the field.
+ * @param negative whether or not the number is negative.
+ * @param is_signed whether or not the conversion is a signed conversion.
+ * @return the sign character, or '\0' when no sign is printed.
+ */
+static char __format_sign(format_specification_t* specification, bool negative, bool is_signed) {
+    if (negative) {
+        return '-';
+    } else if (is_signed && specification->force_sign) {
+        return '+';
+    } else if (is_signed && specification->space_sign) {
+        return ' ';
+    } else {
+        return '\0';
+    }
+}
+
+/**
+ * @brief Convert an unsigned integer to text in the given base.
+ *
+ * @param buffer destination buffer of FORMAT_INTEGER_BUFFER_SIZE characters.
+ * @param value value to convert.
+ * @param base base of the conversion (2, 8, 10 or 16).
+ * @param uppercase use uppercase letters for digits above 9.
+ * @return number of digits written at the start of the buffer.
+ */
+static size_t __format_unsigned_base(char* buffer, u64 value, u8 base, bool uppercase) {
+    switch (base) {
+        case 2:
+            return convert_u64_to_power_of_two_base(buffer, value, 1, uppercase);
+        case 8:
+            return convert_u64_to_power_of_two_base(buffer, value, 3, uppercase);
+        case 16:
+            return convert_u64_to_power_of_two_base(buffer, value, 4, uppercase);
+        default:
+            return convert_u64_to_decimal(buffer, value);
+    }
+}
+
+/**
+ * @brief Emit an integer field.
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param magnitude absolute value of the integer.
+ * @param negative whether or not the integer is negative.
+ * @param is_signed whether or not the conversion is a signed conversion.
+ * @param base base of the conversion.
+ */
+static void __format_integer(
+        format_output_t* output,
+        format_specification_t* specification,
+        u64 magnitude,
+        bool negative,
+        bool is_signed,
+        u8 base) {
+    char digits[FORMAT_INTEGER_BUFFER_SIZE];
+    char sign = __format_sign(specification, negative, is_signed);
+    size_t length;
+    size_t leading_zeros = 0;
+
+    length = __format_unsigned_base(digits, magnitude, base, specification->specifier == 'X');
+
+    if (specification->precision >= 0) {
+        /* an explicit precision turns off zero padding, and a zero precision hides a zero value */
+        specification->zero_pad = false;
+        if (specification->precision == 0 && magnitude == 0) {
+            length = 0;
+        } else if ((size_t)specification->precision > length) {
+            leading_zeros = (size_t)specification->precision - length;
+        }
+    }
+
+    __format_emit_field(
+        output,
+        specification,
+        &sign,
+        sign != '\0' ? 1 : 0,
+        leading_zeros,
+        digits,
+        length
+    );
+}
+
+/**
+ * @brief Fetch the digit of a decimal at a power of ten.
+ *
+ * @param decimal decimal to read.
+ * @param place power of ten of the digit.
+ * @return the digit character ('0' outside of the significant digits).
+ */
+static char __format_decimal_digit(const convert_decimal_t* decimal, s32 place) {
+    s32 index = decimal->exponent - place;
+
+    if (index >= 0 && index < (s32)decimal->length) {
+        return decimal->digits[index];
+    }
+    return '0';
+}
+
+/**
+ * @brief Emit "nan" or "inf" when a value is not finite.
+ *
+ * The precision of the specifier is clamped to FORMAT_FLOAT_MAX_PRECISION.
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param value value to check.
+ * @return whether or not the value was emitted.
+ */
+static bool __format_non_finite(format_output_t* output, format_specification_t* specification, double value) {
+    char sign = __format_sign(specification, value < 0.0, true);
+
+    if (specification->precision > FORMAT_FLOAT_MAX_PRECISION) {
+        specification->precision = FORMAT_FLOAT_MAX_PRECISION;
+    }
+
+    if (value != value) {
+        specification->zero_pad = false;
+        __format_emit_field(output, specification, NULL, 0, 0, "nan", 3);
+        return true;
+    } else if (value > FORMAT_DOUBLE_MAX || value < -FORMAT_DOUBLE_MAX) {
+        specification->zero_pad = false;
+        __format_emit_field(output, specification, &sign, sign != '\0' ? 1 : 0, 0, "inf", 3);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Emit a decimal in scientific notation.
+ *
+ * Without a precision the round trip digits are printed (with at least one fractional digit).
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param sign sign character of the field ('\0' for none).
+ * @param decimal shortest digits of the value, or its digits rounded to precision + 1 significant digits.
+ */
+static void __format_scientific_decimal(
+        format_output_t* output,
+        format_specification_t* specification,
+        char sign,
+        const convert_decimal_t* decimal) {
+    char body[FORMAT_FLOAT_BUFFER_SIZE];
+    s32 fraction_digits = (s32)decimal->length - 1;
+    s32 exponent;
+    s32 place;
+    size_t length = 0;
+
+    if (specification->precision >= 0) {
+        fraction_digits = specification->precision;
+    } else if (fraction_digits < 1) {
+        fraction_digits = 1;
+    }
+    exponent = decimal->exponent;
+
+    body[length++] = __format_decimal_digit(decimal, exponent);
+    if (fraction_digits > 0) {
+        body[length++] = '.';
+        for (place = exponent - 1; place >= exponent - fraction_digits; place--) {
+            body[length++] = __format_decimal_digit(decimal, place);
+        }
+    }
+    body[length++] = 'e';
+    body[length++] = exponent < 0 ? '-' : '+';
+    length += convert_u32_to_decimal(&body[length], (u32)(exponent < 0 ? -exponent : exponent));
+
+    __format_emit_field(output, specification, &sign, sign != '\0' ? 1 : 0, 0, body, length);
+}
+
+/**
+ * @brief Emit a floating point number in scientific notation.
+ *
+ * With a precision the exact value is rounded once, so the shortest digits
+ * are never rounded a second time.
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param value value to emit.
+ */
+static void __format_scientific_notation(format_output_t* output, format_specification_t* specification, double value) {
+    convert_decimal_t decimal;
+
+    if (__format_non_finite(output, specification, value)) {
+        return;
+    }
+
+    if (specification->precision >= 0) {
+        convert_double_to_significant_decimal(&decimal, value, specification->precision + 1);
+    } else {
+        convert_double_to_shortest_decimal(&decimal, value);
+    }
+    __format_scientific_decimal(output, specification, __format_sign(specification, value < 0.0, true), &decimal);
+}
+
+/**
+ * @brief Emit a floating point number.
+ *
+ * Values of 10^19 and above, and values below 10^-20 printed without a precision,
+ * are emitted in scientific notation so the field stays bounded. With a
+ * precision the exact value is rounded once, as in scientific notation.
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param value value to emit.
+ */
+static void __format_floating_point(format_output_t* output, format_specification_t* specification, double value) {
+    char body[FORMAT_FLOAT_BUFFER_SIZE];
+    char sign = __format_sign(specification, value < 0.0, true);
+    convert_decimal_t decimal;
+    s32 fraction_digits;
+    s32 place;
+    size_t length = 0;
+
+    if (__format_non_finite(output, specification, value)) {
+        return;
+    }
+
+    convert_double_to_shortest_decimal(&decimal, value);
+    if (decimal.length != 0
+            && (decimal.exponent >= FORMAT_FIXED_MAX_EXPONENT
+                || (specification->precision < 0 && decimal.exponent < FORMAT_FIXED_MIN_EXPONENT))) {
+        if (specification->precision >= 0) {
+            convert_double_to_significant_decimal(&decimal, value, specification->precision + 1);
+        }
+        __format_scientific_decimal(output, specification, sign, &decimal);
+        return;
+    }
+
+    if (specification->precision >= 0) {
+        convert_double_to_fixed_decimal(&decimal, value, specification->precision);
+        fraction_digits = specification->precision;
+    } else {
+        fraction_digits = (s32)decimal.length - decimal.exponent - 1;
+        if (fraction_digits < 1) {
+            fraction_digits = 1;
+        }
+    }
+
+    place = decimal.exponent > 0 ? decimal.exponent : 0;
+    for (; place >= 0; place--) {
+        body[length++] = __format_decimal_digit(&decimal, place);
+    }
+    if (fraction_digits > 0) {
+        body[length++] = '.';
+        for (place = -1; place >= -fraction_digits; place--) {
+            body[length++] = __format_decimal_digit(&decimal, place);
+        }
+    }
+
+    __format_emit_field(output, specification, &sign, sign != '\0' ? 1 : 0, 0, body, length);
+}
+
+/**
+ * @brief Emit a string field.
+ *
+ * @param output output to emit the field on.
+ * @param specification specifier for the field.
+ * @param value string to emit.
+ * @param length number of characters in value.
+ */
+static void __format_string(format_output_t* output, format_specification_t* specification, const char* value, size_t length) {
+    if (specification->precision >= 0 && (size_t)specification->precision < length) {
+        length = (size_t)specification->precision;
+    }
+
+    specification->zero_pad = false;
+    __format_emit_field(output, specification, NULL, 0, 0, value, length);
+}
+
+/**
+ * @brief Parse a decimal number from the format string.
+ *
+ * @param format pointer to the format string pointer (advanced past the number).
+ * @return the parsed number.
+ */
+static s32 __format_parse_number(const char** format) {
+    s32 value = 0;
+
+    while (**format >= '0' && **format <= '9') {
+        value = (value * 10) + (**format - '0');
+        (*format)++;
+    }
+    return value;
+}
+
+/**
+ * @brief Parse a format specifier starting right after the '%'.
+ *
+ * @param specification destination for the parsed specifier.
+ * @param format format string positioned after the '%'.
+ * @param arguments argument list (for `*` width and precision).
+ * @return pointer to the specifier character.
+ */
+static const char* __format_parse_specification(format_specification_t* specification, const char* format, va_list* arguments) {
+    s32 width;
+    bool parsing_flags = true;
+
+    specification->left_justify = false;
+    specification->zero_pad = false;
+    specification->force_sign = false;
+    specification->space_sign = false;
+    specification->width = 0;
+    specification->precision = -1;
+    specification->length = FORMAT_LENGTH_DEFAULT;
+
+    while (parsing_flags) {
+        switch (*format) {
+            case '-':
+                specification->left_justify = true;
+                format++;
+                break;
+            case '0':
+                specification->zero_pad = true;
+                format++;
+                break;
+            case '+':
+                specification->force_sign = true;
+                format++;
+                break;
+            case ' ':
+                specification->space_sign = true;
+                format++;
+                break;
+            default:
+                parsing_flags = false;
+                break;
+        }
+    }
+
+    if (*format == '*') {
+        width = (s32)va_arg(*arguments, int);
+        if (width < 0) {
+            specification->left_justify = true;
+            width = -width;
+        }
+        specification->width = width;
+        format++;
+    } else {
+        specification->width = __format_parse_number(&format);
+    }
+
+    if (*format == '.') {
+        format++;
+        if (*format == '*') {
+            specification->precision = (s32)va_arg(*arguments, int);
+            if (specification->precision < 0) {
+                specification->precision = -1;
+            }
+            format++;
+        } else {
+            specification->precision = __format_parse_number(&format);
+        }
+    }
+
+    if (*format == 'h') {
+        format++;
+        specification->length = FORMAT_LENGTH_SHORT;
+        if (*format == 'h') {
+            format++;
+            specification->length = FORMAT_LENGTH_CHAR;
+        }
+    } else if (*format == 'l') {
+        format++;
+        specification->length = FORMAT_LENGTH_LONG;
+        if (*format == 'l') {
+            format++;
+            specification->length = FORMAT_LENGTH_LONG_LONG;
+        }
+    } else if (*format == 'z') {
+        format++;
+        specification->length = FORMAT_LENGTH_SIZE;
+    }
+
+    specification->specifier = *format;
+    return format;
+}
+
+/**
+ * @brief Fetch a signed integer argument of the specifier's length.
+ *
+ * @param length length modifier of the specifier.
+ * @param arguments argument list.
+ * @return the argument widened to 64 bits.
+ */
+static s64 __format_signed_argument(format_length_t length, va_list* arguments) {
+    switch (length) {
+        case FORMAT_LENGTH_CHAR:
+            return (s64)(s8)va_arg(*arguments, int);
+        case FORMAT_LENGTH_SHORT:
+            return (s64)(s16)va_arg(*arguments, int);
+        case FORMAT_LENGTH_LONG:
+            return (s64)va_arg(*arguments, long);
+        case FORMAT_LENGTH_LONG_LONG:
+            return (s64)va_arg(*arguments, long long);
+        case FORMAT_LENGTH_SIZE:
+            return (s64)va_arg(*arguments, size_t);
+        default:
+            return (s64)va_arg(*arguments, s32);
+    }
+}
+
+/**
+ * @brief Fetch an unsigned integer argument of the specifier's length.
+ *
+ * @param length length modifier of the specifier.
+ * @param arguments argument list.
+ * @return the argument widened to 64 bits.
+ */
+static u64 __format_unsigned_argument(format_length_t length, va_list* arguments) {
+    switch (length) {
+        case FORMAT_LENGTH_CHAR:
+            return (u64)(u8)va_arg(*arguments, unsigned int);
+        case FORMAT_LENGTH_SHORT:
+            return (u64)(u16)va_arg(*arguments, unsigned int);
+        case FORMAT_LENGTH_LONG:
+            return (u64)va_arg(*arguments, unsigned long);
+        case FORMAT_LENGTH_LONG_LONG:
+            return (u64)va_arg(*arguments, unsigned long long);
+        case FORMAT_LENGTH_SIZE:
+            return (u64)va_arg(*arguments, size_t);
+        default:
+            return (u64)va_arg(*arguments, u32);
+    }
+}
+
+/**
+ * @brief Convert a single argument according to its specifier.
+ *
+ * @param output output to emit the field on.
+ * @param specification parsed specifier.
+ * @param arguments argument list.
+ * @return false if the specifier is invalid, true otherwise.
+ */
+static bool __format_convert(format_output_t* output, format_specification_t* specification, va_list* arguments) {
+    s64 signed_value;
+    u64 magnitude;
+    size_t length;
+    const char* string;
+    char character;
+
+    switch (specification->specifier) {
+        case 'd':
+        case 'i':
+            signed_value = __format_signed_argument(specification->length, arguments);
+            if (signed_value < 0) {
+                /* negate through u64 so that S64MIN does not overflow */
+                magnitude = (u64)(-(signed_value + 1)) + 1;
+            } else {
+                magnitude = (u64)signed_value;
+            }
+            __format_integer(output, specification, magnitude, signed_value < 0, true, 10);
+            break;
+        case 'u':
+            __format_integer(output, specification, __format_unsigned_argument(specification->length, arguments), false, false, 10);
+            break;
+        case 'o':
+            __format_integer(output, specification, __format_unsigned_argument(specification->length, arguments), false, false, 8);
+            break;
+        case 'x':
+        case 'X':
+            __format_integer(output, specification, __format_unsigned_argument(specification->length, arguments), false, false, 16);
+            break;
+        case 'b':
+            __format_integer(output, specification, __format_unsigned_argument(specification->length, arguments), false, false, 2);
+            break;
+        case 'f':
+            __format_floating_point(output, specification, va_arg(*arguments, double));
+            break;
+        case 'e':
+            __format_scientific_notation(output, specification, va_arg(*arguments, double));
+            break;
+        case 'c':
+            character = (char)va_arg(*arguments, int);
+            specification->precision = -1;
+            __format_string(output, specification, &character, 1);
+            break;
+        case 's':
+            string = va_arg(*arguments, const char*);
+            if (string == NULL) {
+                string = "(null)";
+            }
+            __format_string(output, specification, string, string_length(string));
+            break;
+        case 'S':
+            length = va_arg(*arguments, size_t);
+            string = va_arg(*arguments, const char*);
+            __format_string(output, specification, string, length);
+            break;
+        case '%':
+            __format_emit(output, "%", 1);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sink used by kvsnprintf to store spans into a buffer.
+ *
+ * @param context format_buffer_t to store the span in.
+ * @param span span to store.
+ * @param length number of characters in span.
+ */
+static void __format_buffer_sink(void* context, const char* span, size_t length) {
+    format_buffer_t* buffer = (format_buffer_t*)context;
+    size_t available;
+
+    if (buffer->position + 1 < buffer->size) {
+        available = buffer->size - buffer->position - 1;
+        if (length > available) {
+            length = available;
+        }
+
+        memory_copy((u8*)&buffer->buffer[buffer->position], (const u8*)span, (u32)length);
+        buffer->position += length;
+    }
+}
+
+s32 format_stream(format_sink_t sink, void* context, const char* format, va_list arguments) {
+    format_output_t output;
+    format_specification_t specification;
+    va_list argument_list;
+    const char* run;
+    bool valid = true;
+
+    output.sink = sink;
+    output.context = context;
+    output.count = 0;
+
+    va_copy(argument_list, arguments);
+    while (valid && *format != '\0') {
+        /* hand the literal text up to the next specifier to the sink in one span */
+        run = format;
+        while (*format != '\0' && *format != '%') {
+            format++;
+        }
+        __format_emit(&output, run, (size_t)(format - run));
+
+        if (*format == '%') {
+            format = __format_parse_specification(&specification, format + 1, &argument_list);
+            valid = __format_convert(&output, &specification, &argument_list);
+            if (valid) {
+                format++;
+            }
+        }
+    }
+    va_end(argument_list);
+
+    return valid ? output.count : -1;
+}
+
+s32 kvsnprintf(char* buffer, size_t size, const char* format, va_list arguments) {
+    format_buffer_t destination;
+    s32 length;
+
+    destination.buffer = buffer;
+    destination.size = size;
+    destination.position = 0;
+
+    length = format_stream(__format_buffer_sink, &destination, format, arguments);
+
+    if (size > 0) {
+        buffer[destination.position] = '\0';
+    }
+    return length;
+}
+
+s32 ksnprintf(char* buffer, size_t size, const char* format, ...) {
+    va_list arguments;
+    s32 length;
+
+    va_start(arguments, format);
+    length = kvsnprintf(buffer, size, format, arguments);
+    va_end(arguments);
+
+    return length;
+}
@@ -5,4 +5,26 @@ void memory_set_value(u8* dest, u8 value, u32 length) {
     while (length--) {
         dest[length] = value;
     }
-}
\ No newline at end of file
+}
+
+void memory_copy(u8* dest, const u8* source, u32 length) {
+    /* only take the wide path when both pointers can reach word alignment together */
+    if ((((uintptr_t)dest ^ (uintptr_t)source) & (sizeof(u32) - 1)) == 0) {
+        while (length > 0 && ((uintptr_t)dest & (sizeof(u32) - 1)) != 0) {
+            *dest++ = *source++;
+            length--;
+        }
+
+        while (length >= sizeof(u32)) {
+            *(u32*)dest = *(const u32*)source;
+            dest += sizeof(u32);
+            source += sizeof(u32);
+            length -= sizeof(u32);
+        }
+    }
+
+    while (length > 0) {
+        *dest++ = *source++;
+        length--;
+    }
+}
@@ -0,0 +1,29 @@
+#include <llanos/util/ring.h>
+#include <llanos/types.h>
+
+void ring_initialize(ring_t* ring, u8* buffer, u32 size) {
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+bool ring_push(ring_t* ring, u8 byte) {
+    if (ring_is_full(ring)) {
+        return false;
+    }
+
+    ring->buffer[ring->head & (ring->size - 1)] = byte;
+    ring->head++;
+    return true;
+}
+
+bool ring_pop(ring_t* ring, u8* byte) {
+    if (ring_is_empty(ring)) {
+        return false;
+    }
+
+    *byte = ring->buffer[ring->tail & (ring->size - 1)];
+    ring->tail++;
+    return true;
+}
@@ -0,0 +1,310 @@
+#include <llanos/video/framebuffer.h>
+#include <llanos/video/font.h>
+#include <llanos/video/vga.h>
+#include <llanos/types.h>
+
+/* the 5x7 font is drawn one pixel in from the left and top, with every font row doubled */
+#define FRAMEBUFFER_GLYPH_LEFT          1
+#define FRAMEBUFFER_GLYPH_TOP           1
+#define FRAMEBUFFER_GLYPH_SCALE_Y       2
+
+/* marks a used glyph cache entry, so a key is never 0 */
+#define FRAMEBUFFER_GLYPH_KEY_USED      0x10000
+
+/* unaligned 128-bit vector of pixels (compiles to SSE2 movdqu on x86) */
+typedef u32 framebuffer_vector_t __attribute__((vector_size(16), aligned(4)));
+
+#define FRAMEBUFFER_VECTOR_PIXELS       (sizeof(framebuffer_vector_t) / sizeof(u32))
+
+#if defined(__i386__) || defined(__x86_64__)
+#define FRAMEBUFFER_VECTOR_TARGET       __attribute__((target("sse2")))
+#else
+#define FRAMEBUFFER_VECTOR_TARGET
+#endif
+
+/* standard VGA text mode colors as 0xrrggbb, indexed by vga_color_t */
+static const u32 __framebuffer_vga_colors[16] = {
+    0x000000,
+    0x0000aa,
+    0x00aa00,
+    0x00aaaa,
+    0xaa0000,
+    0xaa00aa,
+    0xaa5500,
+    0xaaaaaa,
+    0x555555,
+    0x5555ff,
+    0x55ff55,
+    0x55ffff,
+    0xff5555,
+    0xff55ff,
+    0xffff55,
+    0xffffff
+};
+
+/**
+ * @brief Copy pixels with 128-bit vector loads and stores.
+ *
+ * @param dest first pixel to write.
+ * @param source first pixel to read (below dest or not overlapping it).
+ * @param count number of pixels to copy.
+ */
+static FRAMEBUFFER_VECTOR_TARGET void __framebuffer_copy_vector(u32* dest, const u32* source, size_t count) {
+    size_t index = 0;
+
+    for (; index + FRAMEBUFFER_VECTOR_PIXELS <= count; index += FRAMEBUFFER_VECTOR_PIXELS) {
+        *(framebuffer_vector_t*)&dest[index] = *(const framebuffer_vector_t*)&source[index];
+    }
+    for (; index < count; index++) {
+        dest[index] = source[index];
+    }
+}
+
+/**
+ * @brief Fill pixels with 128-bit vector stores.
+ *
+ * @param dest first pixel to write.
+ * @param value pixel value to write.
+ * @param count number of pixels to fill.
+ */
+static FRAMEBUFFER_VECTOR_TARGET void __framebuffer_fill_vector(u32* dest, u32 value, size_t count) {
+    framebuffer_vector_t values = {value, value, value, value};
+    size_t index = 0;
+
+    for (; index + FRAMEBUFFER_VECTOR_PIXELS <= count; index += FRAMEBUFFER_VECTOR_PIXELS) {
+        *(framebuffer_vector_t*)&dest[index] = values;
+    }
+    for (; index < count; index++) {
+        dest[index] = value;
+    }
+}
+
+/**
+ * @brief Copy a run of pixels within or into the framebuffer.
+ *
+ * @param console console the pixels belong to.
+ * @param dest first pixel to write.
+ * @param source first pixel to read (below dest or not overlapping it).
+ * @param count number of pixels to copy.
+ */
+static void __framebuffer_copy(framebuffer_console_t* console, u32* dest, const u32* source, size_t count) {
+    size_t index;
+
+    if (console->vector) {
+        __framebuffer_copy_vector(dest, source, count);
+        return;
+    }
+
+    for (index = 0; index < count; index++) {
+        dest[index] = source[index];
+    }
+}
+
+/**
+ * @brief Fill a run of pixels of the framebuffer.
+ *
+ * @param console console the pixels belong to.
+ * @param dest first pixel to write.
+ * @param value pixel value to write.
+ * @param count number of pixels to fill.
+ */
+static void __framebuffer_fill(framebuffer_console_t* console, u32* dest, u32 value, size_t count) {
+    size_t index;
+
+    if (console->vector) {
+        __framebuffer_fill_vector(dest, value, count);
+        return;
+    }
+
+    for (index = 0; index < count; index++) {
+        dest[index] = value;
+    }
+}
+
+/**
+ * @brief Get the first pixel of a pixel row.
+ *
+ * @param console console to look in.
+ * @param y pixel row.
+ * @return the first pixel of the row.
+ */
+static inline u32* __framebuffer_row(framebuffer_console_t* console, size_t y) {
+    return (u32*)(console->address + y * console->pitch);
+}
+
+/**
+ * @brief Scale an 8 bit color channel to a channel of the framebuffer.
+ *
+ * @param value 8 bit channel value.
+ * @param position bit position of the channel.
+ * @param size number of bits of the channel.
+ * @return the channel bits of a pixel.
+ */
+static u32 __framebuffer_channel(u32 value, u8 position, u8 size) {
+    if (size > 8) {
+        size = 8;
+    }
+    return (value >> (8 - size)) << position;
+}
+
+/**
+ * @brief Get a glyph rasterised in the wanted colors, rasterising it on a cache miss.
+ *
+ * @param console console whose cache to use.
+ * @param character character of the glyph.
+ * @param color_fg foreground color.
+ * @param color_bg background color.
+ * @return FRAMEBUFFER_CELL_HEIGHT rows of FRAMEBUFFER_CELL_WIDTH pixels.
+ */
+static const u32* __framebuffer_glyph(
+        framebuffer_console_t* console,
+        char character,
+        vga_color_t color_fg,
+        vga_color_t color_bg) {
+    u32 key = FRAMEBUFFER_GLYPH_KEY_USED | ((u32)(color_fg & 0xf) << 12) | ((u32)(color_bg & 0xf) << 8) | (u8)character;
+    framebuffer_glyph_t* glyph = &console->glyph_cache[((u32)(u8)character * 31 + (u32)color_fg * 7 + (u32)color_bg) & (FRAMEBUFFER_GLYPH_CACHE_SIZE - 1)];
+    const u8* bitmap;
+    u32 foreground;
+    u32 background;
+    size_t y;
+    size_t x;
+    s32 font_row;
+    s32 font_col;
+
+    if (glyph->key == key) {
+        return glyph->pixels;
+    }
+
+    bitmap = font_get_glyph(character);
+    foreground = console->palette[color_fg & 0xf];
+    background = console->palette[color_bg & 0xf];
+
+    for (y = 0; y < FRAMEBUFFER_CELL_HEIGHT; y++) {
+        font_row = ((s32)y - FRAMEBUFFER_GLYPH_TOP) / FRAMEBUFFER_GLYPH_SCALE_Y;
+        if ((s32)y < FRAMEBUFFER_GLYPH_TOP || font_row >= FONT_GLYPH_HEIGHT) {
+            font_row = -1;
+        }
+
+        for (x = 0; x < FRAMEBUFFER_CELL_WIDTH; x++) {
+            font_col = (s32)x - FRAMEBUFFER_GLYPH_LEFT;
+            glyph->pixels[y * FRAMEBUFFER_CELL_WIDTH + x] = \
+                font_row >= 0 && font_col >= 0 && font_col < FONT_GLYPH_WIDTH && \
+                (bitmap[font_row] >> (FONT_GLYPH_WIDTH - 1 - font_col)) & 1 ? foreground : background;
+        }
+    }
+
+    glyph->key = key;
+    return glyph->pixels;
+}
+
+/**
+ * @brief Move every character row up by one and clear the last row.
+ *
+ * @param console console to scroll.
+ */
+static void __framebuffer_scroll(framebuffer_console_t* console) {
+    size_t used_height = console->rows * FRAMEBUFFER_CELL_HEIGHT;
+    size_t y;
+
+    for (y = 0; y + FRAMEBUFFER_CELL_HEIGHT < used_height; y++) {
+        __framebuffer_copy(
+            console,
+            __framebuffer_row(console, y),
+            __framebuffer_row(console, y + FRAMEBUFFER_CELL_HEIGHT),
+            console->width
+        );
+    }
+    for (; y < used_height; y++) {
+        __framebuffer_fill(console, __framebuffer_row(console, y), console->palette[VGA_COLOR_BLACK], console->width);
+    }
+}
+
+/**
+ * @brief Move the cursor to the start of the next row, scrolling if it was on the last row.
+ *
+ * @param console console to move the cursor of.
+ */
+static void __framebuffer_newline(framebuffer_console_t* console) {
+    console->cursor_col = 0;
+    if (console->cursor_row + 1 < console->rows) {
+        console->cursor_row++;
+    } else {
+        __framebuffer_scroll(console);
+    }
+}
+
+bool framebuffer_console_initialize(framebuffer_console_t* console, const framebuffer_info_t* info, bool vector) {
+    size_t index;
+
+    if (info->bpp != FRAMEBUFFER_BITS_PER_PIXEL || \
+            info->width < FRAMEBUFFER_CELL_WIDTH || \
+            info->height < FRAMEBUFFER_CELL_HEIGHT) {
+        return false;
+    }
+
+    console->address = info->address;
+    console->pitch = info->pitch;
+    console->width = info->width;
+    console->height = info->height;
+    console->columns = info->width / FRAMEBUFFER_CELL_WIDTH;
+    console->rows = info->height / FRAMEBUFFER_CELL_HEIGHT;
+    console->vector = vector;
+
+    for (index = 0; index < sizeof(console->palette) / sizeof(console->palette[0]); index++) {
+        console->palette[index] = \
+            __framebuffer_channel((__framebuffer_vga_colors[index] >> 16) & 0xff, info->red_position, info->red_size) | \
+            __framebuffer_channel((__framebuffer_vga_colors[index] >> 8) & 0xff, info->green_position, info->green_size) | \
+            __framebuffer_channel(__framebuffer_vga_colors[index] & 0xff, info->blue_position, info->blue_size);
+    }
+
+    for (index = 0; index < FRAMEBUFFER_GLYPH_CACHE_SIZE; index++) {
+        console->glyph_cache[index].key = 0;
+    }
+
+    framebuffer_console_clear(console);
+    return true;
+}
+
+void framebuffer_console_clear(framebuffer_console_t* console) {
+    size_t y;
+
+    for (y = 0; y < console->height; y++) {
+        __framebuffer_fill(console, __framebuffer_row(console, y), console->palette[VGA_COLOR_BLACK], console->width);
+    }
+
+    console->cursor_row = 0;
+    console->cursor_col = 0;
+}
+
+void framebuffer_console_write(
+        framebuffer_console_t* console,
+        vga_color_t color_fg,
+        vga_color_t color_bg,
+        const char* buffer,
+        size_t length) {
+    const u32* pixels;
+    size_t index;
+    size_t y;
+
+    for (index = 0; index < length; index++) {
+        if (buffer[index] == '\n') {
+            __framebuffer_newline(console);
+            continue;
+        }
+
+        pixels = __framebuffer_glyph(console, buffer[index], color_fg, color_bg);
+        for (y = 0; y < FRAMEBUFFER_CELL_HEIGHT; y++) {
+            __framebuffer_copy(
+                console,
+                __framebuffer_row(console, console->cursor_row * FRAMEBUFFER_CELL_HEIGHT + y) + \
+                    console->cursor_col * FRAMEBUFFER_CELL_WIDTH,
+                &pixels[y * FRAMEBUFFER_CELL_WIDTH],
+                FRAMEBUFFER_CELL_WIDTH
+            );
+        }
+
+        if (++console->cursor_col >= console->columns) {
+            __framebuffer_newline(console);
+        }
+    }
+}
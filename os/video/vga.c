@@ -1,11 +1,20 @@
 #include <llanos/video/vga.h>
 #include <llanos/management/abort.h>
 #include <llanos/types.h>
-#include <llanos/limits.h>
-#include <llanos/util/memory.h>
 #include <llanos/util/crypt.h>
+#include <llanos/util/format.h>
+#include <llanos/util/memory.h>
+#include <llanos/util/string.h>
 #include <stdarg.h>
 
+typedef struct vga_format_context_s vga_format_context_t;
+
+struct vga_format_context_s {
+    vga_t* vga;
+    vga_color_t color_fg;
+    vga_color_t color_bg;
+};
+
 /**
  * @brief Get a VGA entry from a forground color, background color, and character.
  *
@@ -15,7 +24,62 @@
  * @return a VGA entry representing the character with foreground and background color.
  */
 static inline u16 __vga_get_entry(vga_color_t color_fg, vga_color_t color_bg, char c) {
-    return (((u16)(color_fg) | ((u16)(color_bg) << 4)) << 8) | (u16)(c);
+    return (((u16)(color_fg) | ((u16)(color_bg) << 4)) << 8) | (u16)(u8)(c);
+}
+
+/**
+ * @brief Get the row of the history ring shown at a row of the screen.
+ *
+ * @param vga vga with a history attached.
+ * @param row row of the screen.
+ * @param view_offset number of rows the screen is scrolled back.
+ * @return first entry of the ring row.
+ */
+static inline u16* __vga_history_row(vga_t* vga, size_t row, size_t view_offset) {
+    size_t index = vga->history_top + vga->history_rows + row - view_offset;
+
+    if (index >= vga->history_rows) {
+        index -= vga->history_rows;
+    }
+    if (index >= vga->history_rows) {
+        index -= vga->history_rows;
+    }
+    return &vga->history_address[index * vga->terminal_width];
+}
+
+/**
+ * @brief Mark every row of the screen as dirty.
+ *
+ * @param vga vga to redraw on the next flush.
+ */
+static inline void __vga_mark_screen_dirty(vga_t* vga) {
+    vga->dirty_row_begin = 0;
+    vga->dirty_row_end = vga->terminal_height;
+}
+
+/**
+ * @brief Scroll the live screen of a VGA with a history up by one row.
+ *
+ * Only the head of the ring moves and the new bottom row is cleared; the
+ * other rows stay where they are and the screen is redrawn on the next flush.
+ *
+ * @param vga vga with a history attached.
+ */
+static void __vga_scroll_history(vga_t* vga) {
+    vga->history_top++;
+    if (vga->history_top >= vga->history_rows) {
+        vga->history_top = 0;
+    }
+    if (vga->history_used < vga->history_rows) {
+        vga->history_used++;
+    }
+
+    memory_set_value(
+        (u8*)__vga_history_row(vga, vga->terminal_height - 1, 0),
+        0,
+        (u32)(vga->terminal_width * sizeof(u16))
+    );
+    __vga_mark_screen_dirty(vga);
 }
 
 /**
@@ -23,8 +87,8 @@ static inline u16 __vga_get_entry(vga_color_t color_fg, vga_color_t color_bg, ch
  *
  * This will advance the VGA cursor by 1. If the character reaches the width
  * of the buffer, then it will move to the farthest left character of the next line.
- * If the cursor reaches the last character on the last line, then it will advance to the 
- * very first position (0, 0).
+ * If the cursor reaches the last character on the last line, then it will scroll
+ * when a history is attached, or advance to the very first position (0, 0) otherwise.
  *
  * @param vga the vga struct to advance by 1.
  */
@@ -37,212 +101,126 @@ static void __vga_advance_cursor_by_1(vga_t* vga) {
         vga->cursor_col = 0;
         vga->cursor_row++;
 
-        /* if we have reached the terminal height, then we need to go back to the top */
+        /* if we have reached the terminal height, then we need to scroll or go back to the top */
         if (vga->cursor_row >= vga->terminal_height) {
-            vga->cursor_row = 0;
-        }
-    }
-}
-
-static void __vga_print_unsigned_integer_base(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, u64 value, u8 base) {
-    /* 64 is the longest string of characters that can be used specifically for base 2 */
-    char strvalue[64];
-    unsigned tmpvalue;
-    int indexer;
-
-    /* clear string value */
-    memory_set_value((u8*)strvalue, 0, sizeof(strvalue));
-    indexer = 0;
-
-    if (value != 0) {
-        /* build the string backwards in strvalue */
-        while (value > 0) {
-            tmpvalue = value % base;
-            if (tmpvalue < 10) {
-                strvalue[indexer] = '0' + tmpvalue;
+            if (vga->history_address != NULL) {
+                vga->cursor_row = vga->terminal_height - 1;
+                __vga_scroll_history(vga);
             } else {
-                strvalue[indexer] = 'a' + (tmpvalue - 10);
+                vga->cursor_row = 0;
             }
-            indexer++;
-            value /= base;
         }
-    } else {
-        strvalue[indexer] = '0';
-        indexer++;
-    }
-
-    while (indexer != 0) {
-        indexer--;
-        vga_put_character(vga, color_fg, color_bg, strvalue[indexer]);
     }
 }
 
 /**
- * @brief Print a unsigned integer to a vga without padding.
+ * @brief Grow the dirty row range of a VGA to include a row.
  *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
+ * @param vga vga whose shadow row was written.
+ * @param row row that was written.
  */
-static void __vga_print_unsigned_integer(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, u64 value) {
-    __vga_print_unsigned_integer_base(vga, color_fg, color_bg, value, 10);
+static inline void __vga_mark_row_dirty(vga_t* vga, size_t row) {
+    if (vga->dirty_row_begin >= vga->dirty_row_end) {
+        vga->dirty_row_begin = row;
+        vga->dirty_row_end = row + 1;
+    } else if (row < vga->dirty_row_begin) {
+        vga->dirty_row_begin = row;
+    } else if (row >= vga->dirty_row_end) {
+        vga->dirty_row_end = row + 1;
+    }
 }
 
 /**
- * @brief Print a signed integer to a vga without padding.
+ * @brief Move the hardware cursor to the cursor of the terminal if it moved.
+ *
+ * The cursor is hidden below the screen while the view is scrolled back.
  *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
+ * @param vga vga whose hardware cursor to move.
  */
-static void __vga_print_signed_integer(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, s64 value) {
-    if (value < 0) {
-        vga_put_character(vga, color_fg, color_bg, '-');
-        __vga_print_unsigned_integer(vga, color_fg, color_bg, (u64)(-value));
-    } else {
-        __vga_print_unsigned_integer(vga, color_fg, color_bg, (u64)value);
+static void __vga_sync_cursor(vga_t* vga) {
+    u16 position;
+
+    if (vga->set_cursor == NULL) {
+        return;
     }
-}
 
-/**
- * @brief Print a unsigned integer as an octal number to a vga without padding.
- *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
- */
-static void __vga_print_unsigned_octal(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, u64 value) {
-    __vga_print_unsigned_integer_base(vga, color_fg, color_bg, value, 8);
-}
+    if (vga->view_offset != 0) {
+        position = (u16)(vga->terminal_width * vga->terminal_height);
+    } else {
+        position = (u16)(vga->cursor_row * vga->terminal_width + vga->cursor_col);
+    }
 
-/**
- * @brief Print a unsigned integer as a hex number to a vga without padding.
- *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
- */
-static void __vga_print_unsigned_hex(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, u64 value) {
-    __vga_print_unsigned_integer_base(vga, color_fg, color_bg, value, 16);
+    if (position != vga->cursor_position) {
+        vga->set_cursor(position);
+        vga->cursor_position = position;
+    }
 }
 
 /**
- * @brief Print a unsigned integer as a binary number to a vga without padding.
+ * @brief Move the hardware cursor after a write unless it waits for vga_flush.
  *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
+ * @param vga vga that was written to.
  */
-static void __vga_print_unsigned_binary(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, u64 value) {
-    __vga_print_unsigned_integer_base(vga, color_fg, color_bg, value, 2);
+static inline void __vga_sync_cursor_after_write(vga_t* vga) {
+    if (vga->shadow_address == NULL && vga->history_address == NULL) {
+        __vga_sync_cursor(vga);
+    }
 }
 
 /**
- * @brief Print a floating point number number as scientific notation to a vga without padding.
+ * @brief Store characters at the cursor without moving the hardware cursor.
  *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
+ * @param vga vga to write the characters in.
+ * @param color_fg color of the characters in the forground.
+ * @param color_bg color of the characters in the background.
+ * @param buffer characters to write (not NUL terminated).
+ * @param length number of characters in buffer.
  */
-static void __vga_print_scientific_notation(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, double value) {
-    u32 exp = 0;
-
-    if (value == 0.0) {
-        vga_put_string(vga, color_fg, color_bg, "0.0e+0");
-    } else if (value < 0.0) {
-        vga_put_character(vga, color_fg, color_bg, '-');
-        __vga_print_scientific_notation(vga, color_fg, color_bg, -value);
-    } else if (value < 1.0) {
-        while (value < 1.0) {
-            value *= 10;
-            exp++;
-        }
-
-        vga_put_character(vga, color_fg, color_bg, '0' + (u64)value);
-        vga_put_character(vga, color_fg, color_bg, '.');
-            
-        value -= (u64)value;
-        do {
-            value *= 10.0;
-            vga_put_character(vga, color_fg, color_bg, (char)('0' + (u8)value));
-            value -= (u64)value;
-        } while (value > 0.0);
-
-        vga_put_character(vga, color_fg, color_bg, 'e');
-        vga_put_character(vga, color_fg, color_bg, '-');
-        __vga_print_unsigned_integer(vga, color_fg, color_bg, exp);
-    } else {
-        while (value >= 10.0) {
-            value /= 10;
-            exp++;
-        }
+static void __vga_write_characters(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* buffer, size_t length) {
+    u16 attribute = __vga_get_entry(color_fg, color_bg, '\0');
+    u16* target = vga->shadow_address != NULL ? vga->shadow_address : vga->buffer_address;
+    bool tracked = vga->shadow_address != NULL || vga->history_address != NULL;
+    size_t index;
 
-        vga_put_character(vga, color_fg, color_bg, '0' + (u64)value);
-        vga_put_character(vga, color_fg, color_bg, '.');
-            
-        value -= (u64)value;
-        do {
-            value *= 10.0;
-            vga_put_character(vga, color_fg, color_bg, (char)('0' + (u8)value));
-            value -= (u64)value;
-        } while (value > 0.0);
-
-        vga_put_character(vga, color_fg, color_bg, 'e');
-        vga_put_character(vga, color_fg, color_bg, '+');
-        __vga_print_unsigned_integer(vga, color_fg, color_bg, exp);
+    if (vga->view_offset != 0 && length > 0) {
+        /* new output snaps the view back to the live screen */
+        vga->view_offset = 0;
+        __vga_mark_screen_dirty(vga);
     }
-}
 
-/**
- * @brief Print a floating point number number to a vga without padding.
- *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param value value to print.
- */
-static void __vga_print_floating_point(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, double value) {
-    if (value < 0) {
-        vga_put_character(vga, color_fg, color_bg, '-');
-        __vga_print_floating_point(vga, color_fg, color_bg, -value);
-    } else {
-        if (value >= S64MAX) {
-            __vga_print_scientific_notation(vga, color_fg, color_bg, value);
+    for (index = 0; index < length; index++) {
+        if (buffer[index] == '\n') {
+            vga->cursor_col = vga->terminal_width;
         } else {
-            __vga_print_unsigned_integer(vga, color_fg, color_bg, (u64)value);
-            vga_put_character(vga, color_fg, color_bg, '.');
-            
-            value -= (u64)value;
-            do {
-                value *= 10.0;
-                vga_put_character(vga, color_fg, color_bg, (char)('0' + (u8)value));
-                value -= (u64)value;
-            } while (value > 0.0);
+            /* insert the wanted vga entry at the current cursor address */
+            if (vga->history_address != NULL) {
+                __vga_history_row(vga, vga->cursor_row, 0)[vga->cursor_col] = attribute | (u16)(u8)buffer[index];
+            } else {
+                target[vga->cursor_col + (vga->cursor_row * vga->terminal_width)] = \
+                    attribute | (u16)(u8)buffer[index];
+            }
+
+            if (tracked) {
+                __vga_mark_row_dirty(vga, vga->cursor_row);
+            }
         }
+
+        /* advance the cursor on this vga by 1 */
+        __vga_advance_cursor_by_1(vga);
     }
 }
 
 /**
- * @brief Print a string of characters to the terminal, but only printer `length` characters.
+ * @brief Format sink that writes spans into a VGA.
  *
- * @param vga vga to print to.
- * @param color_fg color to set as character's forground.
- * @param color_bg color to set as character's background.
- * @param length number of characters to print.
- * @param value value to print.
+ * @param context vga_format_context_t describing the VGA and colors to write with.
+ * @param span span of characters to write.
+ * @param length number of characters in span.
  */
-static void __vga_print_string_with_length(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, size_t length, const char* value) {
-    size_t index;
+static void __vga_format_sink(void* context, const char* span, size_t length) {
+    vga_format_context_t* format_context = (vga_format_context_t*)context;
 
-    for (index = 0; index < length; index++) {
-        vga_put_character(vga, color_fg, color_bg, value[index]);
-    }
+    __vga_write_characters(format_context->vga, format_context->color_fg, format_context->color_bg, span, length);
 }
 
 size_t vga_get_default_terminal_width(void) {
@@ -262,10 +240,20 @@ void vga_initialize(vga_t* vga, u16* buffer_address, size_t width, size_t height
     size_t col;
 
     vga->buffer_address = buffer_address;
+    vga->shadow_address = NULL;
+    vga->dirty_row_begin = 0;
+    vga->dirty_row_end = 0;
+    vga->history_address = NULL;
+    vga->history_rows = 0;
+    vga->history_top = 0;
+    vga->history_used = 0;
+    vga->view_offset = 0;
     vga->terminal_width = width;
     vga->terminal_height = height;
     vga->cursor_row = 0;
     vga->cursor_col = 0;
+    vga->set_cursor = NULL;
+    vga->cursor_position = 0;
 
     for (col = 0; col < width; col++) {
         for (row = 0; row < height; row++) {
@@ -274,89 +262,137 @@ void vga_initialize(vga_t* vga, u16* buffer_address, size_t width, size_t height
     }
 }
 
-void vga_put_character(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, char c) {
-    if (c == '\n') {
-        vga->cursor_col = vga->terminal_width;
-        __vga_advance_cursor_by_1(vga);
+void vga_attach_shadow(vga_t* vga, u16* shadow_address) {
+    memory_copy(
+        (u8*)shadow_address,
+        (const u8*)vga->buffer_address,
+        (u32)(vga->terminal_width * vga->terminal_height * sizeof(u16))
+    );
+
+    vga->shadow_address = shadow_address;
+    vga->dirty_row_begin = 0;
+    vga->dirty_row_end = 0;
+}
+
+void vga_attach_history(vga_t* vga, u16* history_address, size_t history_rows) {
+    const u16* screen = vga->shadow_address != NULL ? vga->shadow_address : vga->buffer_address;
+    size_t screen_cells = vga->terminal_width * vga->terminal_height;
+
+    /* the live screen starts out as the first rows of the ring */
+    memory_copy((u8*)history_address, (const u8*)screen, (u32)(screen_cells * sizeof(u16)));
+    memory_set_value(
+        (u8*)&history_address[screen_cells],
+        0,
+        (u32)((history_rows - vga->terminal_height) * vga->terminal_width * sizeof(u16))
+    );
+
+    vga->history_address = history_address;
+    vga->history_rows = history_rows;
+    vga->history_top = 0;
+    vga->history_used = vga->terminal_height;
+    vga->view_offset = 0;
+    vga->shadow_address = NULL;
+    __vga_mark_screen_dirty(vga);
+}
+
+void vga_scroll_view(vga_t* vga, s32 rows) {
+    size_t maximum_offset = vga->history_used - vga->terminal_height;
+    size_t view_offset;
+
+    if (rows < 0) {
+        view_offset = (size_t)-rows > vga->view_offset ? 0 : vga->view_offset - (size_t)-rows;
     } else {
-        /* insert the wanted vga entry at the current cursor address */
-        vga->buffer_address[vga->cursor_col + (vga->cursor_row * vga->terminal_width)] = \
-            __vga_get_entry(color_fg, color_bg, c);
+        view_offset = vga->view_offset + (size_t)rows;
+        if (view_offset > maximum_offset) {
+            view_offset = maximum_offset;
+        }
+    }
 
-        /* advance the cursor on this vga by 1 */
-        __vga_advance_cursor_by_1(vga);
+    if (view_offset != vga->view_offset) {
+        vga->view_offset = view_offset;
+        __vga_mark_screen_dirty(vga);
     }
 }
 
-void vga_put_string(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* str) {
-    while (*str != '\0') {
-        vga_put_character(vga, color_fg, color_bg, *str);
-        str++;
+void vga_attach_hardware_cursor(vga_t* vga, vga_cursor_t set_cursor) {
+    vga->set_cursor = set_cursor;
+    vga->set_cursor((u16)(vga->cursor_row * vga->terminal_width + vga->cursor_col));
+    vga->cursor_position = (u16)(vga->cursor_row * vga->terminal_width + vga->cursor_col);
+}
+
+void vga_flush(vga_t* vga) {
+    size_t offset;
+    size_t row;
+
+    __vga_sync_cursor(vga);
+
+    if (vga->dirty_row_begin >= vga->dirty_row_end) {
+        return;
+    }
+
+    if (vga->history_address != NULL) {
+        /* ring rows are not contiguous across the wrap, so copy row by row */
+        for (row = vga->dirty_row_begin; row < vga->dirty_row_end; row++) {
+            memory_copy(
+                (u8*)&vga->buffer_address[row * vga->terminal_width],
+                (const u8*)__vga_history_row(vga, row, vga->view_offset),
+                (u32)(vga->terminal_width * sizeof(u16))
+            );
+        }
+    } else if (vga->shadow_address != NULL) {
+        /* dirty rows are contiguous in both buffers, so this is a single bulk copy */
+        offset = vga->dirty_row_begin * vga->terminal_width;
+        memory_copy(
+            (u8*)&vga->buffer_address[offset],
+            (const u8*)&vga->shadow_address[offset],
+            (u32)((vga->dirty_row_end - vga->dirty_row_begin) * vga->terminal_width * sizeof(u16))
+        );
     }
+
+    vga->dirty_row_begin = 0;
+    vga->dirty_row_end = 0;
 }
 
+void vga_put_character(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, char c) {
+    vga_write(vga, color_fg, color_bg, &c, 1);
+}
+
+void vga_put_string(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* str) {
+    vga_write(vga, color_fg, color_bg, str, string_length(str));
+}
+
+void vga_write(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* buffer, size_t length) {
+    __vga_write_characters(vga, color_fg, color_bg, buffer, length);
+    __vga_sync_cursor_after_write(vga);
+}
+
+
 void vga_printf(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* format, ...) {
-    char* format_ptr;
     va_list vl;
-    size_t length;
 
     va_start(vl, format);
-    format_ptr = (char*)format;
-    while (*format_ptr != '\0') {
-        if (*format_ptr == '%') {
-            format_ptr++;
-
-            switch (*format_ptr) {
-                case 'd':
-                    __vga_print_signed_integer(vga, color_fg, color_bg, (s64)va_arg(vl, s32));
-                    break;
-                case 'u':
-                    __vga_print_unsigned_integer(vga, color_fg, color_bg, (u64)va_arg(vl, u32));
-                    break;
-                case 'o':
-                    __vga_print_unsigned_octal(vga, color_fg, color_bg, (u64)va_arg(vl, u32));
-                    break;
-                case 'x':
-                    __vga_print_unsigned_hex(vga, color_fg, color_bg, (u64)va_arg(vl, u32));
-                    break;
-                case 'b':
-                    __vga_print_unsigned_binary(vga, color_fg, color_bg, (u64)va_arg(vl, u32));
-                    break;
-                case 'f':
-                    __vga_print_floating_point(vga, color_fg, color_bg, va_arg(vl, double));
-                    break;
-                case 'e':
-                    __vga_print_scientific_notation(vga, color_fg, color_bg, va_arg(vl, double));
-                    break;
-                case 'c':
-                    vga_put_character(vga, color_fg, color_bg, (char)va_arg(vl, int));
-                    break;
-                case 's':
-                    vga_put_string(vga, color_fg, color_bg, va_arg(vl, char*));
-                    break;
-                case 'S':
-                    length = va_arg(vl, size_t);
-                    __vga_print_string_with_length(vga, color_fg, color_bg, length, va_arg(vl, char*));
-                    break;
-                case '%':
-                    vga_put_character(vga, color_fg, color_bg, (char)*format_ptr);
-                    break;
-                default:
-                    abort(crc32str("vga_printf"), vga);
-                    break;
-            }
-        } else {
-            vga_put_character(vga, color_fg, color_bg, (char)*format_ptr);
-        }
-        
-        format_ptr++;
-    }
+    vga_vprintf(vga, color_fg, color_bg, format, vl);
     va_end(vl);
 }
 
+void vga_vprintf(vga_t* vga, vga_color_t color_fg, vga_color_t color_bg, const char* format, va_list arguments) {
+    vga_format_context_t context;
+
+    context.vga = vga;
+    context.color_fg = color_fg;
+    context.color_bg = color_bg;
+
+    if (format_stream(__vga_format_sink, &context, format, arguments) < 0) {
+        abort(crc32str("vga_printf"), NULL);
+    }
+    __vga_sync_cursor_after_write(vga);
+}
+
 
 bool vga_equal(vga_t* first, vga_t* second) {
     return first->buffer_address == second->buffer_address && \
+        first->shadow_address == second->shadow_address && \
+        first->history_address == second->history_address && \
         first->cursor_row == second->cursor_row && \
         first->cursor_col == second->cursor_col && \
         first->terminal_width == second->terminal_width && \
@@ -365,8 +401,18 @@ bool vga_equal(vga_t* first, vga_t* second) {
 
 void vga_copy(vga_t* dest, vga_t* source) {
     dest->buffer_address = source->buffer_address;
+    dest->shadow_address = source->shadow_address;
+    dest->dirty_row_begin = source->dirty_row_begin;
+    dest->dirty_row_end = source->dirty_row_end;
+    dest->history_address = source->history_address;
+    dest->history_rows = source->history_rows;
+    dest->history_top = source->history_top;
+    dest->history_used = source->history_used;
+    dest->view_offset = source->view_offset;
     dest->cursor_row = source->cursor_row;
     dest->cursor_col = source->cursor_col;
     dest->terminal_width = source->terminal_width;
     dest->terminal_height = source->terminal_height;
+    dest->set_cursor = source->set_cursor;
+    dest->cursor_position = source->cursor_position;
 }
\ No newline at end of file
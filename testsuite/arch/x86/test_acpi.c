@@ -0,0 +1,209 @@
+#include <testsuite.h>
+#include <string.h>
+#include <x86/acpi.h>
+
+static u8 __table[256] __attribute__((aligned(16)));
+static size_t __table_length;
+
+/* append bytes to the MADT being built in __table */
+static void __test_append(const void* data, size_t length) {
+    memcpy(&__table[__table_length], data, length);
+    __table_length += length;
+}
+
+static void __test_append_u8(u8 value) {
+    __test_append(&value, sizeof(value));
+}
+
+static void __test_append_u16(u16 value) {
+    __test_append(&value, sizeof(value));
+}
+
+static void __test_append_u32(u32 value) {
+    __test_append(&value, sizeof(value));
+}
+
+/* start a table, the header length is patched by __test_finish_table */
+static void __test_start_table(const char* signature) {
+    acpi_sdt_header_t header;
+
+    memset(__table, 0, sizeof(__table));
+    memset(&header, 0, sizeof(header));
+    memcpy(header.signature, signature, 4);
+    __table_length = 0;
+    __test_append(&header, sizeof(header));
+}
+
+static void __test_start_madt(u32 lapic_address, u32 flags) {
+    __test_start_table("APIC");
+    __test_append_u32(lapic_address);
+    __test_append_u32(flags);
+}
+
+/* an HPET table with 3 timers, its registers in the given address space */
+static void __test_start_hpet(u8 space, u64 address) {
+    __test_start_table("HPET");
+    __test_append_u32(0x8086a201);
+    __test_append_u8(space);
+    __test_append_u8(64);
+    __test_append_u8(0);
+    __test_append_u8(0);
+    __test_append(&address, sizeof(address));
+    __test_append_u8(0);
+    __test_append_u16(128);
+    __test_append_u8(0);
+}
+
+static const acpi_sdt_header_t* __test_finish_table(void) {
+    acpi_sdt_header_t* header = (acpi_sdt_header_t*)__table;
+
+    header->length = (u32)__table_length;
+    header->checksum = (u8)(0x100 - acpi_checksum(__table, __table_length));
+    return header;
+}
+
+static void __test_append_lapic(u8 apic_id, u32 flags) {
+    __test_append_u8(0);
+    __test_append_u8(8);
+    __test_append_u8(apic_id);
+    __test_append_u8(apic_id);
+    __test_append_u32(flags);
+}
+
+static void __test_append_ioapic(u8 id, u32 address, u32 gsi_base) {
+    __test_append_u8(1);
+    __test_append_u8(12);
+    __test_append_u8(id);
+    __test_append_u8(0);
+    __test_append_u32(address);
+    __test_append_u32(gsi_base);
+}
+
+static void __test_append_override(u8 source, u32 gsi, u16 flags) {
+    __test_append_u8(2);
+    __test_append_u8(10);
+    __test_append_u8(0);
+    __test_append_u8(source);
+    __test_append_u32(gsi);
+    __test_append_u16(flags);
+}
+
+
+static void test_acpi_checksum__should__sum_bytes_modulo_256(void) {
+    const u8 bytes[] = {0x80, 0x90, 0x10, 0x01};
+
+    TEST_ASSERT_EQUAL_HEX8(0x21, acpi_checksum(bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_HEX8(0, acpi_checksum(bytes, 0));
+}
+
+static void test_acpi_find_rsdp__should__find_a_valid_rsdp_on_a_16_byte_boundary(void) {
+    acpi_rsdp_t rsdp;
+
+    memset(__table, 0, sizeof(__table));
+    memset(&rsdp, 0, sizeof(rsdp));
+    memcpy(rsdp.signature, "RSD PTR ", 8);
+    rsdp.rsdt_address = 0x1000;
+    rsdp.checksum = (u8)(0x100 - acpi_checksum(&rsdp, 20));
+
+    /* a copy with a broken checksum comes first and is skipped */
+    memcpy(&__table[16], &rsdp, 20);
+    __table[16 + 8]++;
+    memcpy(&__table[64], &rsdp, 20);
+
+    TEST_ASSERT_EQUAL_PTR(&__table[64], acpi_find_rsdp(__table, sizeof(__table)));
+    TEST_ASSERT_NULL(acpi_find_rsdp(__table, 64));
+}
+
+static void test_acpi_parse_madt__should__read_cpus_ioapics_and_overrides(void) {
+    acpi_madt_info_t info;
+
+    __test_start_madt(0xfee00000, ACPI_MADT_PCAT_COMPAT);
+    __test_append_lapic(0, ACPI_MADT_CPU_ENABLED);
+    __test_append_lapic(1, 0);
+    __test_append_lapic(3, ACPI_MADT_CPU_ENABLED);
+    __test_append_ioapic(2, 0xfec00000, 0);
+    __test_append_override(0, 2, 0);
+    __test_append_override(9, 9, ACPI_MADT_TRIGGER_LEVEL | 0x1);
+
+    TEST_ASSERT_TRUE(acpi_parse_madt(__test_finish_table(), &info));
+    TEST_ASSERT_EQUAL_HEX32(0xfee00000, info.lapic_address);
+    TEST_ASSERT_TRUE(info.legacy_pics);
+    TEST_ASSERT_EQUAL_UINT32(2, info.cpu_count);
+    TEST_ASSERT_EQUAL_UINT8(0, info.apic_ids[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, info.apic_ids[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, info.ioapic_count);
+    TEST_ASSERT_EQUAL_UINT8(2, info.ioapics[0].id);
+    TEST_ASSERT_EQUAL_HEX32(0xfec00000, info.ioapics[0].address);
+    TEST_ASSERT_EQUAL_UINT32(0, info.ioapics[0].gsi_base);
+    TEST_ASSERT_EQUAL_UINT32(2, info.isa_routes[0].gsi);
+    TEST_ASSERT_EQUAL_UINT32(1, info.isa_routes[1].gsi);
+    TEST_ASSERT_EQUAL_UINT16(0, info.isa_routes[1].flags);
+    TEST_ASSERT_EQUAL_UINT32(9, info.isa_routes[9].gsi);
+    TEST_ASSERT_EQUAL_UINT16(ACPI_MADT_TRIGGER_LEVEL, info.isa_routes[9].flags & ACPI_MADT_TRIGGER_MASK);
+}
+
+static void test_acpi_parse_madt__should__fail_without_an_ioapic(void) {
+    acpi_madt_info_t info;
+
+    __test_start_madt(0xfee00000, 0);
+    __test_append_lapic(0, ACPI_MADT_CPU_ENABLED);
+
+    TEST_ASSERT_FALSE(acpi_parse_madt(__test_finish_table(), &info));
+    TEST_ASSERT_FALSE(info.legacy_pics);
+}
+
+static void test_acpi_parse_madt__should__stop_at_a_truncated_entry(void) {
+    acpi_madt_info_t info;
+
+    __test_start_madt(0xfee00000, 0);
+    __test_append_lapic(0, ACPI_MADT_CPU_ENABLED);
+    __test_append_ioapic(2, 0xfec00000, 0);
+    /* an entry claiming to run past the end of the table */
+    __test_append_u8(0);
+    __test_append_u8(64);
+
+    TEST_ASSERT_TRUE(acpi_parse_madt(__test_finish_table(), &info));
+    TEST_ASSERT_EQUAL_UINT32(1, info.cpu_count);
+}
+
+static void test_acpi_parse_hpet__should__read_the_register_address(void) {
+    acpi_hpet_info_t info;
+
+    __test_start_hpet(ACPI_ADDRESS_SPACE_MEMORY, 0xfed00000);
+    TEST_ASSERT_TRUE(acpi_parse_hpet(__test_finish_table(), &info));
+    TEST_ASSERT_EQUAL_HEX32(0xfed00000, info.address);
+    TEST_ASSERT_EQUAL_UINT8(0, info.number);
+    TEST_ASSERT_EQUAL_UINT16(128, info.min_tick);
+}
+
+static void test_acpi_parse_hpet__should__fail_outside_of_32_bit_memory(void) {
+    acpi_hpet_info_t info;
+
+    __test_start_hpet(1, 0xfed00000);
+    TEST_ASSERT_FALSE(acpi_parse_hpet(__test_finish_table(), &info));
+
+    __test_start_hpet(ACPI_ADDRESS_SPACE_MEMORY, 0x100000000ULL);
+    TEST_ASSERT_FALSE(acpi_parse_hpet(__test_finish_table(), &info));
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"acpi_checksum should sum bytes modulo 256", test_acpi_checksum__should__sum_bytes_modulo_256},
+    {"acpi_find_rsdp should find a valid rsdp on a 16 byte boundary", test_acpi_find_rsdp__should__find_a_valid_rsdp_on_a_16_byte_boundary},
+
+    {"acpi_parse_madt should read cpus, ioapics and overrides", test_acpi_parse_madt__should__read_cpus_ioapics_and_overrides},
+    {"acpi_parse_madt should fail without an ioapic", test_acpi_parse_madt__should__fail_without_an_ioapic},
+    {"acpi_parse_madt should stop at a truncated entry", test_acpi_parse_madt__should__stop_at_a_truncated_entry},
+
+    {"acpi_parse_hpet should read the register address", test_acpi_parse_hpet__should__read_the_register_address},
+    {"acpi_parse_hpet should fail outside of 32 bit memory", test_acpi_parse_hpet__should__fail_outside_of_32_bit_memory}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
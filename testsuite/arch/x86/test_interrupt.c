@@ -0,0 +1,119 @@
+#include <testsuite.h>
+#include <stddef.h>
+#include <x86/interrupt.h>
+
+static u32 __handled_vector;
+static void* __handled_context;
+
+static void __handler(u32 vector, void* context) {
+    __handled_vector = vector;
+    __handled_context = context;
+}
+
+static void __fault_handler(interrupt_frame_t* frame, void* context) {
+    (void)context;
+    frame->eip += 2;
+}
+
+static void test_interrupt_build_idtr__should__set_limit_to_last_byte_of_table(void) {
+    idt_entry_t idt[INTERRUPT_VECTOR_COUNT];
+    idt_register_t idtr;
+
+    interrupt_build_idtr(&idtr, idt, INTERRUPT_VECTOR_COUNT);
+    TEST_ASSERT_EQUAL(0x7ff, idtr.limit);
+}
+
+static void test_interrupt_setup__should__split_the_handler_address(void) {
+    idt_entry_t entry;
+
+    interrupt_setup(&entry, (void (*)(void))(uintptr_t)0x12345678, SEGMENT_SELECTOR_KERNEL_CODE_32BIT, GATE_TYPE_INTERRUPT_GATE_32BIT, 0, true);
+    TEST_ASSERT_EQUAL_HEX16(0x5678, entry.base_low);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, entry.base_high);
+    TEST_ASSERT_EQUAL(SEGMENT_SELECTOR_KERNEL_CODE_32BIT, entry.sel);
+    TEST_ASSERT_EQUAL(1, entry.present);
+}
+
+static void test_interrupt_register_handler__should__fill_the_slot_of_the_vector(void) {
+    int context;
+
+    interrupt_register_handler(0x21, __handler, &context);
+    TEST_ASSERT_TRUE(interrupt_handlers[0x21].handler == __handler);
+    TEST_ASSERT_EQUAL_PTR(&context, interrupt_handlers[0x21].context);
+
+    /* what the entry stub does with the slot */
+    interrupt_handlers[0x21].handler(0x21, interrupt_handlers[0x21].context);
+    TEST_ASSERT_EQUAL(0x21, __handled_vector);
+    TEST_ASSERT_EQUAL_PTR(&context, __handled_context);
+}
+
+static void test_interrupt_unregister_handler__should__clear_the_slot_of_the_vector(void) {
+    interrupt_register_handler(0x30, __handler, NULL);
+    interrupt_unregister_handler(0x30);
+    TEST_ASSERT_NULL(interrupt_handlers[0x30].handler);
+}
+
+static void test_interrupt_register_fault_handler__should__fill_the_slot_of_the_exception(void) {
+    interrupt_frame_t frame = { .vector = INTERRUPT_VECTOR_PAGE_FAULT, .eip = 0x1000 };
+    int context;
+
+    interrupt_register_fault_handler(INTERRUPT_VECTOR_PAGE_FAULT, __fault_handler, &context);
+    TEST_ASSERT_TRUE(interrupt_fault_handlers[INTERRUPT_VECTOR_PAGE_FAULT].handler == __fault_handler);
+    TEST_ASSERT_EQUAL_PTR(&context, interrupt_fault_handlers[INTERRUPT_VECTOR_PAGE_FAULT].context);
+
+    /* what the fault trampoline does with the slot, the handler may change the frame */
+    interrupt_fault_handlers[INTERRUPT_VECTOR_PAGE_FAULT].handler(&frame, interrupt_fault_handlers[INTERRUPT_VECTOR_PAGE_FAULT].context);
+    TEST_ASSERT_EQUAL_HEX32(0x1002, frame.eip);
+
+    interrupt_unregister_fault_handler(INTERRUPT_VECTOR_PAGE_FAULT);
+    TEST_ASSERT_NULL(interrupt_fault_handlers[INTERRUPT_VECTOR_PAGE_FAULT].handler);
+}
+
+static void test_interrupt_has_error_code__should__match_the_exceptions_the_cpu_pushes_one_for(void) {
+    TEST_ASSERT_FALSE(interrupt_has_error_code(0));
+    TEST_ASSERT_FALSE(interrupt_has_error_code(3));
+    TEST_ASSERT_TRUE(interrupt_has_error_code(8));
+    TEST_ASSERT_FALSE(interrupt_has_error_code(9));
+    TEST_ASSERT_TRUE(interrupt_has_error_code(13));
+    TEST_ASSERT_TRUE(interrupt_has_error_code(INTERRUPT_VECTOR_PAGE_FAULT));
+    TEST_ASSERT_TRUE(interrupt_has_error_code(17));
+    TEST_ASSERT_TRUE(interrupt_has_error_code(30));
+    TEST_ASSERT_FALSE(interrupt_has_error_code(32));
+    TEST_ASSERT_FALSE(interrupt_has_error_code(0x80));
+}
+
+static void test_interrupt_frame__should__match_the_layout_of_the_fault_trampoline(void) {
+    /* pushes of the trampoline (4 segments, pushad), the stub and the CPU */
+    TEST_ASSERT_EQUAL(0, offsetof(interrupt_frame_t, gs));
+    TEST_ASSERT_EQUAL(16, offsetof(interrupt_frame_t, edi));
+    TEST_ASSERT_EQUAL(44, offsetof(interrupt_frame_t, eax));
+    TEST_ASSERT_EQUAL(48, offsetof(interrupt_frame_t, vector));
+    TEST_ASSERT_EQUAL(52, offsetof(interrupt_frame_t, error_code));
+    TEST_ASSERT_EQUAL(56, offsetof(interrupt_frame_t, eip));
+    TEST_ASSERT_EQUAL(68, sizeof(interrupt_frame_t));
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"interrupt_build_idtr should set limit to last byte of table", test_interrupt_build_idtr__should__set_limit_to_last_byte_of_table},
+
+    {"interrupt_setup should split the handler address", test_interrupt_setup__should__split_the_handler_address},
+
+    {"interrupt_register_handler should fill the slot of the vector", test_interrupt_register_handler__should__fill_the_slot_of_the_vector},
+
+    {"interrupt_unregister_handler should clear the slot of the vector", test_interrupt_unregister_handler__should__clear_the_slot_of_the_vector},
+
+    {"interrupt_register_fault_handler should fill the slot of the exception", test_interrupt_register_fault_handler__should__fill_the_slot_of_the_exception},
+
+    {"interrupt_has_error_code should match the exceptions the cpu pushes one for", test_interrupt_has_error_code__should__match_the_exceptions_the_cpu_pushes_one_for},
+
+    {"interrupt_frame should match the layout of the fault trampoline", test_interrupt_frame__should__match_the_layout_of_the_fault_trampoline}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
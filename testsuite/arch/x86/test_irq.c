@@ -0,0 +1,203 @@
+#include <testsuite.h>
+#include <x86/irq.h>
+#include <x86/interrupt.h>
+
+#define TEST_BASE_VECTOR    0x20
+#define TEST_LINE_COUNT     16
+
+/* state of the fake interrupt controller */
+static u32 __masked;
+static u32 __ended;
+static u32 __spurious_lines;
+static u32 __handled;
+static u8 __destinations[TEST_LINE_COUNT];
+static irq_controller_t __controller;
+
+static void __test_mask(void* chip, u8 irq) {
+    (void)chip;
+    __masked |= 1u << irq;
+}
+
+static void __test_unmask(void* chip, u8 irq) {
+    (void)chip;
+    __masked &= ~(1u << irq);
+}
+
+static bool __test_acknowledge(void* chip, u8 irq) {
+    (void)chip;
+    return (__spurious_lines & (1u << irq)) == 0;
+}
+
+static void __test_end(void* chip, u8 irq) {
+    (void)chip;
+    __ended |= 1u << irq;
+}
+
+static bool __test_set_destination(void* chip, u8 irq, u8 apic_id) {
+    (void)chip;
+    __destinations[irq] = apic_id;
+    return true;
+}
+
+static const irq_backend_t __test_backend = {
+    .mask = __test_mask,
+    .unmask = __test_unmask,
+    .acknowledge = __test_acknowledge,
+    .end = __test_end,
+    .set_destination = NULL
+};
+
+/* same controller, able to deliver to other CPUs */
+static const irq_backend_t __test_backend_smp = {
+    .mask = __test_mask,
+    .unmask = __test_unmask,
+    .acknowledge = __test_acknowledge,
+    .end = __test_end,
+    .set_destination = __test_set_destination
+};
+
+static void __test_handler(u32 vector, void* context) {
+    TEST_ASSERT_EQUAL_PTR(&__handled, context);
+    __handled = vector;
+}
+
+static void __test_reset(void) {
+    __masked = 0;
+    __ended = 0;
+    __spurious_lines = 0;
+    __handled = 0;
+    irq_initialize(&__controller, &__test_backend, NULL, TEST_BASE_VECTOR, TEST_LINE_COUNT);
+}
+
+/* controller with CPU 0-3 online as APIC IDs 0x10-0x13 and lines 0-3 requested */
+static void __test_reset_smp(void) {
+    u8 index;
+
+    __test_reset();
+    irq_initialize(&__controller, &__test_backend_smp, NULL, TEST_BASE_VECTOR, TEST_LINE_COUNT);
+    for (index = 0; index < 4; index++) {
+        irq_set_cpu_online(&__controller, index, 0x10 + index);
+        irq_request(&__controller, index, __test_handler, &__handled);
+        __destinations[index] = 0;
+    }
+}
+
+/* what the IRQ entry stub does when the line raises its vector */
+static void __test_raise(u8 irq) {
+    interrupt_handler_entry_t* entry = &interrupt_handlers[TEST_BASE_VECTOR + irq];
+
+    entry->handler(TEST_BASE_VECTOR + irq, entry->context);
+}
+
+
+static void test_irq_initialize__should__mask_every_line_and_take_its_vector(void) {
+    __test_reset();
+
+    TEST_ASSERT_EQUAL_HEX32(0xffff, __masked);
+    TEST_ASSERT_NOT_NULL(interrupt_handlers[TEST_BASE_VECTOR].handler);
+    TEST_ASSERT_EQUAL_PTR(&__controller, interrupt_handlers[TEST_BASE_VECTOR + TEST_LINE_COUNT - 1].context);
+}
+
+static void test_irq_request__should__unmask_the_line_and_run_its_handler(void) {
+    __test_reset();
+
+    irq_request(&__controller, 4, __test_handler, &__handled);
+    TEST_ASSERT_EQUAL_HEX32(0xffef, __masked);
+
+    __test_raise(4);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BASE_VECTOR + 4, __handled);
+    TEST_ASSERT_EQUAL_HEX32(1u << 4, __ended);
+}
+
+static void test_irq_release__should__mask_the_line_and_still_end_its_interrupts(void) {
+    __test_reset();
+
+    irq_request(&__controller, 4, __test_handler, &__handled);
+    irq_release(&__controller, 4);
+    TEST_ASSERT_EQUAL_HEX32(0xffff, __masked);
+
+    __test_raise(4);
+    TEST_ASSERT_EQUAL_UINT32(0, __handled);
+    TEST_ASSERT_EQUAL_HEX32(1u << 4, __ended);
+}
+
+static void test_irq_dispatch__should__neither_handle_nor_end_spurious_interrupts(void) {
+    __test_reset();
+
+    irq_request(&__controller, 7, __test_handler, &__handled);
+    __spurious_lines = 1u << 7;
+
+    __test_raise(7);
+    TEST_ASSERT_EQUAL_UINT32(0, __handled);
+    TEST_ASSERT_EQUAL_HEX32(0, __ended);
+    TEST_ASSERT_EQUAL_UINT32(1, __controller.spurious);
+}
+
+static void test_irq_set_affinity__should__fail_without_backend_support(void) {
+    __test_reset();
+    irq_set_cpu_online(&__controller, 1, 1);
+
+    TEST_ASSERT_FALSE(irq_set_affinity(&__controller, 4, 1u << 1));
+    TEST_ASSERT_EQUAL_HEX32(IRQ_AFFINITY_ALL, __controller.lines[4].affinity);
+    TEST_ASSERT_TRUE(irq_set_affinity(&__controller, 4, (1u << 0) | (1u << 1)));
+}
+
+static void test_irq_set_affinity__should__move_the_line_into_the_mask(void) {
+    __test_reset_smp();
+
+    TEST_ASSERT_FALSE(irq_set_affinity(&__controller, 2, 1u << 5));
+    TEST_ASSERT_TRUE(irq_set_affinity(&__controller, 2, (1u << 2) | (1u << 3)));
+    TEST_ASSERT_EQUAL_UINT8(2, __controller.lines[2].cpu);
+    TEST_ASSERT_EQUAL_HEX8(0x12, __destinations[2]);
+}
+
+static void test_irq_balance__should__spread_busy_lines_over_the_cpus(void) {
+    const u64 counts[TEST_LINE_COUNT] = {1000, 900, 100, 50};
+    u8 index;
+
+    __test_reset_smp();
+
+    TEST_ASSERT_EQUAL_UINT32(3, irq_balance(&__controller, counts));
+    TEST_ASSERT_EQUAL_UINT8(0, __controller.lines[0].cpu);
+    for (index = 1; index < 4; index++) {
+        TEST_ASSERT_EQUAL_UINT8(index, __controller.lines[index].cpu);
+        TEST_ASSERT_EQUAL_HEX8(0x10 + index, __destinations[index]);
+    }
+
+    /* nothing happened since, so nothing moves */
+    TEST_ASSERT_EQUAL_UINT32(0, irq_balance(&__controller, counts));
+}
+
+static void test_irq_balance__should__keep_lines_within_their_affinity(void) {
+    const u64 counts[TEST_LINE_COUNT] = {1000, 900, 100, 50};
+
+    __test_reset_smp();
+    irq_set_affinity(&__controller, 1, 1u << 0);
+
+    irq_balance(&__controller, counts);
+    TEST_ASSERT_EQUAL_UINT8(0, __controller.lines[1].cpu);
+    TEST_ASSERT_NOT_EQUAL(0, __controller.lines[2].cpu);
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"irq_initialize should mask every line and take its vector", test_irq_initialize__should__mask_every_line_and_take_its_vector},
+    {"irq_request should unmask the line and run its handler", test_irq_request__should__unmask_the_line_and_run_its_handler},
+    {"irq_release should mask the line and still end its interrupts", test_irq_release__should__mask_the_line_and_still_end_its_interrupts},
+    {"irq dispatch should neither handle nor end spurious interrupts", test_irq_dispatch__should__neither_handle_nor_end_spurious_interrupts},
+
+    {"irq_set_affinity should fail without backend support", test_irq_set_affinity__should__fail_without_backend_support},
+    {"irq_set_affinity should move the line into the mask", test_irq_set_affinity__should__move_the_line_into_the_mask},
+
+    {"irq_balance should spread busy lines over the cpus", test_irq_balance__should__spread_busy_lines_over_the_cpus},
+    {"irq_balance should keep lines within their affinity", test_irq_balance__should__keep_lines_within_their_affinity}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
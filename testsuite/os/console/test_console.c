@@ -0,0 +1,189 @@
+#include <testsuite.h>
+#include <string.h>
+#include <llanos/types.h>
+#include <llanos/console/console.h>
+
+#define TEST_CAPTURE_SIZE   512
+
+static u32 __test_write_count;
+static u32 __test_locked;
+static u32 __test_locks;
+
+static void __test_counting_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    __test_write_count++;
+    console_capture_write(context, level, buffer, length);
+}
+
+static u32 __test_lock(void) {
+    __test_locked++;
+    __test_locks++;
+    return __test_locked;
+}
+
+static void __test_unlock(u32 state) {
+    TEST_ASSERT_EQUAL_UINT32(__test_locked, state);
+    __test_locked--;
+}
+
+static void __test_locked_write(void* context, log_level_t level, const char* buffer, size_t length) {
+    TEST_ASSERT_EQUAL_UINT32(1, __test_locked);
+    console_capture_write(context, level, buffer, length);
+}
+
+static void __test_locked_flush(void* context) {
+    (void)context;
+    TEST_ASSERT_EQUAL_UINT32(1, __test_locked);
+}
+
+
+static void test_console_write__should__skip_sinks_below_their_level(void) {
+    console_t console;
+    console_capture_t everything;
+    console_capture_t errors;
+    char everything_buffer[TEST_CAPTURE_SIZE];
+    char errors_buffer[TEST_CAPTURE_SIZE];
+
+    console_initialize(&console);
+    console_capture_initialize(&everything, everything_buffer, sizeof(everything_buffer));
+    console_capture_initialize(&errors, errors_buffer, sizeof(errors_buffer));
+    console_add_sink(&console, console_capture_write, NULL, &everything, LOG_LEVEL_DEBUG);
+    console_add_sink(&console, console_capture_write, NULL, &errors, LOG_LEVEL_ERROR);
+
+    console_write(&console, LOG_LEVEL_INFO, "info", 4);
+    console_write(&console, LOG_LEVEL_ERROR, "error", 5);
+
+    TEST_ASSERT_EQUAL_UINT32(9, everything.length);
+    TEST_ASSERT_EQUAL_MEMORY("infoerror", everything_buffer, 9);
+    TEST_ASSERT_EQUAL_UINT32(5, errors.length);
+    TEST_ASSERT_EQUAL_MEMORY("error", errors_buffer, 5);
+}
+
+static void test_console_set_lock__should__hold_the_lock_around_the_sinks(void) {
+    console_t console;
+    console_capture_t capture;
+    char buffer[TEST_CAPTURE_SIZE];
+
+    __test_locked = 0;
+    __test_locks = 0;
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    console_add_sink(&console, __test_locked_write, __test_locked_flush, &capture, LOG_LEVEL_DEBUG);
+    console_set_lock(&console, __test_lock, __test_unlock);
+
+    console_printf(&console, LOG_LEVEL_INFO, "%d", 42);
+    console_flush(&console);
+
+    TEST_ASSERT_EQUAL_UINT32(2, __test_locks);
+    TEST_ASSERT_EQUAL_UINT32(0, __test_locked);
+    TEST_ASSERT_EQUAL_MEMORY("42", buffer, 2);
+}
+
+static void test_console_set_sink_level__should__change_what_a_sink_receives(void) {
+    console_t console;
+    console_capture_t capture;
+    console_sink_t* sink;
+    char buffer[TEST_CAPTURE_SIZE];
+
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    sink = console_add_sink(&console, console_capture_write, NULL, &capture, LOG_LEVEL_DEBUG);
+
+    console_set_sink_level(sink, LOG_LEVEL_WARNING);
+    console_write(&console, LOG_LEVEL_INFO, "info", 4);
+    console_write(&console, LOG_LEVEL_WARNING, "warning", 7);
+
+    TEST_ASSERT_EQUAL_UINT32(7, capture.length);
+    TEST_ASSERT_EQUAL_MEMORY("warning", buffer, 7);
+}
+
+static void test_console_printf__should__batch_formatted_spans_into_one_write(void) {
+    console_t console;
+    console_capture_t capture;
+    char buffer[TEST_CAPTURE_SIZE];
+    s32 length;
+
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    console_add_sink(&console, __test_counting_write, NULL, &capture, LOG_LEVEL_DEBUG);
+
+    __test_write_count = 0;
+    length = console_printf(&console, LOG_LEVEL_INFO, "a %d b %s c %x", -12, "str", 0xbeef);
+
+    TEST_ASSERT_EQUAL_INT32(18, length);
+    TEST_ASSERT_EQUAL_UINT32(1, __test_write_count);
+    TEST_ASSERT_EQUAL_UINT32(18, capture.length);
+    TEST_ASSERT_EQUAL_MEMORY("a -12 b str c beef", buffer, 18);
+}
+
+static void test_console_printf__should__write_output_longer_than_a_batch(void) {
+    console_t console;
+    console_capture_t capture;
+    char buffer[TEST_CAPTURE_SIZE];
+    char expected[CONSOLE_BATCH_SIZE * 2 + 2];
+    s32 length;
+
+    memset(expected, 'x', CONSOLE_BATCH_SIZE * 2);
+    expected[CONSOLE_BATCH_SIZE * 2] = '!';
+    expected[CONSOLE_BATCH_SIZE * 2 + 1] = '\0';
+
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    console_add_sink(&console, console_capture_write, NULL, &capture, LOG_LEVEL_DEBUG);
+
+    length = console_printf(&console, LOG_LEVEL_INFO, "%s", expected);
+
+    TEST_ASSERT_EQUAL_INT32(CONSOLE_BATCH_SIZE * 2 + 1, length);
+    TEST_ASSERT_EQUAL_UINT32(CONSOLE_BATCH_SIZE * 2 + 1, capture.length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer, CONSOLE_BATCH_SIZE * 2 + 1);
+}
+
+static void test_console_add_sink__should__return_null_when_the_console_is_full(void) {
+    console_t console;
+    console_capture_t capture;
+    char buffer[TEST_CAPTURE_SIZE];
+    size_t index;
+
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    for (index = 0; index < CONSOLE_MAX_SINKS; index++) {
+        TEST_ASSERT_NOT_NULL(console_add_sink(&console, console_capture_write, NULL, &capture, LOG_LEVEL_DEBUG));
+    }
+
+    TEST_ASSERT_NULL(console_add_sink(&console, console_capture_write, NULL, &capture, LOG_LEVEL_DEBUG));
+}
+
+static void test_console_capture_write__should__count_characters_that_do_not_fit(void) {
+    console_capture_t capture;
+    char buffer[4];
+
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    console_capture_write(&capture, LOG_LEVEL_INFO, "abc", 3);
+    console_capture_write(&capture, LOG_LEVEL_INFO, "def", 3);
+
+    TEST_ASSERT_EQUAL_UINT32(4, capture.length);
+    TEST_ASSERT_EQUAL_UINT32(2, capture.dropped);
+    TEST_ASSERT_EQUAL_MEMORY("abcd", buffer, 4);
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"console_write should skip sinks below their level", test_console_write__should__skip_sinks_below_their_level},
+    {"console_set_sink_level should change what a sink receives", test_console_set_sink_level__should__change_what_a_sink_receives},
+    {"console_set_lock should hold the lock around the sinks", test_console_set_lock__should__hold_the_lock_around_the_sinks},
+
+    {"console_printf should batch formatted spans into one write", test_console_printf__should__batch_formatted_spans_into_one_write},
+    {"console_printf should write output longer than a batch", test_console_printf__should__write_output_longer_than_a_batch},
+
+    {"console_add_sink should return null when the console is full", test_console_add_sink__should__return_null_when_the_console_is_full},
+
+    {"console_capture_write should count characters that do not fit", test_console_capture_write__should__count_characters_that_do_not_fit}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,93 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/clock.h>
+
+static u64 __counter;
+
+static u64 __test_read(void) {
+    return __counter;
+}
+
+/* cycles * 10^9 / frequency, rounded down, computed with 128-bit arithmetic */
+static u64 __test_reference_ns(u64 cycles, u64 frequency) {
+    return (u64)((unsigned __int128)cycles * CLOCK_NS_PER_SECOND / frequency);
+}
+
+
+static void test_clock_calculate_scale__should__be_exact_for_1_ghz(void) {
+    u32 mult;
+    u32 shift;
+
+    clock_calculate_scale(CLOCK_NS_PER_SECOND, &mult, &shift);
+    TEST_ASSERT_EQUAL_UINT64(123456789012ULL, clock_scale(123456789012ULL, mult, shift));
+}
+
+static void test_clock_calculate_scale__should__keep_the_multiplier_within_32_bits(void) {
+    const u64 frequencies[] = {1, 1193182, 14318180, 2999999999ULL, 5000000000ULL};
+    size_t index;
+    u32 mult;
+    u32 shift;
+
+    for (index = 0; index < sizeof(frequencies) / sizeof(frequencies[0]); index++) {
+        clock_calculate_scale(frequencies[index], &mult, &shift);
+        TEST_ASSERT_TRUE(shift <= 32);
+        TEST_ASSERT_NOT_EQUAL(0, mult);
+    }
+}
+
+static void test_clock_scale__should__match_division_for_an_hour_of_a_3_ghz_tsc(void) {
+    const u64 frequency = 2999999999ULL;
+    const u64 cycles = frequency * 3600;
+    u64 expected = __test_reference_ns(cycles, frequency);
+    u64 ns;
+    u32 mult;
+    u32 shift;
+
+    clock_calculate_scale(frequency, &mult, &shift);
+    ns = clock_scale(cycles, mult, shift);
+
+    /* rounding the multiplier costs less than a part per billion */
+    TEST_ASSERT_UINT64_WITHIN(expected / 1000000000ULL + 1, expected, ns);
+}
+
+static void test_clock_source_ns__should__count_from_initialization(void) {
+    clock_source_t source;
+
+    __counter = 5000;
+    clock_source_initialize(&source, __test_read, 1000000, true);
+    TEST_ASSERT_TRUE(source.invariant);
+    TEST_ASSERT_EQUAL_UINT64(0, clock_source_ns(&source));
+
+    __counter += 1500;
+    TEST_ASSERT_EQUAL_UINT64(6500, clock_source_cycles(&source));
+    TEST_ASSERT_UINT64_WITHIN(1, 1500000, clock_source_ns(&source));
+}
+
+static void test_clock_source_ns__should__stay_0_without_a_frequency(void) {
+    clock_source_t source;
+
+    __counter = 0;
+    clock_source_initialize(&source, __test_read, 0, false);
+    __counter = 123456;
+    TEST_ASSERT_EQUAL_UINT64(0, clock_source_ns(&source));
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"clock_calculate_scale should be exact for 1 GHz", test_clock_calculate_scale__should__be_exact_for_1_ghz},
+    {"clock_calculate_scale should keep the multiplier within 32 bits", test_clock_calculate_scale__should__keep_the_multiplier_within_32_bits},
+
+    {"clock_scale should match division for an hour of a 3 GHz tsc", test_clock_scale__should__match_division_for_an_hour_of_a_3_ghz_tsc},
+
+    {"clock_source_ns should count from initialization", test_clock_source_ns__should__count_from_initialization},
+    {"clock_source_ns should stay 0 without a frequency", test_clock_source_ns__should__stay_0_without_a_frequency}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,203 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/clock.h>
+#include <llanos/management/clockevent.h>
+#include <llanos/util/memory.h>
+
+/* the test clock counts nanoseconds, the test device microseconds */
+#define TEST_CLOCK_FREQUENCY    1000000000ULL
+#define TEST_DEVICE_FREQUENCY   1000000ULL
+
+typedef struct test_device_s test_device_t;
+
+struct test_device_s {
+    u64 armed_cycles;
+    u32 armed;
+    u32 stopped;
+};
+
+static u64 __counter;
+static u32 __handled;
+static u64 __handled_now;
+
+static u64 __test_read(void) {
+    return __counter;
+}
+
+static void __test_set_next(void* context, u64 cycles) {
+    test_device_t* device = (test_device_t*)context;
+
+    device->armed_cycles = cycles;
+    device->armed++;
+}
+
+static void __test_stop(void* context) {
+    ((test_device_t*)context)->stopped++;
+}
+
+static void __test_handler(void* context, u64 now) {
+    (void)context;
+    __handled++;
+    __handled_now = now;
+}
+
+static void __test_setup(clock_source_t* clock, clockevent_t* event, clockevent_device_t* device, test_device_t* state, u64 max_cycles) {
+    __counter = 0;
+    __handled = 0;
+    __handled_now = 0;
+    memory_set_value((u8*)state, 0, sizeof(*state));
+
+    clock_source_initialize(clock, __test_read, TEST_CLOCK_FREQUENCY, true);
+    clockevent_device_initialize(device, "test", __test_set_next, __test_stop, state, TEST_DEVICE_FREQUENCY, 2, max_cycles);
+    clockevent_initialize(event, clock);
+    clockevent_set_device(event, device);
+    clockevent_set_handler(event, __test_handler, NULL);
+}
+
+
+static void test_clockevent_program__should__fail_without_a_device(void) {
+    clock_source_t clock;
+    clockevent_t event;
+
+    clock_source_initialize(&clock, __test_read, TEST_CLOCK_FREQUENCY, true);
+    clockevent_initialize(&event, &clock);
+
+    TEST_ASSERT_FALSE(clockevent_program(&event, 1000));
+    TEST_ASSERT_EQUAL_UINT64(CLOCKEVENT_NONE, event.next_event);
+}
+
+static void test_clockevent_program__should__arm_the_device_for_the_time_left(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    test_device_t state;
+
+    __test_setup(&clock, &event, &device, &state, 0xffffffff);
+    TEST_ASSERT_EQUAL_UINT32(0, state.armed);
+
+    __counter = 1000000;
+    TEST_ASSERT_TRUE(clockevent_program(&event, 6000000));
+    TEST_ASSERT_EQUAL_UINT32(1, state.armed);
+    TEST_ASSERT_TRUE(state.armed_cycles >= 5000 && state.armed_cycles <= 5001);
+}
+
+static void test_clockevent_program__should__arm_the_shortest_wait_for_a_past_expiry(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    test_device_t state;
+
+    __test_setup(&clock, &event, &device, &state, 0xffffffff);
+    __counter = 5000000;
+    TEST_ASSERT_TRUE(clockevent_program(&event, 1000000));
+    TEST_ASSERT_EQUAL_UINT64(2, state.armed_cycles);
+}
+
+static void test_clockevent_interrupt__should__run_the_handler_once_at_expiry(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    test_device_t state;
+
+    __test_setup(&clock, &event, &device, &state, 0xffffffff);
+    clockevent_program(&event, 3000000);
+
+    __counter = 3000000;
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(1, __handled);
+    TEST_ASSERT_EQUAL_UINT64(3000000, __handled_now);
+    TEST_ASSERT_EQUAL_UINT64(CLOCKEVENT_NONE, event.next_event);
+
+    /* nothing programmed, a stray interrupt is only counted */
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(1, __handled);
+    TEST_ASSERT_EQUAL_UINT32(2, event.interrupts);
+}
+
+static void test_clockevent_interrupt__should__rearm_a_wait_beyond_the_device(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    test_device_t state;
+
+    /* the device reaches 1 ms, the expiry is 2.5 ms away */
+    __test_setup(&clock, &event, &device, &state, 1000);
+    clockevent_program(&event, 2500000);
+    TEST_ASSERT_EQUAL_UINT64(1000, state.armed_cycles);
+
+    __counter = 1000000;
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(0, __handled);
+    TEST_ASSERT_EQUAL_UINT64(1000, state.armed_cycles);
+
+    __counter = 2000000;
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(0, __handled);
+    TEST_ASSERT_EQUAL_UINT64(500, state.armed_cycles);
+
+    __counter = 2500000;
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(1, __handled);
+    TEST_ASSERT_EQUAL_UINT32(3, state.armed);
+}
+
+static void test_clockevent_stop__should__disarm_the_device(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    test_device_t state;
+
+    __test_setup(&clock, &event, &device, &state, 0xffffffff);
+    clockevent_program(&event, 3000000);
+    clockevent_stop(&event);
+    TEST_ASSERT_EQUAL_UINT32(1, state.stopped);
+    TEST_ASSERT_EQUAL_UINT64(CLOCKEVENT_NONE, event.next_event);
+
+    __counter = 3000000;
+    clockevent_interrupt(&event);
+    TEST_ASSERT_EQUAL_UINT32(0, __handled);
+}
+
+static void test_clockevent_set_device__should__move_the_programmed_expiry(void) {
+    clock_source_t clock;
+    clockevent_t event;
+    clockevent_device_t device;
+    clockevent_device_t other;
+    test_device_t state;
+    test_device_t other_state;
+
+    __test_setup(&clock, &event, &device, &state, 0xffffffff);
+    memory_set_value((u8*)&other_state, 0, sizeof(other_state));
+    clockevent_device_initialize(&other, "other", __test_set_next, __test_stop, &other_state, TEST_DEVICE_FREQUENCY * 10, 1, 0xffffffff);
+
+    clockevent_program(&event, 4000000);
+    clockevent_set_device(&event, &other);
+    TEST_ASSERT_EQUAL_UINT32(1, state.stopped);
+    TEST_ASSERT_EQUAL_UINT32(1, other_state.armed);
+    /* rounded up, never short of the expiry */
+    TEST_ASSERT_TRUE(other_state.armed_cycles >= 40000 && other_state.armed_cycles <= 40001);
+}
+
+
+
+testfunc_container_t test_function_containers[] = {
+    {"clockevent_program should fail without a device", test_clockevent_program__should__fail_without_a_device},
+    {"clockevent_program should arm the device for the time left", test_clockevent_program__should__arm_the_device_for_the_time_left},
+    {"clockevent_program should arm the shortest wait for a past expiry", test_clockevent_program__should__arm_the_shortest_wait_for_a_past_expiry},
+
+    {"clockevent_interrupt should run the handler once at expiry", test_clockevent_interrupt__should__run_the_handler_once_at_expiry},
+    {"clockevent_interrupt should rearm a wait beyond the device", test_clockevent_interrupt__should__rearm_a_wait_beyond_the_device},
+
+    {"clockevent_stop should disarm the device", test_clockevent_stop__should__disarm_the_device},
+
+    {"clockevent_set_device should move the programmed expiry", test_clockevent_set_device__should__move_the_programmed_expiry}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,88 @@
+#include <testsuite.h>
+#include <string.h>
+#include <llanos/types.h>
+#include <llanos/management/irqstat.h>
+#include <llanos/console/console.h>
+
+#define TEST_CAPTURE_SIZE   512
+
+static irqstat_t __stats;
+
+
+static void test_irqstat_record__should__count_per_cpu_and_in_total(void) {
+    irqstat_initialize(&__stats);
+
+    irqstat_record(&__stats, 0, 0x20, 100);
+    irqstat_record(&__stats, 1, 0x20, 100);
+    irqstat_record(&__stats, 1, 0x20, 100);
+    irqstat_record(&__stats, 0, 0x21, 100);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __stats.cpus[0].count[0x20]);
+    TEST_ASSERT_EQUAL_UINT32(2, __stats.cpus[1].count[0x20]);
+    TEST_ASSERT_EQUAL_UINT64(3, irqstat_get_count(&__stats, 0x20));
+    TEST_ASSERT_EQUAL_UINT64(1, irqstat_get_count(&__stats, 0x21));
+    TEST_ASSERT_EQUAL_UINT64(0, irqstat_get_count(&__stats, 0x22));
+    TEST_ASSERT_EQUAL_UINT64(300, __stats.cpus[0].cycles[0x20] + __stats.cpus[1].cycles[0x20]);
+}
+
+static void test_irqstat_record__should__count_unknown_cpus_on_the_last_cpu(void) {
+    irqstat_initialize(&__stats);
+
+    irqstat_record(&__stats, IRQSTAT_MAX_CPUS + 3, 0x30, 1);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __stats.cpus[IRQSTAT_MAX_CPUS - 1].count[0x30]);
+}
+
+static void test_irqstat_record__should__bucket_handler_time_by_log2(void) {
+    irqstat_initialize(&__stats);
+
+    irqstat_record(&__stats, 0, 0x20, 0);
+    irqstat_record(&__stats, 0, 0x20, 1);
+    irqstat_record(&__stats, 0, 0x20, 1023);
+    irqstat_record(&__stats, 0, 0x20, 1024);
+    irqstat_record(&__stats, 0, 0x20, 0xffffffff);
+
+    TEST_ASSERT_EQUAL_UINT32(2, __stats.histograms[0x20][0]);
+    TEST_ASSERT_EQUAL_UINT32(1, __stats.histograms[0x20][9]);
+    TEST_ASSERT_EQUAL_UINT32(1, __stats.histograms[0x20][10]);
+    TEST_ASSERT_EQUAL_UINT32(1, __stats.histograms[0x20][31]);
+}
+
+static void test_irqstat_dump__should__print_only_raised_vectors(void) {
+    console_t console;
+    console_capture_t capture;
+    char buffer[TEST_CAPTURE_SIZE];
+    const char* expected = \
+        "vector  33: 2 interrupts, 300 cycles average, cpus 0:1 2:1\n" \
+        "    log2 cycles 6:1 8:1\n";
+
+    irqstat_initialize(&__stats);
+    irqstat_record(&__stats, 0, 0x21, 100);
+    irqstat_record(&__stats, 2, 0x21, 500);
+
+    console_initialize(&console);
+    console_capture_initialize(&capture, buffer, sizeof(buffer));
+    console_add_sink(&console, console_capture_write, NULL, &capture, LOG_LEVEL_DEBUG);
+    irqstat_dump(&__stats, &console, LOG_LEVEL_INFO);
+
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), capture.length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer, strlen(expected));
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"irqstat_record should count per cpu and in total", test_irqstat_record__should__count_per_cpu_and_in_total},
+    {"irqstat_record should count unknown cpus on the last cpu", test_irqstat_record__should__count_unknown_cpus_on_the_last_cpu},
+    {"irqstat_record should bucket handler time by log2", test_irqstat_record__should__bucket_handler_time_by_log2},
+
+    {"irqstat_dump should print only raised vectors", test_irqstat_dump__should__print_only_raised_vectors}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,158 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/log.h>
+
+#define TEST_LOG_CAPACITY   1024
+
+typedef struct drained_s drained_t;
+
+struct drained_s {
+    u32 count;
+    char text[TEST_LOG_CAPACITY];
+    size_t length;
+    u64 last_timestamp;
+    u16 last_cpu;
+    u8 last_level;
+};
+
+static u64 __test_log_storage[TEST_LOG_CAPACITY / sizeof(u64)];
+static u64 __test_log_time;
+
+static u64 __test_log_clock(void) {
+    return ++__test_log_time;
+}
+
+static u32 __test_log_cpu(void) {
+    return 3;
+}
+
+static void __test_log_drain(void* context, const log_record_t* record, const char* message) {
+    drained_t* drained = (drained_t*)context;
+    size_t index;
+
+    for (index = 0; index < record->length; index++) {
+        drained->text[drained->length++] = message[index];
+    }
+    drained->text[drained->length++] = '|';
+    drained->text[drained->length] = '\0';
+    drained->count++;
+    drained->last_timestamp = record->timestamp;
+    drained->last_cpu = record->cpu;
+    drained->last_level = record->level;
+}
+
+static void __test_log_initialize(log_buffer_t* log, drained_t* drained) {
+    __test_log_time = 0;
+    log_initialize(log, (u8*)__test_log_storage, TEST_LOG_CAPACITY, __test_log_clock, __test_log_cpu);
+
+    drained->count = 0;
+    drained->length = 0;
+    drained->text[0] = '\0';
+}
+
+static void test_log_drain__should__hand_records_over_in_order(void) {
+    log_buffer_t log;
+    drained_t drained;
+
+    __test_log_initialize(&log, &drained);
+    TEST_ASSERT_TRUE(log_write(&log, LOG_LEVEL_INFO, "first", 5));
+    TEST_ASSERT_TRUE(log_printf(&log, LOG_LEVEL_ERROR, "second %d", 2));
+
+    TEST_ASSERT_EQUAL_UINT32(2, log_drain(&log, __test_log_drain, &drained));
+    TEST_ASSERT_EQUAL_STRING("first|second 2|", drained.text);
+    TEST_ASSERT_EQUAL_UINT32(2, (u32)drained.last_timestamp);
+    TEST_ASSERT_EQUAL(3, drained.last_cpu);
+    TEST_ASSERT_EQUAL(LOG_LEVEL_ERROR, drained.last_level);
+
+    TEST_ASSERT_EQUAL_UINT32(0, log_drain(&log, __test_log_drain, &drained));
+}
+
+static void test_log_drain__should__wait_for_uncommitted_records(void) {
+    log_buffer_t log;
+    drained_t drained;
+    char* message;
+
+    __test_log_initialize(&log, &drained);
+    message = log_reserve(&log, LOG_LEVEL_INFO, 1);
+    TEST_ASSERT_NOT_NULL(message);
+
+    /* a record written after the reservation (an interrupt handler) must wait for it */
+    log_write(&log, LOG_LEVEL_INFO, "b", 1);
+    TEST_ASSERT_EQUAL_UINT32(0, log_drain(&log, __test_log_drain, &drained));
+
+    message[0] = 'a';
+    log_commit(&log, message);
+    TEST_ASSERT_EQUAL_UINT32(2, log_drain(&log, __test_log_drain, &drained));
+    TEST_ASSERT_EQUAL_STRING("a|b|", drained.text);
+}
+
+static void test_log_reserve__should__drop_records_when_full(void) {
+    log_buffer_t log;
+    drained_t drained;
+    u32 written = 0;
+
+    __test_log_initialize(&log, &drained);
+    while (log_write(&log, LOG_LEVEL_DEBUG, "0123456789", 10)) {
+        written++;
+    }
+    log_write(&log, LOG_LEVEL_DEBUG, "0123456789", 10);
+
+    TEST_ASSERT_EQUAL_UINT32(2, log.dropped);
+    TEST_ASSERT_EQUAL_UINT32(written, log_drain(&log, __test_log_drain, &drained));
+
+    /* draining frees the space again */
+    TEST_ASSERT_TRUE(log_write(&log, LOG_LEVEL_DEBUG, "0123456789", 10));
+}
+
+static void test_log_reserve__should__skip_the_end_of_the_ring_with_padding(void) {
+    log_buffer_t log;
+    drained_t drained;
+    u32 round;
+    u32 total = 0;
+
+    __test_log_initialize(&log, &drained);
+
+    /* 48 byte records do not divide the ring evenly, so records keep hitting the end */
+    for (round = 0; round < 100; round++) {
+        TEST_ASSERT_TRUE(log_printf(&log, LOG_LEVEL_INFO, "record %02u ......................", round % 100));
+        if (round % 7 == 6) {
+            total += log_drain(&log, __test_log_drain, &drained);
+            drained.length = 0;
+        }
+    }
+    total += log_drain(&log, __test_log_drain, &drained);
+
+    TEST_ASSERT_EQUAL_UINT32(100, total);
+    TEST_ASSERT_EQUAL_UINT32(0, log.dropped);
+}
+
+static void test_log_printf__should__truncate_long_messages(void) {
+    log_buffer_t log;
+    drained_t drained;
+
+    __test_log_initialize(&log, &drained);
+    log_printf(&log, LOG_LEVEL_INFO, "%300d", 1);
+    log_drain(&log, __test_log_drain, &drained);
+
+    TEST_ASSERT_EQUAL(LOG_MESSAGE_MAX_LENGTH + 1, drained.length);
+}
+
+testfunc_container_t test_function_containers[] = {
+    {"log_drain should hand records over in order", test_log_drain__should__hand_records_over_in_order},
+    {"log_drain should wait for uncommitted records", test_log_drain__should__wait_for_uncommitted_records},
+
+    {"log_reserve should drop records when full", test_log_reserve__should__drop_records_when_full},
+    {"log_reserve should skip the end of the ring with padding", test_log_reserve__should__skip_the_end_of_the_ring_with_padding},
+
+    {"log_printf should truncate long messages", test_log_printf__should__truncate_long_messages}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+    return 0;
+}
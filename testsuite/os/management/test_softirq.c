@@ -0,0 +1,180 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/softirq.h>
+
+#define TEST_VECTOR_LOW     3
+#define TEST_VECTOR_HIGH    7
+
+static softirq_t __softirq;
+static u32 __cpu;
+static bool __interrupts_enabled;
+static u32 __order[16];
+static u32 __order_length;
+static u32 __runs;
+static tasklet_t __tasklet;
+
+static u32 __test_cpu(void) {
+    return __cpu;
+}
+
+static void __test_enable(void) {
+    __interrupts_enabled = true;
+}
+
+static void __test_disable(void) {
+    __interrupts_enabled = false;
+}
+
+static void __test_reset(void) {
+    softirq_initialize(&__softirq, __test_cpu, __test_enable, __test_disable);
+    __cpu = 0;
+    __interrupts_enabled = false;
+    __order_length = 0;
+    __runs = 0;
+}
+
+/* records its vector (the context) and whether interrupts were enabled */
+static void __test_record(void* context) {
+    TEST_ASSERT_TRUE(__interrupts_enabled);
+    __order[__order_length++] = (u32)(uintptr_t)context;
+}
+
+static void __test_raise_self(void* context) {
+    (void)context;
+    __runs++;
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+}
+
+static void __test_nested_run(void* context) {
+    (void)context;
+    __runs++;
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+    /* an interrupt taken here runs softirq_run on its way out */
+    TEST_ASSERT_TRUE(softirq_run(&__softirq));
+}
+
+static void __test_tasklet_reschedule(void* context) {
+    (void)context;
+    if (++__runs < 3) {
+        TEST_ASSERT_TRUE(tasklet_schedule(&__softirq, &__tasklet));
+    }
+}
+
+
+static void test_softirq_run__should__run_raised_vectors_in_order_with_interrupts_enabled(void) {
+    __test_reset();
+    softirq_register(&__softirq, TEST_VECTOR_LOW, __test_record, (void*)(uintptr_t)TEST_VECTOR_LOW);
+    softirq_register(&__softirq, TEST_VECTOR_HIGH, __test_record, (void*)(uintptr_t)TEST_VECTOR_HIGH);
+
+    softirq_raise(&__softirq, TEST_VECTOR_HIGH);
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_FALSE(__interrupts_enabled);
+    TEST_ASSERT_EQUAL_UINT32(2, __order_length);
+    TEST_ASSERT_EQUAL_UINT32(TEST_VECTOR_LOW, __order[0]);
+    TEST_ASSERT_EQUAL_UINT32(TEST_VECTOR_HIGH, __order[1]);
+}
+
+static void test_softirq_run__should__only_run_the_vectors_of_the_calling_cpu(void) {
+    __test_reset();
+    softirq_register(&__softirq, TEST_VECTOR_LOW, __test_record, (void*)(uintptr_t)TEST_VECTOR_LOW);
+
+    __cpu = 1;
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+    __cpu = 0;
+
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(0, __order_length);
+
+    __cpu = 1;
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(1, __order_length);
+}
+
+static void test_softirq_run__should__leave_work_pending_after_the_restart_limit(void) {
+    __test_reset();
+    softirq_register(&__softirq, TEST_VECTOR_LOW, __test_raise_self, NULL);
+
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+
+    TEST_ASSERT_TRUE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(SOFTIRQ_MAX_RESTARTS, __runs);
+}
+
+static void test_softirq_run__should__return_at_once_when_nested(void) {
+    __test_reset();
+    softirq_register(&__softirq, TEST_VECTOR_LOW, __test_nested_run, NULL);
+    softirq_raise(&__softirq, TEST_VECTOR_LOW);
+
+    TEST_ASSERT_TRUE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(SOFTIRQ_MAX_RESTARTS, __runs);
+}
+
+static void test_tasklet_schedule__should__run_a_tasklet_once_per_scheduling(void) {
+    tasklet_t first;
+    tasklet_t second;
+
+    __test_reset();
+    tasklet_initialize(&first, __test_record, (void*)(uintptr_t)1);
+    tasklet_initialize(&second, __test_record, (void*)(uintptr_t)2);
+
+    TEST_ASSERT_TRUE(tasklet_schedule(&__softirq, &first));
+    TEST_ASSERT_TRUE(tasklet_schedule(&__softirq, &second));
+    TEST_ASSERT_FALSE(tasklet_schedule(&__softirq, &first));
+
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(2, __order_length);
+    TEST_ASSERT_EQUAL_UINT32(1, __order[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, __order[1]);
+
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(2, __order_length);
+}
+
+static void test_tasklet_schedule__should__let_a_tasklet_schedule_itself(void) {
+    __test_reset();
+    tasklet_initialize(&__tasklet, __test_tasklet_reschedule, NULL);
+
+    tasklet_schedule(&__softirq, &__tasklet);
+
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(3, __runs);
+}
+
+static void test_tasklet_schedule__should__defer_a_tasklet_running_on_another_cpu(void) {
+    __test_reset();
+    tasklet_initialize(&__tasklet, __test_record, (void*)(uintptr_t)1);
+
+    tasklet_schedule(&__softirq, &__tasklet);
+    __tasklet.running = 1;
+
+    TEST_ASSERT_TRUE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(0, __order_length);
+
+    __tasklet.running = 0;
+    TEST_ASSERT_FALSE(softirq_run(&__softirq));
+    TEST_ASSERT_EQUAL_UINT32(1, __order_length);
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"softirq_run should run raised vectors in order with interrupts enabled", test_softirq_run__should__run_raised_vectors_in_order_with_interrupts_enabled},
+    {"softirq_run should only run the vectors of the calling cpu", test_softirq_run__should__only_run_the_vectors_of_the_calling_cpu},
+    {"softirq_run should leave work pending after the restart limit", test_softirq_run__should__leave_work_pending_after_the_restart_limit},
+    {"softirq_run should return at once when nested", test_softirq_run__should__return_at_once_when_nested},
+
+    {"tasklet_schedule should run a tasklet once per scheduling", test_tasklet_schedule__should__run_a_tasklet_once_per_scheduling},
+    {"tasklet_schedule should let a tasklet schedule itself", test_tasklet_schedule__should__let_a_tasklet_schedule_itself},
+    {"tasklet_schedule should defer a tasklet running on another cpu", test_tasklet_schedule__should__defer_a_tasklet_running_on_another_cpu}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,432 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/thread.h>
+
+#define TEST_THREAD_STACK_SIZE  THREAD_MIN_STACK_SIZE
+#define TEST_THREAD_COUNT       3
+#define TEST_SWITCH_CAPACITY    8
+
+typedef struct test_frame_s test_frame_t;
+typedef struct test_switch_s test_switch_t;
+
+/* first frame the test prepare builds, the stack pointer of a thread that never ran */
+struct test_frame_s {
+    thread_function_t entry;
+    void* argument;
+    void* stack_top;
+    bool started;
+};
+
+/* a switch the test switch_to saw */
+struct test_switch_s {
+    thread_context_t* previous;
+    thread_context_t* next;
+};
+
+static threads_t __threads;
+static thread_t __boot;
+static thread_t __created[TEST_THREAD_COUNT];
+static test_frame_t __frame[TEST_THREAD_COUNT];
+static u8 __stack[TEST_THREAD_COUNT][TEST_THREAD_STACK_SIZE];
+static test_switch_t __switches[TEST_SWITCH_CAPACITY];
+static u32 __switch_count;
+static u32 __ran[TEST_THREAD_COUNT];
+static u32 __idles;
+static u32 __slices;
+static bool __disabled;
+static bool __start_threads;
+
+static u32 __test_lock(void) {
+    u32 state = __disabled ? 1 : 0;
+
+    __disabled = true;
+    return state;
+}
+
+static void __test_unlock(u32 state) {
+    TEST_ASSERT_TRUE(__disabled);
+    __disabled = state != 0;
+}
+
+static void __test_enable(void) {
+    TEST_ASSERT_TRUE(__disabled);
+    __disabled = false;
+}
+
+static void __test_slice(void* context) {
+    TEST_ASSERT_EQUAL_PTR(&__threads, context);
+    TEST_ASSERT_TRUE(__disabled);
+    __slices++;
+}
+
+static void __test_prepare(thread_context_t* context, void* stack_top, thread_function_t entry, void* argument) {
+    thread_t* thread = (thread_t*)argument;
+    test_frame_t* frame = &__frame[thread - __created];
+
+    frame->entry = entry;
+    frame->argument = argument;
+    frame->stack_top = stack_top;
+    frame->started = false;
+    context->stack_pointer = frame;
+}
+
+/*
+ * records the switch, and starts a thread that never ran when __start_threads
+ * is set, the switched out thread goes on once that thread switches away
+ */
+static void __test_switch(thread_context_t* previous, thread_context_t* next) {
+    test_frame_t* frame = (test_frame_t*)next->stack_pointer;
+
+    TEST_ASSERT_TRUE(__disabled);
+    TEST_ASSERT_TRUE(__switch_count < TEST_SWITCH_CAPACITY);
+    __switches[__switch_count].previous = previous;
+    __switches[__switch_count].next = next;
+    __switch_count++;
+
+    if (__start_threads && frame != NULL && !frame->started) {
+        frame->started = true;
+        frame->entry(frame->argument);
+        /* the thread switched back in with interrupts disabled, as they were by its switch */
+        __disabled = true;
+    }
+}
+
+static void __test_record(void* argument) {
+    u32 index = (u32)(uintptr_t)argument;
+
+    TEST_ASSERT_FALSE(__disabled);
+    __ran[index]++;
+}
+
+static void __test_idle(void) {
+    TEST_ASSERT_FALSE(__disabled);
+    __idles++;
+
+    /* an interrupt makes a thread ready */
+    thread_create(
+        &__threads,
+        &__created[2],
+        "woken",
+        THREAD_PRIORITY_DEFAULT,
+        __stack[2],
+        TEST_THREAD_STACK_SIZE,
+        __test_record,
+        (void*)2
+    );
+}
+
+static void __test_setup(bool start_threads) {
+    u32 index;
+
+    __switch_count = 0;
+    __idles = 0;
+    __slices = 0;
+    __disabled = false;
+    __start_threads = start_threads;
+    for (index = 0; index < TEST_THREAD_COUNT; index++) {
+        __ran[index] = 0;
+    }
+    threads_initialize(&__threads, &__boot, __test_prepare, __test_switch, __test_lock, __test_unlock, __test_enable, __test_idle);
+}
+
+static void __test_create_priority(u32 index, u32 priority) {
+    TEST_ASSERT_TRUE(thread_create(
+        &__threads,
+        &__created[index],
+        "test",
+        priority,
+        __stack[index],
+        TEST_THREAD_STACK_SIZE,
+        __test_record,
+        (void*)(uintptr_t)index
+    ));
+}
+
+static void __test_create(u32 index) {
+    __test_create_priority(index, THREAD_PRIORITY_DEFAULT);
+}
+
+static void __test_assert_switch(u32 index, thread_t* previous, thread_t* next) {
+    TEST_ASSERT_TRUE(index < __switch_count);
+    TEST_ASSERT_EQUAL_PTR(&previous->context, __switches[index].previous);
+    TEST_ASSERT_EQUAL_PTR(&next->context, __switches[index].next);
+}
+
+
+static void test_thread_create__should__queue_a_prepared_thread(void) {
+    __test_setup(false);
+    TEST_ASSERT_EQUAL_PTR(&__boot, thread_current(&__threads));
+    TEST_ASSERT_EQUAL_UINT32(0, __boot.id);
+
+    __test_create(0);
+    __test_create(1);
+    TEST_ASSERT_EQUAL_UINT32(1, __created[0].id);
+    TEST_ASSERT_EQUAL_UINT32(2, __created[1].id);
+    TEST_ASSERT_EQUAL(THREAD_READY, __created[0].state);
+    TEST_ASSERT_EQUAL_PTR(__stack[0] + TEST_THREAD_STACK_SIZE, __frame[0].stack_top);
+    TEST_ASSERT_EQUAL_PTR(&__created[0], __frame[0].argument);
+    TEST_ASSERT_FALSE(__disabled);
+
+    /* nothing runs before the boot thread lets it */
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+    TEST_ASSERT_EQUAL_PTR(&__boot, thread_current(&__threads));
+}
+
+static void test_thread_create__should__refuse_a_small_stack(void) {
+    __test_setup(false);
+    TEST_ASSERT_FALSE(thread_create(
+        &__threads,
+        &__created[0],
+        "small",
+        THREAD_PRIORITY_DEFAULT,
+        __stack[0],
+        THREAD_MIN_STACK_SIZE - 1,
+        __test_record,
+        NULL
+    ));
+    TEST_ASSERT_EQUAL_UINT32(0, __threads.ready_mask);
+}
+
+static void test_thread_create__should__refuse_an_unknown_priority(void) {
+    __test_setup(false);
+    TEST_ASSERT_FALSE(thread_create(
+        &__threads,
+        &__created[0],
+        "unknown",
+        THREAD_PRIORITY_LOWEST + 1,
+        __stack[0],
+        TEST_THREAD_STACK_SIZE,
+        __test_record,
+        NULL
+    ));
+    TEST_ASSERT_EQUAL_UINT32(0, __threads.ready_mask);
+}
+
+static void test_thread_create__should__flag_a_higher_priority_thread_to_preempt(void) {
+    __test_setup(false);
+    __test_create_priority(0, THREAD_PRIORITY_DEFAULT + 1);
+    __test_create(1);
+    TEST_ASSERT_FALSE(__threads.need_resched);
+    thread_preempt(&__threads);
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+
+    __test_create_priority(2, THREAD_PRIORITY_DEFAULT - 1);
+    TEST_ASSERT_TRUE(__threads.need_resched);
+    thread_preempt(&__threads);
+    TEST_ASSERT_EQUAL_UINT32(1, __switch_count);
+    __test_assert_switch(0, &__boot, &__created[2]);
+    TEST_ASSERT_FALSE(__threads.need_resched);
+    TEST_ASSERT_EQUAL(THREAD_READY, __boot.state);
+    TEST_ASSERT_FALSE(__disabled);
+}
+
+static void test_thread_yield__should__keep_running_without_ready_threads(void) {
+    __test_setup(false);
+    thread_yield(&__threads);
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+    TEST_ASSERT_EQUAL(THREAD_RUNNING, __boot.state);
+    TEST_ASSERT_FALSE(__disabled);
+}
+
+static void test_thread_yield__should__run_the_threads_in_turns(void) {
+    __test_setup(false);
+    __test_create(0);
+    __test_create(1);
+
+    /* each yield is made by the thread the previous one switched to */
+    thread_yield(&__threads);
+    TEST_ASSERT_EQUAL_PTR(&__created[0], thread_current(&__threads));
+    TEST_ASSERT_EQUAL(THREAD_READY, __boot.state);
+    thread_yield(&__threads);
+    thread_yield(&__threads);
+    thread_yield(&__threads);
+
+    TEST_ASSERT_EQUAL_UINT32(4, __switch_count);
+    __test_assert_switch(0, &__boot, &__created[0]);
+    __test_assert_switch(1, &__created[0], &__created[1]);
+    __test_assert_switch(2, &__created[1], &__boot);
+    __test_assert_switch(3, &__boot, &__created[0]);
+}
+
+static void test_thread_yield__should__run_the_highest_priority_first(void) {
+    __test_setup(false);
+    __test_create_priority(0, THREAD_PRIORITY_LOWEST);
+    __test_create_priority(1, THREAD_PRIORITY_HIGHEST);
+    __test_create(2);
+
+    thread_yield(&__threads);
+    __test_assert_switch(0, &__boot, &__created[1]);
+
+    /* nothing of its priority is ready, the highest priority thread keeps running */
+    thread_yield(&__threads);
+    TEST_ASSERT_EQUAL_UINT32(1, __switch_count);
+    TEST_ASSERT_EQUAL_UINT32((1u << THREAD_PRIORITY_DEFAULT) | (1u << THREAD_PRIORITY_LOWEST), __threads.ready_mask);
+
+    thread_exit(&__threads);
+    /* thread 2 was queued before the boot thread yielded, the lowest priority waits */
+    __test_assert_switch(1, &__created[1], &__created[2]);
+    thread_yield(&__threads);
+    __test_assert_switch(2, &__created[2], &__boot);
+}
+
+static void test_thread_tick__should__preempt_once_the_slice_ended(void) {
+    u32 tick;
+
+    __test_setup(false);
+    threads_set_slice(&__threads, __test_slice, &__threads);
+    TEST_ASSERT_EQUAL_UINT32(0, __slices);
+    /* the first tick of the slice of the boot thread, alone */
+    TEST_ASSERT_FALSE(thread_tick(&__threads));
+
+    __test_create(0);
+    __test_create(1);
+    TEST_ASSERT_EQUAL_UINT32(1, __slices);
+
+    for (tick = 2; tick < THREAD_SLICE_TICKS; tick++) {
+        TEST_ASSERT_TRUE(thread_tick(&__threads));
+        thread_preempt(&__threads);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+
+    TEST_ASSERT_TRUE(thread_tick(&__threads));
+    thread_preempt(&__threads);
+    __test_assert_switch(0, &__boot, &__created[0]);
+    TEST_ASSERT_EQUAL_UINT32(THREAD_SLICE_TICKS, __created[0].slice_left);
+    TEST_ASSERT_FALSE(__disabled);
+}
+
+static void test_thread_tick__should__not_preempt_for_lower_priorities(void) {
+    u32 tick;
+
+    __test_setup(false);
+    __test_create_priority(0, THREAD_PRIORITY_LOWEST);
+
+    for (tick = 0; tick < THREAD_SLICE_TICKS * 2; tick++) {
+        TEST_ASSERT_TRUE(thread_tick(&__threads));
+        thread_preempt(&__threads);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+}
+
+static void test_thread_set_priority__should__requeue_a_ready_thread(void) {
+    __test_setup(false);
+    __test_create_priority(0, THREAD_PRIORITY_LOWEST);
+    __test_create_priority(1, THREAD_PRIORITY_LOWEST);
+    TEST_ASSERT_FALSE(thread_set_priority(&__threads, &__created[1], THREAD_PRIORITY_LEVELS));
+
+    TEST_ASSERT_TRUE(thread_set_priority(&__threads, &__created[1], THREAD_PRIORITY_HIGHEST));
+    TEST_ASSERT_TRUE(__threads.need_resched);
+    TEST_ASSERT_EQUAL_UINT32((1u << THREAD_PRIORITY_HIGHEST) | (1u << THREAD_PRIORITY_LOWEST), __threads.ready_mask);
+    TEST_ASSERT_EQUAL_PTR(&__created[0], __threads.ready_tail[THREAD_PRIORITY_LOWEST]);
+
+    thread_preempt(&__threads);
+    __test_assert_switch(0, &__boot, &__created[1]);
+}
+
+static void test_thread_set_priority__should__make_the_running_thread_give_way(void) {
+    __test_setup(false);
+    __test_create_priority(0, THREAD_PRIORITY_DEFAULT + 1);
+
+    TEST_ASSERT_TRUE(thread_set_priority(&__threads, &__boot, THREAD_PRIORITY_LOWEST));
+    thread_preempt(&__threads);
+    __test_assert_switch(0, &__boot, &__created[0]);
+}
+
+static void test_thread_join__should__return_once_the_thread_exited(void) {
+    __test_setup(true);
+    __test_create(0);
+
+    thread_join(&__threads, &__created[0]);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __ran[0]);
+    TEST_ASSERT_EQUAL(THREAD_DEAD, __created[0].state);
+    TEST_ASSERT_EQUAL(THREAD_RUNNING, __boot.state);
+    TEST_ASSERT_EQUAL_PTR(&__boot, thread_current(&__threads));
+    TEST_ASSERT_EQUAL_UINT32(2, __switch_count);
+    __test_assert_switch(0, &__boot, &__created[0]);
+    __test_assert_switch(1, &__created[0], &__boot);
+    TEST_ASSERT_FALSE(__disabled);
+}
+
+static void test_thread_join__should__return_at_once_for_an_exited_thread_or_itself(void) {
+    __test_setup(true);
+    __test_create(0);
+    thread_join(&__threads, &__created[0]);
+    __switch_count = 0;
+
+    thread_join(&__threads, &__created[0]);
+    thread_join(&__threads, &__boot);
+    TEST_ASSERT_EQUAL_UINT32(0, __switch_count);
+    TEST_ASSERT_EQUAL_UINT32(1, __ran[0]);
+}
+
+static void test_thread_exit__should__wake_every_joiner(void) {
+    __test_setup(false);
+    __test_create(0);
+    __test_create(1);
+    __test_create(2);
+
+    thread_yield(&__threads);
+    /* threads 0 and 1 join thread 2 in turn */
+    thread_join(&__threads, &__created[2]);
+    thread_join(&__threads, &__created[2]);
+    TEST_ASSERT_EQUAL(THREAD_BLOCKED, __created[0].state);
+    TEST_ASSERT_EQUAL(THREAD_BLOCKED, __created[1].state);
+    TEST_ASSERT_EQUAL_PTR(&__created[2], thread_current(&__threads));
+
+    thread_exit(&__threads);
+    TEST_ASSERT_EQUAL(THREAD_DEAD, __created[2].state);
+    TEST_ASSERT_EQUAL_PTR(&__boot, thread_current(&__threads));
+    TEST_ASSERT_EQUAL(THREAD_READY, __created[0].state);
+    TEST_ASSERT_EQUAL(THREAD_READY, __created[1].state);
+    TEST_ASSERT_NULL(__created[2].joiners);
+    __test_assert_switch(3, &__created[2], &__boot);
+}
+
+static void test_thread_join__should__idle_until_a_thread_is_ready(void) {
+    __test_setup(false);
+    __test_create(0);
+
+    thread_join(&__threads, &__created[0]);
+    /* thread 0 joins the blocked boot thread, nothing is left to run */
+    thread_join(&__threads, &__boot);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __idles);
+    TEST_ASSERT_EQUAL_PTR(&__created[2], thread_current(&__threads));
+    __test_assert_switch(1, &__created[0], &__created[2]);
+    TEST_ASSERT_FALSE(__disabled);
+}
+
+
+
+testfunc_container_t test_function_containers[] = {
+    {"thread_create should queue a prepared thread", test_thread_create__should__queue_a_prepared_thread},
+    {"thread_create should refuse a small stack", test_thread_create__should__refuse_a_small_stack},
+    {"thread_create should refuse an unknown priority", test_thread_create__should__refuse_an_unknown_priority},
+    {"thread_create should flag a higher priority thread to preempt", test_thread_create__should__flag_a_higher_priority_thread_to_preempt},
+
+    {"thread_yield should keep running without ready threads", test_thread_yield__should__keep_running_without_ready_threads},
+    {"thread_yield should run the threads in turns", test_thread_yield__should__run_the_threads_in_turns},
+    {"thread_yield should run the highest priority first", test_thread_yield__should__run_the_highest_priority_first},
+
+    {"thread_tick should preempt once the slice ended", test_thread_tick__should__preempt_once_the_slice_ended},
+    {"thread_tick should not preempt for lower priorities", test_thread_tick__should__not_preempt_for_lower_priorities},
+
+    {"thread_set_priority should requeue a ready thread", test_thread_set_priority__should__requeue_a_ready_thread},
+    {"thread_set_priority should make the running thread give way", test_thread_set_priority__should__make_the_running_thread_give_way},
+
+    {"thread_join should return once the thread exited", test_thread_join__should__return_once_the_thread_exited},
+    {"thread_join should return at once for an exited thread or itself", test_thread_join__should__return_at_once_for_an_exited_thread_or_itself},
+    {"thread_join should idle until a thread is ready", test_thread_join__should__idle_until_a_thread_is_ready},
+
+    {"thread_exit should wake every joiner", test_thread_exit__should__wake_every_joiner}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
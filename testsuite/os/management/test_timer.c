@@ -0,0 +1,291 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/management/timer.h>
+
+#define TEST_TIMER_COUNT    1000
+
+typedef struct test_expiry_s test_expiry_t;
+
+/* records the tick a timer ran at */
+struct test_expiry_s {
+    timer_t timer;
+    u64 ran_at;
+    u32 runs;
+};
+
+static u64 __now;
+static u64 __rearmed;
+static u32 __rearms;
+static u32 __locked;
+static timer_wheel_t __wheel;
+
+static u32 __test_lock(void) {
+    __locked++;
+    return __locked;
+}
+
+static void __test_unlock(u32 state) {
+    TEST_ASSERT_EQUAL_UINT32(__locked, state);
+    __locked--;
+}
+
+static void __test_rearm(void* context, u64 expires) {
+    (void)context;
+    TEST_ASSERT_EQUAL_UINT32(1, __locked);
+    __rearmed = expires;
+    __rearms++;
+}
+
+static void __test_expire(void* context) {
+    test_expiry_t* expiry = (test_expiry_t*)context;
+
+    TEST_ASSERT_EQUAL_UINT32(0, __locked);
+    expiry->ran_at = __now;
+    expiry->runs++;
+}
+
+static void __test_readd(void* context) {
+    test_expiry_t* expiry = (test_expiry_t*)context;
+
+    __test_expire(context);
+    timer_add(&__wheel, &expiry->timer, __now);
+}
+
+static void __test_setup(u64 now) {
+    __now = now;
+    __rearmed = TIMER_NONE;
+    __rearms = 0;
+    __locked = 0;
+    timer_wheel_initialize(&__wheel, now, __test_lock, __test_unlock, __test_rearm, NULL);
+}
+
+static void __test_expiry_initialize(test_expiry_t* expiry, timer_function_t function) {
+    expiry->ran_at = 0;
+    expiry->runs = 0;
+    timer_initialize(&expiry->timer, function, expiry);
+}
+
+static u32 __test_run(u64 now) {
+    __now = now;
+    return timer_wheel_run(&__wheel, now);
+}
+
+
+static void test_timer_wheel_run__should__run_a_timer_at_its_expiry(void) {
+    test_expiry_t expiry;
+
+    __test_setup(100);
+    __test_expiry_initialize(&expiry, __test_expire);
+    TEST_ASSERT_TRUE(timer_add(&__wheel, &expiry.timer, 130));
+    TEST_ASSERT_TRUE(timer_pending(&expiry.timer));
+
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(129));
+    TEST_ASSERT_EQUAL_UINT32(1, __test_run(130));
+    TEST_ASSERT_EQUAL_UINT64(130, expiry.ran_at);
+    TEST_ASSERT_FALSE(timer_pending(&expiry.timer));
+    TEST_ASSERT_EQUAL_UINT32(0, __wheel.count);
+
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(200));
+    TEST_ASSERT_EQUAL_UINT32(1, expiry.runs);
+}
+
+static void test_timer_wheel_run__should__cascade_far_timers_to_their_exact_tick(void) {
+    const u64 expires[] = {64, 65, 4095, 4096, 123457, 300000, 16777217};
+    test_expiry_t expiries[sizeof(expires) / sizeof(expires[0])];
+    size_t index;
+    u64 tick;
+
+    __test_setup(1);
+    for (index = 0; index < sizeof(expires) / sizeof(expires[0]); index++) {
+        __test_expiry_initialize(&expiries[index], __test_expire);
+        timer_add(&__wheel, &expiries[index].timer, expires[index]);
+    }
+
+    /* run at every tick the wheel asks for, as the timer interrupt would */
+    for (tick = timer_wheel_next_expiry(&__wheel); tick != TIMER_NONE; tick = timer_wheel_next_expiry(&__wheel)) {
+        __test_run(tick);
+    }
+
+    for (index = 0; index < sizeof(expires) / sizeof(expires[0]); index++) {
+        TEST_ASSERT_EQUAL_UINT32(1, expiries[index].runs);
+        TEST_ASSERT_EQUAL_UINT64(expires[index], expiries[index].ran_at);
+    }
+}
+
+static void test_timer_wheel_run__should__look_past_a_slot_due_a_turn_later(void) {
+    test_expiry_t late;
+    test_expiry_t early;
+    u64 tick;
+
+    /* 4105 shares the level 1 slot the clock is in, due a whole turn after 200 */
+    __test_setup(10);
+    __test_expiry_initialize(&late, __test_expire);
+    __test_expiry_initialize(&early, __test_expire);
+    timer_add(&__wheel, &late.timer, 4105);
+    timer_add(&__wheel, &early.timer, 200);
+    TEST_ASSERT_EQUAL_UINT64(192, timer_wheel_next_expiry(&__wheel));
+
+    for (tick = timer_wheel_next_expiry(&__wheel); tick != TIMER_NONE; tick = timer_wheel_next_expiry(&__wheel)) {
+        __test_run(tick);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(1, early.runs);
+    TEST_ASSERT_EQUAL_UINT64(200, early.ran_at);
+    TEST_ASSERT_EQUAL_UINT32(1, late.runs);
+    TEST_ASSERT_EQUAL_UINT64(4105, late.ran_at);
+}
+
+static void test_timer_wheel_run__should__run_timers_beyond_the_wheel_when_due(void) {
+    const u64 expires = 5 + TIMER_WHEEL_MAX_DELTA * 3;
+    test_expiry_t expiry;
+
+    __test_setup(5);
+    __test_expiry_initialize(&expiry, __test_expire);
+    timer_add(&__wheel, &expiry.timer, expires);
+
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(expires - 1));
+    TEST_ASSERT_TRUE(timer_pending(&expiry.timer));
+    TEST_ASSERT_EQUAL_UINT32(1, __test_run(expires));
+    TEST_ASSERT_EQUAL_UINT64(expires, expiry.ran_at);
+}
+
+static void test_timer_wheel_run__should__run_every_timer_once_in_a_large_jump(void) {
+    static test_expiry_t expiries[TEST_TIMER_COUNT];
+    u32 seed = 12345;
+    size_t index;
+
+    __test_setup(0);
+    for (index = 0; index < TEST_TIMER_COUNT; index++) {
+        seed = seed * 1103515245 + 12345;
+        __test_expiry_initialize(&expiries[index], __test_expire);
+        timer_add(&__wheel, &expiries[index].timer, seed % 1000000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(TEST_TIMER_COUNT, __wheel.count);
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_TIMER_COUNT, __test_run(1000000));
+    for (index = 0; index < TEST_TIMER_COUNT; index++) {
+        TEST_ASSERT_EQUAL_UINT32(1, expiries[index].runs);
+    }
+    TEST_ASSERT_EQUAL_UINT64(TIMER_NONE, timer_wheel_next_expiry(&__wheel));
+}
+
+static void test_timer_wheel_run__should__run_a_timer_readded_for_now_on_the_next_run(void) {
+    test_expiry_t expiry;
+
+    __test_setup(0);
+    __test_expiry_initialize(&expiry, __test_readd);
+    timer_add(&__wheel, &expiry.timer, 10);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __test_run(10));
+    TEST_ASSERT_TRUE(timer_pending(&expiry.timer));
+    TEST_ASSERT_EQUAL_UINT64(11, __rearmed);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __test_run(11));
+    TEST_ASSERT_EQUAL_UINT32(2, expiry.runs);
+}
+
+static void test_timer_cancel__should__keep_a_timer_from_running(void) {
+    test_expiry_t expiry;
+
+    __test_setup(0);
+    __test_expiry_initialize(&expiry, __test_expire);
+    TEST_ASSERT_FALSE(timer_cancel(&__wheel, &expiry.timer));
+
+    timer_add(&__wheel, &expiry.timer, 5000);
+    TEST_ASSERT_TRUE(timer_cancel(&__wheel, &expiry.timer));
+    TEST_ASSERT_FALSE(timer_pending(&expiry.timer));
+    TEST_ASSERT_EQUAL_UINT32(0, __wheel.count);
+
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(10000));
+    TEST_ASSERT_EQUAL_UINT32(0, expiry.runs);
+}
+
+static void test_timer_add__should__refuse_a_pending_timer(void) {
+    test_expiry_t expiry;
+
+    __test_setup(0);
+    __test_expiry_initialize(&expiry, __test_expire);
+    TEST_ASSERT_TRUE(timer_add(&__wheel, &expiry.timer, 50));
+    TEST_ASSERT_FALSE(timer_add(&__wheel, &expiry.timer, 20));
+    TEST_ASSERT_EQUAL_UINT64(50, expiry.timer.expires);
+    TEST_ASSERT_EQUAL_UINT32(1, __wheel.count);
+}
+
+static void test_timer_add__should__rearm_only_for_an_earlier_expiry(void) {
+    test_expiry_t late;
+    test_expiry_t early;
+
+    __test_setup(0);
+    __test_expiry_initialize(&late, __test_expire);
+    __test_expiry_initialize(&early, __test_expire);
+
+    timer_add(&__wheel, &late.timer, 500);
+    TEST_ASSERT_EQUAL_UINT64(500, __rearmed);
+    timer_add(&__wheel, &early.timer, 200);
+    TEST_ASSERT_EQUAL_UINT64(200, __rearmed);
+    timer_cancel(&__wheel, &early.timer);
+    timer_add(&__wheel, &early.timer, 300);
+    TEST_ASSERT_EQUAL_UINT32(2, __rearms);
+
+    /* the early wakeup finds nothing due and rearms for the slot holding the timer at 300 */
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(200));
+    TEST_ASSERT_EQUAL_UINT64(256, __rearmed);
+}
+
+static void test_timer_mod__should__move_a_pending_timer(void) {
+    test_expiry_t expiry;
+
+    __test_setup(0);
+    __test_expiry_initialize(&expiry, __test_expire);
+    TEST_ASSERT_FALSE(timer_mod(&__wheel, &expiry.timer, 1000));
+    TEST_ASSERT_TRUE(timer_mod(&__wheel, &expiry.timer, 40));
+    TEST_ASSERT_EQUAL_UINT32(1, __wheel.count);
+
+    TEST_ASSERT_EQUAL_UINT32(1, __test_run(40));
+    TEST_ASSERT_EQUAL_UINT32(0, __test_run(1000));
+    TEST_ASSERT_EQUAL_UINT32(1, expiry.runs);
+}
+
+static void test_timer_wheel_next_expiry__should__be_exact_for_the_next_slots(void) {
+    test_expiry_t expiry;
+
+    __test_setup(1000);
+    TEST_ASSERT_EQUAL_UINT64(TIMER_NONE, timer_wheel_next_expiry(&__wheel));
+
+    __test_expiry_initialize(&expiry, __test_expire);
+    timer_add(&__wheel, &expiry.timer, 1030);
+    TEST_ASSERT_EQUAL_UINT64(1030, timer_wheel_next_expiry(&__wheel));
+
+    /* an expiry already passed is due now */
+    timer_mod(&__wheel, &expiry.timer, 10);
+    TEST_ASSERT_EQUAL_UINT64(1000, timer_wheel_next_expiry(&__wheel));
+}
+
+
+
+testfunc_container_t test_function_containers[] = {
+    {"timer_wheel_run should run a timer at its expiry", test_timer_wheel_run__should__run_a_timer_at_its_expiry},
+    {"timer_wheel_run should cascade far timers to their exact tick", test_timer_wheel_run__should__cascade_far_timers_to_their_exact_tick},
+    {"timer_wheel_run should look past a slot due a turn later", test_timer_wheel_run__should__look_past_a_slot_due_a_turn_later},
+    {"timer_wheel_run should run timers beyond the wheel when due", test_timer_wheel_run__should__run_timers_beyond_the_wheel_when_due},
+    {"timer_wheel_run should run every timer once in a large jump", test_timer_wheel_run__should__run_every_timer_once_in_a_large_jump},
+    {"timer_wheel_run should run a timer readded for now on the next run", test_timer_wheel_run__should__run_a_timer_readded_for_now_on_the_next_run},
+
+    {"timer_cancel should keep a timer from running", test_timer_cancel__should__keep_a_timer_from_running},
+
+    {"timer_add should refuse a pending timer", test_timer_add__should__refuse_a_pending_timer},
+    {"timer_add should rearm only for an earlier expiry", test_timer_add__should__rearm_only_for_an_earlier_expiry},
+
+    {"timer_mod should move a pending timer", test_timer_mod__should__move_a_pending_timer},
+
+    {"timer_wheel_next_expiry should be exact for the next slots", test_timer_wheel_next_expiry__should__be_exact_for_the_next_slots}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -0,0 +1,185 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/limits.h>
+#include <llanos/util/convert.h>
+
+static void __assert_text(const char* expected, const char* buffer, size_t length) {
+    char text[CONVERT_U64_MAX_BINARY_DIGITS + 1];
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        text[i] = buffer[i];
+    }
+    text[length] = '\0';
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+}
+
+static void test_convert_u32_to_decimal__should__convert_zero(void) {
+    char buffer[CONVERT_U32_MAX_DECIMAL_DIGITS];
+    size_t length = convert_u32_to_decimal(buffer, 0);
+
+    TEST_ASSERT_EQUAL(1, length);
+    __assert_text("0", buffer, length);
+}
+
+static void test_convert_u32_to_decimal__should__convert_digit_count_boundaries(void) {
+    char buffer[CONVERT_U32_MAX_DECIMAL_DIGITS];
+
+    __assert_text("9", buffer, convert_u32_to_decimal(buffer, 9));
+    __assert_text("10", buffer, convert_u32_to_decimal(buffer, 10));
+    __assert_text("99", buffer, convert_u32_to_decimal(buffer, 99));
+    __assert_text("100", buffer, convert_u32_to_decimal(buffer, 100));
+    __assert_text("999999999", buffer, convert_u32_to_decimal(buffer, 999999999));
+    __assert_text("1000000000", buffer, convert_u32_to_decimal(buffer, 1000000000));
+}
+
+static void test_convert_u32_to_decimal__should__convert_max_value(void) {
+    char buffer[CONVERT_U32_MAX_DECIMAL_DIGITS];
+    size_t length = convert_u32_to_decimal(buffer, U32MAX);
+
+    TEST_ASSERT_EQUAL(CONVERT_U32_MAX_DECIMAL_DIGITS, length);
+    __assert_text("4294967295", buffer, length);
+}
+
+static void test_convert_u64_to_decimal__should__convert_values_above_32bits(void) {
+    char buffer[CONVERT_U64_MAX_DECIMAL_DIGITS];
+
+    __assert_text("4294967295", buffer, convert_u64_to_decimal(buffer, 4294967295ULL));
+    __assert_text("4294967296", buffer, convert_u64_to_decimal(buffer, 4294967296ULL));
+    __assert_text("1234567890123", buffer, convert_u64_to_decimal(buffer, 1234567890123ULL));
+}
+
+static void test_convert_u64_to_decimal__should__keep_zeros_inside_chunks(void) {
+    char buffer[CONVERT_U64_MAX_DECIMAL_DIGITS];
+
+    __assert_text("10000000000000000001", buffer, convert_u64_to_decimal(buffer, 10000000000000000001ULL));
+    __assert_text("100000000000", buffer, convert_u64_to_decimal(buffer, 100000000000ULL));
+    __assert_text("9000000000090", buffer, convert_u64_to_decimal(buffer, 9000000000090ULL));
+}
+
+static void test_convert_u64_to_decimal__should__convert_max_value(void) {
+    char buffer[CONVERT_U64_MAX_DECIMAL_DIGITS];
+    size_t length = convert_u64_to_decimal(buffer, U64MAX);
+
+    TEST_ASSERT_EQUAL(CONVERT_U64_MAX_DECIMAL_DIGITS, length);
+    __assert_text("18446744073709551615", buffer, length);
+}
+
+static void test_convert_u64_to_power_of_two_base__should__convert_hex(void) {
+    char buffer[CONVERT_U64_MAX_BINARY_DIGITS];
+
+    __assert_text("0", buffer, convert_u64_to_power_of_two_base(buffer, 0, 4, false));
+    __assert_text("deadbeef", buffer, convert_u64_to_power_of_two_base(buffer, 0xdeadbeef, 4, false));
+    __assert_text("DEADBEEF", buffer, convert_u64_to_power_of_two_base(buffer, 0xdeadbeef, 4, true));
+    __assert_text("1cafef00d", buffer, convert_u64_to_power_of_two_base(buffer, 0x1cafef00dULL, 4, false));
+}
+
+static void test_convert_u64_to_power_of_two_base__should__convert_octal_and_binary(void) {
+    char buffer[CONVERT_U64_MAX_BINARY_DIGITS];
+
+    __assert_text("1777777777777777777777", buffer, convert_u64_to_power_of_two_base(buffer, U64MAX, 3, false));
+    __assert_text("100000000000", buffer, convert_u64_to_power_of_two_base(buffer, 0x200000000ULL, 3, false));
+    __assert_text("1101001", buffer, convert_u64_to_power_of_two_base(buffer, 0x69, 1, false));
+    TEST_ASSERT_EQUAL(CONVERT_U64_MAX_BINARY_DIGITS, convert_u64_to_power_of_two_base(buffer, U64MAX, 1, false));
+}
+
+static void test_convert_double_to_shortest_decimal__should__produce_shortest_digits(void) {
+    convert_decimal_t decimal;
+
+    convert_double_to_shortest_decimal(&decimal, 0.1);
+    __assert_text("1", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(-1, decimal.exponent);
+
+    convert_double_to_shortest_decimal(&decimal, -32.25);
+    __assert_text("3225", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(1, decimal.exponent);
+
+    convert_double_to_shortest_decimal(&decimal, 1.7976931348623157e308);
+    __assert_text("17976931348623157", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(308, decimal.exponent);
+}
+
+static void test_convert_double_to_shortest_decimal__should__convert_zero_and_subnormals(void) {
+    convert_decimal_t decimal;
+
+    convert_double_to_shortest_decimal(&decimal, 0.0);
+    TEST_ASSERT_EQUAL(0, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(0, decimal.exponent);
+
+    convert_double_to_shortest_decimal(&decimal, 5e-324);
+    __assert_text("5", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(-324, decimal.exponent);
+}
+
+static void test_convert_double_to_significant_decimal__should__round_exact_value_half_to_even(void) {
+    convert_decimal_t decimal;
+
+    convert_double_to_significant_decimal(&decimal, 2.675, 3);
+    __assert_text("267", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(0, decimal.exponent);
+
+    convert_double_to_significant_decimal(&decimal, 0.125, 2);
+    __assert_text("12", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(-1, decimal.exponent);
+
+    convert_double_to_significant_decimal(&decimal, 5e-324, 4);
+    __assert_text("4941", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(-324, decimal.exponent);
+
+    /* the shortest digits of 1e23 are one decade above its exact value */
+    convert_double_to_significant_decimal(&decimal, 1e23, 17);
+    __assert_text("99999999999999992", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(22, decimal.exponent);
+
+    convert_double_to_significant_decimal(&decimal, 1.7976931348623157e308, 3);
+    __assert_text("18", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(308, decimal.exponent);
+}
+
+static void test_convert_double_to_fixed_decimal__should__round_at_fraction_digit(void) {
+    convert_decimal_t decimal;
+
+    convert_double_to_fixed_decimal(&decimal, 9.996, 2);
+    __assert_text("1", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(1, decimal.exponent);
+
+    convert_double_to_fixed_decimal(&decimal, 0.6, 0);
+    __assert_text("1", decimal.digits, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(0, decimal.exponent);
+
+    convert_double_to_fixed_decimal(&decimal, 0.5, 0);
+    TEST_ASSERT_EQUAL(0, decimal.length);
+
+    convert_double_to_fixed_decimal(&decimal, 0.0004, 2);
+    TEST_ASSERT_EQUAL(0, decimal.length);
+    TEST_ASSERT_EQUAL_INT32(0, decimal.exponent);
+}
+
+testfunc_container_t test_function_containers[] = {
+    {"convert_u32_to_decimal should convert zero", test_convert_u32_to_decimal__should__convert_zero},
+    {"convert_u32_to_decimal should convert digit count boundaries", test_convert_u32_to_decimal__should__convert_digit_count_boundaries},
+    {"convert_u32_to_decimal should convert max value", test_convert_u32_to_decimal__should__convert_max_value},
+
+    {"convert_u64_to_decimal should convert values above 32bits", test_convert_u64_to_decimal__should__convert_values_above_32bits},
+    {"convert_u64_to_decimal should keep zeros inside chunks", test_convert_u64_to_decimal__should__keep_zeros_inside_chunks},
+    {"convert_u64_to_decimal should convert max value", test_convert_u64_to_decimal__should__convert_max_value},
+
+    {"convert_u64_to_power_of_two_base should convert hex", test_convert_u64_to_power_of_two_base__should__convert_hex},
+    {"convert_u64_to_power_of_two_base should convert octal and binary", test_convert_u64_to_power_of_two_base__should__convert_octal_and_binary},
+
+    {"convert_double_to_shortest_decimal should produce shortest digits", test_convert_double_to_shortest_decimal__should__produce_shortest_digits},
+    {"convert_double_to_shortest_decimal should convert zero and subnormals", test_convert_double_to_shortest_decimal__should__convert_zero_and_subnormals},
+
+    {"convert_double_to_significant_decimal should round exact value half to even", test_convert_double_to_significant_decimal__should__round_exact_value_half_to_even},
+    {"convert_double_to_fixed_decimal should round at fraction digit", test_convert_double_to_fixed_decimal__should__round_at_fraction_digit}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+    return 0;
+}
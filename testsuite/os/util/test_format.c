@@ -0,0 +1,227 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/limits.h>
+#include <llanos/util/format.h>
+
+typedef struct span_recorder_s span_recorder_t;
+
+struct span_recorder_s {
+    size_t spans;
+    size_t characters;
+};
+
+static void __record_span(void* context, const char* span, size_t length) {
+    span_recorder_t* recorder = (span_recorder_t*)context;
+
+    (void)span;
+    recorder->spans++;
+    recorder->characters += length;
+}
+
+static s32 __stream_to_recorder(span_recorder_t* recorder, const char* format, ...) {
+    va_list arguments;
+    s32 length;
+
+    va_start(arguments, format);
+    length = format_stream(__record_span, recorder, format, arguments);
+    va_end(arguments);
+
+    return length;
+}
+
+static void test_ksnprintf__should__copy_plain_text(void) {
+    char buffer[32];
+
+    TEST_ASSERT_EQUAL_INT32(11, ksnprintf(buffer, sizeof(buffer), "plain text!"));
+    TEST_ASSERT_EQUAL_STRING("plain text!", buffer);
+}
+
+static void test_ksnprintf__should__print_signed_and_unsigned_decimal(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%d %d %u", S32MIN, S32MAX, U32MAX);
+    TEST_ASSERT_EQUAL_STRING("-2147483648 2147483647 4294967295", buffer);
+}
+
+static void test_ksnprintf__should__print_64bit_values(void) {
+    char buffer[80];
+
+    ksnprintf(buffer, sizeof(buffer), "%llu %llx %lld", U64MAX, U64MAX, S64MIN);
+    TEST_ASSERT_EQUAL_STRING("18446744073709551615 ffffffffffffffff -9223372036854775808", buffer);
+}
+
+static void test_ksnprintf__should__pad_to_width(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "[%5d][%-5d][%05d][%-05d]", 42, 42, -42, 42);
+    TEST_ASSERT_EQUAL_STRING("[   42][42   ][-0042][42   ]", buffer);
+}
+
+static void test_ksnprintf__should__pad_hex_with_zeros(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%08x %016llX", 0xbeef, 0xdeadbeefULL);
+    TEST_ASSERT_EQUAL_STRING("0000beef 00000000DEADBEEF", buffer);
+}
+
+static void test_ksnprintf__should__use_precision_as_minimum_digits(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%.4d|%8.3u|%.0u|", 7, 5, 0);
+    TEST_ASSERT_EQUAL_STRING("0007|     005||", buffer);
+}
+
+static void test_ksnprintf__should__take_width_and_precision_from_arguments(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "[%*d][%-*d][%.*s]", 4, 1, 3, 2, 3, "abcdef");
+    TEST_ASSERT_EQUAL_STRING("[   1][2  ][abc]", buffer);
+}
+
+static void test_ksnprintf__should__print_signs(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%+d % d %+u", 5, 5, 5);
+    TEST_ASSERT_EQUAL_STRING("+5  5 5", buffer);
+}
+
+static void test_ksnprintf__should__print_strings_and_characters(void) {
+    char buffer[64];
+    char bufferstring[] = {'a', 'b', 'c'};
+
+    ksnprintf(buffer, sizeof(buffer), "%s|%6s|%-4c|%S|%s", "str", "pad", 'z', sizeof(bufferstring), bufferstring, NULL);
+    TEST_ASSERT_EQUAL_STRING("str|   pad|z   |abc|(null)", buffer);
+}
+
+static void test_ksnprintf__should__print_floating_point(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%f %.2f %8.1f %e", 32.25, 3.14159, -1.96, 15.625);
+    TEST_ASSERT_EQUAL_STRING("32.25 3.14     -2.0 1.5625e+1", buffer);
+}
+
+static void test_ksnprintf__should__print_shortest_round_trip_digits(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%f %f %f %e", 0.1, 0.3, 0.0000001, 5e-324);
+    TEST_ASSERT_EQUAL_STRING("0.1 0.3 0.0000001 5.0e-324", buffer);
+}
+
+static void test_ksnprintf__should__round_floating_point_to_precision(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%.2f %.3e %.0f %.2f %.1e", 9.996, 123456.0, 0.6, 1e-30, 9.96e99);
+    TEST_ASSERT_EQUAL_STRING("10.00 1.235e+5 1 0.00 1.0e+100", buffer);
+}
+
+static void test_ksnprintf__should__round_exact_value_once(void) {
+    char buffer[64];
+
+    /* 2.675 is 2.67499999999999982236431605997495353221893310546875 */
+    ksnprintf(buffer, sizeof(buffer), "%.2f %.2f %.3e", 2.675, 0.125, 5e-324);
+    TEST_ASSERT_EQUAL_STRING("2.67 0.12 4.941e-324", buffer);
+}
+
+static void test_ksnprintf__should__round_exact_ties_to_even(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%.0f %.0f %.0f %.1f %.2e", 0.5, 1.5, 2.5, 0.375, 1125.0);
+    TEST_ASSERT_EQUAL_STRING("0 2 2 0.4 1.12e+3", buffer);
+}
+
+static void test_ksnprintf__should__print_exact_digits_past_shortest(void) {
+    char buffer[64];
+
+    ksnprintf(buffer, sizeof(buffer), "%.20f", 0.1);
+    TEST_ASSERT_EQUAL_STRING("0.10000000000000000555", buffer);
+}
+
+static void test_ksnprintf__should__print_non_finite_floating_point(void) {
+    char buffer[64];
+    double zero = 0.0;
+
+    ksnprintf(buffer, sizeof(buffer), "%f %e %05f", 1.0 / zero, -1.0 / zero, zero / zero);
+    TEST_ASSERT_EQUAL_STRING("inf -inf   nan", buffer);
+}
+
+static void test_ksnprintf__should__print_percent_character(void) {
+    char buffer[8];
+
+    ksnprintf(buffer, sizeof(buffer), "100%%");
+    TEST_ASSERT_EQUAL_STRING("100%", buffer);
+}
+
+static void test_ksnprintf__should__truncate_and_return_full_length(void) {
+    char buffer[8];
+
+    TEST_ASSERT_EQUAL_INT32(16, ksnprintf(buffer, sizeof(buffer), "value: %9d", 1));
+    TEST_ASSERT_EQUAL_STRING("value: ", buffer);
+}
+
+static void test_ksnprintf__should__not_write_to_zero_sized_buffer(void) {
+    char buffer[4] = {'x', 'x', 'x', 'x'};
+
+    TEST_ASSERT_EQUAL_INT32(3, ksnprintf(buffer, 0, "abc"));
+    TEST_ASSERT_EQUAL('x', buffer[0]);
+}
+
+static void test_ksnprintf__should__fail_on_invalid_specifier(void) {
+    char buffer[16];
+
+    TEST_ASSERT_EQUAL_INT32(-1, ksnprintf(buffer, sizeof(buffer), "ab%q"));
+    TEST_ASSERT_EQUAL_STRING("ab", buffer);
+    TEST_ASSERT_EQUAL_INT32(-1, ksnprintf(buffer, sizeof(buffer), "ab%"));
+}
+
+static void test_format_stream__should__hand_whole_spans_to_the_sink(void) {
+    span_recorder_t recorder = {0, 0};
+
+    /* "value: " + "12345" + ", name: " + "abcdef" */
+    TEST_ASSERT_EQUAL_INT32(26, __stream_to_recorder(&recorder, "value: %d, name: %s", 12345, "abcdef"));
+    TEST_ASSERT_EQUAL(4, recorder.spans);
+    TEST_ASSERT_EQUAL(26, recorder.characters);
+}
+
+static void test_format_stream__should__hand_padding_in_chunks(void) {
+    span_recorder_t recorder = {0, 0};
+
+    TEST_ASSERT_EQUAL_INT32(40, __stream_to_recorder(&recorder, "%40d", 1));
+    TEST_ASSERT_EQUAL(40, recorder.characters);
+    TEST_ASSERT_TRUE(recorder.spans <= 4);
+}
+
+testfunc_container_t test_function_containers[] = {
+    {"ksnprintf should copy plain text", test_ksnprintf__should__copy_plain_text},
+    {"ksnprintf should print signed and unsigned decimal", test_ksnprintf__should__print_signed_and_unsigned_decimal},
+    {"ksnprintf should print 64bit values", test_ksnprintf__should__print_64bit_values},
+    {"ksnprintf should pad to width", test_ksnprintf__should__pad_to_width},
+    {"ksnprintf should pad hex with zeros", test_ksnprintf__should__pad_hex_with_zeros},
+    {"ksnprintf should use precision as minimum digits", test_ksnprintf__should__use_precision_as_minimum_digits},
+    {"ksnprintf should take width and precision from arguments", test_ksnprintf__should__take_width_and_precision_from_arguments},
+    {"ksnprintf should print signs", test_ksnprintf__should__print_signs},
+    {"ksnprintf should print strings and characters", test_ksnprintf__should__print_strings_and_characters},
+    {"ksnprintf should print floating point", test_ksnprintf__should__print_floating_point},
+    {"ksnprintf should print shortest round trip digits", test_ksnprintf__should__print_shortest_round_trip_digits},
+    {"ksnprintf should round floating point to precision", test_ksnprintf__should__round_floating_point_to_precision},
+    {"ksnprintf should round exact value once", test_ksnprintf__should__round_exact_value_once},
+    {"ksnprintf should round exact ties to even", test_ksnprintf__should__round_exact_ties_to_even},
+    {"ksnprintf should print exact digits past shortest", test_ksnprintf__should__print_exact_digits_past_shortest},
+    {"ksnprintf should print non finite floating point", test_ksnprintf__should__print_non_finite_floating_point},
+    {"ksnprintf should print percent character", test_ksnprintf__should__print_percent_character},
+    {"ksnprintf should truncate and return full length", test_ksnprintf__should__truncate_and_return_full_length},
+    {"ksnprintf should not write to zero sized buffer", test_ksnprintf__should__not_write_to_zero_sized_buffer},
+    {"ksnprintf should fail on invalid specifier", test_ksnprintf__should__fail_on_invalid_specifier},
+
+    {"format_stream should hand whole spans to the sink", test_format_stream__should__hand_whole_spans_to_the_sink},
+    {"format_stream should hand padding in chunks", test_format_stream__should__hand_padding_in_chunks}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+    return 0;
+}
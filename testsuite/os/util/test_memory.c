@@ -18,9 +18,48 @@ static void test_memory_set_value__should__set_memory_starting_at_dest_pointer_f
     TEST_ASSERT_EQUAL_MEMORY(expected, data, sizeof(expected) / sizeof(u8));
 }
 
+static void test_memory_copy__should__copy_nothing_on_zero_length(void) {
+    u8 data[] = {1, 2, 3, 4, 5};
+    u8 source[] = {6, 7, 8, 9, 10};
+    u8 expected[] = {1, 2, 3, 4, 5};
+
+    memory_copy(data, source, 0);
+    TEST_ASSERT_EQUAL_MEMORY(expected, data, sizeof(expected) / sizeof(u8));
+}
+
+static void test_memory_copy__should__copy_length_bytes_from_source_to_dest(void) {
+    u8 data[] = {1, 2, 3, 4, 5};
+    u8 source[] = {6, 7, 8, 9, 10};
+    u8 expected[] = {1, 6, 7, 8, 5};
+
+    memory_copy(&data[1], source, 3);
+    TEST_ASSERT_EQUAL_MEMORY(expected, data, sizeof(expected) / sizeof(u8));
+}
+
+static void test_memory_copy__should__copy_aligned_and_unaligned_tails(void) {
+    u32 words[8];
+    u32 source_words[8];
+    u8* data = (u8*)words;
+    u8* source = (u8*)source_words;
+    size_t index;
+
+    for (index = 0; index < sizeof(words); index++) {
+        data[index] = 0;
+        source[index] = (u8)(index + 1);
+    }
+
+    memory_copy(&data[1], &source[1], 30);
+    TEST_ASSERT_EQUAL_UINT8(0, data[0]);
+    TEST_ASSERT_EQUAL_MEMORY(&source[1], &data[1], 30);
+    TEST_ASSERT_EQUAL_UINT8(0, data[31]);
+}
+
 testfunc_container_t test_function_containers[] = {
     {"memory_set_value should set nothing on zero length", test_memory_set_value__should__set_nothing_on_zero_length},
-    {"memory_set_value should set memory starting at dest pointer for length bytes", test_memory_set_value__should__set_memory_starting_at_dest_pointer_for_length_bytes}
+    {"memory_set_value should set memory starting at dest pointer for length bytes", test_memory_set_value__should__set_memory_starting_at_dest_pointer_for_length_bytes},
+    {"memory_copy should copy nothing on zero length", test_memory_copy__should__copy_nothing_on_zero_length},
+    {"memory_copy should copy length bytes from source to dest", test_memory_copy__should__copy_length_bytes_from_source_to_dest},
+    {"memory_copy should copy aligned and unaligned tails", test_memory_copy__should__copy_aligned_and_unaligned_tails}
 };
 
 int main(void) {
@@ -0,0 +1,113 @@
+#include <testsuite.h>
+#include <llanos/types.h>
+#include <llanos/util/ring.h>
+
+#define TEST_RING_SIZE  8
+
+static u8 __buffer[TEST_RING_SIZE];
+
+static void test_ring_initialize__should__start_empty(void) {
+    ring_t ring;
+    u8 byte;
+
+    ring_initialize(&ring, __buffer, TEST_RING_SIZE);
+    TEST_ASSERT_TRUE(ring_is_empty(&ring));
+    TEST_ASSERT_FALSE(ring_is_full(&ring));
+    TEST_ASSERT_EQUAL_UINT32(0, ring_count(&ring));
+    TEST_ASSERT_FALSE(ring_pop(&ring, &byte));
+}
+
+static void test_ring_pop__should__return_bytes_in_push_order(void) {
+    ring_t ring;
+    u8 byte;
+
+    ring_initialize(&ring, __buffer, TEST_RING_SIZE);
+    TEST_ASSERT_TRUE(ring_push(&ring, 'a'));
+    TEST_ASSERT_TRUE(ring_push(&ring, 'b'));
+    TEST_ASSERT_TRUE(ring_push(&ring, 'c'));
+    TEST_ASSERT_EQUAL_UINT32(3, ring_count(&ring));
+
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8('a', byte);
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8('b', byte);
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8('c', byte);
+    TEST_ASSERT_TRUE(ring_is_empty(&ring));
+}
+
+static void test_ring_push__should__refuse_bytes_when_full(void) {
+    ring_t ring;
+    u8 byte;
+    u32 index;
+
+    ring_initialize(&ring, __buffer, TEST_RING_SIZE);
+    for (index = 0; index < TEST_RING_SIZE; index++) {
+        TEST_ASSERT_TRUE(ring_push(&ring, (u8)index));
+    }
+    TEST_ASSERT_TRUE(ring_is_full(&ring));
+    TEST_ASSERT_FALSE(ring_push(&ring, 0xff));
+
+    /* popping one makes room for exactly one more */
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8(0, byte);
+    TEST_ASSERT_TRUE(ring_push(&ring, 0xff));
+    TEST_ASSERT_FALSE(ring_push(&ring, 0xfe));
+}
+
+static void test_ring_pop__should__wrap_around_the_buffer(void) {
+    ring_t ring;
+    u8 byte;
+    u32 index;
+
+    ring_initialize(&ring, __buffer, TEST_RING_SIZE);
+    for (index = 0; index < TEST_RING_SIZE * 3; index++) {
+        TEST_ASSERT_TRUE(ring_push(&ring, (u8)index));
+        TEST_ASSERT_TRUE(ring_push(&ring, (u8)(index + 100)));
+        TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+        TEST_ASSERT_EQUAL_UINT8((u8)index, byte);
+        TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+        TEST_ASSERT_EQUAL_UINT8((u8)(index + 100), byte);
+    }
+    TEST_ASSERT_TRUE(ring_is_empty(&ring));
+}
+
+static void test_ring_count__should__survive_counter_overflow(void) {
+    ring_t ring;
+    u8 byte;
+
+    ring_initialize(&ring, __buffer, TEST_RING_SIZE);
+    ring.head = 0xfffffffe;
+    ring.tail = 0xfffffffe;
+
+    TEST_ASSERT_TRUE(ring_push(&ring, 1));
+    TEST_ASSERT_TRUE(ring_push(&ring, 2));
+    TEST_ASSERT_TRUE(ring_push(&ring, 3));
+    TEST_ASSERT_EQUAL_UINT32(3, ring_count(&ring));
+
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8(1, byte);
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8(2, byte);
+    TEST_ASSERT_TRUE(ring_pop(&ring, &byte));
+    TEST_ASSERT_EQUAL_UINT8(3, byte);
+    TEST_ASSERT_TRUE(ring_is_empty(&ring));
+}
+
+testfunc_container_t test_function_containers[] = {
+    {"ring_initialize should start empty", test_ring_initialize__should__start_empty},
+    {"ring_pop should return bytes in push order", test_ring_pop__should__return_bytes_in_push_order},
+    {"ring_push should refuse bytes when full", test_ring_push__should__refuse_bytes_when_full},
+    {"ring_pop should wrap around the buffer", test_ring_pop__should__wrap_around_the_buffer},
+    {"ring_count should survive counter overflow", test_ring_count__should__survive_counter_overflow}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+    return 0;
+}
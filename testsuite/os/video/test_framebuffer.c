@@ -0,0 +1,142 @@
+#include <testsuite.h>
+#include <string.h>
+#include <llanos/types.h>
+#include <llanos/video/framebuffer.h>
+
+/* pixel rows are padded by a few pixels to make sure the pitch is honoured */
+#define TEST_PITCH_PADDING  3
+
+static void __framebuffer_info(framebuffer_info_t* info, u32* pixels, u32 width, u32 height) {
+    info->address = (u8*)pixels;
+    info->pitch = (width + TEST_PITCH_PADDING) * sizeof(u32);
+    info->width = width;
+    info->height = height;
+    info->bpp = 32;
+    info->red_position = 16;
+    info->red_size = 8;
+    info->green_position = 8;
+    info->green_size = 8;
+    info->blue_position = 0;
+    info->blue_size = 8;
+}
+
+static u32 __pixel(u32* pixels, u32 width, u32 x, u32 y) {
+    return pixels[y * (width + TEST_PITCH_PADDING) + x];
+}
+
+
+static void test_framebuffer_console_initialize__should__reject_unsupported_depths(void) {
+    framebuffer_console_t console;
+    framebuffer_info_t info;
+    u32 pixels[(16 + TEST_PITCH_PADDING) * 16];
+
+    __framebuffer_info(&info, pixels, 16, 16);
+    info.bpp = 24;
+
+    TEST_ASSERT_FALSE(framebuffer_console_initialize(&console, &info, false));
+}
+
+static void test_framebuffer_console_initialize__should__clear_the_screen(void) {
+    framebuffer_console_t console;
+    framebuffer_info_t info;
+    u32 pixels[(16 + TEST_PITCH_PADDING) * 32];
+    u32 x;
+    u32 y;
+
+    memset(pixels, 0xff, sizeof(pixels));
+    __framebuffer_info(&info, pixels, 16, 32);
+
+    TEST_ASSERT_TRUE(framebuffer_console_initialize(&console, &info, false));
+    TEST_ASSERT_EQUAL_UINT32(2, console.columns);
+    TEST_ASSERT_EQUAL_UINT32(2, console.rows);
+    for (y = 0; y < 32; y++) {
+        for (x = 0; x < 16; x++) {
+            TEST_ASSERT_EQUAL_HEX32(0, __pixel(pixels, 16, x, y));
+        }
+    }
+}
+
+static void test_framebuffer_console_write__should__draw_the_glyph_in_its_colors(void) {
+    framebuffer_console_t console;
+    framebuffer_info_t info;
+    u32 pixels[(16 + TEST_PITCH_PADDING) * 32];
+
+    __framebuffer_info(&info, pixels, 16, 32);
+    framebuffer_console_initialize(&console, &info, false);
+
+    /* the top font row of 'I' is .###. and the font starts one pixel in from the top left */
+    framebuffer_console_write(&console, VGA_COLOR_WHITE, VGA_COLOR_BLUE, "xI", 2);
+
+    TEST_ASSERT_EQUAL_HEX32(0x0000aa, __pixel(pixels, 16, 8, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x0000aa, __pixel(pixels, 16, 9, 1));
+    TEST_ASSERT_EQUAL_HEX32(0xffffff, __pixel(pixels, 16, 10, 1));
+    TEST_ASSERT_EQUAL_HEX32(0xffffff, __pixel(pixels, 16, 12, 2));
+    TEST_ASSERT_EQUAL_HEX32(0x0000aa, __pixel(pixels, 16, 13, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, console.cursor_row);
+    TEST_ASSERT_EQUAL_UINT32(0, console.cursor_col);
+}
+
+static void test_framebuffer_console_write__should__scroll_up_past_the_last_row(void) {
+    framebuffer_console_t console;
+    framebuffer_console_t expected_console;
+    framebuffer_info_t info;
+    u32 pixels[(16 + TEST_PITCH_PADDING) * 32];
+    u32 expected[(16 + TEST_PITCH_PADDING) * 32];
+    u32 y;
+
+    __framebuffer_info(&info, pixels, 16, 32);
+    framebuffer_console_initialize(&console, &info, false);
+    __framebuffer_info(&info, expected, 16, 32);
+    framebuffer_console_initialize(&expected_console, &info, false);
+
+    framebuffer_console_write(&console, VGA_COLOR_WHITE, VGA_COLOR_BLACK, "A\nB\nC", 5);
+    framebuffer_console_write(&expected_console, VGA_COLOR_WHITE, VGA_COLOR_BLACK, "B\nC", 3);
+
+    TEST_ASSERT_EQUAL_UINT32(1, console.cursor_row);
+    for (y = 0; y < 32; y++) {
+        TEST_ASSERT_EQUAL_MEMORY(&expected[y * (16 + TEST_PITCH_PADDING)], &pixels[y * (16 + TEST_PITCH_PADDING)], 16 * sizeof(u32));
+    }
+}
+
+static void test_framebuffer_console_write__should__draw_the_same_with_and_without_vectors(void) {
+    framebuffer_console_t scalar_console;
+    framebuffer_console_t vector_console;
+    framebuffer_info_t info;
+    u32 scalar_pixels[(30 + TEST_PITCH_PADDING) * 32];
+    u32 vector_pixels[(30 + TEST_PITCH_PADDING) * 32];
+    u32 y;
+
+    memset(scalar_pixels, 0, sizeof(scalar_pixels));
+    memset(vector_pixels, 0, sizeof(vector_pixels));
+
+    __framebuffer_info(&info, scalar_pixels, 30, 32);
+    framebuffer_console_initialize(&scalar_console, &info, false);
+    __framebuffer_info(&info, vector_pixels, 30, 32);
+    framebuffer_console_initialize(&vector_console, &info, true);
+
+    framebuffer_console_write(&scalar_console, VGA_COLOR_LIGHT_GREEN, VGA_COLOR_RED, "hello\nworld\n42", 14);
+    framebuffer_console_write(&vector_console, VGA_COLOR_LIGHT_GREEN, VGA_COLOR_RED, "hello\nworld\n42", 14);
+
+    for (y = 0; y < 32; y++) {
+        TEST_ASSERT_EQUAL_MEMORY(&scalar_pixels[y * (30 + TEST_PITCH_PADDING)], &vector_pixels[y * (30 + TEST_PITCH_PADDING)], 30 * sizeof(u32));
+    }
+}
+
+
+testfunc_container_t test_function_containers[] = {
+    {"framebuffer_console_initialize should reject unsupported depths", test_framebuffer_console_initialize__should__reject_unsupported_depths},
+    {"framebuffer_console_initialize should clear the screen", test_framebuffer_console_initialize__should__clear_the_screen},
+
+    {"framebuffer_console_write should draw the glyph in its colors", test_framebuffer_console_write__should__draw_the_glyph_in_its_colors},
+    {"framebuffer_console_write should scroll up past the last row", test_framebuffer_console_write__should__scroll_up_past_the_last_row},
+    {"framebuffer_console_write should draw the same with and without vectors", test_framebuffer_console_write__should__draw_the_same_with_and_without_vectors}
+};
+
+int main(void) {
+    const testsuite_t testsuite = {
+        .test_function_containers = test_function_containers,
+        .num_test_function_containers = sizeof(test_function_containers) / sizeof(testfunc_container_t)
+    };
+
+    testsuite_run_tests(&testsuite);
+}
@@ -425,12 +425,12 @@ static void test_vga_printf__should__print_floating_point_negative(void) {
 
 static void test_vga_printf__should__print_floating_point_large(void) {
     vga_t vga;
-    int width = 27;
+    int width = 25;
     int height = 1;
     int length = width * height;
     uint16_t buffer[length];
     uint16_t buffer_expected[] = {
-        'v', 'a', 'l', 'u', 'e', ':', ' ', '1', '3', '5', '2', '3', '1', '2', '4', '5', '3', '8', '.', '0', '2', '7', '3', '4', '3', '7', '5'
+        'v', 'a', 'l', 'u', 'e', ':', ' ', '1', '3', '5', '2', '3', '1', '2', '4', '5', '3', '8', '.', '0', '2', '7', '3', '4', '4'
     };
 
     vga_initialize(&vga, buffer, width, height);
@@ -628,6 +628,184 @@ static void test_vga_printf__should__print_percent_character(void) {
     TEST_ASSERT_EQUAL_MEMORY(buffer_expected, buffer, length * sizeof(uint16_t));
 }
 
+static void test_vga_attach_shadow__should__copy_buffer_into_shadow(void) {
+    vga_t vga;
+    uint16_t buffer[4 * 2];
+    uint16_t shadow[4 * 2];
+
+    vga_initialize(&vga, buffer, 4, 2);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab");
+    vga_attach_shadow(&vga, shadow);
+
+    TEST_ASSERT_EQUAL_MEMORY(buffer, shadow, sizeof(buffer));
+}
+
+static void test_vga_write__should__only_write_to_shadow_until_flushed(void) {
+    vga_t vga;
+    uint16_t buffer[4 * 2];
+    uint16_t shadow[4 * 2];
+
+    vga_initialize(&vga, buffer, 4, 2);
+    vga_attach_shadow(&vga, shadow);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "abcde");
+
+    TEST_ASSERT_EQUAL(0, buffer[0]);
+    TEST_ASSERT_EQUAL('e', shadow[4]);
+
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL_MEMORY(shadow, buffer, sizeof(buffer));
+}
+
+static void test_vga_flush__should__copy_dirty_rows_only(void) {
+    vga_t vga;
+    uint16_t buffer[4 * 3];
+    uint16_t shadow[4 * 3];
+
+    vga_initialize(&vga, buffer, 4, 3);
+    vga_attach_shadow(&vga, shadow);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "\nxy");
+
+    /* anything outside of the dirty row must be left alone */
+    buffer[0] = 'r';
+    buffer[8] = 'r';
+    vga_flush(&vga);
+
+    TEST_ASSERT_EQUAL('r', buffer[0]);
+    TEST_ASSERT_EQUAL('x', buffer[4]);
+    TEST_ASSERT_EQUAL('y', buffer[5]);
+    TEST_ASSERT_EQUAL('r', buffer[8]);
+
+    /* a second flush has nothing left to copy */
+    buffer[4] = 'r';
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL('r', buffer[4]);
+}
+
+static void test_vga_write__should__scroll_when_history_is_attached(void) {
+    vga_t vga;
+    uint16_t buffer[3 * 2];
+    uint16_t history[3 * 4];
+
+    vga_initialize(&vga, buffer, 3, 2);
+    vga_attach_history(&vga, history, 4);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab\ncd\nef");
+    vga_flush(&vga);
+
+    TEST_ASSERT_EQUAL('c', buffer[0]);
+    TEST_ASSERT_EQUAL('d', buffer[1]);
+    TEST_ASSERT_EQUAL('e', buffer[3]);
+    TEST_ASSERT_EQUAL('f', buffer[4]);
+    TEST_ASSERT_EQUAL(1, vga.cursor_row);
+}
+
+static void test_vga_scroll_view__should__show_older_rows_until_new_output(void) {
+    vga_t vga;
+    uint16_t buffer[3 * 2];
+    uint16_t history[3 * 4];
+
+    vga_initialize(&vga, buffer, 3, 2);
+    vga_attach_history(&vga, history, 4);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab\ncd\nef\n");
+
+    /* the view cannot go further back than the oldest row */
+    vga_scroll_view(&vga, 10);
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL('a', buffer[0]);
+    TEST_ASSERT_EQUAL('c', buffer[3]);
+
+    vga_scroll_view(&vga, -1);
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL('c', buffer[0]);
+    TEST_ASSERT_EQUAL('e', buffer[3]);
+
+    vga_put_character(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, 'g');
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL('e', buffer[0]);
+    TEST_ASSERT_EQUAL('g', buffer[3]);
+}
+
+static void test_vga_scroll_view__should__drop_rows_older_than_the_history(void) {
+    vga_t vga;
+    uint16_t buffer[3 * 2];
+    uint16_t history[3 * 3];
+
+    vga_initialize(&vga, buffer, 3, 2);
+    vga_attach_history(&vga, history, 3);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab\ncd\nef\ngh");
+
+    vga_scroll_view(&vga, 10);
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL('c', buffer[0]);
+    TEST_ASSERT_EQUAL('e', buffer[3]);
+}
+
+static u32 __cursor_updates;
+static u16 __cursor_position;
+
+static void __count_cursor_update(u16 position) {
+    __cursor_updates++;
+    __cursor_position = position;
+}
+
+static void test_vga_write__should__move_the_hardware_cursor_once_per_string(void) {
+    vga_t vga;
+    uint16_t buffer[4 * 3];
+
+    vga_initialize(&vga, buffer, 4, 3);
+    vga_attach_hardware_cursor(&vga, __count_cursor_update);
+    __cursor_updates = 0;
+
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "abcde");
+    TEST_ASSERT_EQUAL(1, __cursor_updates);
+    TEST_ASSERT_EQUAL(5, __cursor_position);
+
+    vga_printf(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "%d%s", 12, "xy");
+    TEST_ASSERT_EQUAL(2, __cursor_updates);
+    TEST_ASSERT_EQUAL(9, __cursor_position);
+
+    /* nothing written, nothing moved */
+    vga_write(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "", 0);
+    TEST_ASSERT_EQUAL(2, __cursor_updates);
+}
+
+static void test_vga_flush__should__move_the_hardware_cursor_of_a_shadowed_vga(void) {
+    vga_t vga;
+    uint16_t buffer[4 * 2];
+    uint16_t shadow[4 * 2];
+
+    vga_initialize(&vga, buffer, 4, 2);
+    vga_attach_shadow(&vga, shadow);
+    vga_attach_hardware_cursor(&vga, __count_cursor_update);
+    __cursor_updates = 0;
+
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab");
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "cde");
+    TEST_ASSERT_EQUAL(0, __cursor_updates);
+
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL(1, __cursor_updates);
+    TEST_ASSERT_EQUAL(5, __cursor_position);
+}
+
+static void test_vga_flush__should__hide_the_hardware_cursor_while_scrolled_back(void) {
+    vga_t vga;
+    uint16_t buffer[3 * 2];
+    uint16_t history[3 * 4];
+
+    vga_initialize(&vga, buffer, 3, 2);
+    vga_attach_history(&vga, history, 4);
+    vga_attach_hardware_cursor(&vga, __count_cursor_update);
+    vga_put_string(&vga, VGA_COLOR_BLACK, VGA_COLOR_BLACK, "ab\ncd\nef");
+
+    vga_scroll_view(&vga, 1);
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL(6, __cursor_position);
+
+    vga_scroll_view(&vga, -1);
+    vga_flush(&vga);
+    TEST_ASSERT_EQUAL(5, __cursor_position);
+}
+
 static void test_vga_equal__should__equal_if_all_components_are_equal(void) {
     vga_t first;
     vga_t second;
@@ -779,6 +957,21 @@ testfunc_container_t test_function_containers[] = {
     {"vga_printf should print string with preceeding length", test_vga_printf__should__print_string_with_preceeding_length},
     {"vga_printf should print percent character", test_vga_printf__should__print_percent_character},
 
+    {"vga_attach_shadow should copy buffer into shadow", test_vga_attach_shadow__should__copy_buffer_into_shadow},
+
+    {"vga_write should only write to shadow until flushed", test_vga_write__should__only_write_to_shadow_until_flushed},
+
+    {"vga_write should scroll when history is attached", test_vga_write__should__scroll_when_history_is_attached},
+
+    {"vga_flush should copy dirty rows only", test_vga_flush__should__copy_dirty_rows_only},
+
+    {"vga_scroll_view should show older rows until new output", test_vga_scroll_view__should__show_older_rows_until_new_output},
+    {"vga_scroll_view should drop rows older than the history", test_vga_scroll_view__should__drop_rows_older_than_the_history},
+
+    {"vga_write should move the hardware cursor once per string", test_vga_write__should__move_the_hardware_cursor_once_per_string},
+    {"vga_flush should move the hardware cursor of a shadowed vga", test_vga_flush__should__move_the_hardware_cursor_of_a_shadowed_vga},
+    {"vga_flush should hide the hardware cursor while scrolled back", test_vga_flush__should__hide_the_hardware_cursor_while_scrolled_back},
+
     {"vga_equal should equal if all components are equal", test_vga_equal__should__equal_if_all_components_are_equal},
     {"vga_equal should not equal if buffer addresses are not equal", test_vga_equal__should__not_equal_if_buffer_addresses_are_not_equal},
     {"vga_equal should not equal if widths are not equal", test_vga_equal__should__not_equal_if_widths_are_not_equal},